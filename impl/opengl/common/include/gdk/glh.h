@@ -28,6 +28,15 @@ namespace glh
     std::string GetShaderInfoLog(const GLuint aShaderStageHandle);
     std::string GetProgramInfoLog(const GLuint ashader_programHandle);
     bool GetError(std::string *aErrorCode = nullptr);
+
+    //! checks if the current context lists an extension, with or without its GL_ prefix (e.g "OES_element_index_uint")
+    bool HasExtension(const std::string_view aName);
+
+    //! checks if the current context is an OpenGL ES or WebGL context, rather than desktop OpenGL
+    bool IsEmbeddedProfile();
+
+    //! major version of the current context's api, e.g: 2 for OpenGL ES 2.0, 4 for OpenGL 4.6. 0 if unavailable
+    int GetMajorVersion();
 /*    //std::vector<std::string> GetErrors();
     //void LogErrors(const bool &aDoNotLogIfNoErrors = false);
     void ClearErrors();*/
@@ -39,6 +48,14 @@ namespace glh
         const int aAttributeOffset, 
         const int aTotalNumberOfvertex_attributeComponents);
 
+    //! as above, for components of any type. Offset and stride are in bytes
+    void Enablevertex_attribute(const GLint attributeLocation, 
+        const int aAttributeSize, 
+        const GLenum aType,
+        const GLboolean aNormalized,
+        const size_t aAttributeByteOffset, 
+        const GLsizei aVertexByteStride);
+
     //! provides texture data to the used shader program
     /// @aUniformHandle handle to the active texture uniform in the used shader program
     void BindtextureUniform(const GLuint aUniformHandle, const GLuint atextureHandle, const int atextureUnit);//, final GLenum &atextureType);
@@ -3,6 +3,8 @@
 #include <gdk/color.h>
 #include <gdk/glh.h>
 
+#include <cctype>
+#include <sstream>
 #include <vector>
 
 namespace glh
@@ -12,8 +14,22 @@ namespace glh
         glClearColor(acolor.r, acolor.g, acolor.b, acolor.a);
     }
 
-    /// TODO: Hugely wasetful! Stop attrib location polling! ahh!!
     void Enablevertex_attribute(const GLint attributeLocation, const int aAttributeSize, const int aAttributeOffset, const int aTotalNumberOfvertex_attributeComponents)
+    {
+        Enablevertex_attribute(attributeLocation, 
+            aAttributeSize, 
+            GL_FLOAT, 
+            GL_FALSE, 
+            sizeof(GLfloat) * aAttributeOffset, 
+            sizeof(GLfloat) * aTotalNumberOfvertex_attributeComponents);
+    }
+
+    void Enablevertex_attribute(const GLint attributeLocation, 
+        const int aAttributeSize, 
+        const GLenum aType,
+        const GLboolean aNormalized,
+        const size_t aAttributeByteOffset, 
+        const GLsizei aVertexByteStride)
     {
         glEnableVertexAttribArray(attributeLocation);
     
@@ -21,10 +37,79 @@ namespace glh
         glVertexAttribPointer(
             attributeLocation, //Position attribute index
             aAttributeSize,    //Pos size
-            GL_FLOAT,          //data type of each member of the format (must be uniform, look at glbindbufferdata, it takes an array or ptr to an array, so no suprise) TODO: support different types.
-            GL_FALSE,
-            sizeof(GLfloat) * aTotalNumberOfvertex_attributeComponents,
-            reinterpret_cast<void *>(sizeof(GLfloat) * aAttributeOffset));
+            aType,             //data type of each component of the attribute
+            aNormalized,       //integer types are read as [-1, 1] or [0, 1] if normalized
+            aVertexByteStride,
+            reinterpret_cast<void *>(aAttributeByteOffset));
+    }
+
+    //! checks if an extension name is aName, with or without its GL_ prefix
+    static bool IsExtension(const std::string_view aExtension, const std::string_view aName)
+    {
+        return aExtension == aName || (aExtension.size() == aName.size() + 3 && 
+            !aExtension.compare(0, 3, "GL_") && !aExtension.compare(3, std::string_view::npos, aName));
+    }
+
+    bool HasExtension(const std::string_view aName)
+    {
+#if defined GL_NUM_EXTENSIONS
+        // core profiles do not provide the space separated list, and fail glGetString(GL_EXTENSIONS) with GL_INVALID_ENUM.
+        // glGetStringi is available from 3.0 on, in every profile
+        if (GetMajorVersion() >= 3)
+        {
+            GLint count(0);
+
+            glGetIntegerv(GL_NUM_EXTENSIONS, &count);
+
+            for (GLint i(0); i < count; ++i)
+            {
+                const auto pExtension = reinterpret_cast<const char *>(glGetStringi(GL_EXTENSIONS, static_cast<GLuint>(i)));
+
+                if (pExtension && IsExtension(pExtension, aName)) return true;
+            }
+
+            return false;
+        }
+#endif
+
+        const auto pExtensions = reinterpret_cast<const char *>(glGetString(GL_EXTENSIONS));
+
+        if (!pExtensions) return false;
+
+        std::istringstream extensions(pExtensions);
+
+        for (std::string extension; extensions >> extension;) if (IsExtension(extension, aName)) return true;
+
+        return false;
+    }
+
+    int GetMajorVersion()
+    {
+        const auto pVersion = reinterpret_cast<const char *>(glGetString(GL_VERSION));
+
+        if (!pVersion) return 0;
+
+        // desktop version strings begin with the version, ES and WebGL ones with "OpenGL ES "
+        const std::string_view version(pVersion);
+
+        const auto begin = version.find_first_of("0123456789");
+
+        if (begin == std::string_view::npos) return 0;
+
+        int major(0);
+
+        for (auto i(begin); i < version.size() && std::isdigit(static_cast<unsigned char>(version[i])); ++i) 
+            major = major * 10 + (version[i] - '0');
+
+        return major;
+    }
+
+    bool IsEmbeddedProfile()
+    {
+        const auto pVersion = reinterpret_cast<const char *>(glGetString(GL_VERSION));
+
+        // ES and WebGL version strings begin "OpenGL ES". Assume the lowest common denominator if the version is unavailable
+        return !pVersion || std::string_view(pVersion).find("OpenGL ES") == 0;
     }
 
     void Viewport(const gdk::graphics_intvector2_type& aPos, const gdk::graphics_intvector2_type& aSize)
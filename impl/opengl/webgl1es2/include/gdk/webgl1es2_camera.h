@@ -35,6 +35,9 @@ namespace gdk
         /// \brief World position of camera
         graphics_mat4x4_type m_ViewMatrix = graphics_mat4x4_type::Identity; 
 
+        /// \brief World position of camera, as a vector. Provided to shaders as _CameraPosition
+        graphics_vector3_type m_WorldPosition = graphics_vector3_type::Zero;
+
         /// \brief Projection of the camera
         graphics_mat4x4_type m_ProjectionMatrix = graphics_mat4x4_type::Identity; 
 
@@ -83,6 +86,9 @@ namespace gdk
         //! gets the projection matrix
         virtual graphics_mat4x4_type getProjectionMatrix() const override;
 
+        //! gets the world position the view matrix was last built from
+        const graphics_vector3_type &getWorldPosition() const;
+
         /// \brief set projection matrix from orthographic bounds
         //void setProject(height, width, depth);
 
@@ -0,0 +1,70 @@
+// © 2019 Joseph Cameron - All Rights Reserved
+
+#ifndef GDK_GFX_WEBGL1ES2_COMMAND_REPLAY_H
+#define GDK_GFX_WEBGL1ES2_COMMAND_REPLAY_H
+
+#include <gdk/command_buffer.h>
+#include <gdk/webgl1es2_shared_uniforms.h>
+
+#include <cstddef>
+#include <unordered_map>
+#include <vector>
+
+namespace gdk
+{
+    class webgl1es2_material;
+    class webgl1es2_model;
+    class webgl1es2_shader_program;
+
+    /// \brief executes command buffers against the gl
+    ///
+    /// \detailed tracks the material, program and model most recently bound, so redundant binds recorded by
+    /// independent buffers are skipped. Uniform handles are resolved to locations once per program.
+    /// State is kept across replays, so buffers submitted one after another share the cache.
+    /// \warn must only be used on the thread that owns the gl context
+    class webgl1es2_command_replay final
+    {
+        //! material most recently activated
+        webgl1es2_material *m_pMaterial = nullptr;
+
+        //! true if state or uniforms set by the current material have since been changed by commands
+        bool m_MaterialIsDirty = false;
+
+        //! program of the current material
+        const webgl1es2_shader_program *m_pProgram = nullptr;
+
+        //! model to draw
+        const webgl1es2_model *m_pModel = nullptr;
+
+        //! model whose attributes are currently bound
+        const webgl1es2_model *m_pBoundModel = nullptr;
+
+        //! serial of the program the bound model's attributes were bound against
+        size_t m_BoundModelProgramSerial = 0;
+
+        //! true if the program the bound model's attributes were bound against has conventional attribute locations
+        bool m_BoundModelIsProgramIndependent = false;
+
+        //! camera values
+        webgl1es2_shared_uniforms m_SharedUniforms;
+
+        //! uniform locations per program serial, indexed by uniform handle. 
+        /// UNRESOLVED_LOCATION for handles not yet looked up
+        std::unordered_map<size_t, std::vector<GLint>> m_UniformLocations;
+
+        //! location of a uniform handle in the current program, or -1 if the program does not declare it
+        GLint getUniformLocation(const command_buffer::uniform_handle aUniform);
+
+        //! binds the current model to the current program, if it is not already
+        void bindModel();
+
+    public:
+        //! execute all commands in the buffer
+        void replay(const command_buffer &aCommandBuffer);
+
+        //! forget all cached state. Required if anything other than this object has changed gl state since the last replay
+        void reset();
+    };
+}
+
+#endif
@@ -4,13 +4,48 @@
 #define GDK_GFX_WEBGL1ES2_CONTEXT_H
 
 #include <gdk/graphics_context.h>
+#include <gdk/webgl1es2_command_replay.h>
+#include <gdk/webgl1es2_deletion_queue.h>
+#include <gdk/webgl1es2_geometry_pool.h>
+#include <gdk/webgl1es2_mesh_file.h>
+#include <gdk/webgl1es2_render_state.h>
+#include <gdk/webgl1es2_stream_buffer.h>
+#include <gdk/webgl1es2_upload_queue.h>
+#include <gdk/webgl1es2_upload_thread.h>
+
+#include <memory>
 
 namespace gdk
 {
     //! brief webgl1/gles2.0 context implementation
     class webgl1es2_context final : public graphics::context
     {
+        //! objects released by resources this context made, waiting for delete_released_resources
+        std::shared_ptr<webgl1es2_deletion_queue> m_pDeletionQueue;
+
+        /// \brief state of the gl context this context renders to. shared with the scenes it makes
+        /// \detailed every method that makes or replaces gl objects binds it first, so the objects are released to m_pDeletionQueue
+        std::shared_ptr<webgl1es2_render_state> m_pRenderState;
+
+        //! executes submitted command buffers. caches uniform locations across submissions
+        std::shared_ptr<webgl1es2_command_replay> m_pCommandReplay;
+
+        //! models and textures made pending, waiting to be uploaded
+        std::shared_ptr<webgl1es2_upload_queue> m_pUploadQueue;
+
+        //! optional thread draining m_pUploadQueue into a shared context
+        std::shared_ptr<webgl1es2_upload_thread> m_pUploadThread;
+
+        //! shared buffers that pooled models are sub-allocated from
+        std::shared_ptr<webgl1es2_geometry_pool> m_pGeometryPool;
+
+        //! ring of buffers for transient geometry. made by the first call to get_stream_buffer
+        mutable std::shared_ptr<webgl1es2_stream_buffer> m_pStreamBuffer;
+
     public: 
+        using graphics::context::submit;
+
+
         virtual scene_ptr_type make_scene() const override;
 
         virtual graphics::context::camera_ptr_type make_camera() const override;
@@ -25,10 +60,50 @@ namespace gdk
 
         virtual graphics::context::model_ptr_type make_model(const vertex_data_view &vertexDataView) const override;
 
+        virtual void update_model(model &aModel, const vertex_data_view &aVertexDataView) const override;
+
+        virtual std::vector<graphics::context::model_ptr_type> make_models(const std::vector<vertex_data_view> &aVertexDataViews) const override;
+
+        /// \brief makes a model from a mesh file. The file's data is uploaded straight from the file, without parsing or copies,
+        /// unless it has 32 bit indexes and the context does not support them, in which case it is split as make_model would
+        /// \exception invalid_argument the file has half float attributes, and the context does not support them
+        graphics::context::model_ptr_type make_model(const webgl1es2_mesh_file &aMeshFile) const;
+
+        /// \brief makes a model whose data shares a few large buffers with the context's other pooled models.
+        /// Consecutive draws of pooled models only change attribute pointer offsets, instead of rebinding buffers
+        graphics::context::model_ptr_type make_pooled_model(const vertex_data_view &vertexDataView) const;
+
+        /// \brief the pool that pooled models are made in. compact it after releasing many pooled models
+        webgl1es2_geometry_pool &get_geometry_pool() const;
+
+        virtual graphics::context::model_ptr_type make_pending_model(const vertex_data_view &vertexDataView) const override;
+
         virtual shader_program_ptr_type make_shader(const std::string &aVertexGLSL, const std::string &aFragGLSL) const override;
 
         virtual graphics::context::texture_ptr_type make_texture(const texture::image_data_2d_view &imageView) const override;
 
+        virtual graphics::context::texture_ptr_type make_pending_texture(const texture::image_data_2d_view &imageView) const override;
+
+        virtual size_t upload_pending(const size_t aByteBudget, const std::chrono::microseconds aTimeBudget) const override;
+
+        virtual size_t get_pending_upload_count() const override;
+
+        virtual void start_upload_thread(std::function<void()> aMakeSharedContextCurrent, 
+            std::function<void()> aReleaseSharedContext, 
+            std::function<void()> aSynchronize) override;
+
+        virtual void stop_upload_thread() override;
+
+        virtual size_t delete_released_resources() const override;
+
+        virtual void set_deletion_delay(const size_t aFrames) const override;
+
+        virtual void submit(const std::vector<const command_buffer *> &aCommandBuffers) const override;
+
+        /// \brief the context's buffers for geometry that only lives for one frame. 
+        /// created on first use, so must first be called with the gl context current
+        webgl1es2_stream_buffer &get_stream_buffer() const;
+
         virtual graphics::context::built_in_shader_ptr_type get_alpha_cutoff_shader() const override;
 
         virtual built_in_shader_ptr_type get_pink_shader_of_death() const override;
@@ -42,8 +117,12 @@ namespace gdk
         //! default ctor
         webgl1es2_context(); 
 
-        //! default dtor
-        virtual ~webgl1es2_context() override = default;
+        /// \brief deletes every object released to the context's deletion queue, including the stream buffer's and geometry pool's
+        /// if nothing else holds them. must be called with the gl context current
+        /// \attention resources that outlive the context keep its deletion queue alive and still release their objects to it,
+        /// but nothing flushes it again, so those objects are never deleted: the gl context they belong to may be gone too.
+        /// Release resources before the context
+        virtual ~webgl1es2_context() override;
     };
 }
 
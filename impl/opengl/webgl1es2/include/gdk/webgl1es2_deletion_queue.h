@@ -0,0 +1,97 @@
+// © 2019 Joseph Cameron - All Rights Reserved
+
+#ifndef GDK_GFX_WEBGL1ES2_DELETION_QUEUE_H
+#define GDK_GFX_WEBGL1ES2_DELETION_QUEUE_H
+
+#include <gdk/opengl.h>
+
+#include <cstddef>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+namespace gdk
+{
+    /// \brief gl objects released by their owners, waiting to be deleted by the thread that owns the gl context
+    ///
+    /// \detailed handles created with a deleter from make_deleter push themselves here when destroyed, so releasing the last
+    /// reference to a model, texture or program is safe on any thread. The gl thread calls flush once per frame, 
+    /// which deletes the objects with one glDelete call per type. 
+    /// A delay keeps objects alive for that many further flushes, for drivers that stall when an object still in use by
+    /// an in flight frame is deleted.
+    class webgl1es2_deletion_queue final
+    {
+    public:
+        //! kinds of gl object
+        enum class object_type
+        {
+            buffer, //!< glDeleteBuffers
+            texture, //!< glDeleteTextures
+            shader, //!< glDeleteShader
+            program //!< glDeleteProgram
+        };
+
+        //! deleter type accepted by jfc::unique_handle<GLuint>
+        using deleter_type = std::function<void(const GLuint)>;
+
+    private:
+        //! a released object
+        struct released_object
+        {
+            object_type type; //!< kind of object
+            GLuint handle; //!< the object
+            size_t flushIndex; //!< value of m_FlushCount when the object was released
+        };
+
+        //! guards all members
+        mutable std::mutex m_Mutex;
+
+        //! objects waiting for deletion, in release order
+        std::vector<released_object> m_Released;
+
+        //! number of flushes so far
+        size_t m_FlushCount = 0;
+
+        //! number of flushes an object waits before it is deleted
+        size_t m_Delay = 0;
+
+        //! delete the objects that have waited at least the delay, or all objects
+        size_t flush(const bool aIgnoreDelay);
+
+    public:
+        //! makes a deleter that pushes handles to a queue. If the queue is null, the deleter deletes immediately
+        static deleter_type make_deleter(std::shared_ptr<webgl1es2_deletion_queue> pQueue, const object_type aType);
+
+        //! deletes an object immediately
+        /// \warn must be called by the thread that owns the gl context
+        static void destroy(const object_type aType, const GLuint aHandle);
+
+        //! add a released object. thread safe
+        void push(const object_type aType, const GLuint aHandle);
+
+        //! delete the objects that have waited at least the delay, batched by type
+        /// \return the number of objects deleted
+        /// \warn must be called by the thread that owns the gl context
+        size_t flush();
+
+        //! delete all objects regardless of the delay
+        /// \return the number of objects deleted
+        /// \warn must be called by the thread that owns the gl context
+        size_t flushAll();
+
+        //! set the number of flushes an object waits before being deleted. thread safe
+        void setDelay(const size_t aFlushes);
+
+        //! number of flushes an object waits before being deleted. thread safe
+        size_t getDelay() const;
+
+        //! number of objects waiting. thread safe
+        size_t getPendingCount() const;
+
+        //! objects still waiting are not deleted: the gl context they belong to may no longer exist. flush before destruction
+        ~webgl1es2_deletion_queue() = default;
+    };
+}
+
+#endif
@@ -6,12 +6,14 @@
 #include <gdk/graphics_types.h>
 #include <gdk/webgl1es2_texture.h>
 #include <gdk/webgl1es2_material.h>
+#include <gdk/webgl1es2_uniform_collection.h>
 #include <jfc/default_ptr.h>
 #include <gdk/entity.h>
 
 #include <iosfwd>
 #include <memory>
 #include <string_view>
+#include <vector>
 
 namespace gdk
 {
@@ -29,6 +31,20 @@ namespace gdk
     /// be broken out into a new abstraction. This work would be a good match for the "material" class seen in many engines.
     class webgl1es2_entity final : public entity
     {
+    public:
+        /// \brief uniform values that replace the material's values for one entity, and their compiled form
+        ///
+        /// \detailed shared with the frame packets the entity is extracted to, so the table is compiled once rather than once per 
+        /// extraction. While a packet still refers to a block, the entity replaces the block instead of modifying it
+        struct property_overrides
+        {
+            //! the values
+            webgl1es2_uniform_collection values;
+
+            //! values resolved against the material. rebuilt when either collection's layout or the program changes
+            mutable webgl1es2_uniform_collection::compiled_override_table compiled;
+        };
+
     private:
         //! model used when rendering the entity
         std::shared_ptr<webgl1es2_model> m_model;
@@ -42,6 +58,12 @@ namespace gdk
         //! Whether or not to respect draw calls
         bool m_IsHidden = false;
 
+        //! uniform values that replace the material's values for this entity only. null until the first is set
+        std::shared_ptr<property_overrides> m_pPropertyOverrides;
+
+        //! the overrides, made or replaced so that no frame packet sees the change
+        webgl1es2_uniform_collection &getWritablePropertyOverrides();
+
     public:
         //! do not allow this entity to be drawn
         virtual void hide() override;
@@ -58,11 +80,48 @@ namespace gdk
         //! impl
         virtual std::shared_ptr<material> getMaterial() const override;
 
-        /// \brief draws the webgl1es2_entity at its current world position, with respect to a view and projection matrix.
-        /// generally should not be called by the end user. view, proj, are most easily provided to the webgl1es2_entity 
-        /// via a camera.
+        //! impl
+        virtual void setTexture(const std::string &aName, std::shared_ptr<texture> aTexture) override;
+        //! impl
+        virtual void setFloat(const std::string &aName, float aValue) override;
+        //! impl
+        virtual void setVector2(const std::string &aName, const graphics_vector2_type &aValue) override;
+        //! impl
+        virtual void setVector3(const std::string &aName, const graphics_vector3_type &aValue) override;
+        //! impl
+        virtual void setVector4(const std::string &aName, const graphics_vector4_type &aValue) override;
+        //! impl
+        virtual void setMatrix4x4(const std::string &aName, const graphics_mat4x4_type &aValue) override;
+        //! impl
+        virtual void setInteger(const std::string &aName, int aValue) override;
+
+        //! appends the values of the named uniforms to a buffer, taking overrides first then material values.
+        /// the layout is that of a per instance attribute, for an instanced draw of entities sharing a material.
+        /// No draw path consumes it yet: gles2 and webgl1 only instance through ANGLE_instanced_arrays, which the scene does not use,
+        /// so entities with overrides are drawn one at a time, see draw
+        /// \exception invalid_argument a name is assigned by neither the entity nor the material, or names a texture
+        void packProperties(const std::vector<std::string> &aNames, std::vector<GLfloat> &aBuffer) const;
+
+        /// \brief draws the webgl1es2_entity at its current world position, with respect to a view-projection matrix.
+        /// generally should not be called by the end user. Only the model dependent uniforms (_Model, _MVP) the program 
+        /// declares are assigned; camera and frame level values are provided by webgl1es2_shared_uniforms.
+        /// property overrides that differ from the material's values are assigned before the draw, and the material's values restored after.
+        /// \warn the program must be in use
         //TODO throw if drwa is called and the currently bound model is not m_model?
-        void draw(const graphics_mat4x4_type &aViewMatrix, const graphics_mat4x4_type &aProjectionMatrix) const;
+        void draw(const webgl1es2_shader_program &aShaderProgram, const graphics_mat4x4_type &aViewProjectionMatrix) const;
+
+        /// \brief draws a model as an entity with the given state would be drawn, see draw. 
+        /// used to draw entities extracted by webgl1es2_scene::extract, without a copy of the entity
+        /// \param pPropertyOverrides the entity's overrides. may be null
+        static void draw(const webgl1es2_model &aModel, 
+            const webgl1es2_material &aMaterial, 
+            const graphics_mat4x4_type &aModelMatrix,
+            const property_overrides *const pPropertyOverrides,
+            const webgl1es2_shader_program &aShaderProgram, 
+            const graphics_mat4x4_type &aViewProjectionMatrix);
+
+        //! the entity's property overrides. null if none have been set
+        const std::shared_ptr<property_overrides> &getPropertyOverrides() const;
 
         /// \brief sets this entity's model.
         void set_model(const std::shared_ptr<webgl1es2_model> a);
@@ -72,6 +131,9 @@ namespace gdk
             const graphics_quaternion_type &aRotation, 
             const graphics_vector3_type &aScale = graphics_vector3_type::One) override;
 
+        /// \brief sets the model matrix
+        void set_model_matrix(const graphics_mat4x4_type &aModelMatrix);
+
         /// \brief returns a const ref to the model matrix
         const graphics_mat4x4_type &getModelMatrix() const;
 
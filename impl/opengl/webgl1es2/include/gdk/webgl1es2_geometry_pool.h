@@ -0,0 +1,159 @@
+// © 2019 Joseph Cameron - All Rights Reserved
+
+#ifndef GDK_GFX_WEBGL1ES2_GEOMETRY_POOL_H
+#define GDK_GFX_WEBGL1ES2_GEOMETRY_POOL_H
+
+#include <gdk/opengl.h>
+#include <jfc/unique_handle.h>
+
+#include <cstddef>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <unordered_set>
+#include <vector>
+
+namespace gdk
+{
+    /// \brief places the vertex and index data of many models into a few large shared buffers
+    ///
+    /// \detailed each allocation is a range of a page, a large buffer sub-allocated with an address ordered, coalescing
+    /// free list. Models drawn one after the other from the same page only change their attribute pointer offsets,
+    /// instead of rebinding buffers. Data larger than a page gets a page of its own.
+    /// gles2 cannot copy between or read back buffers, so each page keeps a cpu copy of its contents,
+    /// from which compact rebuilds the page after moving its allocations together.
+    /// Allocations can be released from any thread; all other work must be done by the thread that owns the gl context.
+    class webgl1es2_geometry_pool final : public std::enable_shared_from_this<webgl1es2_geometry_pool>
+    {
+        //! a buffer and the ranges allocated from it
+        struct page;
+
+    public:
+        //! a range of a page. released back to the pool when destroyed
+        class allocation final
+        {
+            friend class webgl1es2_geometry_pool;
+
+            //! keeps the pool alive for as long as its allocations
+            std::shared_ptr<webgl1es2_geometry_pool> m_pPool;
+
+            //! page the range belongs to
+            page *m_pPage;
+
+            //! number of elements preceding the range in the page. changed by compaction
+            size_t m_Offset;
+
+            //! number of elements in the range
+            size_t m_Count;
+
+            allocation(std::shared_ptr<webgl1es2_geometry_pool> pPool, page *const pPage, const size_t aOffset, const size_t aCount);
+
+        public:
+            //! the buffer the range belongs to
+            GLuint getBufferHandle() const;
+
+            //! number of elements preceding the range in the buffer. may change when the pool is compacted
+            size_t getOffset() const;
+
+            //! number of elements in the range
+            size_t getCount() const;
+
+            /// \brief overwrites aCount elements of the range, starting from the element at aOffset
+            /// \exception out_of_range the data does not fit in the range
+            void write(const size_t aOffset, const void *const pData, const size_t aCount);
+
+            //! releases the range
+            ~allocation();
+
+            allocation(const allocation &) = delete;
+            allocation &operator=(const allocation &) = delete;
+        };
+
+    private:
+        struct page
+        {
+            //! GL_ARRAY_BUFFER or GL_ELEMENT_ARRAY_BUFFER
+            GLenum target;
+
+            //! size of one element in bytes
+            size_t elementSize;
+
+            //! number of elements the page holds
+            size_t capacity;
+
+            //! the buffer
+            jfc::unique_handle<GLuint> buffer;
+
+            //! copy of the buffer's contents, used to rebuild it after compaction
+            std::vector<unsigned char> shadow;
+
+            //! free ranges, offset to element count. adjacent ranges are always merged
+            std::map<size_t, size_t> freeRanges;
+
+            //! live allocations of the page
+            std::unordered_set<allocation *> allocations;
+        };
+
+        //! guards the pages
+        mutable std::mutex m_Mutex;
+
+        //! pages holding vertex data
+        std::vector<std::unique_ptr<page>> m_VertexPages;
+
+        //! pages holding index data
+        std::vector<std::unique_ptr<page>> m_IndexPages;
+
+        //! elements in a vertex page
+        size_t m_VertexPageCapacity;
+
+        //! elements in an index page
+        size_t m_IndexPageCapacity;
+
+        //! finds space for aCount elements, making a page if no page has room, and copies the data there
+        std::unique_ptr<allocation> allocate(std::vector<std::unique_ptr<page>> &aPages,
+            const GLenum aTarget,
+            const size_t aElementSize,
+            const size_t aPageCapacity,
+            const void *const pData,
+            const size_t aCount);
+
+        //! returns an allocation's range to its page's free list
+        void release(allocation &aAllocation);
+
+        //! compacts one set of pages, dropping empty ones
+        size_t compact(std::vector<std::unique_ptr<page>> &aPages);
+
+    public:
+        /// \brief copies vertex data to the pool
+        /// \exception invalid_argument there is no data
+        std::unique_ptr<allocation> allocateVertexData(const GLfloat *const pData, const size_t aCount);
+
+        /// \brief copies index data to the pool
+        /// \exception invalid_argument there is no data
+        std::unique_ptr<allocation> allocateIndexData(const GLushort *const pData, const size_t aCount);
+
+        /// \brief moves the allocations of each page to its start, so the free space is one range at its end,
+        /// and deletes pages without allocations. Each page with moved allocations is respecified with one glBufferData
+        /// \return number of allocations moved
+        size_t compact();
+
+        //! number of pages, vertex and index
+        size_t getPageCount() const;
+
+        //! number of live allocations, vertex and index
+        size_t getAllocationCount() const;
+
+        //! number of free elements in the pool's pages, vertex and index
+        size_t getFreeCount() const;
+
+        /// \brief a pool whose pages hold aVertexPageCapacity vertex components or aIndexPageCapacity indexes
+        /// \exception invalid_argument a capacity is 0
+        /// \warn must be owned by a shared_ptr, which its allocations share
+        webgl1es2_geometry_pool(const size_t aVertexPageCapacity, const size_t aIndexPageCapacity);
+
+        webgl1es2_geometry_pool(const webgl1es2_geometry_pool &) = delete;
+        webgl1es2_geometry_pool &operator=(const webgl1es2_geometry_pool &) = delete;
+    };
+}
+
+#endif
@@ -0,0 +1,57 @@
+// © 2019 Joseph Cameron - All Rights Reserved
+
+#ifndef GDK_GFX_WEBGL1ES2_INTERLEAVED_VIEW_H
+#define GDK_GFX_WEBGL1ES2_INTERLEAVED_VIEW_H
+
+#include <gdk/vertex_data_view.h>
+#include <gdk/webgl1es2_model.h>
+#include <gdk/webgl1es2_vertex_format.h>
+
+#include <vector>
+
+namespace gdk
+{
+    /// \brief the data of a vertex_data_view, interleaved into the single buffer layout a webgl1es2_model uploads
+    ///
+    /// \detailed attributes are sorted into a canonical order: conventional attributes by location (a_Position, a_UV, ...),
+    /// then the rest by name. The same attributes therefore always give the same format, whatever order the view's map iterates in.
+    /// The vertex data is allocated once. Each attribute is then converted to its storage type and scattered into the vertexes,
+    /// with a copy of constant size per vertex. Large views are split over the job system.
+    /// If the view's attributes already share a buffer in exactly that layout, the buffer is used as is, and nothing is copied.
+    /// Makes no gl calls, so can be built on any thread
+    struct webgl1es2_interleaved_view final
+    {
+        //! format of the vertex data
+        webgl1es2_vertex_format vertexFormat;
+
+        //! interleaved vertex data. empty if the view's buffer is used as is, see pSharedVertexData
+        std::vector<webgl1es2_model::attribute_component_data_type> vertexData;
+
+        //! the view's buffer, if its attributes were already interleaved in the layout of vertexFormat. null otherwise
+        /// \warn unowning. valid for as long as the view's data
+        const webgl1es2_model::attribute_component_data_type *pSharedVertexData = nullptr;
+
+        //! number of components in the view's buffer, if it is used as is
+        size_t sharedVertexDataSize = 0;
+
+        //! index data. empty if the view was neither indexed nor optimized
+        std::vector<webgl1es2_model::index_data_type> indexData;
+
+        //! buffer usage matching the view's usage hint
+        webgl1es2_model::Type type;
+
+        /// \brief interleaves a view, then optimizes it if the view asks for it.
+        /// HalfFloat attributes are stored as floats unless aSupportsHalfFloatAttributes
+        /// \exception invalid_argument the view has no attributes, its attributes differ in vertex count,
+        /// or an index refers to a vertex that does not exist
+        webgl1es2_interleaved_view(const vertex_data_view &aVertexDataView, const bool aSupportsHalfFloatAttributes);
+
+        //! the vertex data to upload: the view's buffer if it is used as is, otherwise vertexData
+        const webgl1es2_model::attribute_component_data_type *getVertexData() const;
+
+        //! number of components in getVertexData
+        size_t getVertexDataSize() const;
+    };
+}
+
+#endif
@@ -4,15 +4,14 @@
 #define GDK_GFX_WEBGL1ES2_MATERIAL_H
 
 #include <gdk/material.h>
+#include <gdk/webgl1es2_pipeline_state.h>
 #include <gdk/webgl1es2_shader_program.h>
-
-#include <unordered_map>
+#include <gdk/webgl1es2_uniform_collection.h>
 
 namespace gdk
 {
     //! Decides how a model is rendered. Specifies shader effects, textures, etc.
     /// From the perspective of opengl: a collection of uniform values, opengl pipeline state, and the shader program to be used when rendering a model that uses this material
-    //TODO think about how to model blend functionality. -> subclass that provides blend func related state , in opaque case force opaque options.
     class webgl1es2_material : public material
     {
     public:
@@ -21,22 +20,52 @@ namespace gdk
         //! shaders can be shared among many webgl1es2_materials, therefore shared_ptr
         using shader_ptr_type = std::shared_ptr<gdk::webgl1es2_shader_program>;
 
-        //! associative collection: uniform name to texture data
-        using texture_uniform_collection_type = std::unordered_map<std::string, texture_ptr_impl_type>;
-
     private:
         //! the shader used by the webgl1es2_material
         shader_ptr_type m_pShaderProgram;
 
-        //! texture data provided to the shader stages
-        texture_uniform_collection_type m_Textures;
+        //! uniform values provided to the shader stages
+        webgl1es2_uniform_collection m_Uniforms;
+
+        //! m_Uniforms resolved against m_pShaderProgram. rebuilt on first activation after a uniform is added
+        webgl1es2_uniform_collection::compiled_uniform_table m_CompiledUniforms;
+
+        //! blend, depth, cull and color write state
+        webgl1es2_pipeline_state m_PipelineState;
 
     public:
         //! tries to assign a texture value to a texture uniform of the given name. fails silently
         virtual void setTexture(const std::string &aTextureName, texture_ptr_type aTexture) override;
 
+        //! impl
+        virtual void setFloat(const std::string &aName, float aValue) override;
+
+        //! impl
+        virtual void setVector2(const std::string &aName, const graphics_vector2_type &aValue) override;
+
+        //! impl
+        virtual void setVector3(const std::string &aName, const graphics_vector3_type &aValue) override;
+
+        //! impl
+        virtual void setVector4(const std::string &aName, const graphics_vector4_type &aValue) override;
+
+        //! impl
+        virtual void setMatrix4x4(const std::string &aName, const graphics_mat4x4_type &aValue) override;
+
+        //! impl
+        virtual void setInteger(const std::string &aName, int aValue) override;
+
         shader_ptr_type getShaderProgram();
 
+        //! uniform values assigned by this material
+        const webgl1es2_uniform_collection &getUniforms() const;
+
+        //! sets the fixed function state used when drawing with this material
+        void setPipelineState(const webgl1es2_pipeline_state &aPipelineState);
+
+        //! gets the fixed function state used when drawing with this material
+        const webgl1es2_pipeline_state &getPipelineState() const;
+
         //! modifies the opengl state, assigning the program, assigning values to the program's uniforms etc.
         void activate();
 
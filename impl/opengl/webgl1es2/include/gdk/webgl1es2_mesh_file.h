@@ -0,0 +1,142 @@
+// © 2019 Joseph Cameron - All Rights Reserved
+
+#ifndef GDK_GFX_WEBGL1ES2_MESH_FILE_H
+#define GDK_GFX_WEBGL1ES2_MESH_FILE_H
+
+#include <gdk/mapped_file.h>
+#include <gdk/opengl.h>
+#include <gdk/vertex_data_view.h>
+#include <gdk/webgl1es2_model.h>
+#include <gdk/webgl1es2_vertex_format.h>
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace gdk
+{
+    /// \brief a mesh stored in the exact form webgl1es2_model uploads, so that loading it involves no parsing or conversion
+    ///
+    /// \detailed the file is a header, the vertex format and submesh ranges, then the interleaved vertex data and the index data.
+    /// Both blobs are aligned to BLOB_ALIGNMENT bytes from the start of the file.
+    /// Opening a file maps it, validates the header, and rebuilds the vertex format from its records. The blobs are then
+    /// handed to glBufferData straight from the mapping, see webgl1es2_context::make_model.
+    /// Files are written by encode, from the same interleaver make_model uses. All fields are little endian
+    class webgl1es2_mesh_file final
+    {
+    public:
+        //! first 4 bytes of every mesh file: "GDKM"
+        static constexpr std::uint32_t MAGIC = 0x4d4b4447;
+
+        //! version of the layout. files of other versions are rejected
+        static constexpr std::uint32_t VERSION = 1;
+
+        //! alignment of the vertex and index blobs, relative to the start of the file
+        static constexpr size_t BLOB_ALIGNMENT = 16;
+
+        //! a range of the mesh drawn separately, e.g: with its own material
+        struct submesh
+        {
+            std::uint32_t first; //!< first index, or first vertex if the mesh is not indexed
+            std::uint32_t count; //!< number of indexes, or vertexes if the mesh is not indexed
+        };
+
+        //! start of the file
+        struct header
+        {
+            std::uint32_t magic; //!< MAGIC
+            std::uint32_t version; //!< VERSION
+            std::uint32_t type; //!< webgl1es2_model::Type, from the usage hint of the view the file was written from
+            std::uint32_t attributeCount; //!< number of attribute records following the header
+            std::uint32_t submeshCount; //!< number of submesh records following the attribute records
+            std::uint32_t vertexCount; //!< number of vertexes
+            std::uint32_t vertexStride; //!< bytes per vertex
+            std::uint32_t indexSize; //!< bytes per index: 1, 2 or 4. 0 if the mesh is not indexed
+            std::uint32_t indexCount; //!< number of indexes
+            std::array<float, 3> boundsMin; //!< smallest position of any vertex. zero if the mesh has no float a_Position
+            std::array<float, 3> boundsMax; //!< largest position of any vertex. zero if the mesh has no float a_Position
+            std::uint32_t reserved; //!< zero
+            std::uint64_t vertexDataOffset; //!< bytes from the start of the file to the vertex data
+            std::uint64_t indexDataOffset; //!< bytes from the start of the file to the index data
+        };
+
+        //! an attribute of the vertex format, in vertex order
+        struct attribute_record
+        {
+            std::array<char, 32> name; //!< null terminated
+            std::uint32_t size; //!< number of components
+            std::uint32_t type; //!< webgl1es2_vertex_attribute::component_type
+        };
+
+    private:
+        //! the mapped file. null if the mesh views memory owned by the caller
+        std::shared_ptr<mapped_file> m_pFile;
+
+        //! start of the file's contents
+        const std::byte *m_pData = nullptr;
+
+        //! the header, copied out of the file
+        header m_Header;
+
+        //! format of the vertex data
+        webgl1es2_vertex_format m_VertexFormat;
+
+        //! ranges of the mesh
+        std::vector<submesh> m_Submeshes;
+
+        //! views a mapped file, keeping it mapped for the lifetime of the mesh file
+        webgl1es2_mesh_file(std::shared_ptr<mapped_file> pFile);
+
+    public:
+        //! the file's header
+        const header &getHeader() const;
+
+        //! format of the vertex data
+        const webgl1es2_vertex_format &getVertexFormat() const;
+
+        //! buffer usage of models made from the file
+        webgl1es2_model::Type getType() const;
+
+        //! ranges of the mesh. at least one, covering the whole mesh if none were given to encode
+        const std::vector<submesh> &getSubmeshes() const;
+
+        //! the interleaved vertex data, in the file
+        const webgl1es2_model::attribute_component_data_type *getVertexData() const;
+
+        //! number of 4 byte words in the vertex data
+        size_t getVertexDataSize() const;
+
+        //! the index data, in the file. null if the mesh is not indexed
+        const void *getIndexData() const;
+
+        //! number of indexes. 0 if the mesh is not indexed
+        size_t getIndexCount() const;
+
+        //! GL_UNSIGNED_BYTE, GL_UNSIGNED_SHORT or GL_UNSIGNED_INT. 0 if the mesh is not indexed
+        GLenum getIndexType() const;
+
+        /// \brief interleaves a view in the layout make_model would give it, then writes it as a mesh file.
+        /// The view's optimization is applied. Indexes are stored in the smallest type that fits.
+        /// HalfFloat attributes are stored as floats unless aUseHalfFloatAttributes,
+        /// since the resulting files can only be loaded by contexts that support half float attributes
+        /// \exception invalid_argument the view is invalid, an attribute name is too long,
+        /// a submesh range exceeds the mesh, or an optimized view has more than one submesh
+        static std::vector<std::byte> encode(const vertex_data_view &aVertexDataView,
+            const std::vector<submesh> &aSubmeshes = {},
+            const bool aUseHalfFloatAttributes = false);
+
+        /// \brief maps a mesh file
+        /// \exception runtime_error the file could not be mapped, or is not a valid mesh file
+        webgl1es2_mesh_file(const std::string &aPath);
+
+        /// \brief views a mesh file already in memory, e.g: embedded in the executable. Every index is checked against the vertex count
+        /// \warn unowning. the data must outlive the mesh file, and be 4 byte aligned
+        /// \exception runtime_error the data is not a valid mesh file, has an index past the last vertex, or is misaligned
+        webgl1es2_mesh_file(const std::byte *const pData, const size_t aSize);
+    };
+}
+
+#endif
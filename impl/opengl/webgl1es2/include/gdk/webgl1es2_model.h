@@ -4,12 +4,16 @@
 #define GDK_GFX_VERTEX_DATA_H
 
 #include <gdk/model.h>
+#include <gdk/webgl1es2_geometry_pool.h>
+#include <gdk/webgl1es2_upload_queue.h>
 #include <gdk/webgl1es2_vertex_format.h>
 #include <jfc/shared_proxy_ptr.h>
 #include <jfc/unique_handle.h>
 
 #include <iosfwd>
+#include <memory>
 #include <string>
+#include <vector>
 
 namespace gdk
 {
@@ -20,8 +24,16 @@ namespace gdk
         //! type that must be used to populate vertex data buffers. All GLES2 attrib types have a float based component type. (float, float vec2, float mat etc)
         using attribute_component_data_type = GLfloat; 
 
-        //! type that must be used for index buffer data
-        using index_data_type = GLushort; 
+        //! type that index data is supplied in. Stored in the smallest of GL_UNSIGNED_BYTE, GL_UNSIGNED_SHORT and GL_UNSIGNED_INT that fits
+        using index_data_type = GLuint; 
+
+        //! part of a model split so that each part can be drawn with 16 bit indexes
+        struct index_chunk
+        {
+            size_t firstVertex; //!< number of vertexes preceding the chunk's vertexes in the vertex buffer
+            size_t firstIndex; //!< number of indexes preceding the chunk's indexes in the index buffer
+            size_t indexCount; //!< number of indexes in the chunk. indexes are relative to the chunk's first vertex
+        };
 
         /// \brief Hint to the graphics device about how the vertex data will be used.
         enum class Type 
@@ -63,37 +75,141 @@ namespace gdk
         };
             
     private:
+        //! data of a model created in the pending state
+        class staged_upload;
+
         //! Handle to the (optional) index buffer in the context
-        jfc::unique_handle<GLuint> m_IndexBufferHandle;
+        mutable jfc::unique_handle<GLuint> m_IndexBufferHandle;
 
         //! total number of indicies
         GLsizei m_IndexCount = 0; 
+
+        //! type of the indexes in the index buffer
+        mutable GLenum m_IndexType = GL_UNSIGNED_SHORT;
+
+        //! parts drawn separately, if the model needed 32 bit indexes on a context without support for them. empty otherwise
+        mutable std::vector<index_chunk> m_IndexChunks;
+
+        //! program given to the most recent bind. split models re-point their attributes at each chunk as they draw
+        mutable const webgl1es2_shader_program *m_pBoundProgram = nullptr;
         
         //! Handle to the vertex buffer in the context
-        jfc::unique_handle<GLuint> m_VertexBufferHandle; 
+        mutable jfc::unique_handle<GLuint> m_VertexBufferHandle; 
         
         //! total number of vertexes
-        GLsizei m_VertexCount = 0; 
+        mutable GLsizei m_VertexCount = 0; 
 
         //! Format of the vertex data
         webgl1es2_vertex_format m_vertex_format = webgl1es2_vertex_format::Pos3uv2; 
 
         //! The primitive type to be generated using the vertex data
         PrimitiveMode m_PrimitiveMode = PrimitiveMode::Triangles; 
+
+        //! usage hint of the buffers
+        Type m_Type = Type::Static;
+
+        //! pool the model's data lives in. null if the model owns its buffers
+        std::shared_ptr<webgl1es2_geometry_pool> m_pGeometryPool;
+
+        //! the model's range of a vertex page of m_pGeometryPool
+        std::unique_ptr<webgl1es2_geometry_pool::allocation> m_pVertexAllocation;
+
+        //! the model's range of an index page of m_pGeometryPool. null if the model is not indexed
+        std::unique_ptr<webgl1es2_geometry_pool::allocation> m_pIndexAllocation;
+
+        //! staged data, if the model was created pending and has not yet been bound since its upload
+        mutable std::shared_ptr<staged_upload> m_pStagedUpload;
+
+        //! takes ownership of the buffers of a completed upload
+        void adoptStagedUpload() const;
+
+        //! throws if the model's buffers are not yet available to update
+        void requireResident() const;
+
+        //! throws if the model was split, since its buffers no longer match the data it was made from
+        void requireUnsplit() const;
         
     public:
         //! Binds this vertex data to the pipeline, enables attributes on the currently used shaderprogram
         /// \brief strong association with draw. If draw is on this instance is not called after bind() has not been called before draw, the behaviour will be unintended
         void bind(const webgl1es2_shader_program &aShaderProgram) const;
 
+        /// \brief binds this vertex data, skipping the buffer bind if pBoundModel, the model bound most recently, 
+        /// shares this model's vertex buffer. Pooled models sharing a page then only change attribute pointer offsets
+        void bind(const webgl1es2_shader_program &aShaderProgram, const webgl1es2_model *const pBoundModel) const;
+
         //! invokes pipeline on the data. data must be bound
         void draw() const;
 
-        /*//! replace current data in the vbo and ibo with new data
-        void updatewebgl1es2_model(const std::vector<attribute_component_data_type> &aNewwebgl1es2_model, 
-            const webgl1es2_vertex_format &aNewvertex_format,
-            const std::vector<GLushort> &aIndexData = std::vector<GLushort>(), 
-            const webgl1es2_model::Type &aNewType = Type::Dynamic);*/
+        //! false while the model's data is waiting in an upload queue. a model must be resident to be bound and drawn
+        virtual bool isResident() const override;
+
+        /// \brief replaces all vertex data. The vertex count may change.
+        /// the buffer is respecified with glBufferData, orphaning its old storage, so the driver does not stall on draws still reading it.
+        /// pooled models overwrite their range of the pool if the size is unchanged, otherwise move to a new range
+        /// \exception invalid_argument the data is empty, or not a whole number of vertexes
+        /// \exception runtime_error the model is not resident, or was split
+        void updateVertexData(const std::vector<attribute_component_data_type> &aVertexData);
+
+        /// \brief replaces all vertex data and its format. see updateVertexData
+        void updateVertexData(const webgl1es2_vertex_format &aVertexFormat, const std::vector<attribute_component_data_type> &aVertexData);
+
+        /// \brief replaces all vertex data and its format with aCount components read from pData. see updateVertexData
+        void updateVertexData(const webgl1es2_vertex_format &aVertexFormat, const attribute_component_data_type *const pData, const size_t aCount);
+
+        /// \brief overwrites aCount components of the vertex data, starting from the component at aOffset, with glBufferSubData.
+        /// a range covering the whole buffer is respecified instead, as updateVertexData
+        /// \exception out_of_range the range exceeds the vertex data
+        /// \exception runtime_error the model is not resident, or was split
+        void updateVertexData(const size_t aOffset, const attribute_component_data_type *const pData, const size_t aCount);
+
+        /// \brief replaces all index data. Empty data removes the index buffer, after which the vertexes are drawn in order.
+        /// the buffer is respecified with glBufferData, orphaning its old storage. The index type is chosen again
+        /// \exception invalid_argument the indexes need 32 bits, which the context or the model's geometry pool does not support
+        /// \exception runtime_error the model is not resident, or was split
+        void updateIndexData(const std::vector<index_data_type> &aIndexData);
+
+        /// \brief overwrites aCount indexes, starting from the index at aOffset, with glBufferSubData.
+        /// a range covering the whole buffer is respecified instead, as updateIndexData
+        /// \exception out_of_range the range exceeds the index data, or an index does not fit in the model's index type
+        /// \exception runtime_error the model is not resident, or was split
+        void updateIndexData(const size_t aOffset, const index_data_type *const pData, const size_t aCount);
+
+        //! the buffer holding the model's vertex data. shared with other models if the model is pooled
+        GLuint getVertexBufferHandle() const;
+
+        //! true if the model's data lives in a geometry pool
+        bool isPooled() const;
+
+        //! usage hint given at construction. used for every respecification of the model's buffers
+        Type getType() const;
+
+        //! number of vertexes
+        size_t getVertexCount() const;
+
+        //! layout of a vertex in the vertex buffer
+        const webgl1es2_vertex_format &getVertexFormat() const;
+
+        //! number of indexes. 0 if the model is not indexed
+        size_t getIndexCount() const;
+
+        //! GL_UNSIGNED_BYTE, GL_UNSIGNED_SHORT or GL_UNSIGNED_INT
+        GLenum getIndexType() const;
+
+        //! the parts the model is drawn in, if it was split. empty otherwise
+        const std::vector<index_chunk> &getIndexChunks() const;
+
+        /// \brief splits indexed vertex data into chunks of at most 65536 vertexes, so that each can be drawn with 16 bit indexes.
+        /// Used for models that need 32 bit indexes on contexts without OES_element_index_uint.
+        /// Vertexes used by more than one chunk are duplicated, and unused vertexes are dropped. 
+        /// aVertexData and aIndexData are replaced by the split data
+        /// \exception invalid_argument the primitive mode is not a list of points, lines or triangles, 
+        /// or the indexes are not a whole number of primitives
+        /// \exception out_of_range an index refers to a vertex that does not exist
+        static std::vector<index_chunk> split_indexes(const size_t aVertexStride,
+            std::vector<attribute_component_data_type> &aVertexData,
+            std::vector<index_data_type> &aIndexData,
+            const PrimitiveMode aPrimitiveMode);
       
         //! equality semantics based on handle values
         bool operator==(const webgl1es2_model &);
@@ -113,7 +229,53 @@ namespace gdk
         webgl1es2_model(const webgl1es2_model::Type &aType, 
             const webgl1es2_vertex_format &avertex_format, 
             const std::vector<attribute_component_data_type> &awebgl1es2_model,
-            const std::vector<GLushort> &aIndexData = std::vector<GLushort>(), 
+            const std::vector<index_data_type> &aIndexData = std::vector<index_data_type>(), 
+            const PrimitiveMode &aPrimitiveMode = PrimitiveMode::Triangles);
+
+        //! creates a model from aVertexDataCount components read from pVertexData. The data is uploaded directly, without a copy
+        webgl1es2_model(const webgl1es2_model::Type &aType, 
+            const webgl1es2_vertex_format &avertex_format, 
+            const attribute_component_data_type *const pVertexData,
+            const size_t aVertexDataCount,
+            const std::vector<index_data_type> &aIndexData = std::vector<index_data_type>(), 
+            const PrimitiveMode &aPrimitiveMode = PrimitiveMode::Triangles);
+
+        /// \brief creates a model from vertex and index data already in the form the gl reads, e.g: mapped from a mesh file.
+        /// Both are uploaded directly, without a copy
+        /// \param aIndexType GL_UNSIGNED_BYTE, GL_UNSIGNED_SHORT or GL_UNSIGNED_INT. ignored if aIndexCount is 0
+        /// \exception invalid_argument there is no vertex data, the index type is unknown, 
+        /// or the indexes are 32 bit and the context does not support them
+        webgl1es2_model(const webgl1es2_model::Type &aType, 
+            const webgl1es2_vertex_format &avertex_format, 
+            const attribute_component_data_type *const pVertexData,
+            const size_t aVertexDataCount,
+            const void *const pIndexData,
+            const size_t aIndexCount,
+            const GLenum aIndexType,
+            const PrimitiveMode &aPrimitiveMode = PrimitiveMode::Triangles);
+
+        //! creates a pending model. The data is staged, then uploaded when the queue is drained.
+        webgl1es2_model(webgl1es2_upload_queue &aUploadQueue,
+            const webgl1es2_model::Type &aType, 
+            const webgl1es2_vertex_format &avertex_format, 
+            std::vector<attribute_component_data_type> &&aVertexData,
+            std::vector<index_data_type> &&aIndexData = std::vector<index_data_type>(), 
+            const PrimitiveMode &aPrimitiveMode = PrimitiveMode::Triangles);
+
+        /// \brief creates a model whose data is sub-allocated from a geometry pool, sharing its buffers with other pooled models
+        /// \exception invalid_argument there is no vertex data, or the indexes need 32 bits. pools store 16 bit indexes
+        webgl1es2_model(webgl1es2_geometry_pool &aGeometryPool,
+            const webgl1es2_vertex_format &avertex_format, 
+            const std::vector<attribute_component_data_type> &aVertexData,
+            const std::vector<index_data_type> &aIndexData = std::vector<index_data_type>(), 
+            const PrimitiveMode &aPrimitiveMode = PrimitiveMode::Triangles);
+
+        //! creates a pooled model from aVertexDataCount components read from pVertexData
+        webgl1es2_model(webgl1es2_geometry_pool &aGeometryPool,
+            const webgl1es2_vertex_format &avertex_format, 
+            const attribute_component_data_type *const pVertexData,
+            const size_t aVertexDataCount,
+            const std::vector<index_data_type> &aIndexData = std::vector<index_data_type>(), 
             const PrimitiveMode &aPrimitiveMode = PrimitiveMode::Triangles);
 
         static const jfc::shared_proxy_ptr<gdk::webgl1es2_model> Quad; //!< a quad with format pos3uv2
@@ -0,0 +1,148 @@
+// © 2019 Joseph Cameron - All Rights Reserved
+
+#ifndef GDK_GFX_WEBGL1ES2_PIPELINE_STATE_H
+#define GDK_GFX_WEBGL1ES2_PIPELINE_STATE_H
+
+#include <gdk/opengl.h>
+
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+
+namespace gdk
+{
+    /// \brief fixed function pipeline state: blending, depth testing, face culling and color writes
+    ///
+    /// \detailed immutable. All state is packed into a single integer key, which is used for equality, hashing,
+    /// diffing against the state currently set in the gl, and as the most significant part of the draw sort key.
+    /// The blend bit is the most significant bit of the key, so sorting by key draws opaque states before blended ones.
+    class webgl1es2_pipeline_state final
+    {
+    public:
+        //! packed representation of the state
+        using key_type = std::uint32_t;
+
+        //! specify whether front- or back-facing polygons can be culled
+        enum class face_culling_mode
+        {
+            none, //!< do not cull any polygons
+            front, //!< cull front facing polygons
+            back, //!< cull back facing polygons
+            front_and_back //!< cull front and back facing polygons
+        };
+
+        //! comparison used by the depth test
+        enum class depth_function
+        {
+            never, //!< never passes
+            less, //!< passes if the incoming depth is less than the stored depth
+            equal, //!< passes if the incoming depth is equal to the stored depth
+            less_or_equal, //!< passes if the incoming depth is less than or equal to the stored depth
+            greater, //!< passes if the incoming depth is greater than the stored depth
+            not_equal, //!< passes if the incoming depth is not equal to the stored depth
+            greater_or_equal, //!< passes if the incoming depth is greater than or equal to the stored depth
+            always //!< always passes
+        };
+
+        //! factor applied to the source or destination color when blending
+        enum class blend_factor
+        {
+            zero, //!< (0, 0, 0, 0)
+            one, //!< (1, 1, 1, 1)
+            source_color, //!< source rgba
+            one_minus_source_color, //!< 1 - source rgba
+            destination_color, //!< destination rgba
+            one_minus_destination_color, //!< 1 - destination rgba
+            source_alpha, //!< source alpha
+            one_minus_source_alpha, //!< 1 - source alpha
+            destination_alpha, //!< destination alpha
+            one_minus_destination_alpha, //!< 1 - destination alpha
+            source_alpha_saturate //!< min(source alpha, 1 - destination alpha)
+        };
+
+    private:
+        //! all state
+        key_type m_Key;
+
+        //! construct directly from a key
+        explicit webgl1es2_pipeline_state(const key_type aKey);
+
+    public:
+        //! whether fragments are depth tested
+        bool getDepthTestEnabled() const;
+        //! whether fragments write to the depth buffer
+        bool getDepthWriteEnabled() const;
+        //! depth test comparison
+        depth_function getDepthFunction() const;
+        //! which polygons are culled
+        face_culling_mode getFaceCullingMode() const;
+        //! whether fragments are blended with the color buffer
+        bool getBlendEnabled() const;
+        //! factor applied to the incoming fragment
+        blend_factor getSourceBlendFactor() const;
+        //! factor applied to the color buffer
+        blend_factor getDestinationBlendFactor() const;
+        //! whether the red, green, blue, alpha channels are written, in bits 0 to 3 respectively
+        std::uint8_t getColorMask() const;
+
+        //! copy with depth test enabled or disabled
+        webgl1es2_pipeline_state withDepthTest(const bool aEnabled) const;
+        //! copy with depth writes enabled or disabled
+        webgl1es2_pipeline_state withDepthWrite(const bool aEnabled) const;
+        //! copy with a different depth test comparison
+        webgl1es2_pipeline_state withDepthFunction(const depth_function aFunction) const;
+        //! copy with a different face culling mode
+        webgl1es2_pipeline_state withFaceCullingMode(const face_culling_mode aMode) const;
+        //! copy with blending enabled using the given factors
+        webgl1es2_pipeline_state withBlend(const blend_factor aSource, const blend_factor aDestination) const;
+        //! copy with blending disabled
+        webgl1es2_pipeline_state withoutBlend() const;
+        //! copy with different channel writes
+        webgl1es2_pipeline_state withColorMask(const bool aRed, const bool aGreen, const bool aBlue, const bool aAlpha) const;
+
+        //! packed state. equal states have equal keys
+        key_type getKey() const;
+
+        //! reconstructs a state from its key
+        static webgl1es2_pipeline_state fromKey(const key_type aKey);
+
+        //! issues gl calls for the parts of this state that differ from the state currently set in the gl
+        void activate() const;
+
+        /// \brief equality semantics
+        bool operator==(const webgl1es2_pipeline_state &) const;
+        /// \brief equality semantics
+        bool operator!=(const webgl1es2_pipeline_state &) const;
+
+        /// \brief copy semantics
+        webgl1es2_pipeline_state(const webgl1es2_pipeline_state &) = default;
+        /// \brief copy semantics
+        webgl1es2_pipeline_state &operator=(const webgl1es2_pipeline_state &) = default;
+
+        //! constructs the opaque state: depth tested and written (less), no culling, no blending, all channels written
+        webgl1es2_pipeline_state();
+
+        //! opaque state. see default ctor
+        static const webgl1es2_pipeline_state Opaque;
+
+        //! depth tested but not written, blended by source alpha. suitable for transparent surfaces
+        static const webgl1es2_pipeline_state AlphaBlended;
+
+        //! depth tested but not written, source added to destination. suitable for particles, glows
+        static const webgl1es2_pipeline_state Additive;
+    };
+}
+
+namespace std
+{
+    //! hash support, so pipeline states can key associative collections
+    template<> struct hash<gdk::webgl1es2_pipeline_state>
+    {
+        size_t operator()(const gdk::webgl1es2_pipeline_state &a) const
+        {
+            return std::hash<gdk::webgl1es2_pipeline_state::key_type>()(a.getKey());
+        }
+    };
+}
+
+#endif
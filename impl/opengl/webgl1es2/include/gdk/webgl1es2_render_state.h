@@ -0,0 +1,114 @@
+// © 2019 Joseph Cameron - All Rights Reserved
+
+#ifndef GDK_GFX_WEBGL1ES2_RENDER_STATE_H
+#define GDK_GFX_WEBGL1ES2_RENDER_STATE_H
+
+#include <gdk/opengl.h>
+#include <gdk/webgl1es2_deletion_queue.h>
+#include <gdk/webgl1es2_pipeline_state.h>
+
+#include <memory>
+#include <optional>
+#include <string>
+#include <unordered_map>
+
+namespace gdk
+{
+    /// \brief what the implementation knows about the state currently set in a gl context, used to skip redundant gl calls,
+    /// and where objects created in the context are released to
+    ///
+    /// \detailed each webgl1es2_context owns one, so independent contexts, including contexts on different threads, 
+    /// do not see each other's state. Like the gl itself, a state is made current per thread: the context's scenes and 
+    /// submissions bind its state for the duration of their work, and code that uses programs, materials and pipeline 
+    /// states records to whichever state is current on the calling thread. 
+    /// Threads that have not bound a state use a default state of their own.
+    class webgl1es2_render_state final
+    {
+        //! handle of the program in use, -1 if unknown
+        GLint m_CurrentProgramHandle = -1;
+
+        //! texture units assigned to sampler uniforms of the program in use, by uniform name
+        std::unordered_map<std::string, GLint> m_TextureUniformNameToUnit;
+
+        //! number of texture units assigned to the program in use
+        GLint m_TextureUnitCount = 0;
+
+        //! the pipeline state most recently set. empty if unknown
+        std::optional<webgl1es2_pipeline_state> m_CurrentPipelineState;
+
+        //! queue that gl objects created under this state are released to. null if they are deleted immediately
+        std::shared_ptr<webgl1es2_deletion_queue> m_pDeletionQueue;
+
+        //! whether the context can draw with 32 bit indexes. queried when the state is made
+        const bool m_SupportsUintIndexes;
+
+        //! whether the context can read half float attributes. queried when the state is made
+        const bool m_SupportsHalfFloatAttributes;
+
+        //! GL_HALF_FLOAT_OES or GL_HALF_FLOAT, depending on the profile of the context
+        const GLenum m_HalfFloatAttributeType;
+
+    public:
+        //! makes a state current on the calling thread for the lifetime of the binding, restoring the previous state after
+        class binding final
+        {
+            //! the state current before this binding
+            webgl1es2_render_state *m_pPrevious;
+
+        public:
+            //! binds a state. if null, the state already current stays current
+            explicit binding(webgl1es2_render_state *const pRenderState);
+
+            //! restores the previous state
+            ~binding();
+
+            binding(const binding &) = delete;
+            binding &operator=(const binding &) = delete;
+        };
+
+        //! the state current on the calling thread
+        static webgl1es2_render_state &current();
+
+        //! records that a program is in use. 
+        /// \return false if it was already in use, in which case glUseProgram can be skipped
+        bool setCurrentProgram(const GLint aProgramHandle);
+
+        //! the unit assigned to a sampler uniform of the program in use, assigning the next unit if the uniform has none
+        GLint getTextureUnit(const std::string &aUniformName);
+
+        //! number of texture units assigned to the program in use
+        GLint getTextureUnitCount() const;
+
+        //! the pipeline state most recently set. empty if unknown
+        const std::optional<webgl1es2_pipeline_state> &getCurrentPipelineState() const;
+
+        //! records the pipeline state set in the gl
+        void setCurrentPipelineState(const webgl1es2_pipeline_state &aPipelineState);
+
+        //! queue that gl objects created while this state is current are released to. null if they are deleted immediately
+        const std::shared_ptr<webgl1es2_deletion_queue> &getDeletionQueue() const;
+
+        //! set the queue that gl objects created while this state is current are released to
+        void setDeletionQueue(std::shared_ptr<webgl1es2_deletion_queue> pDeletionQueue);
+
+        //! true if the context can draw with 32 bit indexes: always for desktop gl, with OES_element_index_uint for gles2 and webgl1
+        bool supportsUintIndexes() const;
+
+        //! true if the context can read half float attributes: with OES_vertex_half_float for gles2 and webgl1,
+        /// ARB_half_float_vertex for desktop gl
+        bool supportsHalfFloatAttributes() const;
+
+        //! the type enum of half float attributes, which differs between the extensions. GL_HALF_FLOAT_OES or GL_HALF_FLOAT
+        GLenum getHalfFloatAttributeType() const;
+
+        //! forget all cached state. Use after gl calls made outside of gdk, so the next activations set all state
+        void invalidate();
+
+        /// \brief makes a state, querying the capabilities of the gl context current on the calling thread.
+        /// The capabilities never change after, so can be read from any thread, e.g: by jobs preparing models.
+        /// If no gl context is current, the lowest common denominator is assumed
+        webgl1es2_render_state();
+    };
+}
+
+#endif
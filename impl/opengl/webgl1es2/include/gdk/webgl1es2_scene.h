@@ -5,10 +5,19 @@
 
 #include <gdk/scene.h>
 #include <gdk/webgl1es2_camera.h>
+#include <gdk/webgl1es2_entity.h>
 #include <gdk/webgl1es2_material.h>
 #include <gdk/webgl1es2_model.h>
+#include <gdk/webgl1es2_render_state.h>
+#include <gdk/webgl1es2_shared_uniforms.h>
+#include <gdk/webgl1es2_transform_slots.h>
+#include <gdk/webgl1es2_triple_buffer.h>
 
+#include <cstdint>
+#include <memory>
 #include <unordered_set>
+#include <utility>
+#include <vector>
 
 // TODO handle entity material & model changes. -> Will need to implement signals... vec<functor> likely. Maybe. This adds bookkeeping complexity, runtime complexity. it may be preferrable for the user to "change" an entities properties by removing the one you no longer want and inserting a new one with new properties.
 namespace gdk
@@ -29,13 +38,81 @@ namespace gdk
         //! associative collection: Materials to {Models to collections of Entities} - Used to optimize GL calls
         using material_to_model_to_entity_collection_collection = std::unordered_map<material_ptr_type, model_to_entity_collection>;
 
+        //! what draw_extracted needs to draw an entity, recorded by extract
+        struct render_record
+        {
+            webgl1es2_material *pMaterial; //!< the entity's material. kept alive by the packet
+            const webgl1es2_model *pModel; //!< the entity's model. kept alive by the packet
+            graphics_mat4x4_type modelMatrix; //!< the entity's model matrix
+            std::shared_ptr<const webgl1es2_entity::property_overrides> pPropertyOverrides; //!< the entity's overrides. may be null
+        };
+
+        //! render relevant copy of the scene, produced by extract and consumed by draw_extracted
+        struct frame_packet
+        {
+            std::vector<webgl1es2_camera> cameras; //!< copies of the scene's cameras
+            std::vector<render_record> entities; //!< records of the visible entities, in draw order
+            std::vector<std::shared_ptr<const void>> resources; //!< the materials and models of the records, once each
+            float time = 0; //!< the scene's time when the packet was extracted
+        };
+
     private:
+        //! a blended entity waiting to be drawn, and its depth from the camera
+        struct blended_entity
+        {
+            float depth; //!< distance of the entity's origin along the camera's forward axis
+            webgl1es2_material *pMaterial; //!< the entity's material
+            const webgl1es2_model *pModel; //!< the entity's model
+            const graphics_mat4x4_type *pModelMatrix; //!< the entity's model matrix
+            const webgl1es2_entity::property_overrides *pPropertyOverrides; //!< the entity's overrides. may be null
+        };
+
         //! cameras used to render this webgl1es2_scene.
         camera_collection_type m_cameras;
 
         //! Nested associative array, used to optimize gl calls.
         material_to_model_to_entity_collection_collection m_MaterialToModelToEntityCollection;
 
+        //! state of the context this scene draws to. null if the scene uses whichever state is current on the drawing thread
+        std::shared_ptr<webgl1es2_render_state> m_pRenderState;
+
+        //! time provided to shaders as _Time. owned by the thread that mutates the scene
+        float m_Time = 0;
+
+        //! camera and frame level uniform values. Updated by draw and draw_extracted, per camera. owned by the drawing thread
+        mutable webgl1es2_shared_uniforms m_SharedUniforms;
+
+        //! blended entities of the camera being drawn. kept between draws so that its storage is reused
+        mutable std::vector<blended_entity> m_BlendedEntities;
+
+        //! packets handed from the thread calling extract to the thread calling draw_extracted
+        mutable webgl1es2_triple_buffer<frame_packet> m_FramePackets;
+
+        //! transforms written by any thread, applied to their entities by draw and extract
+        mutable webgl1es2_transform_slots m_TransformSlots;
+
+        //! entity of each transform slot. null for free slots
+        std::vector<entity_ptr_type> m_TransformSlotEntities;
+
+        //! indices of free transform slots
+        std::vector<size_t> m_FreeTransformSlots;
+
+        //! copies transforms written since the last call to their entities' model matrices
+        void applyTransformSlots() const;
+
+        //! collects a blended entity, to be drawn by drawBlendedEntities once the camera's opaque entities are drawn
+        void addBlendedEntity(const graphics_mat4x4_type &aViewMatrix, 
+            webgl1es2_material *pMaterial, 
+            const webgl1es2_model *pModel, 
+            const graphics_mat4x4_type &aModelMatrix,
+            const webgl1es2_entity::property_overrides *pPropertyOverrides) const;
+
+        //! draws the collected blended entities farthest first, so that the surfaces behind each are already in the color buffer
+        void drawBlendedEntities() const;
+
+        //! batches in draw order: sorted by pipeline state, then program
+        std::vector<std::pair<std::uint64_t, material_to_model_to_entity_collection_collection::const_iterator>> getSortedBatches() const;
+
     public:
         //! impl
         virtual bool contains_camera(camera_ptr_type pCamera) const override;
@@ -53,8 +130,53 @@ namespace gdk
         //! remove an entity from the webgl1es2_scene.
         virtual void remove_entity(entity_ptr_type pEntity) override;
 
-        //! draws the webgl1es2_scene
+        /// \brief assigns a transform slot to an entity, so that its model matrix can be written from any thread with write_transform.
+        /// the slot's transform is applied to the entity by the next draw or extract
+        /// \return the slot
+        /// \warn must not be called while other threads are writing transforms, since the slots may be reallocated
+        size_t add_transform_slot(entity_ptr_type pEntity);
+
+        //! frees a transform slot. a transform written to it but not yet applied is discarded
+        /// \warn must not be called while other threads are writing transforms
+        void remove_transform_slot(const size_t aSlot);
+
+        /// \brief writes the model matrix of a slot's entity. lock free; threads writing different slots never wait for each other
+        /// \warn a slot must not be written by two threads at once
+        void write_transform(const size_t aSlot, const graphics_mat4x4_type &aTransform);
+
+        /// \brief writes the model matrix of a slot's entity from a position, rotation and scale. see write_transform
+        void write_transform(const size_t aSlot, 
+            const graphics_vector3_type &aWorldPos, 
+            const graphics_quaternion_type &aRotation, 
+            const graphics_vector3_type &aScale = graphics_vector3_type::One);
+
+        //! set the time provided to shaders as _Time. draw_extracted uses the time of the extracted packet
+        /// \warn must be called by the thread that mutates the scene
+        void setTime(const float aTime);
+
+        //! draws the webgl1es2_scene. Entities with blended materials are drawn after opaque ones, farthest from the camera first
         virtual void draw(const gdk::graphics_intvector2_type &aFrameBufferSize) const override;
+
+        /// \brief records the cameras and visible entities into a frame packet, then hands it to draw_extracted.
+        ///
+        /// \detailed lets simulation and rendering run on separate threads: the simulation thread mutates the scene 
+        /// and its entities, then calls extract; the render thread calls draw_extracted, which only reads packets.
+        /// Neither waits for the other. 
+        /// Cameras are copied, and each entity is recorded as its model, material, model matrix and property overrides. 
+        /// Materials and models are shared with the packet, not copied, so changes to them must still be synchronized with rendering.
+        /// Overrides are shared too, but entities replace rather than modify overrides a packet refers to
+        /// \warn must be called by the thread that mutates the scene, its cameras and entities
+        void extract();
+
+        /// \brief draws the most recently extracted frame packet. Redraws the previous packet if none has been extracted since.
+        /// \warn must be called by the thread that owns the gl context
+        void draw_extracted(const gdk::graphics_intvector2_type &aFrameBufferSize) const;
+
+        //! constructs a scene that draws with the render state of a specific context
+        explicit webgl1es2_scene(std::shared_ptr<webgl1es2_render_state> pRenderState);
+
+        //! constructs a scene that draws with the render state current on the drawing thread
+        webgl1es2_scene() = default;
     };
 }
 
@@ -19,8 +19,7 @@ namespace gdk
 {
     /// \brief Specifies drawing behaviours at the two programmable stages in the OpenGL ES 2.0/WebGL 1.0 pipeline 
     /// (the vertex shader stage and fragment shader stage)
-    //TODO: consider a "pipeline" abstraction, which specifies all fixed options, then takes a program to specify programmable ones.
-    //TODO: pipline abstraction is required to properly support blend-based transparencies, since frag order matters when blending.
+    /// fixed function options (blending, depth, culling) are specified separately, by webgl1es2_pipeline_state
     class webgl1es2_shader_program final : public shader_program
     {
     public:
@@ -46,16 +45,6 @@ namespace gdk
         //! associative collection which maps an active uniform by its name to its index in the program. used in memoization strategy to reduce opengl api calls
         using active_uniform_collection_type = std::unordered_map<std::string, active_uniform_info>;
 
-        //! specify whether front- or back-facing polygons can be culled
-        // TODO: Does this belong to shader or to a separate "pipline" abstraction? Im not sure. Answer has to do with how strongly associated I believe culmode is to userdefined fragment stage is?
-        enum class FaceCullingMode 
-        {
-            Front, //!< cull front facing polygons
-            Back, //!< cull back facing polygons
-            FrontAndBack, //!< cull front and back facing polygons
-            None //!< do not cull any polygons
-        };
-       
         //! type alias used for setting int2 uniform value
         using integer2_uniform_type = std::array<GLint, 2>;
         //! type alias used for setting int3 uniform value
@@ -63,6 +52,22 @@ namespace gdk
         //! type alias used for setting int4 uniform value
         using integer4_uniform_type = std::array<GLint, 4>;
 
+        //! uniforms whose values are provided by the renderer rather than by materials.
+        /// their locations are resolved once at link time, so assigning them never requires a lookup by name
+        enum class standard_uniform
+        {
+            model, //!< mat4 _Model: the entity's model matrix
+            model_view_projection, //!< mat4 _MVP: projection * view * model
+            view, //!< mat4 _View: the camera's view matrix
+            projection, //!< mat4 _Projection: the camera's projection matrix
+            view_projection, //!< mat4 _ViewProjection: projection * view
+            camera_position, //!< vec3 _CameraPosition: the camera's world position
+            time //!< float _Time: seconds, as provided to the scene
+        };
+
+        //! number of standard uniforms
+        static constexpr size_t STANDARD_UNIFORM_COUNT = 7;
+
     private:
         //! handle to the  vertex shader
         jfc::unique_handle<GLuint> m_VertexShaderHandle;
@@ -79,13 +84,45 @@ namespace gdk
         /// \brief uniform name to metadata
         active_uniform_collection_type m_ActiveUniforms;
 
-        //! Whether or not to discard polygons based on [entity space] normal direction
-        FaceCullingMode m_FaceCullingMode = FaceCullingMode::None;
+        //! process-unique id of this program. Unlike the gl handle, never reused after the program is deleted,
+        /// so it is safe to use as a cache key
+        size_t m_Serial;
+
+        //! true if every active attribute in this program is bound to its conventional location
+        bool m_HasConventionalAttributeLocations = true;
+
+        //! locations of the standard uniforms, -1 for those the program does not declare
+        std::array<GLint, STANDARD_UNIFORM_COUNT> m_StandardUniformLocations;
+
+        //! version of the shared value last uploaded to each standard uniform. 0 if never uploaded
+        mutable std::array<size_t, STANDARD_UNIFORM_COUNT> m_StandardUniformVersions = {};
         
     public:
         //! returns a nonnull optional to an attribute info if one with the given name exists
         std::optional<active_attribute_info> tryGetActiveAttribute(const std::string &aAttributeName) const;
 
+        //! returns a nonnull optional to a uniform info if one with the given name exists
+        std::optional<active_uniform_info> tryGetActiveUniform(const std::string &aUniformName) const;
+
+        //! returns the fixed location an attribute name is bound to before link, if the name is one of the conventional names
+        /// (a_Position, a_UV, a_Normal, a_Color, a_Tangent). Vertex formats built from these names can be bound 
+        /// to any conventional program without a per-program lookup.
+        static std::optional<GLuint> tryGetConventionalAttributeLocation(const std::string &aAttributeName);
+
+        //! whether all active attributes are at their conventional locations. 
+        /// if true, attribute bindings for this program are program independent
+        bool hasConventionalAttributeLocations() const;
+
+        //! process-unique id, suitable as a cache key
+        size_t getSerial() const;
+
+        //! location of a standard uniform, or -1 if the program does not declare it
+        GLint getStandardUniformLocation(const standard_uniform aUniform) const;
+
+        //! records that the value with the given version has been uploaded to a standard uniform.
+        /// \return false if the uniform is not declared or already holds that version, in which case nothing needs uploading
+        bool updateStandardUniformVersion(const standard_uniform aUniform, const size_t aVersion) const;
+
         //! assign a float1 uniform from a float
         void setUniform(const std::string &aName, const GLfloat aValue) const;
         //! assign a float2 uniform from a 2 component vector
@@ -0,0 +1,67 @@
+// © 2019 Joseph Cameron - All Rights Reserved
+
+#ifndef GDK_GFX_WEBGL1ES2_SHARED_UNIFORMS_H
+#define GDK_GFX_WEBGL1ES2_SHARED_UNIFORMS_H
+
+#include <gdk/graphics_types.h>
+#include <gdk/opengl.h>
+
+#include <cstddef>
+
+namespace gdk
+{
+    class webgl1es2_shader_program;
+
+    /// \brief frame and camera level values shared by every draw in a camera pass: view, projection, view-projection,
+    /// camera position and time.
+    ///
+    /// \detailed each value carries a version, drawn from a process-wide counter whenever the value changes.
+    /// Programs remember the version they last received for each standard uniform, so uploading to a program whose
+    /// values are current issues no gl calls. A program used by many batches in a frame receives each value once.
+    class webgl1es2_shared_uniforms final
+    {
+        //! a value and the version it was assigned
+        template<typename value_type>
+        struct versioned
+        {
+            value_type value; //!< the value
+            size_t version; //!< process-unique version of the value
+        };
+
+        //! camera's view matrix
+        versioned<graphics_mat4x4_type> m_View;
+
+        //! camera's projection matrix
+        versioned<graphics_mat4x4_type> m_Projection;
+
+        //! projection * view
+        versioned<graphics_mat4x4_type> m_ViewProjection;
+
+        //! camera's world position
+        versioned<graphics_vector3_type> m_CameraPosition;
+
+        //! time in seconds
+        versioned<GLfloat> m_Time;
+
+    public:
+        //! set the camera level values. versions change only for values that differ from the current ones
+        void setCamera(const graphics_mat4x4_type &aViewMatrix, 
+            const graphics_mat4x4_type &aProjectionMatrix, 
+            const graphics_vector3_type &aCameraPosition);
+
+        //! set the frame time
+        void setTime(const GLfloat aTime);
+
+        //! projection * view
+        const graphics_mat4x4_type &getViewProjectionMatrix() const;
+
+        //! assigns the values the program declares and has not yet received to the currently used program
+        /// \warn the program must be in use
+        void upload(const webgl1es2_shader_program &aShaderProgram) const;
+
+        //! constructs with identity matrices, zero position and time
+        webgl1es2_shared_uniforms();
+    };
+}
+
+#endif
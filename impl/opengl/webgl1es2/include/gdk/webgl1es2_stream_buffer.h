@@ -0,0 +1,129 @@
+// © 2019 Joseph Cameron - All Rights Reserved
+
+#ifndef GDK_GFX_WEBGL1ES2_STREAM_BUFFER_H
+#define GDK_GFX_WEBGL1ES2_STREAM_BUFFER_H
+
+#include <gdk/opengl.h>
+#include <gdk/webgl1es2_model.h>
+#include <gdk/webgl1es2_shader_program.h>
+#include <gdk/webgl1es2_vertex_format.h>
+#include <jfc/unique_handle.h>
+
+#include <cstddef>
+#include <optional>
+#include <vector>
+
+namespace gdk
+{
+    /// \brief storage for geometry that only lives for one frame, such as debug lines, ui and trails
+    ///
+    /// \detailed callers allocate ranges and write vertexes and indexes directly into a cpu staging block.
+    /// flush uploads everything allocated since the previous flush with one glBufferSubData per buffer,
+    /// after which the ranges are drawn at their offsets in the shared buffers.
+    /// The buffers are a ring of vbo/ibo pairs, one per frame: each flush writes to the pair least recently used,
+    /// so the driver does not have to wait for draws of the previous frames to finish reading it.
+    /// Replaces making and deleting a model for each piece of transient geometry.
+    class webgl1es2_stream_buffer final
+    {
+    public:
+        //! type of vertex data components
+        using attribute_component_data_type = webgl1es2_model::attribute_component_data_type;
+
+        //! type of index data. always 16 bit, so streamed geometry does not depend on OES_element_index_uint
+        using index_data_type = GLushort;
+
+        //! a range of the buffers, valid for one frame
+        struct allocation
+        {
+            //! where to write the vertex data. valid until the next flush
+            attribute_component_data_type *pVertexData;
+
+            //! where to write the index data. null if no indexes were allocated. valid until the next flush
+            index_data_type *pIndexData;
+
+            //! number of vertexes allocated
+            size_t vertexCount;
+
+            //! number of indexes allocated. indexes are relative to the first vertex of the allocation
+            size_t indexCount;
+
+            //! number of components preceding the allocation's vertex data in the vertex buffer
+            size_t vertexOffset;
+
+            //! number of indexes preceding the allocation's index data in the index buffer
+            size_t indexOffset;
+
+            //! number of components in one vertex of the allocation
+            size_t vertexStride;
+
+            //! the flush the allocation is uploaded by
+            size_t frame;
+        };
+
+    private:
+        //! a vertex buffer and index buffer written in the same frame
+        struct buffer_pair
+        {
+            jfc::unique_handle<GLuint> vertexBuffer; //!< vertex buffer
+            jfc::unique_handle<GLuint> indexBuffer; //!< index buffer
+        };
+
+        //! the ring of buffers
+        std::vector<buffer_pair> m_Buffers;
+
+        //! vertex data allocated since the last flush. sized to the capacity, so allocations are never moved
+        std::vector<attribute_component_data_type> m_VertexStaging;
+
+        //! index data allocated since the last flush. sized to the capacity, so allocations are never moved
+        std::vector<index_data_type> m_IndexStaging;
+
+        //! number of components allocated since the last flush
+        size_t m_VertexCursor = 0;
+
+        //! number of indexes allocated since the last flush
+        size_t m_IndexCursor = 0;
+
+        //! number of flushes so far
+        size_t m_FrameCount = 0;
+
+    public:
+        /// \brief reserves space for vertexes and indexes in the current frame
+        /// \return empty if the frame does not have enough space left
+        /// \exception invalid_argument there are no vertexes, or the vertexes are indexed and there are too many to be
+        /// referred to by index_data_type
+        std::optional<allocation> tryAllocate(const webgl1es2_vertex_format &aVertexFormat,
+            const size_t aVertexCount,
+            const size_t aIndexCount = 0);
+
+        /// \brief uploads the data written to the current frame's allocations to the next buffers in the ring.
+        /// The allocations can then be drawn, until the following flush.
+        void flush();
+
+        /// \brief binds an allocation and enables the attributes of the format on the program, then draws the allocation.
+        /// Indexed allocations are drawn with glDrawElements, others with glDrawArrays
+        /// \exception invalid_argument the format's stride does not match the allocation's
+        /// \exception runtime_error the allocation has not been flushed, or was flushed before the most recent flush
+        void draw(const allocation &aAllocation,
+            const webgl1es2_vertex_format &aVertexFormat,
+            const webgl1es2_shader_program &aShaderProgram,
+            const webgl1es2_model::PrimitiveMode aPrimitiveMode = webgl1es2_model::PrimitiveMode::Triangles) const;
+
+        //! number of components each frame can hold
+        size_t getVertexCapacity() const;
+
+        //! number of indexes each frame can hold
+        size_t getIndexCapacity() const;
+
+        //! number of frames in the ring
+        size_t getBufferCount() const;
+
+        /// \brief creates the ring of buffers, each pair holding aVertexCapacity components and aIndexCapacity indexes
+        /// \exception invalid_argument aVertexCapacity or aBufferCount is 0
+        webgl1es2_stream_buffer(const size_t aVertexCapacity, const size_t aIndexCapacity, const size_t aBufferCount = 3);
+
+        webgl1es2_stream_buffer(const webgl1es2_stream_buffer &) = delete;
+        webgl1es2_stream_buffer &operator=(const webgl1es2_stream_buffer &) = delete;
+    };
+}
+
+#endif
@@ -5,10 +5,12 @@
 
 #include <gdk/opengl.h>
 #include <gdk/texture.h>
+#include <gdk/webgl1es2_upload_queue.h>
 #include <jfc/unique_handle.h>
 
 #include <array>
 #include <cstddef>
+#include <memory>
 #include <string>
 #include <vector>
 
@@ -130,18 +132,28 @@ namespace gdk
         };
 
     private:
+        //! data of a texture created in the pending state
+        class staged_upload;
+
         //! the target type. Cannot be changed after construction. Decides whether the webgl1es2_texture data is 2d or cubic
         GLenum m_BindTarget;
 
         //! handle to the webgl1es2_texture buffer
-        jfc::unique_handle<GLuint> m_Handle;
+        mutable jfc::unique_handle<GLuint> m_Handle;
+
+        //! staged data, if the texture was created pending and its handle has not been requested since its upload
+        mutable std::shared_ptr<staged_upload> m_pStagedUpload;
     
     public:
         /// \brief returns the handle to the webgl1es2_texture in the opengl context
         //TODO consider abstracting this away. Currently only used by Shader, to bind the webgl1es2_texture. Exposing the raw handle
         // like this makes it trivial to put a webgl1es2_texture into an unintended state for example by getting the handle and deleting it.)
+        /// 0 while the texture is not resident. Binding 0 samples as opaque black.
         GLuint getHandle() const;
 
+        //! false while the texture's data is waiting in an upload queue
+        virtual bool isResident() const override;
+
         /// \brief equality semantics
         bool operator==(const webgl1es2_texture &) const;
         /// \brief equality semantics
@@ -165,6 +177,13 @@ namespace gdk
             const magnification_filter magFilter = magnification_filter::nearest,
             const wrap_mode wrapMode = wrap_mode::repeat);
 
+        /// \brief creates a pending 2d texture. The image data is copied, then uploaded when the queue is drained.
+        webgl1es2_texture(webgl1es2_upload_queue &aUploadQueue,
+            const webgl1es2_texture_2d_data_view_type &textureData2d,
+            const minification_filter minFilter = minification_filter::linear,
+            const magnification_filter magFilter = magnification_filter::nearest,
+            const wrap_mode wrapMode = wrap_mode::repeat);
+
         //TODO cubic ctor
         /// \brief creates a cubic webgl1es2_texture from decoded image data.
         /// \exception dimensions must be power of 2
@@ -0,0 +1,112 @@
+// © 2019 Joseph Cameron - All Rights Reserved
+
+#ifndef GDK_GFX_WEBGL1ES2_TRANSFORM_SLOTS_H
+#define GDK_GFX_WEBGL1ES2_TRANSFORM_SLOTS_H
+
+#include <gdk/graphics_types.h>
+
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+
+namespace gdk
+{
+    /// \brief an array of transforms written by any number of threads and consumed by one, without locks
+    ///
+    /// \detailed writers mark the slots they write in a dirty bitset, so the consumer only visits changed slots.
+    /// Writers to different slots never wait for each other; each slot must only be written by one thread at a time.
+    /// Each slot is guarded by a sequence counter: a slot that is being written while it is consumed is skipped,
+    /// and consumed by the following call instead, since the writer marks it dirty again once done.
+    /// The consumer therefore never sees a partially written transform.
+    class webgl1es2_transform_slots final
+    {
+        //! a transform and its sequence counter
+        struct slot
+        {
+            //! odd while the slot is being written
+            std::atomic<std::uint32_t> sequence{0};
+
+            //! the transform's components, in the order of graphics_mat4x4_type::m
+            std::array<std::atomic<float>, 16> components;
+        };
+
+        //! number of slots
+        size_t m_Size = 0;
+
+        //! the slots
+        std::unique_ptr<slot[]> m_Slots;
+
+        //! one bit per slot, set when the slot is written
+        std::unique_ptr<std::atomic<std::uint64_t>[]> m_DirtyBits;
+
+        //! number of words in m_DirtyBits
+        size_t getDirtyWordCount() const;
+
+    public:
+        /// \brief writes a transform to a slot and marks it dirty. lock free
+        /// \warn a slot must not be written by two threads at once
+        /// \exception out_of_range the slot does not exist
+        void write(const size_t aSlot, const graphics_mat4x4_type &aTransform);
+
+        /// \brief calls aConsumer(slot index, transform) for each slot written since the last call, in slot order, then
+        /// clears the slots' dirty bits. lock free
+        /// \return number of slots consumed
+        /// \warn must only be called by one thread at a time
+        template<typename consumer_type>
+        size_t consume(consumer_type &&aConsumer)
+        {
+            size_t consumedCount(0);
+
+            for (size_t word(0), wordCount(getDirtyWordCount()); word < wordCount; ++word)
+            {
+                // cheap test before the read-modify-write, since most words are usually clean
+                if (!m_DirtyBits[word].load(std::memory_order_relaxed)) continue;
+
+                size_t index(word * 64);
+
+                for (auto bits = m_DirtyBits[word].exchange(0, std::memory_order_acquire); bits; bits >>= 1, ++index)
+                {
+                    if (!(bits & 1)) continue;
+
+                    graphics_mat4x4_type transform;
+
+                    if (read(index, transform))
+                    {
+                        aConsumer(index, transform);
+
+                        ++consumedCount;
+                    }
+                }
+            }
+
+            return consumedCount;
+        }
+
+        /// \brief copies a slot's transform
+        /// \return false if the slot was being written, in which case aTransform is unspecified
+        bool read(const size_t aSlot, graphics_mat4x4_type &aTransform) const;
+
+        //! clears a slot's dirty bit, so that a write not yet consumed is never consumed
+        void discard(const size_t aSlot);
+
+        //! check if a slot has been written since the last consume
+        bool isDirty(const size_t aSlot) const;
+
+        //! number of slots
+        size_t size() const;
+
+        /// \brief changes the number of slots. slots that remain keep their transforms and dirty bits, new slots are identity
+        /// \warn must not be called while other threads are writing or consuming
+        void resize(const size_t aSize);
+
+        //! constructs a set of identity transforms
+        explicit webgl1es2_transform_slots(const size_t aSize = 0);
+
+        webgl1es2_transform_slots(const webgl1es2_transform_slots &) = delete;
+        webgl1es2_transform_slots &operator=(const webgl1es2_transform_slots &) = delete;
+    };
+}
+
+#endif
@@ -0,0 +1,75 @@
+// © 2019 Joseph Cameron - All Rights Reserved
+
+#ifndef GDK_GFX_WEBGL1ES2_TRIPLE_BUFFER_H
+#define GDK_GFX_WEBGL1ES2_TRIPLE_BUFFER_H
+
+#include <array>
+#include <atomic>
+#include <cstdint>
+
+namespace gdk
+{
+    /// \brief lock free single producer, single consumer handoff of the most recent value
+    ///
+    /// \detailed the producer fills the back slot then publishes it; the consumer acquires the most recently published slot.
+    /// Neither side ever waits for the other. If the producer publishes faster than the consumer acquires, 
+    /// intermediate values are skipped. If the consumer acquires faster, it sees the same value again.
+    /// Slots are reused, so values that own allocations (vectors etc.) stop allocating once they reach their steady state size.
+    template<typename value_type>
+    class webgl1es2_triple_buffer final
+    {
+        //! set in m_Middle when it holds a slot published since the consumer's last acquire
+        static constexpr std::uint8_t NEW_BIT = 0x4;
+
+        //! slot index bits
+        static constexpr std::uint8_t INDEX_MASK = 0x3;
+
+        //! storage
+        std::array<value_type, 3> m_Slots;
+
+        //! slot being written by the producer
+        std::uint8_t m_Back = 0;
+
+        //! slot most recently handed off, and whether the consumer has yet to see it
+        std::atomic<std::uint8_t> m_Middle{1};
+
+        //! slot being read by the consumer
+        std::uint8_t m_Front = 2;
+
+    public:
+        //! the slot the producer writes into. 
+        /// \warn producer thread only
+        value_type &back()
+        {
+            return m_Slots[m_Back];
+        }
+
+        //! hands the back slot off to the consumer and gives the producer a free slot
+        /// \warn producer thread only
+        void publish()
+        {
+            m_Back = m_Middle.exchange(m_Back | NEW_BIT, std::memory_order_acq_rel) & INDEX_MASK;
+        }
+
+        //! makes the most recently published slot the front slot, if one has been published since the last call.
+        /// \return true if the front slot changed
+        /// \warn consumer thread only
+        bool acquire()
+        {
+            if (!(m_Middle.load(std::memory_order_relaxed) & NEW_BIT)) return false;
+
+            m_Front = m_Middle.exchange(m_Front, std::memory_order_acq_rel) & INDEX_MASK;
+
+            return true;
+        }
+
+        //! the slot the consumer reads from
+        /// \warn consumer thread only
+        const value_type &front() const
+        {
+            return m_Slots[m_Front];
+        }
+    };
+}
+
+#endif
@@ -0,0 +1,185 @@
+// © 2019 Joseph Cameron - All Rights Reserved
+
+#ifndef GDK_GFX_WEBGL1ES2_UNIFORM_COLLECTION_H
+#define GDK_GFX_WEBGL1ES2_UNIFORM_COLLECTION_H
+
+#include <gdk/graphics_types.h>
+#include <gdk/opengl.h>
+#include <gdk/webgl1es2_texture.h>
+
+#include <cstddef>
+#include <memory>
+#include <optional>
+#include <string>
+#include <vector>
+
+namespace gdk
+{
+    class webgl1es2_shader_program;
+
+    /// \brief a set of typed uniform values, stored by name.
+    ///
+    /// \detailed values are packed into a contiguous blob. Before values can be uploaded the collection must be compiled
+    /// against a program, which resolves names to locations once, producing a flat table of (location, type, offset).
+    /// Uploading a compiled table is a single linear pass with no hashing or string comparisons.
+    class webgl1es2_uniform_collection final
+    {
+    public:
+        //! textures can be shared among many collections
+        using texture_ptr_type = std::shared_ptr<webgl1es2_texture>;
+
+        //! type of a uniform value
+        enum class uniform_type
+        {
+            float1, //!< float
+            float2, //!< vec2
+            float3, //!< vec3
+            float4, //!< vec4
+            mat4x4, //!< mat4
+            integer1, //!< int
+            texture //!< sampler2D
+        };
+
+        //! a uniform whose name has been resolved against a specific program
+        struct compiled_uniform
+        {
+            GLint location; //!< location of the uniform in the program
+            uniform_type type; //!< type of the value
+            size_t offset; //!< byte offset into the value blob, or index into the textures if type is texture
+        };
+
+        //! result of compiling a collection against a program
+        struct compiled_uniform_table
+        {
+            //! serial of the program the table was compiled against
+            size_t programSerial = 0;
+
+            //! layout version of the collection at compile time
+            size_t layoutVersion = 0;
+
+            //! uniforms active in the program, in declaration order
+            std::vector<compiled_uniform> uniforms;
+        };
+
+        //! a value that overrides a value in another collection, resolved against a specific program
+        struct compiled_override
+        {
+            compiled_uniform value; //!< the overriding value
+            std::optional<compiled_uniform> defaultValue; //!< the overridden value, if the defaults assign one
+        };
+
+        //! result of compiling a collection as overrides of another collection
+        struct compiled_override_table
+        {
+            //! serial of the program the table was compiled against
+            size_t programSerial = 0;
+
+            //! layout version of the overriding collection at compile time
+            size_t layoutVersion = 0;
+
+            //! layout version of the default collection at compile time
+            size_t defaultsLayoutVersion = 0;
+
+            //! overrides active in the program, in declaration order
+            std::vector<compiled_override> overrides;
+        };
+
+    private:
+        //! a named value in the blob
+        struct declaration
+        {
+            std::string name; //!< name of the uniform
+            uniform_type type; //!< type of the value
+            size_t offset; //!< byte offset into the value blob, or index into the textures
+        };
+
+        //! named values, in the order they were first assigned
+        std::vector<declaration> m_Declarations;
+
+        //! contiguous storage for all non-texture values
+        std::vector<std::byte> m_Values;
+
+        //! texture values
+        std::vector<texture_ptr_type> m_Textures;
+
+        //! names of the texture values, by index. units are assigned to textures by name
+        std::vector<std::string> m_TextureNames;
+
+        //! incremented whenever a declaration is added. Compiled tables with a different version must be rebuilt
+        size_t m_LayoutVersion = 0;
+
+        //! writes a value to the blob, declaring it if the name is new
+        void setValue(const std::string &aName, const uniform_type aType, const void *pValue, const size_t aSize);
+
+        //! check whether a value in this collection is equal to a value in another collection
+        bool valueEquals(const compiled_uniform &aUniform, 
+            const webgl1es2_uniform_collection &aOther, 
+            const compiled_uniform &aOtherUniform) const;
+
+    public:
+        //! assign a float value
+        void set(const std::string &aName, const GLfloat aValue);
+        //! assign a vec2 value
+        void set(const std::string &aName, const graphics_vector2_type &aValue);
+        //! assign a vec3 value
+        void set(const std::string &aName, const graphics_vector3_type &aValue);
+        //! assign a vec4 value
+        void set(const std::string &aName, const graphics_vector4_type &aValue);
+        //! assign a mat4 value
+        void set(const std::string &aName, const graphics_mat4x4_type &aValue);
+        //! assign an int value
+        void set(const std::string &aName, const GLint aValue);
+        //! assign a texture value
+        void set(const std::string &aName, texture_ptr_type aValue);
+
+        //! check if a value has been assigned to the name
+        bool contains(const std::string &aName) const;
+
+        //! check if no values have been assigned
+        bool empty() const;
+
+        //! current layout version
+        size_t getLayoutVersion() const;
+
+        //! check whether a compiled table is still valid for this collection and the given program
+        bool isCompiled(const compiled_uniform_table &aTable, const webgl1es2_shader_program &aShaderProgram) const;
+
+        //! resolve all names against the program. Names the program does not use are dropped
+        compiled_uniform_table compile(const webgl1es2_shader_program &aShaderProgram) const;
+
+        //! assign all values in a compiled table to the currently used program.
+        /// textures are bound to the units the current render state assigns to their names, as shader_program::setUniform does
+        /// \return the number of textures bound
+        GLint upload(const compiled_uniform_table &aTable) const;
+
+        //! assign a single compiled value to the currently used program
+        /// \exception invalid_argument the value is a texture, and the program in use has no free texture unit for it
+        void upload(const compiled_uniform &aUniform) const;
+
+        //! check whether a compiled override table is still valid for this collection, the defaults and the given program
+        bool isCompiled(const compiled_override_table &aTable, 
+            const webgl1es2_shader_program &aShaderProgram, 
+            const webgl1es2_uniform_collection &aDefaults) const;
+
+        //! resolve all names against the program, as overrides of the values in aDefaults.
+        /// units are assigned by name, so overriding textures are bound to the unit of the texture they override
+        compiled_override_table compileOverrides(const webgl1es2_shader_program &aShaderProgram, 
+            const webgl1es2_uniform_collection &aDefaults) const;
+
+        //! assign the overriding values that differ from the defaults to the currently used program.
+        /// \warn aDefaults must have been uploaded, and must be restored with restoreDefaults before drawing
+        /// anything that should not be overridden
+        void uploadOverrides(const compiled_override_table &aTable, const webgl1es2_uniform_collection &aDefaults) const;
+
+        //! reassign the default values replaced by uploadOverrides. 
+        /// overridden uniforms that the defaults do not assign are reset to zero
+        void restoreDefaults(const compiled_override_table &aTable, const webgl1es2_uniform_collection &aDefaults) const;
+
+        //! append the components of a float, vector, matrix or int value to a buffer, e.g: to build per instance attribute data.
+        /// \return the number of components appended. 0 if no value is assigned to the name
+        /// \exception invalid_argument the value is a texture
+        size_t pack(const std::string &aName, std::vector<GLfloat> &aBuffer) const;
+    };
+}
+
+#endif
@@ -0,0 +1,102 @@
+// © 2019 Joseph Cameron - All Rights Reserved
+
+#ifndef GDK_GFX_WEBGL1ES2_UPLOAD_QUEUE_H
+#define GDK_GFX_WEBGL1ES2_UPLOAD_QUEUE_H
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+
+namespace gdk
+{
+    /// \brief staged resource data waiting to be copied into the gl
+    ///
+    /// \detailed resources created in the pending state stage their cpu side data in a pending_upload and push it to a queue.
+    /// The thread that owns the gl context drains the queue a little each frame, so that loading many resources
+    /// does not stall a single frame.
+    class webgl1es2_upload_queue final
+    {
+    public:
+        //! cpu side data of a resource, and the work required to copy it into the gl
+        class pending_upload
+        {
+            //! set once upload has completed
+            std::atomic<bool> m_IsResident{false};
+
+        public:
+            //! approximate number of bytes upload will copy into the gl
+            virtual size_t getSize() const = 0;
+
+            //! copy the staged data into the gl. called once, by the gl thread
+            virtual void upload() = 0;
+
+            //! true once upload has completed. thread safe
+            bool isResident() const
+            {
+                return m_IsResident.load(std::memory_order_acquire);
+            }
+
+            //! called by the queue after upload
+            void markResident()
+            {
+                m_IsResident.store(true, std::memory_order_release);
+            }
+
+            virtual ~pending_upload() = default;
+        };
+
+        //! uploads are shared by the queue and the resource they belong to
+        using pending_upload_ptr = std::shared_ptr<pending_upload>;
+
+    private:
+        //! guards m_Pending and m_PendingBytes
+        mutable std::mutex m_Mutex;
+
+        //! uploads in the order they were pushed
+        std::deque<pending_upload_ptr> m_Pending;
+
+        //! sum of the sizes of m_Pending
+        size_t m_PendingBytes = 0;
+
+        //! notified when an upload is pushed
+        mutable std::condition_variable m_Pushed;
+
+    public:
+        //! add an upload to the back of the queue. thread safe
+        void push(pending_upload_ptr pUpload);
+
+        /// \brief upload from the front of the queue until either budget is spent. 
+        ///
+        /// \detailed at least one upload is performed if any are pending, so a single upload larger than the budget cannot stall the queue.
+        /// Uploads whose resource has been destroyed are discarded without being uploaded.
+        /// If aSynchronize is set, it is called once after the uploads and before any of them are marked resident.
+        /// A thread draining into a shared context uses it to make its uploads visible to the rendering context.
+        /// If an upload throws, it is discarded, the uploads completed before it are still marked resident, and the exception is rethrown.
+        /// \return number of bytes uploaded
+        /// \warn must be called by a thread with a current gl context
+        size_t drain(const size_t aByteBudget, 
+            const std::chrono::microseconds aTimeBudget, 
+            const std::function<void()> &aSynchronize = {});
+
+        //! upload everything in the queue
+        /// \warn must be called by the thread that owns the gl context
+        size_t drain();
+
+        //! blocks until an upload is pending or the timeout expires
+        /// \return true if an upload is pending
+        bool waitForPending(const std::chrono::milliseconds aTimeout) const;
+
+        //! number of uploads waiting. thread safe
+        size_t getPendingCount() const;
+
+        //! number of bytes waiting. thread safe
+        size_t getPendingBytes() const;
+    };
+}
+
+#endif
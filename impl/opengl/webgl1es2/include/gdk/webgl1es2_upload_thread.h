@@ -0,0 +1,77 @@
+// © 2019 Joseph Cameron - All Rights Reserved
+
+#ifndef GDK_GFX_WEBGL1ES2_UPLOAD_THREAD_H
+#define GDK_GFX_WEBGL1ES2_UPLOAD_THREAD_H
+
+#include <gdk/webgl1es2_upload_queue.h>
+
+#include <atomic>
+#include <exception>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+
+namespace gdk
+{
+    /// \brief drains an upload queue on a dedicated thread, into a gl context shared with the rendering context
+    ///
+    /// \detailed gdk does not create gl contexts, so the user supplies functions that make a context, created
+    /// sharing objects with the rendering context (e.g: a hidden glfw window passed as the share parameter, or an
+    /// eglCreateContext share_context), current on the calling thread and release it again.
+    /// After each batch of uploads the synchronize function is called before the batch is marked resident, 
+    /// guaranteeing the rendering context sees complete data. By default this is glFinish. 
+    /// Where EGL_KHR_fence_sync is available, eglCreateSyncKHR followed by eglClientWaitSyncKHR is a cheaper equivalent.
+    class webgl1es2_upload_thread final
+    {
+    public:
+        //! function acting on the calling thread's gl context
+        using context_function_type = std::function<void()>;
+
+    private:
+        //! queue being drained
+        std::shared_ptr<webgl1es2_upload_queue> m_pQueue;
+
+        //! cleared to ask the thread to stop
+        std::atomic<bool> m_IsRunning{true};
+
+        //! guards m_Exception
+        mutable std::mutex m_ExceptionMutex;
+
+        //! exception that stopped the thread, if any
+        std::exception_ptr m_Exception;
+
+        //! the loader thread
+        std::thread m_Thread;
+
+        //! body of the loader thread
+        void run(const context_function_type aMakeCurrent, 
+            const context_function_type aReleaseCurrent, 
+            const context_function_type aSynchronize);
+
+    public:
+        //! stops the thread, after the batch it is uploading, and waits for it to exit. Uploads still queued stay queued
+        /// \warn not thread safe
+        void stop();
+
+        //! rethrows the exception that stopped the thread, if one did
+        void rethrowIfFailed() const;
+
+        /// \brief starts the thread
+        /// \param aMakeCurrent makes the shared context current on the calling thread. called once, by the new thread
+        /// \param aReleaseCurrent releases the shared context. called once, by the new thread, before it exits
+        /// \param aSynchronize waits for the calling thread's gl commands to complete. if empty, glFinish is used
+        webgl1es2_upload_thread(std::shared_ptr<webgl1es2_upload_queue> pQueue,
+            context_function_type aMakeCurrent,
+            context_function_type aReleaseCurrent,
+            context_function_type aSynchronize = {});
+
+        //! stops the thread. see stop
+        ~webgl1es2_upload_thread();
+
+        webgl1es2_upload_thread(const webgl1es2_upload_thread &) = delete;
+        webgl1es2_upload_thread &operator=(const webgl1es2_upload_thread &) = delete;
+    };
+}
+
+#endif
@@ -3,6 +3,7 @@
 #ifndef GDK_GFX_VERTEXATTRIBUTE_H
 #define GDK_GFX_VERTEXATTRIBUTE_H
 
+#include <cstddef>
 #include <iosfwd>
 #include <string>
 
@@ -11,18 +12,37 @@ namespace gdk
     /// \brief A vertex attribute is a component of a vertex. Typical definitions would include: position, uv, normal, color. Strictly speaking though they are entirely arbitrary.
     ///
     /// \detailed Vertex attributes are made up of an arbitrary set of components.
-    /// In the context of OpenGL, a component is a floating-point value.
-    // TODO: support more than just GLfloat.
+    /// Components are floats in the vertex shader, but can be stored in smaller types to save memory and fetch bandwidth.
     // TODO: may have to break out into two siblings: interleaved attribute and noninterleaved? I am not sure. that may be more appropriately controlled at the format level. Need to whiteboard this.
     struct webgl1es2_vertex_attribute final
     {
         using size_type = unsigned short;
 
+        //! how each component is stored in the vertex buffer
+        enum class component_type
+        {
+            float32, //!< GL_FLOAT
+            float16, //!< GL_HALF_FLOAT_OES. requires OES_vertex_half_float on gles2 and webgl1
+            int8_normalized, //!< GL_BYTE, [-128, 127] read as (2c + 1) / 255, so 0 is not exact
+            uint8_normalized, //!< GL_UNSIGNED_BYTE, [0, 255] read as [0, 1]
+            int16_normalized, //!< GL_SHORT, [-32768, 32767] read as (2c + 1) / 65535, so 0 is not exact
+            uint16_normalized //!< GL_UNSIGNED_SHORT, [0, 65535] read as [0, 1]
+        };
+
         //! name of the vertex attribute, used to access its value within a programmable shader stage. e.g: "a_uv"
         std::string name;
 
         //! number of components in the attribute. TODO: consider renaming to count? size is a bit confusing
         size_type size = 0;
+
+        //! how the components are stored
+        component_type type = component_type::float32;
+
+        //! size of one component in bytes
+        size_t getComponentSize() const;
+
+        //! bytes the attribute occupies in a vertex. padded to a multiple of 4, so that every attribute is 4 byte aligned
+        size_t getPaddedSize() const;
        
         /// \brief equality semantics
         bool operator==(const webgl1es2_vertex_attribute &) const;
@@ -39,8 +59,8 @@ namespace gdk
         /// \brief move semantics
         webgl1es2_vertex_attribute &operator=(webgl1es2_vertex_attribute &&) = default;
         
-        /// \brief constructs an attribute with a given name and number of components
-        webgl1es2_vertex_attribute(const std::string &aName, const unsigned short &aSize);
+        /// \brief constructs an attribute with a given name, number of components and component storage
+        webgl1es2_vertex_attribute(const std::string &aName, const unsigned short &aSize, const component_type aType = component_type::float32);
     };
 }
 
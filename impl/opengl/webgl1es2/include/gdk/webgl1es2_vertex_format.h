@@ -7,6 +7,8 @@
 #include <gdk/webgl1es2_shader_program.h>
 #include <gdk/webgl1es2_vertex_attribute.h>
 
+#include <array>
+#include <optional>
 #include <string>
 #include <vector>
 
@@ -23,23 +25,72 @@ namespace gdk
     /// 8..10 Tangent, then repeat (11-13 goes to Position etc...). Attributes, within the context of the graphics pipeline
     /// represents instanced data. In the context of the Vertex Shader stage, you will be able to access a set of attributes,
     /// representing a single full vertex.
-    /// TODO: need to support different GL types. forcing float is esay to think about but wasteful in the case of many attribs (uv, color, normal).
+    /// Attributes may store their components in smaller types, see webgl1es2_vertex_attribute::component_type.
+    /// Each attribute is padded to a multiple of 4 bytes, so a vertex is always a whole number of 4 byte words,
+    /// and vertex data can still be carried in float sized elements. For all float formats a word is a component.
     /// TODO: need to support multiple vbos instead of just 1. then allow user to type and use as theyd like, potentially interleaving attribs in 1 vbo and not another. e.g vbo1: float, position; vbo2: short, normal, uv interleaved.
     class webgl1es2_vertex_format final
     {
+    public:
+        //! precomputed pointer setup for a single attribute. everything needed to enable it, no names
+        struct attribute_binding
+        {
+            GLuint location; //!< location of the attribute in the program
+            GLint size; //!< number of components in the attribute
+            webgl1es2_vertex_attribute::component_type type; //!< how the components are stored
+            GLint offset; //!< number of bytes preceding the attribute in a vertex
+        };
+
+        //! all the attribute pointer setup required to bind this format to a program
+        using attribute_binding_table = std::vector<attribute_binding>;
+
+    private:
+        //! a binding table built for a program that does not use conventional attribute locations
+        struct program_binding_table
+        {
+            size_t programSerial = 0; //!< serial of the program the table was built for. 0, which no program has, if unused
+            attribute_binding_table table; //!< the bindings
+        };
+
         //! name and # of floats of each attribute in the format
         std::vector<webgl1es2_vertex_attribute> m_Format;
 
-        //! total number of floats in the entire format
+        //! number of 4 byte words in a vertex
         webgl1es2_vertex_attribute::size_type m_SumOfAttributeComponents = 0;       
+
+        //! bindings for attributes with conventional names. Valid for any program with conventional attribute locations
+        attribute_binding_table m_ConventionalBindingTable;
+
+        /// \brief bindings for the programs without conventional attribute locations that the format was most recently bound to.
+        /// Bounded, so that formats outliving many such programs do not accumulate tables; the oldest table is replaced
+        mutable std::array<program_binding_table, 4> m_ProgramBindingTables;
+
+        //! index of the table in m_ProgramBindingTables that the next new program replaces
+        mutable size_t m_NextProgramBindingTable = 0;
+
+        //! gets the binding table for a program, building and caching it if the program is not among the recently seen
+        const attribute_binding_table &getBindingTable(const webgl1es2_shader_program &aShaderProgram) const;
             
     public:
         //! prepares gl context to draw vertex data formatted according to this vertex format
+        /// \warn must be called by the thread that owns the gl context. the table cache is not synchronized, 
+        /// so a format must not be enabled by two threads at once, even when each has its own context
         void enableAttributes(const webgl1es2_shader_program &aShaderProgram) const;
 
-        //! Total number of components (sum of length of attributes)
+        //! prepares gl context to draw vertex data that starts aBaseOffset words into the bound buffer
+        /// \warn see enableAttributes
+        void enableAttributes(const webgl1es2_shader_program &aShaderProgram, const size_t aBaseOffset) const;
+
+        /// \brief size of a vertex in 4 byte words, i.e: the number of vertex data elements per vertex.
+        /// The total number of components if every attribute is float32
         int getSumOfAttributeComponents() const;
 
+        //! the attributes of the format, in vertex order
+        const std::vector<webgl1es2_vertex_attribute> &getAttributes() const;
+
+        //! number of bytes preceding the named attribute in a vertex. empty if the format has no such attribute
+        std::optional<size_t> tryGetAttributeOffset(const std::string &aName) const;
+
         //! copy semantics
         webgl1es2_vertex_format& operator=(const webgl1es2_vertex_format &) = default;
         //! copy semantics
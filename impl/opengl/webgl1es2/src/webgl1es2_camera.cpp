@@ -2,6 +2,7 @@
 
 #include <gdk/webgl1es2_camera.h>
 #include <gdk/webgl1es2_entity.h>
+#include <gdk/webgl1es2_pipeline_state.h>
 
 #include <gdk/intvector2.h>
 #include <gdk/mat4x4.h>
@@ -13,23 +14,13 @@
 #include <gdk/glh.h>
 
 #include <iostream>
-#include <mutex>
 #include <sstream>
 #include <stdexcept>
 
 using namespace gdk;
 
 webgl1es2_camera::webgl1es2_camera()
-{
-    static std::once_flag once;
-
-    std::call_once(once, []()
-    {
-        glEnable(GL_DEPTH_TEST);
-
-        glEnable(GL_SCISSOR_TEST);
-    });
-}
+{}
 
 void webgl1es2_camera::setViewportPosition(const gdk::graphics_vector2_type &a)
 {
@@ -60,6 +51,8 @@ void webgl1es2_camera::set_view_matrix(const gdk::graphics_vector3_type &aWorldP
     m_ViewMatrix.rotate({aRotation.toEuler() * -1});
 
     m_ViewMatrix.translate(aWorldPos * -1);
+
+    m_WorldPosition = aWorldPos;
 }
 
 void webgl1es2_camera::setClearcolor(const gdk::color &acolor)
@@ -80,7 +73,13 @@ void webgl1es2_camera::activate(const gdk::graphics_intvector2_type &aFrameBuffe
     
     glh::Viewport(viewportPixelPosition, viewportPixelSize);
 
+    // enabled here rather than once per process, so that every context a camera is activated in has it enabled
+    glEnable(GL_SCISSOR_TEST);
+
     glh::Scissor(viewportPixelPosition, viewportPixelSize);
+
+    // clears obey the depth and color write masks, so make sure the previous material's masks are not still set
+    if (m_ClearMode != ClearMode::Nothing) webgl1es2_pipeline_state::Opaque.activate();
     
     switch(m_ClearMode)
     {
@@ -118,3 +117,7 @@ graphics_mat4x4_type webgl1es2_camera::getProjectionMatrix() const
     return m_ProjectionMatrix;
 }
 
+const graphics_vector3_type &webgl1es2_camera::getWorldPosition() const
+{
+    return m_WorldPosition;
+}
@@ -0,0 +1,186 @@
+// © 2019 Joseph Cameron - All Rights Reserved
+
+#include <gdk/mat4x4.h>
+
+#include <gdk/webgl1es2_command_replay.h>
+#include <gdk/webgl1es2_material.h>
+#include <gdk/webgl1es2_model.h>
+#include <gdk/webgl1es2_pipeline_state.h>
+#include <gdk/webgl1es2_shader_program.h>
+
+#include <cstring>
+#include <stdexcept>
+#include <string>
+
+using namespace gdk;
+
+static constexpr char TAG[] = "command_replay";
+
+//! marks a handle whose location has not been looked up
+static constexpr GLint UNRESOLVED_LOCATION(-2);
+
+//! copies a payload out of the command arena, which does not guarantee alignment
+template<typename payload_type>
+static payload_type read(const std::byte *pPayload)
+{
+    payload_type payload;
+
+    std::memcpy(&payload, pPayload, sizeof(payload_type));
+
+    return payload;
+}
+
+static graphics_mat4x4_type to_matrix(const float *pFloats)
+{
+    graphics_mat4x4_type matrix;
+
+    std::memcpy(&matrix.m[0][0], pFloats, sizeof(matrix.m));
+
+    return matrix;
+}
+
+GLint webgl1es2_command_replay::getUniformLocation(const command_buffer::uniform_handle aUniform)
+{
+    auto &locations = m_UniformLocations[m_pProgram->getSerial()];
+
+    if (aUniform >= locations.size()) locations.resize(aUniform + 1, UNRESOLVED_LOCATION);
+
+    if (locations[aUniform] == UNRESOLVED_LOCATION)
+    {
+        const auto activeUniform = m_pProgram->tryGetActiveUniform(command_buffer::get_uniform_name(aUniform));
+
+        locations[aUniform] = activeUniform ? activeUniform->location : -1;
+    }
+
+    return locations[aUniform];
+}
+
+void webgl1es2_command_replay::bindModel()
+{
+    // attribute bindings made against a conventional program are valid for every conventional program
+    if (m_pBoundModel == m_pModel && (m_BoundModelProgramSerial == m_pProgram->getSerial() || 
+        (m_BoundModelIsProgramIndependent && m_pProgram->hasConventionalAttributeLocations()))) return;
+
+    m_pModel->bind(*m_pProgram);
+
+    m_pBoundModel = m_pModel;
+    m_BoundModelProgramSerial = m_pProgram->getSerial();
+    m_BoundModelIsProgramIndependent = m_pProgram->hasConventionalAttributeLocations();
+}
+
+void webgl1es2_command_replay::reset()
+{
+    m_pMaterial = nullptr;
+    m_MaterialIsDirty = false;
+    m_pProgram = nullptr;
+    m_pModel = nullptr;
+    m_pBoundModel = nullptr;
+    m_BoundModelProgramSerial = 0;
+    m_BoundModelIsProgramIndependent = false;
+}
+
+void webgl1es2_command_replay::replay(const command_buffer &aCommandBuffer)
+{
+    using command_type = command_buffer::command_type;
+
+    aCommandBuffer.for_each([&](const command_type aType, const std::byte *pPayload)
+    {
+        switch (aType)
+        {
+            case command_type::set_camera:
+            {
+                const auto command = read<command_buffer::set_camera_command>(pPayload);
+
+                m_SharedUniforms.setCamera(to_matrix(command.viewMatrix), 
+                    to_matrix(command.projectionMatrix), 
+                    {command.position[0], command.position[1], command.position[2]});
+            } break;
+
+            case command_type::bind_material:
+            {
+                const auto command = read<command_buffer::bind_material_command>(pPayload);
+
+                const auto pMaterial = static_cast<webgl1es2_material *>(aCommandBuffer.get_material(command.materialIndex).get());
+
+                if (pMaterial == m_pMaterial && !m_MaterialIsDirty) break;
+
+                pMaterial->activate();
+
+                m_pMaterial = pMaterial;
+                m_MaterialIsDirty = false;
+                m_pProgram = pMaterial->getShaderProgram().get();
+            } break;
+
+            case command_type::bind_model:
+            {
+                const auto command = read<command_buffer::bind_model_command>(pPayload);
+
+                m_pModel = static_cast<webgl1es2_model *>(aCommandBuffer.get_model(command.modelIndex).get());
+            } break;
+
+            case command_type::set_uniform:
+            {
+                if (!m_pProgram) throw std::runtime_error(std::string(TAG).append(": set_uniform requires a bound material"));
+
+                const auto command = read<command_buffer::set_uniform_command>(pPayload);
+
+                const auto location = getUniformLocation(command.uniform);
+
+                if (location == -1) break;
+
+                using uniform_type = command_buffer::uniform_type;
+
+                switch (command.type)
+                {
+                    case uniform_type::float1: glUniform1fv(location, 1, command.floats); break;
+                    case uniform_type::float2: glUniform2fv(location, 1, command.floats); break;
+                    case uniform_type::float3: glUniform3fv(location, 1, command.floats); break;
+                    case uniform_type::float4: glUniform4fv(location, 1, command.floats); break;
+                    case uniform_type::mat4x4: glUniformMatrix4fv(location, 1, GL_FALSE, command.floats); break;
+                    case uniform_type::integer1: glUniform1i(location, command.integer); break;
+                }
+
+                m_MaterialIsDirty = true;
+            } break;
+
+            case command_type::set_state:
+            {
+                const auto command = read<command_buffer::set_state_command>(pPayload);
+
+                webgl1es2_pipeline_state::fromKey(static_cast<webgl1es2_pipeline_state::key_type>(command.key)).activate();
+
+                m_MaterialIsDirty = true;
+            } break;
+
+            case command_type::draw:
+            {
+                if (!m_pProgram || !m_pModel) throw std::runtime_error(std::string(TAG).append(": draw requires a bound material and model"));
+
+                // a pending model has nothing to draw yet
+                if (!m_pModel->isResident()) break;
+
+                const auto command = read<command_buffer::draw_command>(pPayload);
+
+                bindModel();
+
+                m_SharedUniforms.upload(*m_pProgram);
+
+                using standard_uniform = webgl1es2_shader_program::standard_uniform;
+
+                if (const auto location = m_pProgram->getStandardUniformLocation(standard_uniform::model); location != -1)
+                {
+                    glUniformMatrix4fv(location, 1, GL_FALSE, command.modelMatrix);
+                }
+
+                if (const auto location = m_pProgram->getStandardUniformLocation(standard_uniform::model_view_projection); location != -1)
+                {
+                    const auto mvp = m_SharedUniforms.getViewProjectionMatrix() * to_matrix(command.modelMatrix);
+
+                    glUniformMatrix4fv(location, 1, GL_FALSE, &mvp.m[0][0]);
+                }
+
+                m_pModel->draw();
+            } break;
+        }
+    });
+}
@@ -1,10 +1,15 @@
 // © 2019 Joseph Cameron - All Rights Reserved
 
+#include <optional>
 #include <stdexcept>
+#include <string>
+#include <utility>
 
+#include <gdk/job_system.h>
 #include <gdk/webgl1es2_camera.h>
 #include <gdk/webgl1es2_context.h>
 #include <gdk/webgl1es2_entity.h>
+#include <gdk/webgl1es2_interleaved_view.h>
 #include <gdk/webgl1es2_material.h>
 #include <gdk/webgl1es2_model.h>
 #include <gdk/webgl1es2_scene.h>
@@ -12,8 +17,32 @@
 
 using namespace gdk;
 
+static constexpr char TAG[] = "webgl1es2_context";
+
 webgl1es2_context::webgl1es2_context()
-{}
+: m_pDeletionQueue(std::make_shared<webgl1es2_deletion_queue>())
+, m_pRenderState(std::make_shared<webgl1es2_render_state>())
+, m_pCommandReplay(std::make_shared<webgl1es2_command_replay>())
+, m_pUploadQueue(std::make_shared<webgl1es2_upload_queue>())
+// 4MB vertex pages and 512KB index pages
+, m_pGeometryPool(std::make_shared<webgl1es2_geometry_pool>(1 << 20, 1 << 18))
+{
+    m_pRenderState->setDeletionQueue(m_pDeletionQueue);
+}
+
+webgl1es2_context::~webgl1es2_context()
+{
+    // the upload thread makes objects in a shared context, so is stopped before the last flush
+    m_pUploadThread.reset();
+
+    const webgl1es2_render_state::binding binding(m_pRenderState.get());
+
+    // buffers owned only by the context are released now, so the flush deletes them
+    m_pStreamBuffer.reset();
+    m_pGeometryPool.reset();
+
+    m_pDeletionQueue->flushAll();
+}
 
 graphics::context::camera_ptr_type webgl1es2_context::make_camera() const 
 {
@@ -57,6 +86,8 @@ graphics::context::material_ptr_type webgl1es2_context::make_material(gdk::graph
 
 graphics::context::shader_program_ptr_type webgl1es2_context::make_shader(const std::string &aVertexGLSL, const std::string &aFragGLSL) const 
 {
+    const webgl1es2_render_state::binding binding(m_pRenderState.get());
+
     return graphics::context::shader_program_ptr_type(
         new webgl1es2_shader_program(aVertexGLSL, aFragGLSL));
 }
@@ -87,7 +118,8 @@ graphics::context::built_in_model_ptr_type webgl1es2_context::get_quad_model() c
         std::shared_ptr<webgl1es2_model>(webgl1es2_model::Quad));
 }
 
-graphics::context::texture_ptr_type webgl1es2_context::make_texture(const texture::image_data_2d_view &imageView) const
+//! adapts a public image view to the webgl1es2 texture data view
+static webgl1es2_texture::webgl1es2_texture_2d_data_view_type to_texture_data_view(const texture::image_data_2d_view &imageView)
 {
     webgl1es2_texture::webgl1es2_texture_2d_data_view_type data;
     data.width = imageView.width;
@@ -103,78 +135,237 @@ graphics::context::texture_ptr_type webgl1es2_context::make_texture(const textur
     }
 
     data.data = imageView.data;
-    
-    return graphics::context::texture_ptr_type(new webgl1es2_texture(data));
+
+    return data;
+}
+
+graphics::context::texture_ptr_type webgl1es2_context::make_texture(const texture::image_data_2d_view &imageView) const
+{
+    const webgl1es2_render_state::binding binding(m_pRenderState.get());
+
+    return graphics::context::texture_ptr_type(new webgl1es2_texture(to_texture_data_view(imageView)));
+}
+
+graphics::context::texture_ptr_type webgl1es2_context::make_pending_texture(const texture::image_data_2d_view &imageView) const
+{
+    const webgl1es2_render_state::binding binding(m_pRenderState.get());
+
+    return graphics::context::texture_ptr_type(new webgl1es2_texture(*m_pUploadQueue, to_texture_data_view(imageView)));
+}
+
+size_t webgl1es2_context::upload_pending(const size_t aByteBudget, const std::chrono::microseconds aTimeBudget) const
+{
+    if (m_pUploadThread) m_pUploadThread->rethrowIfFailed();
+
+    return m_pUploadQueue->drain(aByteBudget, aTimeBudget);
+}
+
+size_t webgl1es2_context::get_pending_upload_count() const
+{
+    return m_pUploadQueue->getPendingCount();
+}
+
+void webgl1es2_context::start_upload_thread(std::function<void()> aMakeSharedContextCurrent, 
+    std::function<void()> aReleaseSharedContext, 
+    std::function<void()> aSynchronize)
+{
+    if (m_pUploadThread) throw std::runtime_error("webgl1es2 context upload thread is already running");
+
+    m_pUploadThread = std::make_shared<webgl1es2_upload_thread>(m_pUploadQueue, 
+        std::move(aMakeSharedContextCurrent), 
+        std::move(aReleaseSharedContext), 
+        std::move(aSynchronize));
+}
+
+void webgl1es2_context::stop_upload_thread()
+{
+    if (!m_pUploadThread) return;
+
+    const auto pUploadThread = std::move(m_pUploadThread);
+
+    pUploadThread->stop();
+
+    pUploadThread->rethrowIfFailed();
+}
+
+size_t webgl1es2_context::delete_released_resources() const
+{
+    return m_pDeletionQueue->flush();
 }
 
-static webgl1es2_model::Type VertexDataViewUsageHintToType(vertex_data_view::UsageHint usageHint)
+void webgl1es2_context::set_deletion_delay(const size_t aFrames) const
 {
-    switch(usageHint)
+    m_pDeletionQueue->setDelay(aFrames);
+}
+
+webgl1es2_stream_buffer &webgl1es2_context::get_stream_buffer() const
+{
+    // 1MB of vertex data and 128KB of index data per frame, over 3 frames
+    static constexpr size_t STREAM_VERTEX_CAPACITY(1 << 18);
+    static constexpr size_t STREAM_INDEX_CAPACITY(1 << 16);
+    static constexpr size_t STREAM_BUFFER_COUNT(3);
+
+    if (!m_pStreamBuffer)
     {
-        case vertex_data_view::UsageHint::Dynamic: return webgl1es2_model::Type::Dynamic;
-        case vertex_data_view::UsageHint::Static: return webgl1es2_model::Type::Static;
-        case vertex_data_view::UsageHint::Streaming: return webgl1es2_model::Type::Stream;
+        const webgl1es2_render_state::binding binding(m_pRenderState.get());
+
+        m_pStreamBuffer = std::make_shared<webgl1es2_stream_buffer>(STREAM_VERTEX_CAPACITY, STREAM_INDEX_CAPACITY, STREAM_BUFFER_COUNT);
     }
 
-    throw std::invalid_argument("unhandled usageHint");
+    return *m_pStreamBuffer;
+}
+
+void webgl1es2_context::submit(const std::vector<const command_buffer *> &aCommandBuffers) const
+{
+    const webgl1es2_render_state::binding binding(m_pRenderState.get());
+
+    // scenes and other direct gl users may have changed state since the last submission
+    m_pCommandReplay->reset();
+
+    for (const auto pCommandBuffer : aCommandBuffers) m_pCommandReplay->replay(*pCommandBuffer);
 }
 
-//TODO remove copy. This is a memory wasteful adapter between public context api and webgles model ctor. How? mody ctor then in ctor do not interleave, instead append to back of vertexbuffer data. additional advantage of removing format and attribute abstraction from web1gles2 impl. this work needs to be moved into the initing functor for m_VertexHandle or whatver within the model impl, then simplify this method, passthrough params of this method to the ctor
 graphics::context::model_ptr_type webgl1es2_context::make_model(const vertex_data_view &vertexDataView) const
 {
-    if (!vertexDataView.m_AttributeData.size()) throw std::invalid_argument("vertex data view must contain at least one attribute data view");
+    const webgl1es2_render_state::binding binding(m_pRenderState.get());
 
-    auto usageType = VertexDataViewUsageHintToType(vertexDataView.m_Usage);
+    const webgl1es2_interleaved_view interleaved(vertexDataView, m_pRenderState->supportsHalfFloatAttributes());
 
-    std::vector<webgl1es2_vertex_attribute> attributeFormats;
+    return graphics::context::model_ptr_type(new gdk::webgl1es2_model(
+        interleaved.type, 
+        interleaved.vertexFormat,
+        interleaved.getVertexData(),
+        interleaved.getVertexDataSize(),
+        interleaved.indexData));
+}
 
-    size_t vertexCount(
-        vertexDataView.m_AttributeData.begin()->second.m_DataLength /
-        vertexDataView.m_AttributeData.begin()->second.m_ComponentCount);
+graphics::context::model_ptr_type webgl1es2_context::make_model(const webgl1es2_mesh_file &aMeshFile) const
+{
+    const webgl1es2_render_state::binding binding(m_pRenderState.get());
 
-    if (!vertexCount) throw std::invalid_argument("vertex attribute data must have data");
+    const auto &format = aMeshFile.getVertexFormat();
 
-    for (const auto &[current_name, current_attribute_data_view] : vertexDataView.m_AttributeData)
-    {
-        attributeFormats.push_back({
-            current_name, 
-            static_cast<short unsigned int>(current_attribute_data_view.m_ComponentCount)});
+    if (!m_pRenderState->supportsHalfFloatAttributes()) for (const auto &attribute : format.getAttributes())
+        if (attribute.type == webgl1es2_vertex_attribute::component_type::float16)
+            throw std::invalid_argument(std::string(TAG).append(": mesh file has half float attributes, which the context does not support"));
 
-        auto currentVertexCount = current_attribute_data_view.m_DataLength /
-            current_attribute_data_view.m_ComponentCount;
+    const auto type = aMeshFile.getType();
 
-        if (currentVertexCount != vertexCount) throw std::invalid_argument("attribute data arrays must contribute to the same number of vertexes");
+    // models needing 32 bit indexes are split into 16 bit chunks, which needs the indexes widened
+    if (aMeshFile.getIndexType() == GL_UNSIGNED_INT && !m_pRenderState->supportsUintIndexes())
+    {
+        const auto pIndexes = static_cast<const GLuint *>(aMeshFile.getIndexData());
+
+        return graphics::context::model_ptr_type(new gdk::webgl1es2_model(
+            type,
+            format,
+            aMeshFile.getVertexData(),
+            aMeshFile.getVertexDataSize(),
+            std::vector<webgl1es2_model::index_data_type>(pIndexes, pIndexes + aMeshFile.getIndexCount())));
     }
 
-    std::vector<attribute_data_view::attribute_component_type> data;
+    return graphics::context::model_ptr_type(new gdk::webgl1es2_model(
+        type,
+        format,
+        aMeshFile.getVertexData(),
+        aMeshFile.getVertexDataSize(),
+        aMeshFile.getIndexData(),
+        aMeshFile.getIndexCount(),
+        aMeshFile.getIndexType()));
+}
+
+void webgl1es2_context::update_model(model &aModel, const vertex_data_view &aVertexDataView) const
+{
+    const webgl1es2_render_state::binding binding(m_pRenderState.get());
+
+    const webgl1es2_interleaved_view interleaved(aVertexDataView, m_pRenderState->supportsHalfFloatAttributes());
+
+    auto &model = static_cast<webgl1es2_model &>(aModel);
 
-    const size_t vertexcount = 
-        vertexDataView.m_AttributeData.begin()->second.m_DataLength / 
-        vertexDataView.m_AttributeData.begin()->second.m_ComponentCount;
+    model.updateVertexData(interleaved.vertexFormat, interleaved.getVertexData(), interleaved.getVertexDataSize());
 
-    //Interleaver. Adapter required to deal with diff between make_model and model ctor. Remvoe this asap.
-    for (size_t vertexcounter(0); vertexcounter < vertexcount; ++vertexcounter) 
+    // indexes of the old data no longer apply. unoptimized views are drawn in order
+    if (interleaved.indexData.size() || model.getIndexCount()) model.updateIndexData(interleaved.indexData);
+}
+
+std::vector<graphics::context::model_ptr_type> webgl1es2_context::make_models(const std::vector<vertex_data_view> &aVertexDataViews) const
+{
+    std::vector<std::optional<webgl1es2_interleaved_view>> prepared(aVertexDataViews.size());
+
+    // interleaving does not touch the gl, so is spread over the job system. large views are split further by the interleaver
+    // capabilities are queried here, since the jobs do not have the gl context
+    const auto supportsHalfFloatAttributes = m_pRenderState->supportsHalfFloatAttributes();
+
+    job_system::get_shared()->parallel_for(0, aVertexDataViews.size(), 1, 
+        [&aVertexDataViews, &prepared, supportsHalfFloatAttributes](const size_t aBegin, const size_t aEnd)
     {
-        for (const auto &[current_name, current_attribute_data_view] : vertexDataView.m_AttributeData)
-        {
-            for (size_t i(0), s(current_attribute_data_view.m_ComponentCount); i < s; ++i)
-            {
-                data.push_back(*(current_attribute_data_view.m_pData + i + (vertexcounter * s)));
-            }
-        }
+        for (auto i(aBegin); i < aEnd; ++i) prepared[i].emplace(aVertexDataViews[i], supportsHalfFloatAttributes);
+    });
+
+    const webgl1es2_render_state::binding binding(m_pRenderState.get());
+
+    std::vector<graphics::context::model_ptr_type> models;
+    models.reserve(aVertexDataViews.size());
+
+    for (auto &current : prepared)
+    {
+        models.push_back(graphics::context::model_ptr_type(new gdk::webgl1es2_model(
+            current->type, 
+            current->vertexFormat,
+            current->getVertexData(),
+            current->getVertexDataSize(),
+            current->indexData)));
+
+        // release each interleaved copy once uploaded, to keep the peak memory of large imports down
+        current.reset();
     }
 
-    webgl1es2_vertex_format vertexFormat(attributeFormats);
+    return models;
+}
+
+graphics::context::model_ptr_type webgl1es2_context::make_pooled_model(const vertex_data_view &vertexDataView) const
+{
+    const webgl1es2_render_state::binding binding(m_pRenderState.get());
 
-    return graphics::context::model_ptr_type(new gdk::webgl1es2_model(
-        gdk::webgl1es2_model::Type::Static, 
-        vertexFormat,
-        data));
+    // pooled models share the pool's buffers, so the usage hint is the pool's
+    const webgl1es2_interleaved_view interleaved(vertexDataView, m_pRenderState->supportsHalfFloatAttributes());
+
+    return graphics::context::model_ptr_type(new gdk::webgl1es2_model(*m_pGeometryPool,
+        interleaved.vertexFormat,
+        interleaved.getVertexData(),
+        interleaved.getVertexDataSize(),
+        interleaved.indexData));
+}
+
+webgl1es2_geometry_pool &webgl1es2_context::get_geometry_pool() const
+{
+    return *m_pGeometryPool;
+}
+
+graphics::context::model_ptr_type webgl1es2_context::make_pending_model(const vertex_data_view &vertexDataView) const
+{
+    const webgl1es2_render_state::binding binding(m_pRenderState.get());
+
+    // no gl calls are made until the upload, so this can run on loader jobs: the capabilities were queried 
+    // on the gl thread when the context made its state, and are only read here
+    webgl1es2_interleaved_view interleaved(vertexDataView, m_pRenderState->supportsHalfFloatAttributes());
+
+    // the upload happens after the caller's data may be gone, so a shared buffer is copied to be staged
+    auto data = interleaved.pSharedVertexData
+        ? std::vector<webgl1es2_model::attribute_component_data_type>(interleaved.getVertexData(), 
+            interleaved.getVertexData() + interleaved.getVertexDataSize())
+        : std::move(interleaved.vertexData);
+
+    return graphics::context::model_ptr_type(new gdk::webgl1es2_model(*m_pUploadQueue,
+        interleaved.type, 
+        interleaved.vertexFormat,
+        std::move(data),
+        std::move(interleaved.indexData)));
 }
 
 graphics::context::scene_ptr_type webgl1es2_context::make_scene() const
 {
     return graphics::context::scene_ptr_type(
-        new gdk::webgl1es2_scene()
+        new gdk::webgl1es2_scene(m_pRenderState)
     );
 }
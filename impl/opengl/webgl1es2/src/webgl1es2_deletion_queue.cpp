@@ -0,0 +1,124 @@
+// © 2019 Joseph Cameron - All Rights Reserved
+
+#include <gdk/webgl1es2_deletion_queue.h>
+
+#include <algorithm>
+
+using namespace gdk;
+
+webgl1es2_deletion_queue::deleter_type webgl1es2_deletion_queue::make_deleter(std::shared_ptr<webgl1es2_deletion_queue> pQueue, 
+    const object_type aType)
+{
+    if (!pQueue) return [aType](const GLuint aHandle)
+    {
+        destroy(aType, aHandle);
+    };
+
+    return [pQueue, aType](const GLuint aHandle)
+    {
+        pQueue->push(aType, aHandle);
+    };
+}
+
+void webgl1es2_deletion_queue::destroy(const object_type aType, const GLuint aHandle)
+{
+    switch (aType)
+    {
+        case object_type::buffer: glDeleteBuffers(1, &aHandle); break;
+        case object_type::texture: glDeleteTextures(1, &aHandle); break;
+        case object_type::shader: glDeleteShader(aHandle); break;
+        case object_type::program: glDeleteProgram(aHandle); break;
+    }
+}
+
+void webgl1es2_deletion_queue::push(const object_type aType, const GLuint aHandle)
+{
+    // unique_handles that have been moved from hold 0, which names no object
+    if (!aHandle) return;
+
+    std::lock_guard<std::mutex> lock(m_Mutex);
+
+    m_Released.push_back({aType, aHandle, m_FlushCount});
+}
+
+//! deletes objects with as few calls as the api allows
+static void destroy_all(const std::vector<GLuint> &aBuffers, 
+    const std::vector<GLuint> &aTextures, 
+    const std::vector<GLuint> &aShaders, 
+    const std::vector<GLuint> &aPrograms)
+{
+    if (aBuffers.size()) glDeleteBuffers(static_cast<GLsizei>(aBuffers.size()), aBuffers.data());
+
+    if (aTextures.size()) glDeleteTextures(static_cast<GLsizei>(aTextures.size()), aTextures.data());
+
+    // programs before shaders: attached shaders are only deleted once no longer attached
+    for (const auto handle : aPrograms) glDeleteProgram(handle);
+
+    for (const auto handle : aShaders) glDeleteShader(handle);
+}
+
+size_t webgl1es2_deletion_queue::flush(const bool aIgnoreDelay)
+{
+    std::vector<GLuint> buffers, textures, shaders, programs;
+
+    {
+        std::lock_guard<std::mutex> lock(m_Mutex);
+
+        const auto flushIndex = m_FlushCount++;
+
+        // objects are in release order, so the ones that have waited long enough are at the front
+        const auto firstKept = aIgnoreDelay ? m_Released.end() : std::find_if(m_Released.begin(), m_Released.end(), 
+            [this, flushIndex](const released_object &a)
+            {
+                return flushIndex - a.flushIndex < m_Delay;
+            });
+
+        for (auto iter = m_Released.begin(); iter != firstKept; ++iter)
+        {
+            switch (iter->type)
+            {
+                case object_type::buffer: buffers.push_back(iter->handle); break;
+                case object_type::texture: textures.push_back(iter->handle); break;
+                case object_type::shader: shaders.push_back(iter->handle); break;
+                case object_type::program: programs.push_back(iter->handle); break;
+            }
+        }
+
+        m_Released.erase(m_Released.begin(), firstKept);
+    }
+
+    destroy_all(buffers, textures, shaders, programs);
+
+    return buffers.size() + textures.size() + shaders.size() + programs.size();
+}
+
+size_t webgl1es2_deletion_queue::flush()
+{
+    return flush(false);
+}
+
+size_t webgl1es2_deletion_queue::flushAll()
+{
+    return flush(true);
+}
+
+void webgl1es2_deletion_queue::setDelay(const size_t aFlushes)
+{
+    std::lock_guard<std::mutex> lock(m_Mutex);
+
+    m_Delay = aFlushes;
+}
+
+size_t webgl1es2_deletion_queue::getDelay() const
+{
+    std::lock_guard<std::mutex> lock(m_Mutex);
+
+    return m_Delay;
+}
+
+size_t webgl1es2_deletion_queue::getPendingCount() const
+{
+    std::lock_guard<std::mutex> lock(m_Mutex);
+
+    return m_Released.size();
+}
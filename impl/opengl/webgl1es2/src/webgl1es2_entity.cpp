@@ -9,6 +9,8 @@
 #include <gdk/webgl1es2_shader_program.h>
 #include <gdk/webgl1es2_model.h>
 
+#include <stdexcept>
+
 using namespace gdk;
 
 static constexpr char TAG[] = "entity";
@@ -18,22 +20,65 @@ webgl1es2_entity::webgl1es2_entity(const std::shared_ptr<webgl1es2_model> amodel
 , m_Material(aMaterial)
 {}
 
-void webgl1es2_entity::draw(const graphics_mat4x4_type &aViewMatrix, const graphics_mat4x4_type &aProjectionMatrix) const
+void webgl1es2_entity::draw(const webgl1es2_shader_program &aShaderProgram, const graphics_mat4x4_type &aViewProjectionMatrix) const
 {
     if (m_IsHidden) return;
 
-    const graphics_mat4x4_type p = aProjectionMatrix;
-    const graphics_mat4x4_type v = aViewMatrix;
-    const graphics_mat4x4_type m = getModelMatrix();
+    draw(*m_model, *m_Material, m_ModelMatrix, m_pPropertyOverrides.get(), aShaderProgram, aViewProjectionMatrix);
+}
+
+void webgl1es2_entity::draw(const webgl1es2_model &aModel, 
+    const webgl1es2_material &aMaterial, 
+    const graphics_mat4x4_type &aModelMatrix,
+    const property_overrides *const pPropertyOverrides,
+    const webgl1es2_shader_program &aShaderProgram, 
+    const graphics_mat4x4_type &aViewProjectionMatrix)
+{
+    using standard_uniform = webgl1es2_shader_program::standard_uniform;
+
+    if (const auto location = aShaderProgram.getStandardUniformLocation(standard_uniform::model); location != -1)
+    {
+        glUniformMatrix4fv(location, 1, GL_FALSE, &aModelMatrix.m[0][0]);
+    }
+
+    if (const auto location = aShaderProgram.getStandardUniformLocation(standard_uniform::model_view_projection); location != -1)
+    {
+        const auto mvp = aViewProjectionMatrix * aModelMatrix;
+
+        glUniformMatrix4fv(location, 1, GL_FALSE, &mvp.m[0][0]);
+    }
+
+    if (pPropertyOverrides && !pPropertyOverrides->values.empty())
+    {
+        const auto &overrides = pPropertyOverrides->values;
+        const auto &defaults = aMaterial.getUniforms();
+
+        if (!overrides.isCompiled(pPropertyOverrides->compiled, aShaderProgram, defaults)) 
+            pPropertyOverrides->compiled = overrides.compileOverrides(aShaderProgram, defaults);
+
+        overrides.uploadOverrides(pPropertyOverrides->compiled, defaults);
+
+        aModel.draw();
 
-    const auto mvp = p * v * m;
+        overrides.restoreDefaults(pPropertyOverrides->compiled, defaults);
+    }
+    else aModel.draw();
+}
+
+const std::shared_ptr<webgl1es2_entity::property_overrides> &webgl1es2_entity::getPropertyOverrides() const
+{
+    return m_pPropertyOverrides;
+}
 
-    m_Material->getShaderProgram()->setUniform("_Model", mvp); 
-    m_Material->getShaderProgram()->setUniform("_View", mvp);
-    m_Material->getShaderProgram()->setUniform("_Projection", mvp);
-    m_Material->getShaderProgram()->setUniform("_MVP", mvp);
+webgl1es2_uniform_collection &webgl1es2_entity::getWritablePropertyOverrides()
+{
+    // blocks are only referenced by entities and the frame packets extract writes, both owned by the thread calling this,
+    // so a block referenced once is not being drawn. the copy's table is compiled on its first draw
+    if (!m_pPropertyOverrides) m_pPropertyOverrides = std::make_shared<property_overrides>();
+    else if (m_pPropertyOverrides.use_count() > 1) 
+        m_pPropertyOverrides = std::make_shared<property_overrides>(property_overrides{m_pPropertyOverrides->values, {}});
 
-    m_model->draw();
+    return m_pPropertyOverrides->values;
 }
 
 const graphics_mat4x4_type &webgl1es2_entity::getModelMatrix() const
@@ -49,6 +94,11 @@ void webgl1es2_entity::set_model_matrix(const graphics_vector3_type &aWorldPos,
     m_ModelMatrix.scale(aScale);
 }
 
+void webgl1es2_entity::set_model_matrix(const graphics_mat4x4_type &aModelMatrix)
+{
+    m_ModelMatrix = aModelMatrix;
+}
+
 void webgl1es2_entity::set_model(const std::shared_ptr<webgl1es2_model> a)
 {
     m_model = a;
@@ -78,3 +128,48 @@ bool webgl1es2_entity::isHidden() const
 {
     return m_IsHidden;
 }
+
+void webgl1es2_entity::setTexture(const std::string &aName, std::shared_ptr<texture> aTexture)
+{
+    getWritablePropertyOverrides().set(aName, std::static_pointer_cast<webgl1es2_texture>(aTexture));
+}
+
+void webgl1es2_entity::setFloat(const std::string &aName, float aValue)
+{
+    getWritablePropertyOverrides().set(aName, static_cast<GLfloat>(aValue));
+}
+
+void webgl1es2_entity::setVector2(const std::string &aName, const graphics_vector2_type &aValue)
+{
+    getWritablePropertyOverrides().set(aName, aValue);
+}
+
+void webgl1es2_entity::setVector3(const std::string &aName, const graphics_vector3_type &aValue)
+{
+    getWritablePropertyOverrides().set(aName, aValue);
+}
+
+void webgl1es2_entity::setVector4(const std::string &aName, const graphics_vector4_type &aValue)
+{
+    getWritablePropertyOverrides().set(aName, aValue);
+}
+
+void webgl1es2_entity::setMatrix4x4(const std::string &aName, const graphics_mat4x4_type &aValue)
+{
+    getWritablePropertyOverrides().set(aName, aValue);
+}
+
+void webgl1es2_entity::setInteger(const std::string &aName, int aValue)
+{
+    getWritablePropertyOverrides().set(aName, static_cast<GLint>(aValue));
+}
+
+void webgl1es2_entity::packProperties(const std::vector<std::string> &aNames, std::vector<GLfloat> &aBuffer) const
+{
+    for (const auto &name : aNames)
+    {
+        if (!(m_pPropertyOverrides && m_pPropertyOverrides->values.pack(name, aBuffer)) && 
+            !m_Material->getUniforms().pack(name, aBuffer)) 
+            throw std::invalid_argument(std::string(TAG).append(": no value is assigned to \"").append(name).append("\""));
+    }
+}
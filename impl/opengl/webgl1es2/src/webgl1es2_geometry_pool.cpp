@@ -0,0 +1,291 @@
+// © 2019 Joseph Cameron - All Rights Reserved
+
+#include <gdk/webgl1es2_deletion_queue.h>
+#include <gdk/webgl1es2_geometry_pool.h>
+#include <gdk/webgl1es2_render_state.h>
+
+#include <algorithm>
+#include <cstring>
+#include <iterator>
+#include <optional>
+#include <stdexcept>
+#include <string>
+
+using namespace gdk;
+
+static constexpr char TAG[] = "webgl1es2_geometry_pool";
+
+//! takes the first free range that fits, in address order, splitting off what is left of it
+template<typename free_range_collection_type>
+static std::optional<size_t> take_free_range(free_range_collection_type &aFreeRanges, const size_t aCount)
+{
+    for (auto iter = aFreeRanges.begin(); iter != aFreeRanges.end(); ++iter)
+    {
+        if (const auto [offset, count] = *iter; count >= aCount)
+        {
+            aFreeRanges.erase(iter);
+
+            if (count > aCount) aFreeRanges[offset + aCount] = count - aCount;
+
+            return offset;
+        }
+    }
+
+    return {};
+}
+
+//! returns a range to the free ranges, merging it with its neighbours
+template<typename free_range_collection_type>
+static void give_free_range(free_range_collection_type &aFreeRanges, size_t aOffset, size_t aCount)
+{
+    auto next = aFreeRanges.lower_bound(aOffset);
+
+    if (next != aFreeRanges.begin())
+    {
+        if (auto previous = std::prev(next); previous->first + previous->second == aOffset)
+        {
+            aOffset = previous->first;
+            aCount += previous->second;
+
+            aFreeRanges.erase(previous);
+        }
+    }
+
+    if (next != aFreeRanges.end() && aOffset + aCount == next->first)
+    {
+        aCount += next->second;
+
+        aFreeRanges.erase(next);
+    }
+
+    aFreeRanges[aOffset] = aCount;
+}
+
+webgl1es2_geometry_pool::allocation::allocation(std::shared_ptr<webgl1es2_geometry_pool> pPool,
+    page *const pPage,
+    const size_t aOffset,
+    const size_t aCount)
+: m_pPool(std::move(pPool))
+, m_pPage(pPage)
+, m_Offset(aOffset)
+, m_Count(aCount)
+{}
+
+webgl1es2_geometry_pool::allocation::~allocation()
+{
+    m_pPool->release(*this);
+}
+
+GLuint webgl1es2_geometry_pool::allocation::getBufferHandle() const
+{
+    return m_pPage->buffer.get();
+}
+
+size_t webgl1es2_geometry_pool::allocation::getOffset() const
+{
+    return m_Offset;
+}
+
+size_t webgl1es2_geometry_pool::allocation::getCount() const
+{
+    return m_Count;
+}
+
+void webgl1es2_geometry_pool::allocation::write(const size_t aOffset, const void *const pData, const size_t aCount)
+{
+    if (aOffset > m_Count || aCount > m_Count - aOffset)
+        throw std::out_of_range(std::string(TAG).append(": write exceeds the allocation"));
+
+    if (!aCount) return;
+
+    std::lock_guard<std::mutex> lock(m_pPool->m_Mutex);
+
+    const auto byteOffset = m_pPage->elementSize * (m_Offset + aOffset);
+    const auto byteCount = m_pPage->elementSize * aCount;
+
+    std::memcpy(m_pPage->shadow.data() + byteOffset, pData, byteCount);
+
+    glBindBuffer(m_pPage->target, m_pPage->buffer.get());
+    glBufferSubData(m_pPage->target, byteOffset, byteCount, pData);
+    glBindBuffer(m_pPage->target, 0);
+}
+
+webgl1es2_geometry_pool::webgl1es2_geometry_pool(const size_t aVertexPageCapacity, const size_t aIndexPageCapacity)
+: m_VertexPageCapacity(aVertexPageCapacity)
+, m_IndexPageCapacity(aIndexPageCapacity)
+{
+    if (!m_VertexPageCapacity || !m_IndexPageCapacity)
+        throw std::invalid_argument(std::string(TAG).append(": page capacity must be greater than 0"));
+}
+
+std::unique_ptr<webgl1es2_geometry_pool::allocation> webgl1es2_geometry_pool::allocate(std::vector<std::unique_ptr<page>> &aPages,
+    const GLenum aTarget,
+    const size_t aElementSize,
+    const size_t aPageCapacity,
+    const void *const pData,
+    const size_t aCount)
+{
+    if (!aCount) throw std::invalid_argument(std::string(TAG).append(": no data to allocate"));
+
+    std::lock_guard<std::mutex> lock(m_Mutex);
+
+    page *pPage(nullptr);
+    size_t offset(0);
+
+    for (auto &pCandidate : aPages) if (const auto candidateOffset = take_free_range(pCandidate->freeRanges, aCount))
+    {
+        pPage = pCandidate.get();
+        offset = *candidateOffset;
+
+        break;
+    }
+
+    if (!pPage)
+    {
+        const auto capacity = std::max(aPageCapacity, aCount);
+
+        GLuint handle(0);
+
+        glGenBuffers(1, &handle);
+        glBindBuffer(aTarget, handle);
+        glBufferData(aTarget, aElementSize * capacity, nullptr, GL_STATIC_DRAW);
+        glBindBuffer(aTarget, 0);
+
+        aPages.push_back(std::unique_ptr<page>(new page{
+            aTarget,
+            aElementSize,
+            capacity,
+            jfc::unique_handle<GLuint>(handle, webgl1es2_deletion_queue::make_deleter(
+                webgl1es2_render_state::current().getDeletionQueue(), webgl1es2_deletion_queue::object_type::buffer)),
+            std::vector<unsigned char>(aElementSize * capacity),
+            {},
+            {}}));
+
+        pPage = aPages.back().get();
+
+        if (capacity > aCount) pPage->freeRanges[aCount] = capacity - aCount;
+    }
+
+    std::memcpy(pPage->shadow.data() + (aElementSize * offset), pData, aElementSize * aCount);
+
+    glBindBuffer(aTarget, pPage->buffer.get());
+    glBufferSubData(aTarget, aElementSize * offset, aElementSize * aCount, pData);
+    glBindBuffer(aTarget, 0);
+
+    std::unique_ptr<allocation> pAllocation(new allocation(shared_from_this(), pPage, offset, aCount));
+
+    pPage->allocations.insert(pAllocation.get());
+
+    return pAllocation;
+}
+
+void webgl1es2_geometry_pool::release(allocation &aAllocation)
+{
+    std::lock_guard<std::mutex> lock(m_Mutex);
+
+    give_free_range(aAllocation.m_pPage->freeRanges, aAllocation.m_Offset, aAllocation.m_Count);
+
+    aAllocation.m_pPage->allocations.erase(&aAllocation);
+}
+
+std::unique_ptr<webgl1es2_geometry_pool::allocation> webgl1es2_geometry_pool::allocateVertexData(const GLfloat *const pData, const size_t aCount)
+{
+    return allocate(m_VertexPages, GL_ARRAY_BUFFER, sizeof(GLfloat), m_VertexPageCapacity, pData, aCount);
+}
+
+std::unique_ptr<webgl1es2_geometry_pool::allocation> webgl1es2_geometry_pool::allocateIndexData(const GLushort *const pData, const size_t aCount)
+{
+    return allocate(m_IndexPages, GL_ELEMENT_ARRAY_BUFFER, sizeof(GLushort), m_IndexPageCapacity, pData, aCount);
+}
+
+size_t webgl1es2_geometry_pool::compact(std::vector<std::unique_ptr<page>> &aPages)
+{
+    size_t movedCount(0);
+
+    aPages.erase(std::remove_if(aPages.begin(), aPages.end(), [](const std::unique_ptr<page> &pPage)
+    {
+        return pPage->allocations.empty();
+    }), aPages.end());
+
+    for (auto &pPage : aPages)
+    {
+        std::vector<allocation *> allocations(pPage->allocations.begin(), pPage->allocations.end());
+
+        std::sort(allocations.begin(), allocations.end(), [](const allocation *a, const allocation *b)
+        {
+            return a->m_Offset < b->m_Offset;
+        });
+
+        size_t end(0), pageMovedCount(0);
+
+        // moving in offset order only ever moves data towards the start, over data already moved or released
+        for (auto pAllocation : allocations)
+        {
+            if (pAllocation->m_Offset != end)
+            {
+                std::memmove(pPage->shadow.data() + (pPage->elementSize * end),
+                    pPage->shadow.data() + (pPage->elementSize * pAllocation->m_Offset),
+                    pPage->elementSize * pAllocation->m_Count);
+
+                pAllocation->m_Offset = end;
+
+                ++pageMovedCount;
+            }
+
+            end += pAllocation->m_Count;
+        }
+
+        pPage->freeRanges.clear();
+
+        if (end < pPage->capacity) pPage->freeRanges[end] = pPage->capacity - end;
+
+        if (pageMovedCount)
+        {
+            glBindBuffer(pPage->target, pPage->buffer.get());
+            glBufferData(pPage->target, pPage->shadow.size(), pPage->shadow.data(), GL_STATIC_DRAW);
+            glBindBuffer(pPage->target, 0);
+
+            movedCount += pageMovedCount;
+        }
+    }
+
+    return movedCount;
+}
+
+size_t webgl1es2_geometry_pool::compact()
+{
+    std::lock_guard<std::mutex> lock(m_Mutex);
+
+    return compact(m_VertexPages) + compact(m_IndexPages);
+}
+
+size_t webgl1es2_geometry_pool::getPageCount() const
+{
+    std::lock_guard<std::mutex> lock(m_Mutex);
+
+    return m_VertexPages.size() + m_IndexPages.size();
+}
+
+size_t webgl1es2_geometry_pool::getAllocationCount() const
+{
+    std::lock_guard<std::mutex> lock(m_Mutex);
+
+    size_t count(0);
+
+    for (const auto &pPage : m_VertexPages) count += pPage->allocations.size();
+    for (const auto &pPage : m_IndexPages) count += pPage->allocations.size();
+
+    return count;
+}
+
+size_t webgl1es2_geometry_pool::getFreeCount() const
+{
+    std::lock_guard<std::mutex> lock(m_Mutex);
+
+    size_t count(0);
+
+    for (const auto *pPages : {&m_VertexPages, &m_IndexPages}) for (const auto &pPage : *pPages)
+        for (const auto &[offset, freeCount] : pPage->freeRanges) count += freeCount;
+
+    return count;
+}
@@ -0,0 +1,298 @@
+// © 2019 Joseph Cameron - All Rights Reserved
+
+#include <gdk/job_system.h>
+#include <gdk/mesh_optimizer.h>
+#include <gdk/vertex_quantizer.h>
+#include <gdk/webgl1es2_interleaved_view.h>
+#include <gdk/webgl1es2_shader_program.h>
+
+#include <algorithm>
+#include <cstring>
+#include <limits>
+#include <optional>
+#include <stdexcept>
+#include <string>
+#include <tuple>
+#include <utility>
+
+using namespace gdk;
+
+static constexpr char TAG[] = "webgl1es2_interleaved_view";
+
+//! an attribute of a view, by name
+using named_attribute = std::pair<const std::string *, const attribute_data_view *>;
+
+static webgl1es2_model::Type usage_hint_to_type(const vertex_data_view::UsageHint aUsageHint)
+{
+    switch(aUsageHint)
+    {
+        case vertex_data_view::UsageHint::Dynamic: return webgl1es2_model::Type::Dynamic;
+        case vertex_data_view::UsageHint::Static: return webgl1es2_model::Type::Static;
+        case vertex_data_view::UsageHint::Streaming: return webgl1es2_model::Type::Stream;
+    }
+
+    throw std::invalid_argument(std::string(TAG).append(": unhandled usage hint"));
+}
+
+//! the component type an attribute's data is stored as. half floats fall back to floats if the context cannot read them
+static webgl1es2_vertex_attribute::component_type storage_type_to_component_type(const attribute_data_view::StorageType aStorageType,
+    const bool aSupportsHalfFloatAttributes)
+{
+    switch (aStorageType)
+    {
+        case attribute_data_view::StorageType::Float: return webgl1es2_vertex_attribute::component_type::float32;
+        case attribute_data_view::StorageType::HalfFloat: return aSupportsHalfFloatAttributes
+            ? webgl1es2_vertex_attribute::component_type::float16
+            : webgl1es2_vertex_attribute::component_type::float32;
+        case attribute_data_view::StorageType::NormalizedByte: return webgl1es2_vertex_attribute::component_type::int8_normalized;
+        case attribute_data_view::StorageType::NormalizedUnsignedByte: return webgl1es2_vertex_attribute::component_type::uint8_normalized;
+        case attribute_data_view::StorageType::NormalizedShort: return webgl1es2_vertex_attribute::component_type::int16_normalized;
+        case attribute_data_view::StorageType::NormalizedUnsignedShort: return webgl1es2_vertex_attribute::component_type::uint16_normalized;
+    }
+
+    throw std::invalid_argument(std::string(TAG).append(": unhandled storage type"));
+}
+
+//! converts aCount float components to aType, writing them to pDestination
+static void quantize(const webgl1es2_vertex_attribute::component_type aType,
+    const attribute_data_view::attribute_component_type *const pSource,
+    void *const pDestination,
+    const size_t aCount)
+{
+    switch (aType)
+    {
+        case webgl1es2_vertex_attribute::component_type::float32:
+            std::memcpy(pDestination, pSource, sizeof(attribute_data_view::attribute_component_type) * aCount); break;
+        case webgl1es2_vertex_attribute::component_type::float16:
+            vertex_quantizer::to_half(pSource, static_cast<std::uint16_t *>(pDestination), aCount); break;
+        case webgl1es2_vertex_attribute::component_type::int8_normalized:
+            vertex_quantizer::to_snorm8(pSource, static_cast<std::int8_t *>(pDestination), aCount); break;
+        case webgl1es2_vertex_attribute::component_type::uint8_normalized:
+            vertex_quantizer::to_unorm8(pSource, static_cast<std::uint8_t *>(pDestination), aCount); break;
+        case webgl1es2_vertex_attribute::component_type::int16_normalized:
+            vertex_quantizer::to_snorm16(pSource, static_cast<std::int16_t *>(pDestination), aCount); break;
+        case webgl1es2_vertex_attribute::component_type::uint16_normalized:
+            vertex_quantizer::to_unorm16(pSource, static_cast<std::uint16_t *>(pDestination), aCount); break;
+    }
+}
+
+//! copies aCount elements of size bytes, aSourceStride bytes apart, to pDestination, aDestinationStride bytes apart.
+/// The size is constant, so each copy compiles to a few vector moves rather than a call to memcpy
+template<size_t size>
+static void copy_strided(const unsigned char *pSource, const size_t aSourceStride, 
+    unsigned char *pDestination, const size_t aDestinationStride, 
+    const size_t aCount)
+{
+    for (size_t i(0); i < aCount; ++i, pSource += aSourceStride, pDestination += aDestinationStride) std::memcpy(pDestination, pSource, size);
+}
+
+//! copies aCount elements of aSize bytes, aSourceStride bytes apart, to pDestination, aDestinationStride bytes apart
+static void copy_strided(const unsigned char *const pSource, const size_t aSourceStride, 
+    unsigned char *const pDestination, const size_t aDestinationStride, 
+    const size_t aSize, const size_t aCount)
+{
+    switch (aSize)
+    {
+        case 4: copy_strided<4>(pSource, aSourceStride, pDestination, aDestinationStride, aCount); break;
+        case 8: copy_strided<8>(pSource, aSourceStride, pDestination, aDestinationStride, aCount); break;
+        case 12: copy_strided<12>(pSource, aSourceStride, pDestination, aDestinationStride, aCount); break;
+        case 16: copy_strided<16>(pSource, aSourceStride, pDestination, aDestinationStride, aCount); break;
+
+        default: for (size_t i(0); i < aCount; ++i) 
+            std::memcpy(pDestination + (i * aDestinationStride), pSource + (i * aSourceStride), aSize);
+    }
+}
+
+//! the view's attributes in canonical order: conventional attributes by location, then the rest by name
+static std::vector<named_attribute> sort_attributes(const vertex_data_view &aVertexDataView)
+{
+    std::vector<named_attribute> attributes;
+    attributes.reserve(aVertexDataView.m_AttributeData.size());
+
+    for (const auto &[name, attribute] : aVertexDataView.m_AttributeData) attributes.push_back({&name, &attribute});
+
+    const auto key = [](const named_attribute &aAttribute)
+    {
+        const auto location = webgl1es2_shader_program::tryGetConventionalAttributeLocation(*aAttribute.first);
+
+        return std::make_tuple(location ? *location : std::numeric_limits<GLuint>::max(), std::cref(*aAttribute.first));
+    };
+
+    std::sort(attributes.begin(), attributes.end(), [&key](const named_attribute &a, const named_attribute &b)
+    {
+        return key(a) < key(b);
+    });
+
+    return attributes;
+}
+
+//! validates the view, then builds the format of its attributes in canonical order
+static webgl1es2_vertex_format make_format(const vertex_data_view &aVertexDataView, const bool aSupportsHalfFloatAttributes)
+{
+    if (aVertexDataView.m_AttributeData.empty())
+        throw std::invalid_argument(std::string(TAG).append(": vertex data view must contain at least one attribute data view"));
+
+    const auto &firstAttribute = aVertexDataView.m_AttributeData.begin()->second;
+
+    const auto vertexCount = firstAttribute.m_DataLength / firstAttribute.m_ComponentCount;
+
+    if (!vertexCount) throw std::invalid_argument(std::string(TAG).append(": vertex attribute data must have data"));
+
+    std::vector<webgl1es2_vertex_attribute> attributes;
+
+    for (const auto &[pName, pAttribute] : sort_attributes(aVertexDataView))
+    {
+        if (pAttribute->m_DataLength / pAttribute->m_ComponentCount != vertexCount)
+            throw std::invalid_argument(std::string(TAG).append(": attribute data arrays must contribute to the same number of vertexes"));
+
+        attributes.push_back({*pName,
+            static_cast<webgl1es2_vertex_attribute::size_type>(pAttribute->m_ComponentCount),
+            storage_type_to_component_type(pAttribute->m_StorageType, aSupportsHalfFloatAttributes)});
+    }
+
+    return webgl1es2_vertex_format(attributes);
+}
+
+webgl1es2_interleaved_view::webgl1es2_interleaved_view(const vertex_data_view &aVertexDataView, const bool aSupportsHalfFloatAttributes)
+: vertexFormat(make_format(aVertexDataView, aSupportsHalfFloatAttributes))
+, type(usage_hint_to_type(aVertexDataView.m_Usage))
+{
+    using component_type = attribute_data_view::attribute_component_type;
+
+    // per vertex layout, in format order. offsets are in bytes
+    struct attribute_layout
+    {
+        const attribute_data_view *pView;
+        webgl1es2_vertex_attribute::component_type type;
+        size_t size;
+        size_t offset;
+    };
+
+    std::vector<attribute_layout> attributes;
+
+    for (const auto &[pName, pAttribute] : sort_attributes(aVertexDataView))
+    {
+        const auto &format = vertexFormat.getAttributes()[attributes.size()];
+
+        attributes.push_back({pAttribute, format.type, format.getComponentSize() * format.size, *vertexFormat.tryGetAttributeOffset(*pName)});
+    }
+
+    const auto vertexCount = attributes.front().pView->m_DataLength / attributes.front().pView->m_ComponentCount;
+
+    // in words. vertex data is carried in float sized elements, packed attributes included
+    const auto stride = static_cast<size_t>(vertexFormat.getSumOfAttributeComponents());
+    const auto byteStride = sizeof(component_type) * stride;
+
+    // a buffer the caller already interleaved in the format's layout can be uploaded as is. 
+    // optimization reorders the data, so always works on a copy
+    const auto pBase = reinterpret_cast<const unsigned char *>(attributes.front().pView->m_pData);
+
+    const auto isShareable = aVertexDataView.m_Optimization == vertex_data_view::Optimization::None && 
+        std::all_of(attributes.begin(), attributes.end(), [pBase, byteStride](const attribute_layout &aAttribute)
+    {
+        return aAttribute.type == webgl1es2_vertex_attribute::component_type::float32 &&
+            aAttribute.pView->m_Stride == byteStride &&
+            reinterpret_cast<const unsigned char *>(aAttribute.pView->m_pData) == pBase + aAttribute.offset;
+    });
+
+    if (isShareable)
+    {
+        pSharedVertexData = attributes.front().pView->m_pData;
+        sharedVertexDataSize = vertexCount * stride;
+    }
+    else
+    {
+        // the only allocation of the vertex data. zero initialized, so the padding of packed attributes is deterministic
+        vertexData.resize(vertexCount * stride);
+
+        const auto interleaveRange = [this, &attributes, byteStride](const size_t aBegin, const size_t aEnd)
+        {
+            const auto pBytes = reinterpret_cast<unsigned char *>(vertexData.data()) + (aBegin * byteStride);
+
+            // packed attributes of the range are converted in one call, so the quantizers can vectorize, then scattered.
+            // strided sources are gathered first
+            std::vector<component_type> gathered;
+            std::vector<unsigned char> converted;
+
+            for (const auto &attribute : attributes)
+            {
+                const auto componentCount = attribute.pView->m_ComponentCount;
+                const auto sourceStride = attribute.pView->m_Stride;
+                const auto pSource = reinterpret_cast<const unsigned char *>(attribute.pView->m_pData) + (aBegin * sourceStride);
+
+                if (attribute.type == webgl1es2_vertex_attribute::component_type::float32)
+                {
+                    copy_strided(pSource, sourceStride, pBytes + attribute.offset, byteStride, attribute.size, aEnd - aBegin);
+
+                    continue;
+                }
+
+                auto pFloats = reinterpret_cast<const component_type *>(pSource);
+
+                if (!attribute.pView->isPacked())
+                {
+                    gathered.resize(componentCount * (aEnd - aBegin));
+
+                    copy_strided(pSource, sourceStride, reinterpret_cast<unsigned char *>(gathered.data()), sizeof(component_type) * componentCount,
+                        sizeof(component_type) * componentCount, aEnd - aBegin);
+
+                    pFloats = gathered.data();
+                }
+
+                converted.resize(attribute.size * (aEnd - aBegin));
+
+                quantize(attribute.type, pFloats, converted.data(), componentCount * (aEnd - aBegin));
+
+                copy_strided(converted.data(), attribute.size, pBytes + attribute.offset, byteStride, attribute.size, aEnd - aBegin);
+            }
+        };
+
+        // small models are not worth the cost of handing out jobs
+        static constexpr size_t PARALLEL_VERTEX_GRAIN_SIZE(4096);
+
+        if (vertexCount > PARALLEL_VERTEX_GRAIN_SIZE)
+            job_system::get_shared()->parallel_for(0, vertexCount, PARALLEL_VERTEX_GRAIN_SIZE, interleaveRange);
+        else interleaveRange(0, vertexCount);
+    }
+
+    if (aVertexDataView.m_pIndexData)
+    {
+        indexData.assign(aVertexDataView.m_pIndexData, aVertexDataView.m_pIndexData + aVertexDataView.m_IndexCount);
+
+        if (std::any_of(indexData.begin(), indexData.end(), [vertexCount](const webgl1es2_model::index_data_type aIndex)
+        {
+            return aIndex >= vertexCount;
+        })) throw std::invalid_argument(std::string(TAG).append(": index refers to a vertex that does not exist"));
+    }
+
+    switch (aVertexDataView.m_Optimization)
+    {
+        case vertex_data_view::Optimization::None: break;
+
+        case vertex_data_view::Optimization::Full:
+        {
+            // only float positions can be read by the overdraw optimization
+            std::optional<size_t> positionOffset;
+
+            if (const auto search = aVertexDataView.m_AttributeData.find("a_Position"); search != aVertexDataView.m_AttributeData.end() &&
+                search->second.m_ComponentCount == 3 &&
+                search->second.m_StorageType == attribute_data_view::StorageType::Float)
+            {
+                positionOffset = *vertexFormat.tryGetAttributeOffset("a_Position") / sizeof(component_type);
+            }
+
+            if (aVertexDataView.m_pIndexData) mesh_optimizer::optimize(stride, vertexData, indexData, positionOffset);
+            else indexData = mesh_optimizer::optimize(stride, vertexData, positionOffset);
+        } break;
+    }
+}
+
+const webgl1es2_model::attribute_component_data_type *webgl1es2_interleaved_view::getVertexData() const
+{
+    return pSharedVertexData ? pSharedVertexData : vertexData.data();
+}
+
+size_t webgl1es2_interleaved_view::getVertexDataSize() const
+{
+    return pSharedVertexData ? sharedVertexDataSize : vertexData.size();
+}
@@ -4,21 +4,48 @@ using namespace gdk;
 
 void webgl1es2_material::setTexture(const std::string &aTextureName, texture_ptr_type aTexture)
 {
-    m_Textures[aTextureName] = std::static_pointer_cast<webgl1es2_texture>(aTexture);
+    m_Uniforms.set(aTextureName, std::static_pointer_cast<webgl1es2_texture>(aTexture));
 }
 
-#include <iostream>
+void webgl1es2_material::setFloat(const std::string &aName, float aValue)
+{
+    m_Uniforms.set(aName, static_cast<GLfloat>(aValue));
+}
+
+void webgl1es2_material::setVector2(const std::string &aName, const graphics_vector2_type &aValue)
+{
+    m_Uniforms.set(aName, aValue);
+}
+
+void webgl1es2_material::setVector3(const std::string &aName, const graphics_vector3_type &aValue)
+{
+    m_Uniforms.set(aName, aValue);
+}
+
+void webgl1es2_material::setVector4(const std::string &aName, const graphics_vector4_type &aValue)
+{
+    m_Uniforms.set(aName, aValue);
+}
+
+void webgl1es2_material::setMatrix4x4(const std::string &aName, const graphics_mat4x4_type &aValue)
+{
+    m_Uniforms.set(aName, aValue);
+}
+
+void webgl1es2_material::setInteger(const std::string &aName, int aValue)
+{
+    m_Uniforms.set(aName, static_cast<GLint>(aValue));
+}
 
 void webgl1es2_material::activate()
 {
+    m_PipelineState.activate();
+
     m_pShaderProgram->useProgram();
 
-    for (const auto &[name, texture] : m_Textures)
-    {
-        m_pShaderProgram->setUniform(name, *texture);
-    }
+    if (!m_Uniforms.isCompiled(m_CompiledUniforms, *m_pShaderProgram)) m_CompiledUniforms = m_Uniforms.compile(*m_pShaderProgram);
 
-    //TODO: activate the rest of this webgl1es2_material's uniforms...
+    m_Uniforms.upload(m_CompiledUniforms);
 }
 
 webgl1es2_material::webgl1es2_material(shader_ptr_type pShader)
@@ -30,3 +57,17 @@ webgl1es2_material::shader_ptr_type webgl1es2_material::getShaderProgram()
     return m_pShaderProgram;
 }
 
+const webgl1es2_uniform_collection &webgl1es2_material::getUniforms() const
+{
+    return m_Uniforms;
+}
+
+void webgl1es2_material::setPipelineState(const webgl1es2_pipeline_state &aPipelineState)
+{
+    m_PipelineState = aPipelineState;
+}
+
+const webgl1es2_pipeline_state &webgl1es2_material::getPipelineState() const
+{
+    return m_PipelineState;
+}
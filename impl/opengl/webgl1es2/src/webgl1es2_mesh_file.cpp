@@ -0,0 +1,328 @@
+// © 2019 Joseph Cameron - All Rights Reserved
+
+#include <gdk/webgl1es2_interleaved_view.h>
+#include <gdk/webgl1es2_mesh_file.h>
+
+#include <algorithm>
+#include <cstring>
+#include <limits>
+#include <stdexcept>
+
+using namespace gdk;
+
+static constexpr char TAG[] = "webgl1es2_mesh_file";
+
+static_assert(sizeof(webgl1es2_mesh_file::header) == 80, "header layout must not depend on the compiler");
+static_assert(sizeof(webgl1es2_mesh_file::attribute_record) == 40, "attribute record layout must not depend on the compiler");
+static_assert(sizeof(webgl1es2_mesh_file::submesh) == 8, "submesh layout must not depend on the compiler");
+
+static std::runtime_error make_error(const char *aWhat)
+{
+    return std::runtime_error(std::string(TAG).append(": ").append(aWhat));
+}
+
+//! rounds up to the next multiple of the blob alignment
+static std::uint64_t align_blob(const std::uint64_t aOffset)
+{
+    return (aOffset + webgl1es2_mesh_file::BLOB_ALIGNMENT - 1) / webgl1es2_mesh_file::BLOB_ALIGNMENT * webgl1es2_mesh_file::BLOB_ALIGNMENT;
+}
+
+//! bytes from the start of the file to the first attribute record
+static constexpr std::uint64_t ATTRIBUTE_RECORDS_OFFSET(sizeof(webgl1es2_mesh_file::header));
+
+//! bytes from the start of the file to the first submesh record
+static std::uint64_t submesh_records_offset(const webgl1es2_mesh_file::header &aHeader)
+{
+    return ATTRIBUTE_RECORDS_OFFSET + (sizeof(webgl1es2_mesh_file::attribute_record) * static_cast<std::uint64_t>(aHeader.attributeCount));
+}
+
+//! copies the header out of the file, and checks it is one this version can read
+static webgl1es2_mesh_file::header read_header(const std::byte *const pData, const size_t aSize)
+{
+    if (reinterpret_cast<std::uintptr_t>(pData) % alignof(webgl1es2_model::attribute_component_data_type))
+        throw make_error("mesh data must be 4 byte aligned");
+
+    webgl1es2_mesh_file::header header;
+
+    if (aSize < sizeof(header)) throw make_error("data is too small to be a mesh file");
+
+    std::memcpy(&header, pData, sizeof(header));
+
+    if (header.magic != webgl1es2_mesh_file::MAGIC) throw make_error("data is not a mesh file");
+    if (header.version != webgl1es2_mesh_file::VERSION) throw make_error("unsupported mesh file version");
+
+    if (submesh_records_offset(header) + (sizeof(webgl1es2_mesh_file::submesh) * static_cast<std::uint64_t>(header.submeshCount)) > aSize)
+        throw make_error("records exceed the file");
+
+    return header;
+}
+
+//! rebuilds the vertex format from the attribute records
+static webgl1es2_vertex_format read_format(const webgl1es2_mesh_file::header &aHeader, const std::byte *const pData)
+{
+    std::vector<webgl1es2_vertex_attribute> attributes;
+
+    for (std::uint32_t i(0); i < aHeader.attributeCount; ++i)
+    {
+        webgl1es2_mesh_file::attribute_record record;
+
+        std::memcpy(&record, pData + ATTRIBUTE_RECORDS_OFFSET + (sizeof(record) * i), sizeof(record));
+
+        if (std::find(record.name.begin(), record.name.end(), '\0') == record.name.end())
+            throw make_error("attribute name is not terminated");
+
+        if (!record.size || record.size > 4) throw make_error("attribute size must be 1 to 4");
+
+        if (record.type > static_cast<std::uint32_t>(webgl1es2_vertex_attribute::component_type::uint16_normalized))
+            throw make_error("unknown attribute component type");
+
+        attributes.push_back({record.name.data(),
+            static_cast<webgl1es2_vertex_attribute::size_type>(record.size),
+            static_cast<webgl1es2_vertex_attribute::component_type>(record.type)});
+    }
+
+    if (attributes.empty()) throw make_error("mesh must have at least one attribute");
+
+    webgl1es2_vertex_format format(attributes);
+
+    if (sizeof(webgl1es2_model::attribute_component_data_type) * format.getSumOfAttributeComponents() != aHeader.vertexStride)
+        throw make_error("vertex stride does not match the vertex format");
+
+    return format;
+}
+
+//! checks every index refers to a vertex, so that a corrupt file cannot make draws read past the vertex buffer
+template<typename index_type>
+static void validate_indexes(const std::byte *const pIndexData, const std::uint32_t aIndexCount, const std::uint32_t aVertexCount)
+{
+    // the index blob is aligned, so the indexes can be read in place
+    const auto pIndexes = reinterpret_cast<const index_type *>(pIndexData);
+
+    index_type maxIndex(0);
+
+    for (std::uint32_t i(0); i < aIndexCount; ++i) maxIndex = std::max(maxIndex, pIndexes[i]);
+
+    if (aIndexCount && maxIndex >= aVertexCount) throw make_error("index exceeds the vertex count");
+}
+
+webgl1es2_mesh_file::webgl1es2_mesh_file(const std::string &aPath)
+: webgl1es2_mesh_file(std::make_shared<mapped_file>(aPath))
+{}
+
+webgl1es2_mesh_file::webgl1es2_mesh_file(std::shared_ptr<mapped_file> pFile)
+: webgl1es2_mesh_file(pFile->data(), pFile->size())
+{
+    m_pFile = std::move(pFile);
+}
+
+webgl1es2_mesh_file::webgl1es2_mesh_file(const std::byte *const pData, const size_t aSize)
+: m_pData(pData)
+, m_Header(read_header(pData, aSize))
+, m_VertexFormat(read_format(m_Header, pData))
+{
+    if (m_Header.type > static_cast<std::uint32_t>(webgl1es2_model::Type::Stream)) throw make_error("unknown buffer usage");
+
+    if (m_Header.vertexDataOffset % BLOB_ALIGNMENT || m_Header.indexDataOffset % BLOB_ALIGNMENT)
+        throw make_error("blobs are misaligned");
+
+    if (!m_Header.vertexCount) throw make_error("mesh must have vertexes");
+
+    if (m_Header.vertexDataOffset > aSize ||
+        static_cast<std::uint64_t>(m_Header.vertexCount) * m_Header.vertexStride > aSize - m_Header.vertexDataOffset)
+        throw make_error("vertex data exceeds the file");
+
+    switch (m_Header.indexSize)
+    {
+        case 0: if (m_Header.indexCount) throw make_error("indexes must have a size"); break;
+        case 1: case 2: case 4: break;
+
+        default: throw make_error("index size must be 0, 1, 2 or 4");
+    }
+
+    if (m_Header.indexDataOffset > aSize ||
+        static_cast<std::uint64_t>(m_Header.indexCount) * m_Header.indexSize > aSize - m_Header.indexDataOffset)
+        throw make_error("index data exceeds the file");
+
+    switch (m_Header.indexSize)
+    {
+        case 1: validate_indexes<std::uint8_t>(pData + m_Header.indexDataOffset, m_Header.indexCount, m_Header.vertexCount); break;
+        case 2: validate_indexes<std::uint16_t>(pData + m_Header.indexDataOffset, m_Header.indexCount, m_Header.vertexCount); break;
+        case 4: validate_indexes<std::uint32_t>(pData + m_Header.indexDataOffset, m_Header.indexCount, m_Header.vertexCount); break;
+    }
+
+    m_Submeshes.resize(m_Header.submeshCount);
+
+    std::memcpy(m_Submeshes.data(), pData + submesh_records_offset(m_Header), sizeof(submesh) * m_Submeshes.size());
+
+    const std::uint64_t elementCount = m_Header.indexSize ? m_Header.indexCount : m_Header.vertexCount;
+
+    for (const auto &current : m_Submeshes) if (static_cast<std::uint64_t>(current.first) + current.count > elementCount)
+        throw make_error("submesh exceeds the mesh");
+}
+
+const webgl1es2_mesh_file::header &webgl1es2_mesh_file::getHeader() const
+{
+    return m_Header;
+}
+
+const webgl1es2_vertex_format &webgl1es2_mesh_file::getVertexFormat() const
+{
+    return m_VertexFormat;
+}
+
+webgl1es2_model::Type webgl1es2_mesh_file::getType() const
+{
+    return static_cast<webgl1es2_model::Type>(m_Header.type);
+}
+
+const std::vector<webgl1es2_mesh_file::submesh> &webgl1es2_mesh_file::getSubmeshes() const
+{
+    return m_Submeshes;
+}
+
+const webgl1es2_model::attribute_component_data_type *webgl1es2_mesh_file::getVertexData() const
+{
+    return reinterpret_cast<const webgl1es2_model::attribute_component_data_type *>(m_pData + m_Header.vertexDataOffset);
+}
+
+size_t webgl1es2_mesh_file::getVertexDataSize() const
+{
+    return static_cast<size_t>(m_Header.vertexCount) * m_Header.vertexStride / sizeof(webgl1es2_model::attribute_component_data_type);
+}
+
+const void *webgl1es2_mesh_file::getIndexData() const
+{
+    return m_Header.indexSize ? m_pData + m_Header.indexDataOffset : nullptr;
+}
+
+size_t webgl1es2_mesh_file::getIndexCount() const
+{
+    return m_Header.indexCount;
+}
+
+GLenum webgl1es2_mesh_file::getIndexType() const
+{
+    switch (m_Header.indexSize)
+    {
+        case 1: return GL_UNSIGNED_BYTE;
+        case 2: return GL_UNSIGNED_SHORT;
+        case 4: return GL_UNSIGNED_INT;
+    }
+
+    return 0;
+}
+
+//! writes indexes narrowed to aIndexSize bytes each
+static void write_indexes(const std::vector<webgl1es2_model::index_data_type> &aIndexData, const size_t aIndexSize, std::byte *pDestination)
+{
+    const auto write = [&](auto aIndex)
+    {
+        for (const auto index : aIndexData)
+        {
+            aIndex = static_cast<decltype(aIndex)>(index);
+
+            std::memcpy(pDestination, &aIndex, sizeof(aIndex));
+
+            pDestination += sizeof(aIndex);
+        }
+    };
+
+    switch (aIndexSize)
+    {
+        case 1: write(std::uint8_t()); break;
+        case 2: write(std::uint16_t()); break;
+        case 4: write(std::uint32_t()); break;
+    }
+}
+
+std::vector<std::byte> webgl1es2_mesh_file::encode(const vertex_data_view &aVertexDataView,
+    const std::vector<submesh> &aSubmeshes,
+    const bool aUseHalfFloatAttributes)
+{
+    if (aVertexDataView.m_Optimization != vertex_data_view::Optimization::None && aSubmeshes.size() > 1)
+        throw std::invalid_argument(std::string(TAG).append(": optimization reorders the mesh, so cannot preserve submesh ranges"));
+
+    const webgl1es2_interleaved_view interleaved(aVertexDataView, aUseHalfFloatAttributes);
+
+    const auto &format = interleaved.vertexFormat;
+    const auto &attributes = format.getAttributes();
+
+    header header {};
+    header.magic = MAGIC;
+    header.version = VERSION;
+    header.type = static_cast<std::uint32_t>(interleaved.type);
+    header.attributeCount = static_cast<std::uint32_t>(attributes.size());
+    header.vertexStride = static_cast<std::uint32_t>(sizeof(webgl1es2_model::attribute_component_data_type) * format.getSumOfAttributeComponents());
+    header.vertexCount = static_cast<std::uint32_t>(interleaved.getVertexDataSize() / format.getSumOfAttributeComponents());
+    header.indexCount = static_cast<std::uint32_t>(interleaved.indexData.size());
+
+    if (!interleaved.indexData.empty())
+    {
+        const auto maxIndex = *std::max_element(interleaved.indexData.begin(), interleaved.indexData.end());
+
+        header.indexSize = maxIndex <= std::numeric_limits<std::uint8_t>::max() ? 1
+            : maxIndex <= std::numeric_limits<std::uint16_t>::max() ? 2
+            : 4;
+    }
+
+    auto submeshes = aSubmeshes;
+
+    const auto elementCount = header.indexSize ? header.indexCount : header.vertexCount;
+
+    if (submeshes.empty()) submeshes.push_back({0, elementCount});
+
+    for (const auto &current : submeshes) if (static_cast<std::uint64_t>(current.first) + current.count > elementCount)
+        throw std::invalid_argument(std::string(TAG).append(": submesh exceeds the mesh"));
+
+    header.submeshCount = static_cast<std::uint32_t>(submeshes.size());
+
+    // bounds of float positions. quantized positions are in the unit cube, scaled by the model's transform
+    for (const auto &attribute : attributes) if (attribute.name == "a_Position" && attribute.size == 3 &&
+        attribute.type == webgl1es2_vertex_attribute::component_type::float32)
+    {
+        const auto stride = static_cast<size_t>(format.getSumOfAttributeComponents());
+        const auto pPositions = interleaved.getVertexData() + (*format.tryGetAttributeOffset(attribute.name) / sizeof(float));
+
+        header.boundsMin = {pPositions[0], pPositions[1], pPositions[2]};
+        header.boundsMax = header.boundsMin;
+
+        for (size_t vertex(0); vertex < header.vertexCount; ++vertex) for (size_t i(0); i < 3; ++i)
+        {
+            const auto component = pPositions[(vertex * stride) + i];
+
+            header.boundsMin[i] = std::min(header.boundsMin[i], component);
+            header.boundsMax[i] = std::max(header.boundsMax[i], component);
+        }
+    }
+
+    const auto vertexDataSize = static_cast<std::uint64_t>(header.vertexCount) * header.vertexStride;
+    const auto indexDataSize = static_cast<std::uint64_t>(header.indexCount) * header.indexSize;
+
+    header.vertexDataOffset = align_blob(submesh_records_offset(header) + (sizeof(submesh) * submeshes.size()));
+    header.indexDataOffset = align_blob(header.vertexDataOffset + vertexDataSize);
+
+    std::vector<std::byte> file(static_cast<size_t>(header.indexDataOffset + indexDataSize));
+
+    std::memcpy(file.data(), &header, sizeof(header));
+
+    for (size_t i(0); i < attributes.size(); ++i)
+    {
+        if (attributes[i].name.size() >= attribute_record().name.size())
+            throw std::invalid_argument(std::string(TAG).append(": attribute name is too long: ").append(attributes[i].name));
+
+        attribute_record record {};
+        std::copy(attributes[i].name.begin(), attributes[i].name.end(), record.name.begin());
+        record.size = attributes[i].size;
+        record.type = static_cast<std::uint32_t>(attributes[i].type);
+
+        std::memcpy(file.data() + ATTRIBUTE_RECORDS_OFFSET + (sizeof(record) * i), &record, sizeof(record));
+    }
+
+    std::memcpy(file.data() + submesh_records_offset(header), submeshes.data(), sizeof(submesh) * submeshes.size());
+
+    std::memcpy(file.data() + header.vertexDataOffset, interleaved.getVertexData(), static_cast<size_t>(vertexDataSize));
+
+    write_indexes(interleaved.indexData, header.indexSize, file.data() + header.indexDataOffset);
+
+    return file;
+}
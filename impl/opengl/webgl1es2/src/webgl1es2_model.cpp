@@ -3,9 +3,14 @@
 #include <gdk/glh.h>
 #include <gdk/opengl.h>
 
+#include <gdk/webgl1es2_deletion_queue.h>
 #include <gdk/webgl1es2_model.h>
+#include <gdk/webgl1es2_render_state.h>
 
+#include <algorithm>
+#include <cstring>
 #include <iostream>
+#include <limits>
 #include <stdexcept>
 
 using namespace gdk;
@@ -117,7 +122,9 @@ bool webgl1es2_model::operator==(const webgl1es2_model &that)
 {
     return
         m_IndexBufferHandle == that.m_IndexBufferHandle
-        && m_VertexBufferHandle == that.m_VertexBufferHandle;
+        && m_VertexBufferHandle == that.m_VertexBufferHandle
+        && m_pVertexAllocation == that.m_pVertexAllocation
+        && m_pIndexAllocation == that.m_pIndexAllocation;
 }
 
 bool webgl1es2_model::operator!=(const webgl1es2_model &that)
@@ -127,112 +134,717 @@ bool webgl1es2_model::operator!=(const webgl1es2_model &that)
 
 void webgl1es2_model::bind(const webgl1es2_shader_program &aShaderProgram) const
 {
-    glBindBuffer(GL_ARRAY_BUFFER, m_VertexBufferHandle.get());
+    bind(aShaderProgram, nullptr);
+}
+
+void webgl1es2_model::bind(const webgl1es2_shader_program &aShaderProgram, const webgl1es2_model *const pBoundModel) const
+{
+    adoptStagedUpload();
+
+    m_pBoundProgram = &aShaderProgram;
+
+    const auto vertexBufferHandle = getVertexBufferHandle();
+
+    if (!pBoundModel || pBoundModel->getVertexBufferHandle() != vertexBufferHandle) glBindBuffer(GL_ARRAY_BUFFER, vertexBufferHandle);
     
-    m_vertex_format.enableAttributes(aShaderProgram);
+    if (m_pVertexAllocation) m_vertex_format.enableAttributes(aShaderProgram, m_pVertexAllocation->getOffset());
+    else m_vertex_format.enableAttributes(aShaderProgram);
 }
 
 void webgl1es2_model::draw() const
 {
     GLenum primitiveMode = PrimitiveModeToOpenGLPrimitiveType(m_PrimitiveMode);
 
-    if (m_IndexBufferHandle.get() > 0)
+    // pooled indexes are relative to the model's first vertex, which bind set as the attribute pointers' base
+    if (m_pIndexAllocation)
+    {
+        glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, m_pIndexAllocation->getBufferHandle());
+
+        glDrawElements(primitiveMode,
+            m_IndexCount,
+            GL_UNSIGNED_SHORT,
+            reinterpret_cast<void *>(sizeof(GLushort) * m_pIndexAllocation->getOffset()));
+    }
+    else if (!m_IndexChunks.empty())
+    {
+        glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, m_IndexBufferHandle.get());
+
+        // chunk indexes are relative to the chunk's first vertex, so the attributes are pointed at each chunk in turn
+        for (const auto &chunk : m_IndexChunks)
+        {
+            m_vertex_format.enableAttributes(*m_pBoundProgram, chunk.firstVertex * m_vertex_format.getSumOfAttributeComponents());
+
+            glDrawElements(primitiveMode,
+                static_cast<GLsizei>(chunk.indexCount),
+                GL_UNSIGNED_SHORT,
+                reinterpret_cast<void *>(sizeof(GLushort) * chunk.firstIndex));
+        }
+    }
+    else if (m_IndexBufferHandle.get() > 0)
     {
         glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, m_IndexBufferHandle.get());
         
         glDrawElements(primitiveMode,
             m_IndexCount,
-            GL_UNSIGNED_SHORT,
+            m_IndexType,
             static_cast<void *>(0));
     }
     else glDrawArrays(primitiveMode, 0, m_VertexCount);
 }
 
-/*void webgl1es2_model::updatewebgl1es2_model(const std::vector<webgl1es2_model::attribute_component_data_type> &aNewwebgl1es2_model
-    , const webgl1es2_vertex_format &aNewvertex_format
-    , const std::vector<GLushort> &aIndexData
-    , const webgl1es2_model::Type &aNewType)
+//! creates a buffer object and copies data into it. returns a null handle if there is no data.
+/// the buffer is released to pDeletionQueue, or deleted immediately if it is null
+static jfc::unique_handle<GLuint> make_buffer(const GLenum aTarget, 
+    const void *pData, 
+    const size_t aSize, 
+    const webgl1es2_model::Type aType,
+    std::shared_ptr<webgl1es2_deletion_queue> pDeletionQueue)
 {
-    //VBO
-    m_vertex_format = aNewvertex_format;
-    m_VertexCount  = static_cast<GLsizei>(aNewwebgl1es2_model.size() / aNewvertex_format.getSumOfAttributeComponents());
-    GLint type = webgl1es2_modelTypeToOpenGLDrawType(aNewType);
-    
-    glBindBuffer (GL_ARRAY_BUFFER, m_VertexBufferHandle.get());
-    glBufferData (GL_ARRAY_BUFFER, sizeof(webgl1es2_model::attribute_component_data_type) * aNewwebgl1es2_model.size(), &aNewwebgl1es2_model[0], type);
-    //glBindBuffer (GL_ARRAY_BUFFER,0);
+    GLuint handle(0);
 
-    //IBO    
-    if (m_IndexCount > 0)
+    if (aSize)
     {
-        //glGenBuffers(1, &m_IndexBufferHandle.get());
-        glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, m_IndexBufferHandle.get());
-        glBufferData(GL_ELEMENT_ARRAY_BUFFER, sizeof(GLushort) * aIndexData.size(), &aIndexData[0], webgl1es2_modelTypeToOpenGLDrawType(aNewType));
-        //glBindBuffer(GL_ELEMENT_ARRAY_BUFFER,0);
-    
-        std::string errorCode;
-        
-        if (glh::GetError(&errorCode)) std::runtime_error(std::string(TAG).append(errorCode));
+        glGenBuffers(1, &handle);
+        glBindBuffer(aTarget, handle);
+        glBufferData(aTarget, aSize, pData, webgl1es2_modelTypeToOpenGLDrawType(aType));
+        glBindBuffer(aTarget, 0);
+    }
+
+    return jfc::unique_handle<GLuint>(handle, 
+        webgl1es2_deletion_queue::make_deleter(std::move(pDeletionQueue), webgl1es2_deletion_queue::object_type::buffer));
+}
+
+//! respecifies a buffer's storage and contents. The driver orphans the old storage rather than waiting for draws still reading it
+static void respecify_buffer(const GLenum aTarget, const GLuint aHandle, const void *pData, const size_t aSize, const webgl1es2_model::Type aType)
+{
+    glBindBuffer(aTarget, aHandle);
+    glBufferData(aTarget, aSize, pData, webgl1es2_modelTypeToOpenGLDrawType(aType));
+    glBindBuffer(aTarget, 0);
+}
+
+//! overwrites part of a buffer. a range covering the whole buffer is respecified instead, since sub data updates 
+/// to storage still in use by the gpu can stall
+static void update_buffer_range(const GLenum aTarget, const GLuint aHandle, 
+    const size_t aOffset, const void *pData, const size_t aSize, 
+    const size_t aBufferSize, const webgl1es2_model::Type aType)
+{
+    if (!aSize) return;
+
+    if (!aOffset && aSize == aBufferSize) 
+    {
+        respecify_buffer(aTarget, aHandle, pData, aSize, aType);
+
+        return;
     }
-}*/
+
+    glBindBuffer(aTarget, aHandle);
+    glBufferSubData(aTarget, aOffset, aSize, pData);
+    glBindBuffer(aTarget, 0);
+}
+
+//! a handle that does not yet refer to a buffer
+static jfc::unique_handle<GLuint> null_buffer()
+{
+    return jfc::unique_handle<GLuint>(0, [](const GLuint) {});
+}
+
+//! size in bytes of an index of a gl index type
+static size_t index_type_size(const GLenum aIndexType)
+{
+    switch (aIndexType)
+    {
+        case GL_UNSIGNED_BYTE: return sizeof(GLubyte);
+        case GL_UNSIGNED_SHORT: return sizeof(GLushort);
+        case GL_UNSIGNED_INT: return sizeof(GLuint);
+    }
+
+    throw std::invalid_argument(std::string(TAG).append(": unhandled index type"));
+}
+
+//! the smallest index type that can hold every index
+static GLenum smallest_index_type(const std::vector<webgl1es2_model::index_data_type> &aIndexData)
+{
+    const auto maxIndex = aIndexData.empty() ? 0 : *std::max_element(aIndexData.begin(), aIndexData.end());
+
+    if (maxIndex <= std::numeric_limits<GLubyte>::max()) return GL_UNSIGNED_BYTE;
+    if (maxIndex <= std::numeric_limits<GLushort>::max()) return GL_UNSIGNED_SHORT;
+
+    return GL_UNSIGNED_INT;
+}
+
+//! narrows indexes to an index type, ready for upload
+/// \exception out_of_range an index does not fit in the type
+static std::vector<unsigned char> pack_indexes(const webgl1es2_model::index_data_type *const pData, const size_t aCount, const GLenum aIndexType)
+{
+    std::vector<unsigned char> packed(index_type_size(aIndexType) * aCount);
+
+    const auto pack = [&](auto *const pPacked)
+    {
+        using packed_type = std::remove_pointer_t<decltype(pPacked)>;
+
+        for (size_t i(0); i < aCount; ++i)
+        {
+            if (pData[i] > std::numeric_limits<packed_type>::max()) 
+                throw std::out_of_range(std::string(TAG).append(": index does not fit in the model's index type"));
+
+            pPacked[i] = static_cast<packed_type>(pData[i]);
+        }
+    };
+
+    switch (aIndexType)
+    {
+        case GL_UNSIGNED_BYTE: pack(reinterpret_cast<GLubyte *>(packed.data())); break;
+        case GL_UNSIGNED_SHORT: pack(reinterpret_cast<GLushort *>(packed.data())); break;
+        default: std::memcpy(packed.data(), pData, packed.size()); break;
+    }
+
+    return packed;
+}
+
+//! vertex and index data in the form uploaded to the gl
+struct prepared_geometry
+{
+    //! the vertex data, if splitting changed it. empty otherwise
+    std::vector<webgl1es2_model::attribute_component_data_type> splitVertexData;
+
+    //! the indexes, narrowed to indexType
+    std::vector<unsigned char> indexData;
+
+    //! type of the indexes
+    GLenum indexType;
+
+    //! chunks the indexes were split into. empty if the model was not split
+    std::vector<webgl1es2_model::index_chunk> chunks;
+};
+
+//! narrows the indexes to the smallest type that fits. Data needing 32 bit indexes on a context without support for them 
+/// is split into chunks with 16 bit indexes instead
+/// \warn must be called with the gl context current
+static prepared_geometry prepare_geometry(const webgl1es2_vertex_format &aVertexFormat,
+    const webgl1es2_model::attribute_component_data_type *const pVertexData,
+    const size_t aVertexDataCount,
+    const std::vector<webgl1es2_model::index_data_type> &aIndexData,
+    const webgl1es2_model::PrimitiveMode aPrimitiveMode)
+{
+    prepared_geometry prepared;
+
+    prepared.indexType = smallest_index_type(aIndexData);
+
+    if (prepared.indexType == GL_UNSIGNED_INT && !webgl1es2_render_state::current().supportsUintIndexes())
+    {
+        prepared.splitVertexData.assign(pVertexData, pVertexData + aVertexDataCount);
+
+        auto indexData = aIndexData;
+
+        prepared.chunks = webgl1es2_model::split_indexes(aVertexFormat.getSumOfAttributeComponents(), 
+            prepared.splitVertexData, indexData, aPrimitiveMode);
+
+        prepared.indexType = GL_UNSIGNED_SHORT;
+        prepared.indexData = pack_indexes(indexData.data(), indexData.size(), prepared.indexType);
+    }
+    else prepared.indexData = pack_indexes(aIndexData.data(), aIndexData.size(), prepared.indexType);
+
+    return prepared;
+}
+
+//! narrows indexes to the 16 bits used by geometry pools
+/// \exception invalid_argument an index does not fit
+static std::vector<GLushort> to_pooled_indexes(const webgl1es2_model::index_data_type *const pData, const size_t aCount)
+{
+    std::vector<GLushort> indexes(aCount);
+
+    for (size_t i(0); i < aCount; ++i)
+    {
+        if (pData[i] > std::numeric_limits<GLushort>::max()) 
+            throw std::invalid_argument(std::string(TAG).append(": pooled models are limited to 16 bit indexes"));
+
+        indexes[i] = static_cast<GLushort>(pData[i]);
+    }
+
+    return indexes;
+}
+
+std::vector<webgl1es2_model::index_chunk> webgl1es2_model::split_indexes(const size_t aVertexStride,
+    std::vector<attribute_component_data_type> &aVertexData,
+    std::vector<index_data_type> &aIndexData,
+    const PrimitiveMode aPrimitiveMode)
+{
+    size_t primitiveSize(0);
+
+    switch (aPrimitiveMode)
+    {
+        case PrimitiveMode::Points: primitiveSize = 1; break;
+        case PrimitiveMode::Lines: primitiveSize = 2; break;
+        case PrimitiveMode::Triangles: primitiveSize = 3; break;
+
+        default: throw std::invalid_argument(std::string(TAG).append(": only lists of points, lines or triangles can be split"));
+    }
+
+    if (aIndexData.size() % primitiveSize) 
+        throw std::invalid_argument(std::string(TAG).append(": index data is not a whole number of primitives"));
+
+    static constexpr size_t MAX_CHUNK_VERTEX_COUNT(static_cast<size_t>(std::numeric_limits<GLushort>::max()) + 1);
+    static constexpr auto UNMAPPED(std::numeric_limits<index_data_type>::max());
+
+    const auto vertexCount = aVertexData.size() / aVertexStride;
+
+    // index of each source vertex in the current chunk
+    std::vector<index_data_type> chunkIndexOfVertex(vertexCount, UNMAPPED);
+
+    // source vertexes of the current chunk, in chunk order
+    std::vector<index_data_type> chunkVertexes;
+
+    std::vector<attribute_component_data_type> splitVertexData;
+    splitVertexData.reserve(aVertexData.size());
+
+    std::vector<index_data_type> splitIndexData;
+    splitIndexData.reserve(aIndexData.size());
+
+    std::vector<index_chunk> chunks;
+
+    const auto closeChunk = [&]()
+    {
+        for (const auto vertex : chunkVertexes)
+        {
+            const auto pVertex = aVertexData.begin() + (vertex * aVertexStride);
+
+            splitVertexData.insert(splitVertexData.end(), pVertex, pVertex + aVertexStride);
+
+            chunkIndexOfVertex[vertex] = UNMAPPED;
+        }
+
+        chunks.back().indexCount = splitIndexData.size() - chunks.back().firstIndex;
+
+        chunkVertexes.clear();
+    };
+
+    for (size_t primitive(0); primitive < aIndexData.size(); primitive += primitiveSize)
+    {
+        size_t newVertexCount(0);
+
+        for (size_t i(0); i < primitiveSize; ++i)
+        {
+            const auto vertex = aIndexData[primitive + i];
+
+            if (vertex >= vertexCount) throw std::out_of_range(std::string(TAG).append(": index refers to a vertex that does not exist"));
+
+            if (chunkIndexOfVertex[vertex] == UNMAPPED) ++newVertexCount;
+        }
+
+        // primitives are never divided between chunks
+        if (chunks.empty() || chunkVertexes.size() + newVertexCount > MAX_CHUNK_VERTEX_COUNT)
+        {
+            if (!chunks.empty()) closeChunk();
+
+            chunks.push_back({splitVertexData.size() / aVertexStride, splitIndexData.size(), 0});
+        }
+
+        for (size_t i(0); i < primitiveSize; ++i)
+        {
+            const auto vertex = aIndexData[primitive + i];
+
+            if (chunkIndexOfVertex[vertex] == UNMAPPED)
+            {
+                chunkIndexOfVertex[vertex] = static_cast<index_data_type>(chunkVertexes.size());
+
+                chunkVertexes.push_back(vertex);
+            }
+
+            splitIndexData.push_back(chunkIndexOfVertex[vertex]);
+        }
+    }
+
+    if (!chunks.empty()) closeChunk();
+
+    aVertexData = std::move(splitVertexData);
+    aIndexData = std::move(splitIndexData);
+
+    return chunks;
+}
+
+//! vertex and index data waiting to be uploaded, and the buffers they are uploaded to
+class webgl1es2_model::staged_upload final : public webgl1es2_upload_queue::pending_upload
+{
+public:
+    //! usage hint for both buffers
+    webgl1es2_model::Type type;
+
+    //! format of the vertex data
+    webgl1es2_vertex_format vertexFormat;
+
+    //! primitives the indexes describe. needed to split the model
+    webgl1es2_model::PrimitiveMode primitiveMode;
+
+    //! staged vertex data. released after upload
+    std::vector<attribute_component_data_type> vertexData;
+
+    //! staged index data. released after upload
+    std::vector<index_data_type> indexData;
+
+    //! number of vertexes uploaded. differs from the staged count if the model was split
+    GLsizei vertexCount = 0;
+
+    //! type the indexes were uploaded as
+    GLenum indexType = GL_UNSIGNED_SHORT;
+
+    //! chunks the model was split into, if any
+    std::vector<webgl1es2_model::index_chunk> indexChunks;
+
+    //! vertex buffer, once uploaded
+    jfc::unique_handle<GLuint> vertexBuffer;
+
+    //! index buffer, once uploaded
+    jfc::unique_handle<GLuint> indexBuffer;
+
+    //! size of the staged data. recorded at construction, since the data is released by upload
+    size_t size;
+
+    //! deletion queue of the context the model was made by. upload may run on a thread with a different current render state
+    std::shared_ptr<webgl1es2_deletion_queue> pDeletionQueue;
+
+    virtual size_t getSize() const override
+    {
+        return size;
+    }
+
+    virtual void upload() override
+    {
+        // the index type depends on the context's extensions, so is chosen on the uploading thread
+        auto prepared = prepare_geometry(vertexFormat, vertexData.data(), vertexData.size(), indexData, primitiveMode);
+
+        const auto &uploadedVertexData = prepared.chunks.empty() ? vertexData : prepared.splitVertexData;
+
+        vertexBuffer = make_buffer(GL_ARRAY_BUFFER, uploadedVertexData.data(), 
+            sizeof(attribute_component_data_type) * uploadedVertexData.size(), type, pDeletionQueue);
+        indexBuffer = make_buffer(GL_ELEMENT_ARRAY_BUFFER, prepared.indexData.data(), 
+            prepared.indexData.size(), type, pDeletionQueue);
+
+        vertexCount = static_cast<GLsizei>(uploadedVertexData.size() / vertexFormat.getSumOfAttributeComponents());
+        indexType = prepared.indexType;
+        indexChunks = std::move(prepared.chunks);
+
+        vertexData = {};
+        indexData = {};
+    }
+
+    staged_upload(const webgl1es2_model::Type aType, 
+        const webgl1es2_vertex_format &aVertexFormat,
+        const webgl1es2_model::PrimitiveMode aPrimitiveMode,
+        std::vector<attribute_component_data_type> &&aVertexData, 
+        std::vector<index_data_type> &&aIndexData)
+    : type(aType)
+    , vertexFormat(aVertexFormat)
+    , primitiveMode(aPrimitiveMode)
+    , vertexData(std::move(aVertexData))
+    , indexData(std::move(aIndexData))
+    , vertexBuffer(null_buffer())
+    , indexBuffer(null_buffer())
+    , size(sizeof(attribute_component_data_type) * vertexData.size() + sizeof(index_data_type) * indexData.size())
+    , pDeletionQueue(webgl1es2_render_state::current().getDeletionQueue())
+    {}
+};
+
+bool webgl1es2_model::isResident() const
+{
+    return !m_pStagedUpload || m_pStagedUpload->isResident();
+}
+
+void webgl1es2_model::adoptStagedUpload() const
+{
+    if (m_pStagedUpload && m_pStagedUpload->isResident())
+    {
+        m_VertexBufferHandle = std::move(m_pStagedUpload->vertexBuffer);
+        m_IndexBufferHandle = std::move(m_pStagedUpload->indexBuffer);
+        m_VertexCount = m_pStagedUpload->vertexCount;
+        m_IndexType = m_pStagedUpload->indexType;
+        m_IndexChunks = std::move(m_pStagedUpload->indexChunks);
+
+        m_pStagedUpload.reset();
+    }
+}
 
 webgl1es2_model::webgl1es2_model(const webgl1es2_model::Type &aType, 
     const webgl1es2_vertex_format &avertex_format,
     const std::vector<webgl1es2_model::attribute_component_data_type> &awebgl1es2_model, 
-    const std::vector<GLushort> &aIndexData,
+    const std::vector<index_data_type> &aIndexData,
     const PrimitiveMode &aPrimitiveMode)
-: m_IndexBufferHandle([&aIndexData, &aType]()
+: webgl1es2_model(aType, avertex_format, awebgl1es2_model.data(), awebgl1es2_model.size(), aIndexData, aPrimitiveMode)
+{}
+
+webgl1es2_model::webgl1es2_model(const webgl1es2_model::Type &aType, 
+    const webgl1es2_vertex_format &avertex_format,
+    const attribute_component_data_type *const pVertexData, 
+    const size_t aVertexDataCount,
+    const std::vector<index_data_type> &aIndexData,
+    const PrimitiveMode &aPrimitiveMode)
+: m_IndexBufferHandle(null_buffer())
+, m_IndexCount((GLsizei)aIndexData.size())
+, m_VertexBufferHandle(null_buffer())
+, m_vertex_format(avertex_format)
+, m_PrimitiveMode(aPrimitiveMode)
+, m_Type(aType)
 {
-    GLuint ibo(0);
-    
-    if (aIndexData.size() > 0)
-    {
-        glGenBuffers(1, &ibo);
-        
-        glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, ibo);
-        
-        glBufferData(GL_ELEMENT_ARRAY_BUFFER, 
-            sizeof(GLushort) * aIndexData.size(), 
-            &aIndexData[0], 
-            webgl1es2_modelTypeToOpenGLDrawType(aType));
+    if (!aVertexDataCount) throw std::invalid_argument(std::string(TAG).append(": no vertex data to upload!"));
 
-        glBindBuffer(GL_ELEMENT_ARRAY_BUFFER,0);
-    
-        std::string errorCode;
-        
-        if (glh::GetError(&errorCode)) std::runtime_error(std::string(TAG).append(errorCode));
-    }
-    
-    return ibo;
-}(),
-[](const GLuint handle)
+    auto prepared = prepare_geometry(avertex_format, pVertexData, aVertexDataCount, aIndexData, aPrimitiveMode);
+
+    // split data is a copy. otherwise the caller's data is uploaded directly
+    const auto isSplit = !prepared.chunks.empty();
+
+    const auto pUploadedData = isSplit ? prepared.splitVertexData.data() : pVertexData;
+    const auto uploadedCount = isSplit ? prepared.splitVertexData.size() : aVertexDataCount;
+
+    const auto &pDeletionQueue = webgl1es2_render_state::current().getDeletionQueue();
+
+    m_VertexBufferHandle = make_buffer(GL_ARRAY_BUFFER, pUploadedData, 
+        sizeof(webgl1es2_model::attribute_component_data_type) * uploadedCount, aType, pDeletionQueue);
+    m_IndexBufferHandle = make_buffer(GL_ELEMENT_ARRAY_BUFFER, prepared.indexData.data(), prepared.indexData.size(), aType, pDeletionQueue);
+
+    m_VertexCount = static_cast<GLsizei>(uploadedCount) / avertex_format.getSumOfAttributeComponents();
+    m_IndexType = prepared.indexType;
+    m_IndexChunks = std::move(prepared.chunks);
+}
+
+webgl1es2_model::webgl1es2_model(const webgl1es2_model::Type &aType, 
+    const webgl1es2_vertex_format &avertex_format,
+    const attribute_component_data_type *const pVertexData, 
+    const size_t aVertexDataCount,
+    const void *const pIndexData,
+    const size_t aIndexCount,
+    const GLenum aIndexType,
+    const PrimitiveMode &aPrimitiveMode)
+: m_IndexBufferHandle(null_buffer())
+, m_IndexCount(static_cast<GLsizei>(aIndexCount))
+, m_IndexType(aIndexCount ? aIndexType : GL_UNSIGNED_SHORT)
+, m_VertexBufferHandle(null_buffer())
+, m_VertexCount(static_cast<GLsizei>(aVertexDataCount)/avertex_format.getSumOfAttributeComponents())
+, m_vertex_format(avertex_format)
+, m_PrimitiveMode(aPrimitiveMode)
+, m_Type(aType)
 {
-    glDeleteBuffers(1, &handle);
-})
+    if (!aVertexDataCount) throw std::invalid_argument(std::string(TAG).append(": no vertex data to upload!"));
+
+    const auto indexSize = index_type_size(m_IndexType);
+
+    if (aIndexCount && m_IndexType == GL_UNSIGNED_INT && !webgl1es2_render_state::current().supportsUintIndexes())
+        throw std::invalid_argument(std::string(TAG).append(": the context does not support 32 bit indexes"));
+
+    const auto &pDeletionQueue = webgl1es2_render_state::current().getDeletionQueue();
+
+    m_VertexBufferHandle = make_buffer(GL_ARRAY_BUFFER, pVertexData, 
+        sizeof(attribute_component_data_type) * aVertexDataCount, aType, pDeletionQueue);
+    m_IndexBufferHandle = make_buffer(GL_ELEMENT_ARRAY_BUFFER, pIndexData, indexSize * aIndexCount, aType, pDeletionQueue);
+}
+
+webgl1es2_model::webgl1es2_model(webgl1es2_geometry_pool &aGeometryPool,
+    const webgl1es2_vertex_format &avertex_format,
+    const std::vector<attribute_component_data_type> &aVertexData, 
+    const std::vector<index_data_type> &aIndexData,
+    const PrimitiveMode &aPrimitiveMode)
+: webgl1es2_model(aGeometryPool, avertex_format, aVertexData.data(), aVertexData.size(), aIndexData, aPrimitiveMode)
+{}
+
+webgl1es2_model::webgl1es2_model(webgl1es2_geometry_pool &aGeometryPool,
+    const webgl1es2_vertex_format &avertex_format,
+    const attribute_component_data_type *const pVertexData, 
+    const size_t aVertexDataCount,
+    const std::vector<index_data_type> &aIndexData,
+    const PrimitiveMode &aPrimitiveMode)
+: m_IndexBufferHandle(null_buffer())
 , m_IndexCount((GLsizei)aIndexData.size())
-, m_VertexBufferHandle([&awebgl1es2_model, &aType]()
+, m_VertexBufferHandle(null_buffer())
+, m_VertexCount(static_cast<GLsizei>(aVertexDataCount)/avertex_format.getSumOfAttributeComponents())
+, m_vertex_format(avertex_format)
+, m_PrimitiveMode(aPrimitiveMode)
+, m_pGeometryPool(aGeometryPool.shared_from_this())
 {
-    if (!awebgl1es2_model.size()) std::invalid_argument(std::string(TAG).append("no vertex data to upload!"));
-    
-    GLuint vbo(0);
-    
-    glGenBuffers(1, &vbo);
-    glBindBuffer(GL_ARRAY_BUFFER, vbo);
-    glBufferData(GL_ARRAY_BUFFER, sizeof(webgl1es2_model::attribute_component_data_type) * awebgl1es2_model.size(), &awebgl1es2_model[0], webgl1es2_modelTypeToOpenGLDrawType(aType));
-    glBindBuffer(GL_ARRAY_BUFFER, 0);
-    
-    std::string errorCode;
+    if (!aVertexDataCount) throw std::invalid_argument(std::string(TAG).append(": no vertex data to upload!"));
 
-    if (glh::GetError(&errorCode)) std::runtime_error(std::string(TAG).append(errorCode));
-    
-    return vbo;
-}(),
-[](const GLuint handle)
-{
-    glDeleteBuffers(1, &handle);
-})
-, m_VertexCount(static_cast<GLsizei>(awebgl1es2_model.size())/avertex_format.getSumOfAttributeComponents())
+    m_pVertexAllocation = m_pGeometryPool->allocateVertexData(pVertexData, aVertexDataCount);
+
+    if (!aIndexData.empty())
+    {
+        const auto indexes = to_pooled_indexes(aIndexData.data(), aIndexData.size());
+
+        m_pIndexAllocation = m_pGeometryPool->allocateIndexData(indexes.data(), indexes.size());
+    }
+}
+
+webgl1es2_model::webgl1es2_model(webgl1es2_upload_queue &aUploadQueue,
+    const webgl1es2_model::Type &aType, 
+    const webgl1es2_vertex_format &avertex_format,
+    std::vector<webgl1es2_model::attribute_component_data_type> &&aVertexData, 
+    std::vector<index_data_type> &&aIndexData,
+    const PrimitiveMode &aPrimitiveMode)
+: m_IndexBufferHandle(null_buffer())
+, m_IndexCount((GLsizei)aIndexData.size())
+, m_VertexBufferHandle(null_buffer())
+, m_VertexCount(static_cast<GLsizei>(aVertexData.size())/avertex_format.getSumOfAttributeComponents())
 , m_vertex_format(avertex_format)
 , m_PrimitiveMode(aPrimitiveMode)
-{}
+, m_Type(aType)
+{
+    if (aVertexData.empty()) throw std::invalid_argument(std::string(TAG).append(": no vertex data to upload!"));
+
+    m_pStagedUpload = std::make_shared<staged_upload>(aType, avertex_format, aPrimitiveMode, std::move(aVertexData), std::move(aIndexData));
+
+    aUploadQueue.push(m_pStagedUpload);
+}
+
+void webgl1es2_model::requireResident() const
+{
+    adoptStagedUpload();
 
+    if (m_pStagedUpload) throw std::runtime_error(std::string(TAG).append(": model cannot be updated before it is resident"));
+}
+
+void webgl1es2_model::requireUnsplit() const
+{
+    if (!m_IndexChunks.empty()) throw std::runtime_error(std::string(TAG).append(": split models cannot be updated"));
+}
+
+void webgl1es2_model::updateVertexData(const std::vector<attribute_component_data_type> &aVertexData)
+{
+    updateVertexData(m_vertex_format, aVertexData);
+}
+
+void webgl1es2_model::updateVertexData(const webgl1es2_vertex_format &aVertexFormat, const std::vector<attribute_component_data_type> &aVertexData)
+{
+    updateVertexData(aVertexFormat, aVertexData.data(), aVertexData.size());
+}
+
+void webgl1es2_model::updateVertexData(const webgl1es2_vertex_format &aVertexFormat, const attribute_component_data_type *const pData, const size_t aCount)
+{
+    if (!aCount) throw std::invalid_argument(std::string(TAG).append(": no vertex data to upload!"));
+
+    const auto stride = static_cast<size_t>(aVertexFormat.getSumOfAttributeComponents());
+
+    if (aCount % stride) 
+        throw std::invalid_argument(std::string(TAG).append(": vertex data is not a whole number of vertexes"));
+
+    requireResident();
+    requireUnsplit();
+
+    if (m_pVertexAllocation)
+    {
+        if (m_pVertexAllocation->getCount() == aCount) m_pVertexAllocation->write(0, pData, aCount);
+        else m_pVertexAllocation = m_pGeometryPool->allocateVertexData(pData, aCount);
+    }
+    else respecify_buffer(GL_ARRAY_BUFFER, m_VertexBufferHandle.get(), 
+        pData, sizeof(attribute_component_data_type) * aCount, m_Type);
+
+    m_vertex_format = aVertexFormat;
+    m_VertexCount = static_cast<GLsizei>(aCount / stride);
+}
+
+void webgl1es2_model::updateVertexData(const size_t aOffset, const attribute_component_data_type *const pData, const size_t aCount)
+{
+    requireResident();
+    requireUnsplit();
+
+    const auto componentCount = static_cast<size_t>(m_VertexCount) * m_vertex_format.getSumOfAttributeComponents();
+
+    if (aOffset > componentCount || aCount > componentCount - aOffset) 
+        throw std::out_of_range(std::string(TAG).append(": vertex data range exceeds the vertex data"));
+
+    if (m_pVertexAllocation) m_pVertexAllocation->write(aOffset, pData, aCount);
+    else update_buffer_range(GL_ARRAY_BUFFER, m_VertexBufferHandle.get(), 
+        sizeof(attribute_component_data_type) * aOffset, pData, sizeof(attribute_component_data_type) * aCount, 
+        sizeof(attribute_component_data_type) * componentCount, m_Type);
+}
+
+void webgl1es2_model::updateIndexData(const std::vector<index_data_type> &aIndexData)
+{
+    requireResident();
+    requireUnsplit();
+
+    if (m_pGeometryPool)
+    {
+        const auto indexes = to_pooled_indexes(aIndexData.data(), aIndexData.size());
+
+        if (indexes.empty()) m_pIndexAllocation.reset();
+        else if (m_pIndexAllocation && m_pIndexAllocation->getCount() == indexes.size()) 
+            m_pIndexAllocation->write(0, indexes.data(), indexes.size());
+        else m_pIndexAllocation = m_pGeometryPool->allocateIndexData(indexes.data(), indexes.size());
+    }
+    else
+    {
+        const auto indexType = smallest_index_type(aIndexData);
+
+        if (indexType == GL_UNSIGNED_INT && !webgl1es2_render_state::current().supportsUintIndexes()) 
+            throw std::invalid_argument(std::string(TAG).append(": the context does not support 32 bit indexes. "
+                "Make a new model instead, which is split into 16 bit chunks"));
+
+        const auto packed = pack_indexes(aIndexData.data(), aIndexData.size(), indexType);
+
+        if (packed.empty()) m_IndexBufferHandle = null_buffer();
+        else if (!m_IndexBufferHandle.get()) m_IndexBufferHandle = make_buffer(GL_ELEMENT_ARRAY_BUFFER, 
+            packed.data(), packed.size(), m_Type, webgl1es2_render_state::current().getDeletionQueue());
+        else respecify_buffer(GL_ELEMENT_ARRAY_BUFFER, m_IndexBufferHandle.get(), packed.data(), packed.size(), m_Type);
+
+        m_IndexType = indexType;
+    }
+
+    m_IndexCount = static_cast<GLsizei>(aIndexData.size());
+}
+
+void webgl1es2_model::updateIndexData(const size_t aOffset, const index_data_type *const pData, const size_t aCount)
+{
+    requireResident();
+    requireUnsplit();
+
+    const auto indexCount = static_cast<size_t>(m_IndexCount);
+
+    if (aOffset > indexCount || aCount > indexCount - aOffset) 
+        throw std::out_of_range(std::string(TAG).append(": index data range exceeds the index data"));
+
+    // pools store 16 bit indexes
+    const auto indexType = m_pIndexAllocation ? GL_UNSIGNED_SHORT : m_IndexType;
+
+    const auto packed = pack_indexes(pData, aCount, indexType);
+
+    if (m_pIndexAllocation) m_pIndexAllocation->write(aOffset, packed.data(), aCount);
+    else update_buffer_range(GL_ELEMENT_ARRAY_BUFFER, m_IndexBufferHandle.get(), 
+        index_type_size(indexType) * aOffset, packed.data(), packed.size(), 
+        index_type_size(indexType) * indexCount, m_Type);
+}
+
+GLuint webgl1es2_model::getVertexBufferHandle() const
+{
+    return m_pVertexAllocation ? m_pVertexAllocation->getBufferHandle() : m_VertexBufferHandle.get();
+}
+
+bool webgl1es2_model::isPooled() const
+{
+    return static_cast<bool>(m_pGeometryPool);
+}
+
+webgl1es2_model::Type webgl1es2_model::getType() const
+{
+    return m_Type;
+}
+
+size_t webgl1es2_model::getVertexCount() const
+{
+    return static_cast<size_t>(m_VertexCount);
+}
+
+const webgl1es2_vertex_format &webgl1es2_model::getVertexFormat() const
+{
+    return m_vertex_format;
+}
+
+size_t webgl1es2_model::getIndexCount() const
+{
+    return static_cast<size_t>(m_IndexCount);
+}
+
+GLenum webgl1es2_model::getIndexType() const
+{
+    return m_IndexType;
+}
+
+const std::vector<webgl1es2_model::index_chunk> &webgl1es2_model::getIndexChunks() const
+{
+    return m_IndexChunks;
+}
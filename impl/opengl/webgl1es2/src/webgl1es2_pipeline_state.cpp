@@ -0,0 +1,273 @@
+// © 2019 Joseph Cameron - All Rights Reserved
+
+#include <gdk/webgl1es2_pipeline_state.h>
+#include <gdk/webgl1es2_render_state.h>
+
+#include <stdexcept>
+
+using namespace gdk;
+
+static constexpr char TAG[] = "pipeline_state";
+
+// key layout, least significant bit first
+static constexpr webgl1es2_pipeline_state::key_type COLOR_MASK_SHIFT(0),     COLOR_MASK_MASK(0xF);
+static constexpr webgl1es2_pipeline_state::key_type DEPTH_FUNCTION_SHIFT(4), DEPTH_FUNCTION_MASK(0x7);
+static constexpr webgl1es2_pipeline_state::key_type DEPTH_WRITE_SHIFT(7),    DEPTH_WRITE_MASK(0x1);
+static constexpr webgl1es2_pipeline_state::key_type DEPTH_TEST_SHIFT(8),     DEPTH_TEST_MASK(0x1);
+static constexpr webgl1es2_pipeline_state::key_type CULL_MODE_SHIFT(9),      CULL_MODE_MASK(0x3);
+static constexpr webgl1es2_pipeline_state::key_type BLEND_DST_SHIFT(11),     BLEND_DST_MASK(0xF);
+static constexpr webgl1es2_pipeline_state::key_type BLEND_SRC_SHIFT(15),     BLEND_SRC_MASK(0xF);
+static constexpr webgl1es2_pipeline_state::key_type BLEND_SHIFT(31),         BLEND_MASK(0x1);
+
+static inline webgl1es2_pipeline_state::key_type getField(const webgl1es2_pipeline_state::key_type aKey,
+    const webgl1es2_pipeline_state::key_type aShift,
+    const webgl1es2_pipeline_state::key_type aMask)
+{
+    return (aKey >> aShift) & aMask;
+}
+
+static inline webgl1es2_pipeline_state::key_type setField(const webgl1es2_pipeline_state::key_type aKey,
+    const webgl1es2_pipeline_state::key_type aShift,
+    const webgl1es2_pipeline_state::key_type aMask,
+    const webgl1es2_pipeline_state::key_type aValue)
+{
+    return (aKey & ~(aMask << aShift)) | ((aValue & aMask) << aShift);
+}
+
+static inline GLenum depth_function_to_glenum(const webgl1es2_pipeline_state::depth_function a)
+{
+    switch (a)
+    {
+        case webgl1es2_pipeline_state::depth_function::never: return GL_NEVER;
+        case webgl1es2_pipeline_state::depth_function::less: return GL_LESS;
+        case webgl1es2_pipeline_state::depth_function::equal: return GL_EQUAL;
+        case webgl1es2_pipeline_state::depth_function::less_or_equal: return GL_LEQUAL;
+        case webgl1es2_pipeline_state::depth_function::greater: return GL_GREATER;
+        case webgl1es2_pipeline_state::depth_function::not_equal: return GL_NOTEQUAL;
+        case webgl1es2_pipeline_state::depth_function::greater_or_equal: return GL_GEQUAL;
+        case webgl1es2_pipeline_state::depth_function::always: return GL_ALWAYS;
+    }
+
+    throw std::invalid_argument("unhandled depth function");
+}
+
+static inline GLenum face_culling_mode_to_glenum(const webgl1es2_pipeline_state::face_culling_mode a)
+{
+    switch (a)
+    {
+        case webgl1es2_pipeline_state::face_culling_mode::front: return GL_FRONT;
+        case webgl1es2_pipeline_state::face_culling_mode::back: return GL_BACK;
+        case webgl1es2_pipeline_state::face_culling_mode::front_and_back: return GL_FRONT_AND_BACK;
+
+        case webgl1es2_pipeline_state::face_culling_mode::none: break;
+    }
+
+    throw std::invalid_argument("unhandled face culling mode");
+}
+
+static inline GLenum blend_factor_to_glenum(const webgl1es2_pipeline_state::blend_factor a)
+{
+    switch (a)
+    {
+        case webgl1es2_pipeline_state::blend_factor::zero: return GL_ZERO;
+        case webgl1es2_pipeline_state::blend_factor::one: return GL_ONE;
+        case webgl1es2_pipeline_state::blend_factor::source_color: return GL_SRC_COLOR;
+        case webgl1es2_pipeline_state::blend_factor::one_minus_source_color: return GL_ONE_MINUS_SRC_COLOR;
+        case webgl1es2_pipeline_state::blend_factor::destination_color: return GL_DST_COLOR;
+        case webgl1es2_pipeline_state::blend_factor::one_minus_destination_color: return GL_ONE_MINUS_DST_COLOR;
+        case webgl1es2_pipeline_state::blend_factor::source_alpha: return GL_SRC_ALPHA;
+        case webgl1es2_pipeline_state::blend_factor::one_minus_source_alpha: return GL_ONE_MINUS_SRC_ALPHA;
+        case webgl1es2_pipeline_state::blend_factor::destination_alpha: return GL_DST_ALPHA;
+        case webgl1es2_pipeline_state::blend_factor::one_minus_destination_alpha: return GL_ONE_MINUS_DST_ALPHA;
+        case webgl1es2_pipeline_state::blend_factor::source_alpha_saturate: return GL_SRC_ALPHA_SATURATE;
+    }
+
+    throw std::invalid_argument("unhandled blend factor");
+}
+
+const webgl1es2_pipeline_state webgl1es2_pipeline_state::Opaque = webgl1es2_pipeline_state();
+
+const webgl1es2_pipeline_state webgl1es2_pipeline_state::AlphaBlended = webgl1es2_pipeline_state()
+    .withDepthWrite(false)
+    .withBlend(blend_factor::source_alpha, blend_factor::one_minus_source_alpha);
+
+const webgl1es2_pipeline_state webgl1es2_pipeline_state::Additive = webgl1es2_pipeline_state()
+    .withDepthWrite(false)
+    .withBlend(blend_factor::one, blend_factor::one);
+
+webgl1es2_pipeline_state::webgl1es2_pipeline_state(const key_type aKey)
+: m_Key(aKey)
+{}
+
+webgl1es2_pipeline_state::webgl1es2_pipeline_state()
+: m_Key([]()
+{
+    key_type key(0);
+
+    key = setField(key, COLOR_MASK_SHIFT, COLOR_MASK_MASK, 0xF);
+    key = setField(key, DEPTH_FUNCTION_SHIFT, DEPTH_FUNCTION_MASK, static_cast<key_type>(depth_function::less));
+    key = setField(key, DEPTH_WRITE_SHIFT, DEPTH_WRITE_MASK, 1);
+    key = setField(key, DEPTH_TEST_SHIFT, DEPTH_TEST_MASK, 1);
+    key = setField(key, CULL_MODE_SHIFT, CULL_MODE_MASK, static_cast<key_type>(face_culling_mode::none));
+    key = setField(key, BLEND_DST_SHIFT, BLEND_DST_MASK, static_cast<key_type>(blend_factor::zero));
+    key = setField(key, BLEND_SRC_SHIFT, BLEND_SRC_MASK, static_cast<key_type>(blend_factor::one));
+    key = setField(key, BLEND_SHIFT, BLEND_MASK, 0);
+
+    return key;
+}())
+{}
+
+bool webgl1es2_pipeline_state::getDepthTestEnabled() const
+{
+    return getField(m_Key, DEPTH_TEST_SHIFT, DEPTH_TEST_MASK);
+}
+
+bool webgl1es2_pipeline_state::getDepthWriteEnabled() const
+{
+    return getField(m_Key, DEPTH_WRITE_SHIFT, DEPTH_WRITE_MASK);
+}
+
+webgl1es2_pipeline_state::depth_function webgl1es2_pipeline_state::getDepthFunction() const
+{
+    return static_cast<depth_function>(getField(m_Key, DEPTH_FUNCTION_SHIFT, DEPTH_FUNCTION_MASK));
+}
+
+webgl1es2_pipeline_state::face_culling_mode webgl1es2_pipeline_state::getFaceCullingMode() const
+{
+    return static_cast<face_culling_mode>(getField(m_Key, CULL_MODE_SHIFT, CULL_MODE_MASK));
+}
+
+bool webgl1es2_pipeline_state::getBlendEnabled() const
+{
+    return getField(m_Key, BLEND_SHIFT, BLEND_MASK);
+}
+
+webgl1es2_pipeline_state::blend_factor webgl1es2_pipeline_state::getSourceBlendFactor() const
+{
+    return static_cast<blend_factor>(getField(m_Key, BLEND_SRC_SHIFT, BLEND_SRC_MASK));
+}
+
+webgl1es2_pipeline_state::blend_factor webgl1es2_pipeline_state::getDestinationBlendFactor() const
+{
+    return static_cast<blend_factor>(getField(m_Key, BLEND_DST_SHIFT, BLEND_DST_MASK));
+}
+
+std::uint8_t webgl1es2_pipeline_state::getColorMask() const
+{
+    return static_cast<std::uint8_t>(getField(m_Key, COLOR_MASK_SHIFT, COLOR_MASK_MASK));
+}
+
+webgl1es2_pipeline_state webgl1es2_pipeline_state::withDepthTest(const bool aEnabled) const
+{
+    return webgl1es2_pipeline_state(setField(m_Key, DEPTH_TEST_SHIFT, DEPTH_TEST_MASK, aEnabled));
+}
+
+webgl1es2_pipeline_state webgl1es2_pipeline_state::withDepthWrite(const bool aEnabled) const
+{
+    return webgl1es2_pipeline_state(setField(m_Key, DEPTH_WRITE_SHIFT, DEPTH_WRITE_MASK, aEnabled));
+}
+
+webgl1es2_pipeline_state webgl1es2_pipeline_state::withDepthFunction(const depth_function aFunction) const
+{
+    return webgl1es2_pipeline_state(setField(m_Key, DEPTH_FUNCTION_SHIFT, DEPTH_FUNCTION_MASK, static_cast<key_type>(aFunction)));
+}
+
+webgl1es2_pipeline_state webgl1es2_pipeline_state::withFaceCullingMode(const face_culling_mode aMode) const
+{
+    return webgl1es2_pipeline_state(setField(m_Key, CULL_MODE_SHIFT, CULL_MODE_MASK, static_cast<key_type>(aMode)));
+}
+
+webgl1es2_pipeline_state webgl1es2_pipeline_state::withBlend(const blend_factor aSource, const blend_factor aDestination) const
+{
+    auto key = setField(m_Key, BLEND_SHIFT, BLEND_MASK, 1);
+    key = setField(key, BLEND_SRC_SHIFT, BLEND_SRC_MASK, static_cast<key_type>(aSource));
+    key = setField(key, BLEND_DST_SHIFT, BLEND_DST_MASK, static_cast<key_type>(aDestination));
+
+    return webgl1es2_pipeline_state(key);
+}
+
+webgl1es2_pipeline_state webgl1es2_pipeline_state::withoutBlend() const
+{
+    return webgl1es2_pipeline_state(setField(m_Key, BLEND_SHIFT, BLEND_MASK, 0));
+}
+
+webgl1es2_pipeline_state webgl1es2_pipeline_state::withColorMask(const bool aRed, const bool aGreen, const bool aBlue, const bool aAlpha) const
+{
+    return webgl1es2_pipeline_state(setField(m_Key, COLOR_MASK_SHIFT, COLOR_MASK_MASK,
+        (aRed << 0) | (aGreen << 1) | (aBlue << 2) | (aAlpha << 3)));
+}
+
+webgl1es2_pipeline_state::key_type webgl1es2_pipeline_state::getKey() const
+{
+    return m_Key;
+}
+
+webgl1es2_pipeline_state webgl1es2_pipeline_state::fromKey(const key_type aKey)
+{
+    return webgl1es2_pipeline_state(aKey);
+}
+
+void webgl1es2_pipeline_state::activate() const
+{
+    auto &renderState = webgl1es2_render_state::current();
+
+    // the current state is empty until the first activation, so the first activation sets everything
+    const auto &currentPipelineState = renderState.getCurrentPipelineState();
+
+    const key_type changed = currentPipelineState ? currentPipelineState->m_Key ^ m_Key : ~key_type(0);
+
+    if (!changed) return;
+
+    if (getField(changed, DEPTH_TEST_SHIFT, DEPTH_TEST_MASK))
+    {
+        if (getDepthTestEnabled()) glEnable(GL_DEPTH_TEST);
+        else glDisable(GL_DEPTH_TEST);
+    }
+
+    if (getField(changed, DEPTH_WRITE_SHIFT, DEPTH_WRITE_MASK)) glDepthMask(getDepthWriteEnabled() ? GL_TRUE : GL_FALSE);
+
+    if (getField(changed, DEPTH_FUNCTION_SHIFT, DEPTH_FUNCTION_MASK)) glDepthFunc(depth_function_to_glenum(getDepthFunction()));
+
+    if (getField(changed, CULL_MODE_SHIFT, CULL_MODE_MASK))
+    {
+        const auto wasCulling = currentPipelineState && currentPipelineState->getFaceCullingMode() != face_culling_mode::none;
+
+        if (getFaceCullingMode() == face_culling_mode::none) glDisable(GL_CULL_FACE);
+        else
+        {
+            if (!wasCulling) glEnable(GL_CULL_FACE);
+
+            glCullFace(face_culling_mode_to_glenum(getFaceCullingMode()));
+        }
+    }
+
+    if (getField(changed, BLEND_SHIFT, BLEND_MASK))
+    {
+        if (getBlendEnabled()) glEnable(GL_BLEND);
+        else glDisable(GL_BLEND);
+    }
+
+    if (getField(changed, BLEND_SRC_SHIFT, BLEND_SRC_MASK) || getField(changed, BLEND_DST_SHIFT, BLEND_DST_MASK))
+    {
+        glBlendFunc(blend_factor_to_glenum(getSourceBlendFactor()), blend_factor_to_glenum(getDestinationBlendFactor()));
+    }
+
+    if (getField(changed, COLOR_MASK_SHIFT, COLOR_MASK_MASK))
+    {
+        const auto mask = getColorMask();
+
+        glColorMask((mask & 0x1) != 0, (mask & 0x2) != 0, (mask & 0x4) != 0, (mask & 0x8) != 0);
+    }
+
+    renderState.setCurrentPipelineState(*this);
+}
+
+bool webgl1es2_pipeline_state::operator==(const webgl1es2_pipeline_state &b) const
+{
+    return m_Key == b.m_Key;
+}
+
+bool webgl1es2_pipeline_state::operator!=(const webgl1es2_pipeline_state &b) const
+{
+    return !(*this == b);
+}
@@ -0,0 +1,112 @@
+// © 2019 Joseph Cameron - All Rights Reserved
+
+#include <gdk/glh.h>
+#include <gdk/webgl1es2_render_state.h>
+
+using namespace gdk;
+
+// values of GL_HALF_FLOAT_OES and GL_HALF_FLOAT. the headers of each platform only define one of them
+static constexpr GLenum HALF_FLOAT_OES(0x8D61), HALF_FLOAT(0x140B);
+
+//! state bound to the calling thread, null if none is bound
+static thread_local webgl1es2_render_state *s_pBound = nullptr;
+
+webgl1es2_render_state::binding::binding(webgl1es2_render_state *const pRenderState)
+: m_pPrevious(s_pBound)
+{
+    if (pRenderState) s_pBound = pRenderState;
+}
+
+webgl1es2_render_state::binding::~binding()
+{
+    s_pBound = m_pPrevious;
+}
+
+webgl1es2_render_state &webgl1es2_render_state::current()
+{
+    if (s_pBound) return *s_pBound;
+
+    // made on first use only, since making a state queries the gl, which threads that always bind a state may not have
+    static thread_local webgl1es2_render_state threadDefault;
+
+    return threadDefault;
+}
+
+bool webgl1es2_render_state::setCurrentProgram(const GLint aProgramHandle)
+{
+    if (m_CurrentProgramHandle == aProgramHandle) return false;
+
+    m_CurrentProgramHandle = aProgramHandle;
+
+    m_TextureUniformNameToUnit.clear();
+    m_TextureUnitCount = 0;
+
+    return true;
+}
+
+GLint webgl1es2_render_state::getTextureUnit(const std::string &aUniformName)
+{
+    if (const auto search = m_TextureUniformNameToUnit.find(aUniformName); search != m_TextureUniformNameToUnit.end()) 
+        return search->second;
+
+    return m_TextureUniformNameToUnit[aUniformName] = m_TextureUnitCount++;
+}
+
+GLint webgl1es2_render_state::getTextureUnitCount() const
+{
+    return m_TextureUnitCount;
+}
+
+const std::optional<webgl1es2_pipeline_state> &webgl1es2_render_state::getCurrentPipelineState() const
+{
+    return m_CurrentPipelineState;
+}
+
+void webgl1es2_render_state::setCurrentPipelineState(const webgl1es2_pipeline_state &aPipelineState)
+{
+    m_CurrentPipelineState = aPipelineState;
+}
+
+const std::shared_ptr<webgl1es2_deletion_queue> &webgl1es2_render_state::getDeletionQueue() const
+{
+    return m_pDeletionQueue;
+}
+
+void webgl1es2_render_state::setDeletionQueue(std::shared_ptr<webgl1es2_deletion_queue> pDeletionQueue)
+{
+    m_pDeletionQueue = std::move(pDeletionQueue);
+}
+
+bool webgl1es2_render_state::supportsUintIndexes() const
+{
+    return m_SupportsUintIndexes;
+}
+
+bool webgl1es2_render_state::supportsHalfFloatAttributes() const
+{
+    return m_SupportsHalfFloatAttributes;
+}
+
+GLenum webgl1es2_render_state::getHalfFloatAttributeType() const
+{
+    return m_HalfFloatAttributeType;
+}
+
+void webgl1es2_render_state::invalidate()
+{
+    m_CurrentProgramHandle = -1;
+
+    m_TextureUniformNameToUnit.clear();
+    m_TextureUnitCount = 0;
+
+    m_CurrentPipelineState.reset();
+}
+
+webgl1es2_render_state::webgl1es2_render_state()
+: m_SupportsUintIndexes(!glh::IsEmbeddedProfile() || glh::HasExtension("OES_element_index_uint"))
+, m_SupportsHalfFloatAttributes(glh::IsEmbeddedProfile() 
+    ? glh::HasExtension("OES_vertex_half_float") 
+    // core since desktop 3.0, which may be a core profile that does not list it
+    : glh::GetMajorVersion() >= 3 || glh::HasExtension("ARB_half_float_vertex"))
+, m_HalfFloatAttributeType(glh::IsEmbeddedProfile() ? HALF_FLOAT_OES : HALF_FLOAT)
+{}
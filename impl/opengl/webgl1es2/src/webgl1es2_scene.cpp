@@ -1,8 +1,16 @@
 #include <gdk/webgl1es2_entity.h>
 #include <gdk/webgl1es2_scene.h>
 
+#include <algorithm>
+#include <cstdint>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
 using namespace gdk;
 
+static constexpr char TAG[] = "webgl1es2_scene";
+
 void webgl1es2_scene::add_camera(camera_ptr_type pCamera)
 {
     m_cameras.insert(pCamera);
@@ -56,32 +64,358 @@ void webgl1es2_scene::remove_entity(entity_ptr_type pEntity)
     // nested sets replace with sets of size_t? or perhaps iters to the global set. yes. rewrite. indicies.?
 }
 
+size_t webgl1es2_scene::add_transform_slot(entity_ptr_type pEntity)
+{
+    if (!pEntity) throw std::invalid_argument(std::string(TAG).append(": entity must not be null"));
+
+    if (m_FreeTransformSlots.empty())
+    {
+        const auto slot = m_TransformSlotEntities.size();
+
+        m_TransformSlotEntities.push_back(std::move(pEntity));
+
+        // grow geometrically, so that adding many slots does not reallocate each time
+        if (m_TransformSlots.size() < m_TransformSlotEntities.size()) 
+            m_TransformSlots.resize(std::max<size_t>(64, m_TransformSlots.size() * 2));
+
+        return slot;
+    }
+
+    const auto slot = m_FreeTransformSlots.back();
+
+    m_FreeTransformSlots.pop_back();
+
+    m_TransformSlotEntities[slot] = std::move(pEntity);
+
+    return slot;
+}
+
+void webgl1es2_scene::remove_transform_slot(const size_t aSlot)
+{
+    if (aSlot >= m_TransformSlotEntities.size() || !m_TransformSlotEntities[aSlot]) 
+        throw std::invalid_argument(std::string(TAG).append(": transform slot is not in use"));
+
+    m_TransformSlotEntities[aSlot].reset();
+
+    m_TransformSlots.discard(aSlot);
+
+    m_FreeTransformSlots.push_back(aSlot);
+}
+
+void webgl1es2_scene::write_transform(const size_t aSlot, const graphics_mat4x4_type &aTransform)
+{
+    m_TransformSlots.write(aSlot, aTransform);
+}
+
+void webgl1es2_scene::write_transform(const size_t aSlot, 
+    const graphics_vector3_type &aWorldPos, 
+    const graphics_quaternion_type &aRotation, 
+    const graphics_vector3_type &aScale)
+{
+    graphics_mat4x4_type transform;
+    transform.setToIdentity();
+    transform.translate(aWorldPos);
+    transform.rotate(aRotation);
+    transform.scale(aScale);
+
+    m_TransformSlots.write(aSlot, transform);
+}
+
+void webgl1es2_scene::applyTransformSlots() const
+{
+    m_TransformSlots.consume([this](const size_t aSlot, const graphics_mat4x4_type &aTransform)
+    {
+        if (aSlot < m_TransformSlotEntities.size()) if (const auto &pEntity = m_TransformSlotEntities[aSlot])
+            static_cast<webgl1es2_entity *>(pEntity.get())->set_model_matrix(aTransform);
+    });
+}
+
+void webgl1es2_scene::setTime(const float aTime)
+{
+    m_Time = aTime;
+}
+
+std::vector<std::pair<std::uint64_t, webgl1es2_scene::material_to_model_to_entity_collection_collection::const_iterator>> 
+webgl1es2_scene::getSortedBatches() const
+{
+    // order batches by pipeline state then program, so each state and program transition happens as few times as possible.
+    // the blend bit is the most significant bit of the pipeline key, so blended materials are drawn after opaque ones
+    std::vector<std::pair<std::uint64_t, material_to_model_to_entity_collection_collection::const_iterator>> sortedBatches;
+    sortedBatches.reserve(m_MaterialToModelToEntityCollection.size());
+
+    for (auto iter = m_MaterialToModelToEntityCollection.begin(); iter != m_MaterialToModelToEntityCollection.end(); ++iter)
+    {
+        const std::uint64_t sortKey = 
+            (static_cast<std::uint64_t>(iter->first->getPipelineState().getKey()) << 32) | 
+            (static_cast<std::uint64_t>(iter->first->getShaderProgram()->getSerial()) & 0xFFFFFFFF);
+
+        sortedBatches.push_back({sortKey, iter});
+    }
+
+    std::sort(sortedBatches.begin(), sortedBatches.end(), [](const auto &a, const auto &b)
+    {
+        return a.first < b.first;
+    });
+
+    return sortedBatches;
+}
+
+void webgl1es2_scene::addBlendedEntity(const graphics_mat4x4_type &aViewMatrix, 
+    webgl1es2_material *pMaterial, 
+    const webgl1es2_model *pModel, 
+    const graphics_mat4x4_type &aModelMatrix,
+    const webgl1es2_entity::property_overrides *pPropertyOverrides) const
+{
+    const auto &model = aModelMatrix.m;
+    const auto &view = aViewMatrix.m;
+
+    // matrices are column major: the origin's view space z is the view's third row applied to the model's translation.
+    // the camera looks down -z, so depth is its negation
+    const float depth = -(view[0][2] * model[3][0] + view[1][2] * model[3][1] + view[2][2] * model[3][2] + view[3][2]);
+
+    m_BlendedEntities.push_back({depth, pMaterial, pModel, &aModelMatrix, pPropertyOverrides});
+}
+
+void webgl1es2_scene::drawBlendedEntities() const
+{
+    std::sort(m_BlendedEntities.begin(), m_BlendedEntities.end(), [](const blended_entity &a, const blended_entity &b)
+    {
+        return a.depth > b.depth;
+    });
+
+    const webgl1es2_material *pActiveMaterial = nullptr;
+    const webgl1es2_shader_program *pActiveProgram = nullptr;
+    const webgl1es2_model *pBoundModel = nullptr;
+
+    for (const auto &current : m_BlendedEntities)
+    {
+        if (current.pMaterial != pActiveMaterial)
+        {
+            current.pMaterial->activate();
+
+            const auto pProgram = current.pMaterial->getShaderProgram().get();
+
+            m_SharedUniforms.upload(*pProgram);
+
+            // see draw: model bindings made against a conventional program survive program changes
+            if (!pActiveProgram || 
+                !pActiveProgram->hasConventionalAttributeLocations() || 
+                !pProgram->hasConventionalAttributeLocations()) pBoundModel = nullptr;
+
+            pActiveMaterial = current.pMaterial;
+            pActiveProgram = pProgram;
+        }
+
+        if (current.pModel != pBoundModel)
+        {
+            current.pModel->bind(*pActiveProgram, pBoundModel);
+
+            pBoundModel = current.pModel;
+        }
+
+        webgl1es2_entity::draw(*current.pModel, *current.pMaterial, *current.pModelMatrix, current.pPropertyOverrides, 
+            *pActiveProgram, m_SharedUniforms.getViewProjectionMatrix());
+    }
+
+    m_BlendedEntities.clear();
+}
+
+webgl1es2_scene::webgl1es2_scene(std::shared_ptr<webgl1es2_render_state> pRenderState)
+: m_pRenderState(std::move(pRenderState))
+{}
+
 void webgl1es2_scene::draw(const gdk::graphics_intvector2_type &aFrameBufferSize) const
 {
+    const webgl1es2_render_state::binding binding(m_pRenderState.get());
+
+    applyTransformSlots();
+
+    const auto sortedBatches = getSortedBatches();
+
+    m_SharedUniforms.setTime(m_Time);
+
     for (auto &current_camera : m_cameras)
     {
-        static_cast<webgl1es2_camera *>(current_camera.get())->activate(aFrameBufferSize);
+        const auto pCamera = static_cast<webgl1es2_camera *>(current_camera.get());
+
+        pCamera->activate(aFrameBufferSize);
+
+        const auto viewMatrix = pCamera->getViewMatrix();
+
+        m_SharedUniforms.setCamera(viewMatrix, pCamera->getProjectionMatrix(), pCamera->getWorldPosition());
 
-        for (auto &[current_material, current_model_to_entity_collection] : m_MaterialToModelToEntityCollection)
+        // with conventional attribute locations, a model's attribute bindings do not depend on the program,
+        // so a model that is still bound does not have to be rebound when only the program changes
+        const webgl1es2_model *pBoundModel = nullptr;
+        bool boundModelIsProgramIndependent = false;
+
+        for (const auto &[current_sort_key, current_batch] : sortedBatches)
         {
+            auto &[current_material, current_model_to_entity_collection] = *current_batch;
+
+            // blended entities are drawn once every opaque one is, in depth order rather than batch order
+            if (current_material->getPipelineState().getBlendEnabled())
+            {
+                for (auto &[current_model, current_entity_collection] : current_model_to_entity_collection) if (current_model->isResident())
+                {
+                    for (auto &current_entity : current_entity_collection) if (!current_entity->isHidden())
+                    {
+                        const auto pEntity = static_cast<const webgl1es2_entity *>(current_entity.get());
+
+                        addBlendedEntity(viewMatrix, current_material.get(), current_model.get(), 
+                            pEntity->getModelMatrix(), pEntity->getPropertyOverrides().get());
+                    }
+                }
+
+                continue;
+            }
+
             current_material->activate(); 
 
+            const auto &current_program = *current_material->getShaderProgram();
+
+            m_SharedUniforms.upload(current_program);
+
             for (auto &[current_model, current_entity_collection] : current_model_to_entity_collection)
             {
-                current_model->bind(*current_material->getShaderProgram());
+                // entities whose model is still waiting in an upload queue are skipped until it is resident
+                if (!current_model->isResident()) continue;
+
+                if (current_model.get() != pBoundModel || 
+                    !boundModelIsProgramIndependent || 
+                    !current_program.hasConventionalAttributeLocations())
+                {
+                    current_model->bind(current_program, pBoundModel);
+
+                    pBoundModel = current_model.get();
+                    boundModelIsProgramIndependent = current_program.hasConventionalAttributeLocations();
+                }
 
                 for (auto &current_entity : current_entity_collection) 
                 {
                     auto current_entity_impl = static_cast<webgl1es2_entity *>(current_entity.get());
                     
-                    current_entity_impl->draw(
-                        current_camera->getViewMatrix(), 
-                        current_camera->getProjectionMatrix());
+                    current_entity_impl->draw(current_program, m_SharedUniforms.getViewProjectionMatrix());
                 }
             }
         }
 
-        //for (transparent_materals....) //TODO handle blended materials.
+        drawBlendedEntities();
+    }
+}
+
+void webgl1es2_scene::extract()
+{
+    applyTransformSlots();
+
+    auto &packet = m_FramePackets.back();
+
+    packet.cameras.clear();
+    packet.entities.clear();
+    packet.resources.clear();
+    packet.time = m_Time;
+
+    for (const auto &pCamera : m_cameras) packet.cameras.push_back(*static_cast<webgl1es2_camera *>(pCamera.get()));
+
+    for (const auto &[current_sort_key, current_batch] : getSortedBatches())
+    {
+        const auto &[current_material, current_model_to_entity_collection] = *current_batch;
+
+        const auto batchBegin = packet.entities.size();
+
+        packet.resources.push_back(current_material);
+
+        for (const auto &[current_model, current_entity_collection] : current_model_to_entity_collection)
+        {
+            if (!current_model->isResident()) continue;
+
+            packet.resources.push_back(current_model);
+
+            for (const auto &current_entity : current_entity_collection) if (!current_entity->isHidden())
+            {
+                const auto pEntity = static_cast<const webgl1es2_entity *>(current_entity.get());
+
+                packet.entities.push_back({
+                    current_material.get(), 
+                    current_model.get(), 
+                    pEntity->getModelMatrix(),
+                    pEntity->getPropertyOverrides()});
+            }
+        }
+
+        // pooled models sharing a page are drawn one after the other, so draw_extracted only changes attribute offsets between them.
+        // the sort is stable, so entities of the same model stay together
+        std::stable_sort(packet.entities.begin() + batchBegin, packet.entities.end(), [](const render_record &a, const render_record &b)
+        {
+            return (a.pModel->isPooled() ? a.pModel->getVertexBufferHandle() : 0) < 
+                (b.pModel->isPooled() ? b.pModel->getVertexBufferHandle() : 0);
+        });
     }
+
+    m_FramePackets.publish();
 }
 
+void webgl1es2_scene::draw_extracted(const gdk::graphics_intvector2_type &aFrameBufferSize) const
+{
+    const webgl1es2_render_state::binding binding(m_pRenderState.get());
+
+    m_FramePackets.acquire();
+
+    const auto &packet = m_FramePackets.front();
+
+    // shared values come only from the packet, since the scene's own are written by the thread calling extract
+    m_SharedUniforms.setTime(packet.time);
+
+    for (const auto &current_camera : packet.cameras)
+    {
+        current_camera.activate(aFrameBufferSize);
+
+        const auto viewMatrix = current_camera.getViewMatrix();
+
+        m_SharedUniforms.setCamera(viewMatrix, current_camera.getProjectionMatrix(), current_camera.getWorldPosition());
+
+        const webgl1es2_material *pActiveMaterial = nullptr;
+        const webgl1es2_shader_program *pActiveProgram = nullptr;
+        const webgl1es2_model *pBoundModel = nullptr;
+
+        for (const auto &current : packet.entities)
+        {
+            // see draw
+            if (current.pMaterial->getPipelineState().getBlendEnabled())
+            {
+                addBlendedEntity(viewMatrix, current.pMaterial, current.pModel, current.modelMatrix, current.pPropertyOverrides.get());
+
+                continue;
+            }
+
+            if (current.pMaterial != pActiveMaterial)
+            {
+                current.pMaterial->activate();
+
+                const auto pProgram = current.pMaterial->getShaderProgram().get();
+
+                m_SharedUniforms.upload(*pProgram);
+
+                // see draw: model bindings made against a conventional program survive program changes
+                if (!pActiveProgram || 
+                    !pActiveProgram->hasConventionalAttributeLocations() || 
+                    !pProgram->hasConventionalAttributeLocations()) pBoundModel = nullptr;
+
+                pActiveMaterial = current.pMaterial;
+                pActiveProgram = pProgram;
+            }
+
+            if (current.pModel != pBoundModel)
+            {
+                current.pModel->bind(*pActiveProgram, pBoundModel);
+
+                pBoundModel = current.pModel;
+            }
+
+            webgl1es2_entity::draw(*current.pModel, *current.pMaterial, current.modelMatrix, current.pPropertyOverrides.get(), 
+                *pActiveProgram, m_SharedUniforms.getViewProjectionMatrix());
+        }
+
+        drawBlendedEntities();
+    }
+}
@@ -3,8 +3,11 @@
 #include <gdkgraphics/buildinfo.h>
 
 #include <gdk/glh.h>
+#include <gdk/webgl1es2_deletion_queue.h>
+#include <gdk/webgl1es2_render_state.h>
 #include <gdk/webgl1es2_shader_program.h>
 
+#include <array>
 #include <atomic>
 #include <iostream>
 #include <sstream>
@@ -15,9 +18,31 @@ using namespace gdk;
 
 static constexpr char TAG[] = "shader_program";
 
-//TODO: use this to throw is uniform data is being assigned to an unused shdaer program
-//TODO: is address really a good idea? probably not: a ptr could point to a dead instance & crash. a ptr could point to a different shader starting at the same address after a deletion. is handle a good idea? No crashes but again could point to new shader in reclaimed handle. Im not sure how to enforce. weak_handle may be the solution, since it safely nulls after the owner of the handle falls out of scope.
-static std::atomic<GLint> s_CurrentShaderProgramHandle(-1);
+//! source of program serials
+static std::atomic<size_t> s_ProgramSerialCounter(0);
+
+//! attribute names bound to fixed locations before link. 
+/// GLES2.0/WebGL1.0 guarantee at least 8 attribute locations
+static constexpr std::array<std::pair<const char *, GLuint>, 5> CONVENTIONAL_ATTRIBUTE_LOCATIONS(
+{{
+    {"a_Position", 0},
+    {"a_UV",       1},
+    {"a_Normal",   2},
+    {"a_Color",    3},
+    {"a_Tangent",  4},
+}});
+
+//! names of the standard uniforms, in the order of webgl1es2_shader_program::standard_uniform
+static constexpr std::array<const char *, webgl1es2_shader_program::STANDARD_UNIFORM_COUNT> STANDARD_UNIFORM_NAMES(
+{{
+    "_Model",
+    "_MVP",
+    "_View",
+    "_Projection",
+    "_ViewProjection",
+    "_CameraPosition",
+    "_Time"
+}});
 
 const jfc::shared_proxy_ptr<gdk::webgl1es2_shader_program> webgl1es2_shader_program::PinkShaderOfDeath([]()
 {
@@ -118,27 +143,6 @@ const jfc::shared_proxy_ptr<gdk::webgl1es2_shader_program> webgl1es2_shader_prog
     return new gdk::webgl1es2_shader_program(vertexShaderSource, fragmentShaderSource);
 });
 
-static inline void setUpFaceCullingMode(webgl1es2_shader_program::FaceCullingMode a)
-{
-    if (a == webgl1es2_shader_program::FaceCullingMode::None)
-    {
-        glDisable(GL_CULL_FACE);
-
-        return;
-    }
-
-    glEnable(GL_CULL_FACE);
-
-    switch(a)
-    {
-        case webgl1es2_shader_program::FaceCullingMode::Front: glCullFace(GL_FRONT); break;
-        case webgl1es2_shader_program::FaceCullingMode::Back: glCullFace(GL_BACK); break;
-        case webgl1es2_shader_program::FaceCullingMode::FrontAndBack: glCullFace(GL_FRONT_AND_BACK); break;
-
-        case webgl1es2_shader_program::FaceCullingMode::None: break;
-    }
-}
-
 webgl1es2_shader_program::webgl1es2_shader_program(std::string aVertexSource, std::string aFragmentSource)
 : m_VertexShaderHandle([&aVertexSource]()
 {
@@ -154,10 +158,8 @@ webgl1es2_shader_program::webgl1es2_shader_program(std::string aVertexSource, st
     glShaderSource(vs, 1, &vertex_shader, 0);
     glCompileShader(vs);
 
-    return decltype(m_VertexShaderHandle)(vs, [](const GLuint handle)
-    {
-        glDeleteShader(handle);
-    });
+    return decltype(m_VertexShaderHandle)(vs, webgl1es2_deletion_queue::make_deleter(
+        webgl1es2_render_state::current().getDeletionQueue(), webgl1es2_deletion_queue::object_type::shader));
 }())
 , m_FragmentShaderHandle([&aFragmentSource]()
 {
@@ -173,10 +175,8 @@ webgl1es2_shader_program::webgl1es2_shader_program(std::string aVertexSource, st
     glShaderSource(fs, 1, &fragment_shader, 0);
     glCompileShader(fs);
 
-    return decltype(m_FragmentShaderHandle)(fs, [](const GLuint handle)
-    {
-        glDeleteShader(handle);
-    });
+    return decltype(m_FragmentShaderHandle)(fs, webgl1es2_deletion_queue::make_deleter(
+        webgl1es2_render_state::current().getDeletionQueue(), webgl1es2_deletion_queue::object_type::shader));
 }())
 , m_ProgramHandle([this]()
 {
@@ -187,6 +187,10 @@ webgl1es2_shader_program::webgl1es2_shader_program(std::string aVertexSource, st
     GLuint programHandle = glCreateProgram();
     glAttachShader(programHandle, vs);
     glAttachShader(programHandle, fs);
+
+    // Fix conventional attributes to known locations, so attribute bindings can be shared among programs
+    for (const auto &[name, location] : CONVENTIONAL_ATTRIBUTE_LOCATIONS) glBindAttribLocation(programHandle, location, name);
+
     glLinkProgram(programHandle);
 
     // Confirm no compilation/link errors
@@ -206,12 +210,10 @@ webgl1es2_shader_program::webgl1es2_shader_program(std::string aVertexSource, st
         throw std::runtime_error(std::string(TAG).append(message.str()));
     }
 
-    return jfc::unique_handle<GLuint>(programHandle,
-        [](const GLuint handle)
-        {
-            glDeleteProgram(handle);
-        });
+    return jfc::unique_handle<GLuint>(programHandle, webgl1es2_deletion_queue::make_deleter(
+        webgl1es2_render_state::current().getDeletionQueue(), webgl1es2_deletion_queue::object_type::program));
 }())
+, m_Serial(++s_ProgramSerialCounter)
 {
     const auto programHandle = m_ProgramHandle.get();
 
@@ -242,12 +244,20 @@ webgl1es2_shader_program::webgl1es2_shader_program(std::string aVertexSource, st
                 &component_type,              // e.g: float
                 &attrib_name_buffer.front()); // e.g: "a_Position"
 
+            const std::string name(attrib_name_buffer.begin(), attrib_name_buffer.begin() + currentNameLength);
+
             webgl1es2_shader_program::active_attribute_info info;
-            info.location = i;
+            info.location = glGetAttribLocation(programHandle, name.c_str()); // active index is not the location
             info.type = component_type;
             info.count = component_count;
 
-            m_ActiveAttributes[std::string(attrib_name_buffer.begin(), attrib_name_buffer.begin() + currentNameLength)] = std::move(info);
+            if (const auto conventionalLocation = tryGetConventionalAttributeLocation(name); 
+                !conventionalLocation || static_cast<GLint>(*conventionalLocation) != info.location)
+            {
+                m_HasConventionalAttributeLocations = false;
+            }
+
+            m_ActiveAttributes[name] = std::move(info);
         }
     }
 
@@ -273,37 +283,31 @@ webgl1es2_shader_program::webgl1es2_shader_program(std::string aVertexSource, st
                 &attribute_type,               // e.g: "texture"
                 &uniform_name_buffer.front()); // e.g: "u_Diffuse" 
 
+            const std::string name(uniform_name_buffer.begin(), uniform_name_buffer.begin() + currentNameLength);
+
             webgl1es2_shader_program::active_uniform_info info;
-            info.location = i;
+            info.location = glGetUniformLocation(programHandle, name.c_str()); // active index is not the location
             info.type = attribute_type;
             info.size = attribute_size;
 
-            m_ActiveUniforms[std::string(uniform_name_buffer.begin(), uniform_name_buffer.begin() + currentNameLength)] = std::move(info);
+            m_ActiveUniforms[name] = std::move(info);
         }
     }
-}
 
-//! map of active textures. Allows to overwrite textures with the same names to the same units, since units are very limited.
-// TODO: i think this can be local to tranlsation unit
-static std::unordered_map<std::string, GLint> s_ActiveTextureUniformNameToUnit;
+    for (size_t i(0); i < STANDARD_UNIFORM_COUNT; ++i)
+    {
+        const auto activeUniform = tryGetActiveUniform(STANDARD_UNIFORM_NAMES[i]);
 
-static short s_ActiveTextureUnitCounter(0);
+        m_StandardUniformLocations[i] = activeUniform ? activeUniform->location : -1;
+    }
+}
 
 GLuint webgl1es2_shader_program::useProgram() const
 {
     const auto handle = m_ProgramHandle.get();
 
-    if (s_CurrentShaderProgramHandle != handle)
-    {
-        s_CurrentShaderProgramHandle = handle;
-
-        s_ActiveTextureUniformNameToUnit.clear();
-        s_ActiveTextureUnitCounter = 0;
-
-        setUpFaceCullingMode(m_FaceCullingMode);
-
-        glUseProgram(handle);
-    }
+    //TODO: is handle a good idea? a new program can reuse the handle of a deleted one, which would skip its glUseProgram
+    if (webgl1es2_render_state::current().setCurrentProgram(handle)) glUseProgram(handle);
 
     return handle;
 }
@@ -585,22 +589,12 @@ void webgl1es2_shader_program::setUniform(const std::string &aName, const gdk::w
 
     if (activeUniformSearch != m_ActiveUniforms.end())
     {   
-        const auto &activeTextureSearch = s_ActiveTextureUniformNameToUnit.find(aName);
-        
-        GLint unit;
-
-        if (activeTextureSearch == s_ActiveTextureUniformNameToUnit.end())
-        {
-            unit = s_ActiveTextureUnitCounter++;
+        // textures with the same names are assigned the same units, since units are very limited
+        auto &renderState = webgl1es2_render_state::current();
 
-            s_ActiveTextureUniformNameToUnit[aName] = unit;
-        }
-        else
-        {
-            unit = activeTextureSearch->second;
-        }
+        const GLint unit = renderState.getTextureUnit(aName);
 
-        if (s_ActiveTextureUnitCounter < webgl1es2_shader_program::MAX_TEXTURE_UNITS) 
+        if (renderState.getTextureUnitCount() < static_cast<GLint>(webgl1es2_shader_program::MAX_TEXTURE_UNITS)) 
         {
             //TODO: parameterize! Improve texture as well to support non2ds. 
             // The type (2d or cube) should be a property of the texture abstraction.
@@ -612,7 +606,7 @@ void webgl1es2_shader_program::setUniform(const std::string &aName, const gdk::w
 
             glUniform1i(activeUniformSearch->second.location, unit);
         }
-        else throw std::invalid_argument(std::string("GLES2.0/WebGL1.0 only provide 8 texture units; you are trying to bind too many simultaneous textures to the context: ") + std::to_string(s_ActiveTextureUnitCounter));
+        else throw std::invalid_argument(std::string("GLES2.0/WebGL1.0 only provide 8 texture units; you are trying to bind too many simultaneous textures to the context: ") + std::to_string(renderState.getTextureUnitCount()));
     }
 }
 
@@ -623,3 +617,42 @@ std::optional<webgl1es2_shader_program::active_attribute_info> webgl1es2_shader_
     return {};
 }
 
+std::optional<webgl1es2_shader_program::active_uniform_info> webgl1es2_shader_program::tryGetActiveUniform(const std::string &aUniformName) const
+{
+    if (auto found = m_ActiveUniforms.find(aUniformName); found != m_ActiveUniforms.end()) return found->second;
+
+    return {};
+}
+
+std::optional<GLuint> webgl1es2_shader_program::tryGetConventionalAttributeLocation(const std::string &aAttributeName)
+{
+    for (const auto &[name, location] : CONVENTIONAL_ATTRIBUTE_LOCATIONS) if (aAttributeName == name) return location;
+
+    return {};
+}
+
+bool webgl1es2_shader_program::hasConventionalAttributeLocations() const
+{
+    return m_HasConventionalAttributeLocations;
+}
+
+size_t webgl1es2_shader_program::getSerial() const
+{
+    return m_Serial;
+}
+
+GLint webgl1es2_shader_program::getStandardUniformLocation(const standard_uniform aUniform) const
+{
+    return m_StandardUniformLocations[static_cast<size_t>(aUniform)];
+}
+
+bool webgl1es2_shader_program::updateStandardUniformVersion(const standard_uniform aUniform, const size_t aVersion) const
+{
+    const auto i = static_cast<size_t>(aUniform);
+
+    if (m_StandardUniformLocations[i] == -1 || m_StandardUniformVersions[i] == aVersion) return false;
+
+    m_StandardUniformVersions[i] = aVersion;
+
+    return true;
+}
@@ -0,0 +1,87 @@
+// © 2019 Joseph Cameron - All Rights Reserved
+
+#include <gdk/mat4x4.h>
+#include <gdk/vector3.h>
+
+#include <gdk/webgl1es2_shader_program.h>
+#include <gdk/webgl1es2_shared_uniforms.h>
+
+#include <atomic>
+#include <cstring>
+
+using namespace gdk;
+
+//! source of value versions. shared by all instances, so two instances never produce the same version
+static std::atomic<size_t> s_VersionCounter(0);
+
+static bool matrices_equal(const graphics_mat4x4_type &a, const graphics_mat4x4_type &b)
+{
+    return !std::memcmp(&a.m[0][0], &b.m[0][0], sizeof(a.m));
+}
+
+webgl1es2_shared_uniforms::webgl1es2_shared_uniforms()
+: m_View({graphics_mat4x4_type::Identity, ++s_VersionCounter})
+, m_Projection({graphics_mat4x4_type::Identity, ++s_VersionCounter})
+, m_ViewProjection({graphics_mat4x4_type::Identity, ++s_VersionCounter})
+, m_CameraPosition({graphics_vector3_type::Zero, ++s_VersionCounter})
+, m_Time({0, ++s_VersionCounter})
+{}
+
+void webgl1es2_shared_uniforms::setCamera(const graphics_mat4x4_type &aViewMatrix, 
+    const graphics_mat4x4_type &aProjectionMatrix, 
+    const graphics_vector3_type &aCameraPosition)
+{
+    const bool viewChanged = !matrices_equal(m_View.value, aViewMatrix);
+    const bool projectionChanged = !matrices_equal(m_Projection.value, aProjectionMatrix);
+
+    if (viewChanged) m_View = {aViewMatrix, ++s_VersionCounter};
+
+    if (projectionChanged) m_Projection = {aProjectionMatrix, ++s_VersionCounter};
+
+    if (viewChanged || projectionChanged) m_ViewProjection = {aProjectionMatrix * aViewMatrix, ++s_VersionCounter};
+
+    if (m_CameraPosition.value.x != aCameraPosition.x || 
+        m_CameraPosition.value.y != aCameraPosition.y || 
+        m_CameraPosition.value.z != aCameraPosition.z) 
+    {
+        m_CameraPosition = {aCameraPosition, ++s_VersionCounter};
+    }
+}
+
+void webgl1es2_shared_uniforms::setTime(const GLfloat aTime)
+{
+    if (m_Time.value != aTime) m_Time = {aTime, ++s_VersionCounter};
+}
+
+const graphics_mat4x4_type &webgl1es2_shared_uniforms::getViewProjectionMatrix() const
+{
+    return m_ViewProjection.value;
+}
+
+void webgl1es2_shared_uniforms::upload(const webgl1es2_shader_program &aShaderProgram) const
+{
+    using standard_uniform = webgl1es2_shader_program::standard_uniform;
+
+    const auto uploadMatrix = [&aShaderProgram](const standard_uniform aUniform, const versioned<graphics_mat4x4_type> &aMatrix)
+    {
+        if (aShaderProgram.updateStandardUniformVersion(aUniform, aMatrix.version))
+        {
+            glUniformMatrix4fv(aShaderProgram.getStandardUniformLocation(aUniform), 1, GL_FALSE, &aMatrix.value.m[0][0]);
+        }
+    };
+
+    uploadMatrix(standard_uniform::view, m_View);
+    uploadMatrix(standard_uniform::projection, m_Projection);
+    uploadMatrix(standard_uniform::view_projection, m_ViewProjection);
+
+    if (aShaderProgram.updateStandardUniformVersion(standard_uniform::camera_position, m_CameraPosition.version))
+    {
+        glUniform3f(aShaderProgram.getStandardUniformLocation(standard_uniform::camera_position), 
+            m_CameraPosition.value.x, m_CameraPosition.value.y, m_CameraPosition.value.z);
+    }
+
+    if (aShaderProgram.updateStandardUniformVersion(standard_uniform::time, m_Time.version))
+    {
+        glUniform1f(aShaderProgram.getStandardUniformLocation(standard_uniform::time), m_Time.value);
+    }
+}
@@ -0,0 +1,161 @@
+// © 2019 Joseph Cameron - All Rights Reserved
+
+#include <gdk/webgl1es2_deletion_queue.h>
+#include <gdk/webgl1es2_render_state.h>
+#include <gdk/webgl1es2_stream_buffer.h>
+
+#include <limits>
+#include <stdexcept>
+#include <string>
+
+using namespace gdk;
+
+static constexpr char TAG[] = "webgl1es2_stream_buffer";
+
+static GLenum primitive_mode_to_gl(const webgl1es2_model::PrimitiveMode aPrimitiveMode)
+{
+    switch (aPrimitiveMode)
+    {
+        case webgl1es2_model::PrimitiveMode::Points: return GL_POINTS;
+        case webgl1es2_model::PrimitiveMode::Lines: return GL_LINES;
+        case webgl1es2_model::PrimitiveMode::LineStrip: return GL_LINE_STRIP;
+        case webgl1es2_model::PrimitiveMode::LineLoop: return GL_LINE_LOOP;
+        case webgl1es2_model::PrimitiveMode::Triangles: return GL_TRIANGLES;
+        case webgl1es2_model::PrimitiveMode::TriangleStrip: return GL_TRIANGLE_STRIP;
+        case webgl1es2_model::PrimitiveMode::TriangleFan: return GL_TRIANGLE_FAN;
+    }
+
+    throw std::invalid_argument(std::string(TAG).append(": unhandled primitive mode"));
+}
+
+//! creates a stream buffer of a fixed size. a size of 0 gives a null handle
+static jfc::unique_handle<GLuint> make_stream_buffer(const GLenum aTarget, const size_t aSize)
+{
+    GLuint handle(0);
+
+    if (aSize)
+    {
+        glGenBuffers(1, &handle);
+        glBindBuffer(aTarget, handle);
+        glBufferData(aTarget, aSize, nullptr, GL_STREAM_DRAW);
+        glBindBuffer(aTarget, 0);
+    }
+
+    return jfc::unique_handle<GLuint>(handle, webgl1es2_deletion_queue::make_deleter(
+        webgl1es2_render_state::current().getDeletionQueue(), webgl1es2_deletion_queue::object_type::buffer));
+}
+
+webgl1es2_stream_buffer::webgl1es2_stream_buffer(const size_t aVertexCapacity, const size_t aIndexCapacity, const size_t aBufferCount)
+: m_VertexStaging(aVertexCapacity)
+, m_IndexStaging(aIndexCapacity)
+{
+    if (!aVertexCapacity) throw std::invalid_argument(std::string(TAG).append(": vertex capacity must be greater than 0"));
+    if (!aBufferCount) throw std::invalid_argument(std::string(TAG).append(": buffer count must be greater than 0"));
+
+    m_Buffers.reserve(aBufferCount);
+
+    for (size_t i(0); i < aBufferCount; ++i) m_Buffers.push_back({
+        make_stream_buffer(GL_ARRAY_BUFFER, sizeof(attribute_component_data_type) * aVertexCapacity),
+        make_stream_buffer(GL_ELEMENT_ARRAY_BUFFER, sizeof(index_data_type) * aIndexCapacity)});
+}
+
+std::optional<webgl1es2_stream_buffer::allocation> webgl1es2_stream_buffer::tryAllocate(const webgl1es2_vertex_format &aVertexFormat,
+    const size_t aVertexCount,
+    const size_t aIndexCount)
+{
+    if (!aVertexCount) throw std::invalid_argument(std::string(TAG).append(": no vertexes to allocate"));
+
+    // indexes are relative to the allocation, so only the allocation's own vertex count is limited
+    if (aIndexCount && aVertexCount - 1 > std::numeric_limits<index_data_type>::max())
+        throw std::invalid_argument(std::string(TAG).append(": too many vertexes to index"));
+
+    const auto stride = static_cast<size_t>(aVertexFormat.getSumOfAttributeComponents());
+    const auto componentCount = stride * aVertexCount;
+
+    if (componentCount > m_VertexStaging.size() - m_VertexCursor || aIndexCount > m_IndexStaging.size() - m_IndexCursor) return {};
+
+    allocation result{
+        m_VertexStaging.data() + m_VertexCursor,
+        aIndexCount ? m_IndexStaging.data() + m_IndexCursor : nullptr,
+        aVertexCount,
+        aIndexCount,
+        m_VertexCursor,
+        m_IndexCursor,
+        stride,
+        m_FrameCount};
+
+    m_VertexCursor += componentCount;
+    m_IndexCursor += aIndexCount;
+
+    return result;
+}
+
+void webgl1es2_stream_buffer::flush()
+{
+    const auto &buffers = m_Buffers[m_FrameCount % m_Buffers.size()];
+
+    if (m_VertexCursor)
+    {
+        glBindBuffer(GL_ARRAY_BUFFER, buffers.vertexBuffer.get());
+        glBufferSubData(GL_ARRAY_BUFFER, 0, sizeof(attribute_component_data_type) * m_VertexCursor, m_VertexStaging.data());
+        glBindBuffer(GL_ARRAY_BUFFER, 0);
+    }
+
+    if (m_IndexCursor)
+    {
+        glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, buffers.indexBuffer.get());
+        glBufferSubData(GL_ELEMENT_ARRAY_BUFFER, 0, sizeof(index_data_type) * m_IndexCursor, m_IndexStaging.data());
+        glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, 0);
+    }
+
+    m_VertexCursor = 0;
+    m_IndexCursor = 0;
+
+    ++m_FrameCount;
+}
+
+void webgl1es2_stream_buffer::draw(const allocation &aAllocation,
+    const webgl1es2_vertex_format &aVertexFormat,
+    const webgl1es2_shader_program &aShaderProgram,
+    const webgl1es2_model::PrimitiveMode aPrimitiveMode) const
+{
+    if (aAllocation.frame + 1 != m_FrameCount) throw std::runtime_error(std::string(TAG).append(
+        ": allocations can only be drawn between the flush that uploads them and the next flush"));
+
+    if (static_cast<size_t>(aVertexFormat.getSumOfAttributeComponents()) != aAllocation.vertexStride)
+        throw std::invalid_argument(std::string(TAG).append(": vertex format does not match the allocation"));
+
+    const auto &buffers = m_Buffers[aAllocation.frame % m_Buffers.size()];
+
+    const auto primitiveMode = primitive_mode_to_gl(aPrimitiveMode);
+
+    glBindBuffer(GL_ARRAY_BUFFER, buffers.vertexBuffer.get());
+
+    aVertexFormat.enableAttributes(aShaderProgram, aAllocation.vertexOffset);
+
+    if (aAllocation.indexCount)
+    {
+        glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, buffers.indexBuffer.get());
+
+        glDrawElements(primitiveMode,
+            static_cast<GLsizei>(aAllocation.indexCount),
+            GL_UNSIGNED_SHORT,
+            reinterpret_cast<void *>(sizeof(index_data_type) * aAllocation.indexOffset));
+    }
+    else glDrawArrays(primitiveMode, 0, static_cast<GLsizei>(aAllocation.vertexCount));
+}
+
+size_t webgl1es2_stream_buffer::getVertexCapacity() const
+{
+    return m_VertexStaging.size();
+}
+
+size_t webgl1es2_stream_buffer::getIndexCapacity() const
+{
+    return m_IndexStaging.size();
+}
+
+size_t webgl1es2_stream_buffer::getBufferCount() const
+{
+    return m_Buffers.size();
+}
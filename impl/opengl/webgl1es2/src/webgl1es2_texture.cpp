@@ -1,6 +1,8 @@
 // © 2018 Joseph Cameron - All Rights Reserved
 
 #include <gdk/glh.h>
+#include <gdk/webgl1es2_deletion_queue.h>
+#include <gdk/webgl1es2_render_state.h>
 #include <gdk/webgl1es2_texture.h>
 
 #include <stb/stb_image.h>
@@ -8,6 +10,7 @@
 #include <cmath>
 #include <iostream>
 #include <mutex>
+#include <optional>
 #include <stdexcept>
 #include <stdexcept>
 #include <type_traits>
@@ -172,12 +175,13 @@ webgl1es2_texture webgl1es2_texture::make_from_png_rgba32(const std::vector<GLub
     throw std::runtime_error(std::string(TAG).append(": could not decode RGBA32 data provided to webgl1es2_texture"));
 }
 
-webgl1es2_texture::webgl1es2_texture(const webgl1es2_texture_2d_data_view_type &textureData2d,
-    const minification_filter minFilter,
-    const magnification_filter magFilter,
-    const wrap_mode wrapMode)
-: m_BindTarget(bind_target_to_glenum(bind_target::texture_2d))    
-, m_Handle([&]()
+//! creates a 2d texture object and copies image data into it. 
+/// the texture is released to pDeletionQueue, or deleted immediately if it is null
+static jfc::unique_handle<GLuint> make_texture_2d(const webgl1es2_texture::webgl1es2_texture_2d_data_view_type &textureData2d,
+    const webgl1es2_texture::minification_filter minFilter,
+    const webgl1es2_texture::magnification_filter magFilter,
+    const webgl1es2_texture::wrap_mode wrapMode,
+    std::shared_ptr<webgl1es2_deletion_queue> pDeletionQueue)
 {
     // TODO Should reenable this
     /*if (!isPowerOfTwo(textureData2d.width) || !isPowerOfTwo(textureData2d.height)) 
@@ -192,9 +196,9 @@ webgl1es2_texture::webgl1es2_texture(const webgl1es2_texture_2d_data_view_type &
 
     glActiveTexture(GL_TEXTURE0);
 
-    glBindTexture(m_BindTarget, handle);
+    glBindTexture(GL_TEXTURE_2D, handle);
 
-    glTexImage2D(m_BindTarget, 
+    glTexImage2D(GL_TEXTURE_2D, 
         0, 
         textureFormatToGLint(textureData2d.format), 
         textureData2d.width, 
@@ -212,16 +216,110 @@ webgl1es2_texture::webgl1es2_texture(const webgl1es2_texture_2d_data_view_type &
     glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, wrap_mode_to_glint(wrapMode));
     glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, wrap_mode_to_glint(wrapMode));
 
-    return handle;
-}(),
-[](const GLuint handle)
+    return jfc::unique_handle<GLuint>(handle, 
+        webgl1es2_deletion_queue::make_deleter(std::move(pDeletionQueue), webgl1es2_deletion_queue::object_type::texture));
+}
+
+//! number of bytes per texel of image data in a format
+static size_t bytes_per_texel(const webgl1es2_texture::format a)
+{
+    switch(a)
+    {
+        case webgl1es2_texture::format::rgba: return 4;
+        case webgl1es2_texture::format::rgb: return 3;
+        case webgl1es2_texture::format::luminance_alpha: return 2;
+        case webgl1es2_texture::format::luminance: return 1;
+        case webgl1es2_texture::format::a: return 1;
+    }
+
+    throw std::runtime_error("unhandled format type");
+}
+
+//! image data waiting to be uploaded, and the texture it is uploaded to
+class webgl1es2_texture::staged_upload final : public webgl1es2_upload_queue::pending_upload
 {
-    glDeleteTextures(1, &handle);
-})
+public:
+    //! copy of the image data. released after upload
+    std::vector<std::byte> data;
+
+    //! view of data
+    webgl1es2_texture_2d_data_view_type view;
+
+    minification_filter minFilter; //!< min filter
+    magnification_filter magFilter; //!< mag filter
+    wrap_mode wrapMode; //!< wrap mode
+
+    //! the texture, once uploaded
+    std::optional<jfc::unique_handle<GLuint>> handle;
+
+    //! size of the image data. recorded at construction, since the data is released by upload
+    size_t size;
+
+    //! deletion queue of the context the texture was made by. upload may run on a thread with a different current render state
+    std::shared_ptr<webgl1es2_deletion_queue> pDeletionQueue;
+
+    virtual size_t getSize() const override
+    {
+        return size;
+    }
+
+    virtual void upload() override
+    {
+        handle = make_texture_2d(view, minFilter, magFilter, wrapMode, pDeletionQueue);
+
+        data = {};
+    }
+
+    staged_upload(const webgl1es2_texture_2d_data_view_type &aView, 
+        const minification_filter aMinFilter,
+        const magnification_filter aMagFilter,
+        const wrap_mode aWrapMode)
+    : data(aView.data, aView.data + aView.width * aView.height * bytes_per_texel(aView.format))
+    , view(aView)
+    , minFilter(aMinFilter)
+    , magFilter(aMagFilter)
+    , wrapMode(aWrapMode)
+    , size(data.size())
+    , pDeletionQueue(webgl1es2_render_state::current().getDeletionQueue())
+    {
+        view.data = data.data();
+    }
+};
+
+webgl1es2_texture::webgl1es2_texture(const webgl1es2_texture_2d_data_view_type &textureData2d,
+    const minification_filter minFilter,
+    const magnification_filter magFilter,
+    const wrap_mode wrapMode)
+: m_BindTarget(bind_target_to_glenum(bind_target::texture_2d))    
+, m_Handle(make_texture_2d(textureData2d, minFilter, magFilter, wrapMode, webgl1es2_render_state::current().getDeletionQueue()))
 {}
 
+webgl1es2_texture::webgl1es2_texture(webgl1es2_upload_queue &aUploadQueue,
+    const webgl1es2_texture_2d_data_view_type &textureData2d,
+    const minification_filter minFilter,
+    const magnification_filter magFilter,
+    const wrap_mode wrapMode)
+: m_BindTarget(bind_target_to_glenum(bind_target::texture_2d))    
+, m_Handle(0, [](const GLuint) {})
+, m_pStagedUpload(std::make_shared<staged_upload>(textureData2d, minFilter, magFilter, wrapMode))
+{
+    aUploadQueue.push(m_pStagedUpload);
+}
+
+bool webgl1es2_texture::isResident() const
+{
+    return !m_pStagedUpload || m_pStagedUpload->isResident();
+}
+
 GLuint webgl1es2_texture::getHandle() const
 {
+    if (m_pStagedUpload && m_pStagedUpload->isResident())
+    {
+        m_Handle = std::move(*m_pStagedUpload->handle);
+
+        m_pStagedUpload.reset();
+    }
+
     return m_Handle.get();
 }
 
@@ -0,0 +1,122 @@
+// © 2019 Joseph Cameron - All Rights Reserved
+
+#include <gdk/webgl1es2_transform_slots.h>
+
+#include <stdexcept>
+#include <string>
+
+using namespace gdk;
+
+static constexpr char TAG[] = "webgl1es2_transform_slots";
+
+//! number of slots covered by a dirty word
+static constexpr size_t BITS_PER_WORD(64);
+
+//! sets a slot's components to the identity
+static void set_identity(std::array<std::atomic<float>, 16> &aComponents)
+{
+    for (size_t i(0); i < aComponents.size(); ++i) aComponents[i].store((i % 5) ? 0.f : 1.f, std::memory_order_relaxed);
+}
+
+webgl1es2_transform_slots::webgl1es2_transform_slots(const size_t aSize)
+{
+    resize(aSize);
+}
+
+size_t webgl1es2_transform_slots::getDirtyWordCount() const
+{
+    return (m_Size + BITS_PER_WORD - 1) / BITS_PER_WORD;
+}
+
+void webgl1es2_transform_slots::write(const size_t aSlot, const graphics_mat4x4_type &aTransform)
+{
+    if (aSlot >= m_Size) throw std::out_of_range(std::string(TAG).append(": slot out of range"));
+
+    auto &slot = m_Slots[aSlot];
+
+    // odd while writing. the fence keeps the component stores from being seen before it
+    const auto sequence = slot.sequence.load(std::memory_order_relaxed);
+
+    slot.sequence.store(sequence + 1, std::memory_order_relaxed);
+
+    std::atomic_thread_fence(std::memory_order_release);
+
+    for (size_t column(0); column < 4; ++column) for (size_t row(0); row < 4; ++row)
+        slot.components[(column * 4) + row].store(aTransform.m[column][row], std::memory_order_relaxed);
+
+    slot.sequence.store(sequence + 2, std::memory_order_release);
+
+    m_DirtyBits[aSlot / BITS_PER_WORD].fetch_or(std::uint64_t(1) << (aSlot % BITS_PER_WORD), std::memory_order_release);
+}
+
+bool webgl1es2_transform_slots::read(const size_t aSlot, graphics_mat4x4_type &aTransform) const
+{
+    if (aSlot >= m_Size) throw std::out_of_range(std::string(TAG).append(": slot out of range"));
+
+    const auto &slot = m_Slots[aSlot];
+
+    const auto sequence = slot.sequence.load(std::memory_order_acquire);
+
+    if (sequence & 1) return false;
+
+    for (size_t column(0); column < 4; ++column) for (size_t row(0); row < 4; ++row)
+        aTransform.m[column][row] = slot.components[(column * 4) + row].load(std::memory_order_relaxed);
+
+    std::atomic_thread_fence(std::memory_order_acquire);
+
+    return slot.sequence.load(std::memory_order_relaxed) == sequence;
+}
+
+void webgl1es2_transform_slots::discard(const size_t aSlot)
+{
+    if (aSlot >= m_Size) throw std::out_of_range(std::string(TAG).append(": slot out of range"));
+
+    m_DirtyBits[aSlot / BITS_PER_WORD].fetch_and(~(std::uint64_t(1) << (aSlot % BITS_PER_WORD)), std::memory_order_relaxed);
+}
+
+bool webgl1es2_transform_slots::isDirty(const size_t aSlot) const
+{
+    if (aSlot >= m_Size) throw std::out_of_range(std::string(TAG).append(": slot out of range"));
+
+    return m_DirtyBits[aSlot / BITS_PER_WORD].load(std::memory_order_acquire) & (std::uint64_t(1) << (aSlot % BITS_PER_WORD));
+}
+
+size_t webgl1es2_transform_slots::size() const
+{
+    return m_Size;
+}
+
+void webgl1es2_transform_slots::resize(const size_t aSize)
+{
+    if (aSize == m_Size) return;
+
+    auto pSlots = std::make_unique<slot[]>(aSize);
+
+    for (size_t i(0); i < aSize; ++i)
+    {
+        if (i < m_Size) for (size_t j(0); j < 16; ++j)
+            pSlots[i].components[j].store(m_Slots[i].components[j].load(std::memory_order_relaxed), std::memory_order_relaxed);
+        else set_identity(pSlots[i].components);
+    }
+
+    const auto oldWordCount = getDirtyWordCount();
+
+    m_Size = aSize;
+
+    const auto wordCount = getDirtyWordCount();
+
+    auto pDirtyBits = std::make_unique<std::atomic<std::uint64_t>[]>(wordCount);
+
+    for (size_t i(0); i < wordCount; ++i)
+    {
+        auto bits = i < oldWordCount ? m_DirtyBits[i].load(std::memory_order_relaxed) : 0;
+
+        // drop the bits of removed slots
+        if (i == wordCount - 1 && aSize % BITS_PER_WORD) bits &= (std::uint64_t(1) << (aSize % BITS_PER_WORD)) - 1;
+
+        pDirtyBits[i].store(bits, std::memory_order_relaxed);
+    }
+
+    m_Slots = std::move(pSlots);
+    m_DirtyBits = std::move(pDirtyBits);
+}
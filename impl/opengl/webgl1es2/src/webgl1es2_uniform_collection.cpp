@@ -0,0 +1,339 @@
+// © 2019 Joseph Cameron - All Rights Reserved
+
+#include <gdk/webgl1es2_render_state.h>
+#include <gdk/webgl1es2_shader_program.h>
+#include <gdk/webgl1es2_uniform_collection.h>
+
+#include <cstring>
+#include <stdexcept>
+
+using namespace gdk;
+
+static constexpr char TAG[] = "uniform_collection";
+
+//! size in bytes of a non-texture value in the blob
+static size_t value_size(const webgl1es2_uniform_collection::uniform_type aType)
+{
+    using uniform_type = webgl1es2_uniform_collection::uniform_type;
+
+    switch (aType)
+    {
+        case uniform_type::float1: return sizeof(GLfloat);
+        case uniform_type::float2: return sizeof(GLfloat) * 2;
+        case uniform_type::float3: return sizeof(GLfloat) * 3;
+        case uniform_type::float4: return sizeof(GLfloat) * 4;
+        case uniform_type::mat4x4: return sizeof(GLfloat) * 16;
+        case uniform_type::integer1: return sizeof(GLint);
+        case uniform_type::texture: return 0;
+    }
+
+    return 0;
+}
+
+void webgl1es2_uniform_collection::setValue(const std::string &aName, const uniform_type aType, const void *pValue, const size_t aSize)
+{
+    for (const auto &current : m_Declarations) if (current.name == aName)
+    {
+        if (current.type != aType) throw std::invalid_argument(std::string(TAG).append(": uniform \"")
+            .append(aName).append("\" has already been assigned a value of a different type"));
+
+        std::memcpy(&m_Values[current.offset], pValue, aSize);
+
+        return;
+    }
+
+    const auto offset = m_Values.size();
+
+    m_Values.resize(offset + aSize);
+
+    std::memcpy(&m_Values[offset], pValue, aSize);
+
+    m_Declarations.push_back({aName, aType, offset});
+
+    ++m_LayoutVersion;
+}
+
+void webgl1es2_uniform_collection::set(const std::string &aName, const GLfloat aValue)
+{
+    setValue(aName, uniform_type::float1, &aValue, sizeof(GLfloat));
+}
+
+void webgl1es2_uniform_collection::set(const std::string &aName, const graphics_vector2_type &aValue)
+{
+    const GLfloat data[] = {aValue.x, aValue.y};
+
+    setValue(aName, uniform_type::float2, data, sizeof(data));
+}
+
+void webgl1es2_uniform_collection::set(const std::string &aName, const graphics_vector3_type &aValue)
+{
+    const GLfloat data[] = {aValue.x, aValue.y, aValue.z};
+
+    setValue(aName, uniform_type::float3, data, sizeof(data));
+}
+
+void webgl1es2_uniform_collection::set(const std::string &aName, const graphics_vector4_type &aValue)
+{
+    const GLfloat data[] = {aValue.x, aValue.y, aValue.z, aValue.w};
+
+    setValue(aName, uniform_type::float4, data, sizeof(data));
+}
+
+void webgl1es2_uniform_collection::set(const std::string &aName, const graphics_mat4x4_type &aValue)
+{
+    setValue(aName, uniform_type::mat4x4, &aValue.m[0][0], sizeof(aValue.m));
+}
+
+void webgl1es2_uniform_collection::set(const std::string &aName, const GLint aValue)
+{
+    setValue(aName, uniform_type::integer1, &aValue, sizeof(GLint));
+}
+
+void webgl1es2_uniform_collection::set(const std::string &aName, texture_ptr_type aValue)
+{
+    for (const auto &current : m_Declarations) if (current.name == aName)
+    {
+        if (current.type != uniform_type::texture) throw std::invalid_argument(std::string(TAG).append(": uniform \"")
+            .append(aName).append("\" has already been assigned a value of a different type"));
+
+        m_Textures[current.offset] = aValue;
+
+        return;
+    }
+
+    m_Declarations.push_back({aName, uniform_type::texture, m_Textures.size()});
+
+    m_Textures.push_back(aValue);
+
+    m_TextureNames.push_back(aName);
+
+    ++m_LayoutVersion;
+}
+
+bool webgl1es2_uniform_collection::contains(const std::string &aName) const
+{
+    for (const auto &current : m_Declarations) if (current.name == aName) return true;
+
+    return false;
+}
+
+bool webgl1es2_uniform_collection::empty() const
+{
+    return m_Declarations.empty();
+}
+
+size_t webgl1es2_uniform_collection::getLayoutVersion() const
+{
+    return m_LayoutVersion;
+}
+
+bool webgl1es2_uniform_collection::isCompiled(const compiled_uniform_table &aTable, const webgl1es2_shader_program &aShaderProgram) const
+{
+    return aTable.layoutVersion == m_LayoutVersion && aTable.programSerial == aShaderProgram.getSerial();
+}
+
+webgl1es2_uniform_collection::compiled_uniform_table webgl1es2_uniform_collection::compile(const webgl1es2_shader_program &aShaderProgram) const
+{
+    compiled_uniform_table table;
+    table.programSerial = aShaderProgram.getSerial();
+    table.layoutVersion = m_LayoutVersion;
+
+    for (const auto &current : m_Declarations)
+    {
+        if (const auto activeUniform = aShaderProgram.tryGetActiveUniform(current.name))
+        {
+            table.uniforms.push_back({activeUniform->location, current.type, current.offset});
+        }
+    }
+
+    return table;
+}
+
+void webgl1es2_uniform_collection::upload(const compiled_uniform &aUniform) const
+{
+    const auto pFloats = reinterpret_cast<const GLfloat *>(m_Values.data() + aUniform.offset);
+
+    switch (aUniform.type)
+    {
+        case uniform_type::float1: glUniform1fv(aUniform.location, 1, pFloats); break;
+        case uniform_type::float2: glUniform2fv(aUniform.location, 1, pFloats); break;
+        case uniform_type::float3: glUniform3fv(aUniform.location, 1, pFloats); break;
+        case uniform_type::float4: glUniform4fv(aUniform.location, 1, pFloats); break;
+        case uniform_type::mat4x4: glUniformMatrix4fv(aUniform.location, 1, GL_FALSE, pFloats); break;
+
+        case uniform_type::integer1:
+        {
+            glUniform1iv(aUniform.location, 1, reinterpret_cast<const GLint *>(m_Values.data() + aUniform.offset));
+        } break;
+
+        case uniform_type::texture:
+        {
+            // textures with the same names are assigned the same units, so materials and overrides sharing a program share units
+            const GLint unit = webgl1es2_render_state::current().getTextureUnit(m_TextureNames[aUniform.offset]);
+
+            if (unit >= static_cast<GLint>(webgl1es2_shader_program::MAX_TEXTURE_UNITS))
+                throw std::invalid_argument(std::string("GLES2.0/WebGL1.0 only provide 8 texture units; you are trying to bind too many simultaneous textures to the context: ")
+                    + std::to_string(unit));
+
+            glActiveTexture(GL_TEXTURE0 + unit);
+
+            glBindTexture(GL_TEXTURE_2D, m_Textures[aUniform.offset]->getHandle());
+
+            glUniform1i(aUniform.location, unit);
+        } break;
+    }
+}
+
+GLint webgl1es2_uniform_collection::upload(const compiled_uniform_table &aTable) const
+{
+    GLint textureCount(0);
+
+    for (const auto &current : aTable.uniforms)
+    {
+        upload(current);
+
+        if (current.type == uniform_type::texture) ++textureCount;
+    }
+
+    return textureCount;
+}
+
+bool webgl1es2_uniform_collection::valueEquals(const compiled_uniform &aUniform, 
+    const webgl1es2_uniform_collection &aOther, 
+    const compiled_uniform &aOtherUniform) const
+{
+    if (aUniform.type != aOtherUniform.type) return false;
+
+    if (aUniform.type == uniform_type::texture) return m_Textures[aUniform.offset] == aOther.m_Textures[aOtherUniform.offset];
+
+    return !std::memcmp(&m_Values[aUniform.offset], &aOther.m_Values[aOtherUniform.offset], value_size(aUniform.type));
+}
+
+bool webgl1es2_uniform_collection::isCompiled(const compiled_override_table &aTable, 
+    const webgl1es2_shader_program &aShaderProgram, 
+    const webgl1es2_uniform_collection &aDefaults) const
+{
+    return aTable.layoutVersion == m_LayoutVersion && 
+        aTable.defaultsLayoutVersion == aDefaults.m_LayoutVersion &&
+        aTable.programSerial == aShaderProgram.getSerial();
+}
+
+webgl1es2_uniform_collection::compiled_override_table webgl1es2_uniform_collection::compileOverrides(
+    const webgl1es2_shader_program &aShaderProgram, 
+    const webgl1es2_uniform_collection &aDefaults) const
+{
+    compiled_override_table table;
+    table.programSerial = aShaderProgram.getSerial();
+    table.layoutVersion = m_LayoutVersion;
+    table.defaultsLayoutVersion = aDefaults.m_LayoutVersion;
+
+    const auto defaults = aDefaults.compile(aShaderProgram);
+
+    for (const auto &current : m_Declarations)
+    {
+        const auto activeUniform = aShaderProgram.tryGetActiveUniform(current.name);
+
+        if (!activeUniform) continue;
+
+        compiled_override compiled;
+        compiled.value = {activeUniform->location, current.type, current.offset};
+
+        for (const auto &currentDefault : defaults.uniforms)
+        {
+            if (currentDefault.location == activeUniform->location)
+            {
+                if (currentDefault.type != current.type) throw std::invalid_argument(std::string(TAG)
+                    .append(": override \"").append(current.name).append("\" has a different type than the value it overrides"));
+
+                compiled.defaultValue = currentDefault;
+
+                break;
+            }
+        }
+
+        table.overrides.push_back(compiled);
+    }
+
+    return table;
+}
+
+void webgl1es2_uniform_collection::uploadOverrides(const compiled_override_table &aTable, 
+    const webgl1es2_uniform_collection &aDefaults) const
+{
+    for (const auto &current : aTable.overrides)
+    {
+        if (current.defaultValue && valueEquals(current.value, aDefaults, *current.defaultValue)) continue;
+
+        upload(current.value);
+    }
+}
+
+void webgl1es2_uniform_collection::restoreDefaults(const compiled_override_table &aTable, 
+    const webgl1es2_uniform_collection &aDefaults) const
+{
+    static constexpr GLfloat ZEROS[16] = {};
+
+    for (const auto &current : aTable.overrides)
+    {
+        if (current.defaultValue)
+        {
+            if (!valueEquals(current.value, aDefaults, *current.defaultValue)) aDefaults.upload(*current.defaultValue);
+
+            continue;
+        }
+
+        const auto location = current.value.location;
+
+        switch (current.value.type)
+        {
+            case uniform_type::float1: glUniform1fv(location, 1, ZEROS); break;
+            case uniform_type::float2: glUniform2fv(location, 1, ZEROS); break;
+            case uniform_type::float3: glUniform3fv(location, 1, ZEROS); break;
+            case uniform_type::float4: glUniform4fv(location, 1, ZEROS); break;
+            case uniform_type::mat4x4: glUniformMatrix4fv(location, 1, GL_FALSE, ZEROS); break;
+            case uniform_type::integer1: glUniform1i(location, 0); break;
+
+            case uniform_type::texture:
+            {
+                glActiveTexture(GL_TEXTURE0 + webgl1es2_render_state::current().getTextureUnit(m_TextureNames[current.value.offset]));
+
+                glBindTexture(GL_TEXTURE_2D, 0);
+            } break;
+        }
+    }
+}
+
+size_t webgl1es2_uniform_collection::pack(const std::string &aName, std::vector<GLfloat> &aBuffer) const
+{
+    for (const auto &current : m_Declarations) if (current.name == aName)
+    {
+        switch (current.type)
+        {
+            case uniform_type::integer1:
+            {
+                GLint value;
+
+                std::memcpy(&value, &m_Values[current.offset], sizeof(GLint));
+
+                aBuffer.push_back(static_cast<GLfloat>(value));
+
+                return 1;
+            }
+
+            case uniform_type::texture: throw std::invalid_argument(std::string(TAG)
+                .append(": texture \"").append(aName).append("\" cannot be packed"));
+
+            default:
+            {
+                const auto count = value_size(current.type) / sizeof(GLfloat);
+                const auto pFloats = reinterpret_cast<const GLfloat *>(&m_Values[current.offset]);
+
+                aBuffer.insert(aBuffer.end(), pFloats, pFloats + count);
+
+                return count;
+            }
+        }
+    }
+
+    return 0;
+}
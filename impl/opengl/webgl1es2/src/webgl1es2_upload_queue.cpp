@@ -0,0 +1,119 @@
+// © 2019 Joseph Cameron - All Rights Reserved
+
+#include <gdk/webgl1es2_upload_queue.h>
+
+#include <limits>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+using namespace gdk;
+
+static constexpr char TAG[] = "upload_queue";
+
+void webgl1es2_upload_queue::push(pending_upload_ptr pUpload)
+{
+    if (!pUpload) throw std::invalid_argument(std::string(TAG).append(": upload must not be null"));
+
+    {
+        std::lock_guard<std::mutex> lock(m_Mutex);
+
+        m_PendingBytes += pUpload->getSize();
+
+        m_Pending.push_back(std::move(pUpload));
+    }
+
+    m_Pushed.notify_one();
+}
+
+size_t webgl1es2_upload_queue::drain(const size_t aByteBudget, 
+    const std::chrono::microseconds aTimeBudget, 
+    const std::function<void()> &aSynchronize)
+{
+    using clock = std::chrono::steady_clock;
+
+    const auto start = clock::now();
+
+    size_t uploadedBytes(0);
+
+    std::vector<pending_upload_ptr> uploaded;
+
+    const auto markUploadedResident = [&]()
+    {
+        if (aSynchronize && uploaded.size()) aSynchronize();
+
+        for (const auto &pUpload : uploaded) pUpload->markResident();
+    };
+
+    // uploads completed before one that throws have already left the queue, so must still be marked resident
+    try
+    {
+        for (bool first(true);; first = false)
+        {
+            pending_upload_ptr pUpload;
+
+            {
+                std::lock_guard<std::mutex> lock(m_Mutex);
+
+                if (m_Pending.empty()) break;
+
+                // a budget is a soft limit: an upload that would exceed it waits for the next drain, unless nothing has been uploaded yet
+                if (!first && uploadedBytes + m_Pending.front()->getSize() > aByteBudget) break;
+
+                pUpload = std::move(m_Pending.front());
+
+                m_Pending.pop_front();
+
+                m_PendingBytes -= pUpload->getSize();
+            }
+
+            // the queue holds the only reference, so the resource no longer exists
+            if (pUpload.use_count() == 1) continue;
+
+            pUpload->upload();
+
+            uploadedBytes += pUpload->getSize();
+
+            uploaded.push_back(std::move(pUpload));
+
+            // compared in the budget's units: converting a large budget to the clock's units would overflow
+            if (std::chrono::duration_cast<std::chrono::microseconds>(clock::now() - start) >= aTimeBudget) break;
+        }
+    }
+    catch (...)
+    {
+        markUploadedResident();
+
+        throw;
+    }
+
+    markUploadedResident();
+
+    return uploadedBytes;
+}
+
+bool webgl1es2_upload_queue::waitForPending(const std::chrono::milliseconds aTimeout) const
+{
+    std::unique_lock<std::mutex> lock(m_Mutex);
+
+    return m_Pushed.wait_for(lock, aTimeout, [this]() { return !m_Pending.empty(); });
+}
+
+size_t webgl1es2_upload_queue::drain()
+{
+    return drain(std::numeric_limits<size_t>::max(), std::chrono::microseconds::max());
+}
+
+size_t webgl1es2_upload_queue::getPendingCount() const
+{
+    std::lock_guard<std::mutex> lock(m_Mutex);
+
+    return m_Pending.size();
+}
+
+size_t webgl1es2_upload_queue::getPendingBytes() const
+{
+    std::lock_guard<std::mutex> lock(m_Mutex);
+
+    return m_PendingBytes;
+}
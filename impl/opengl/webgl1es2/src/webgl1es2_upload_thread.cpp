@@ -0,0 +1,91 @@
+// © 2019 Joseph Cameron - All Rights Reserved
+
+#include <gdk/opengl.h>
+#include <gdk/webgl1es2_upload_thread.h>
+
+#include <chrono>
+#include <limits>
+#include <stdexcept>
+#include <string>
+
+using namespace gdk;
+
+static constexpr char TAG[] = "upload_thread";
+
+//! upper bound on the bytes uploaded between synchronizations, so that the first resources of a large burst become resident early
+static constexpr size_t BATCH_BYTE_BUDGET = 4 * 1024 * 1024;
+
+//! how often the thread checks whether it has been asked to stop while the queue is empty
+static constexpr std::chrono::milliseconds POLL_INTERVAL(10);
+
+webgl1es2_upload_thread::webgl1es2_upload_thread(std::shared_ptr<webgl1es2_upload_queue> pQueue,
+    context_function_type aMakeCurrent,
+    context_function_type aReleaseCurrent,
+    context_function_type aSynchronize)
+: m_pQueue([&pQueue]()
+{
+    if (!pQueue) throw std::invalid_argument(std::string(TAG).append(": queue must not be null"));
+
+    return std::move(pQueue);
+}())
+{
+    if (!aMakeCurrent || !aReleaseCurrent) throw std::invalid_argument(std::string(TAG)
+        .append(": make current and release functions must be provided"));
+
+    if (!aSynchronize) aSynchronize = []() { glFinish(); };
+
+    m_Thread = std::thread(&webgl1es2_upload_thread::run, this, 
+        std::move(aMakeCurrent), std::move(aReleaseCurrent), std::move(aSynchronize));
+}
+
+webgl1es2_upload_thread::~webgl1es2_upload_thread()
+{
+    stop();
+}
+
+void webgl1es2_upload_thread::stop()
+{
+    m_IsRunning.store(false, std::memory_order_relaxed);
+
+    if (m_Thread.joinable()) m_Thread.join();
+}
+
+void webgl1es2_upload_thread::run(const context_function_type aMakeCurrent, 
+    const context_function_type aReleaseCurrent, 
+    const context_function_type aSynchronize)
+{
+    try
+    {
+        aMakeCurrent();
+
+        try
+        {
+            while (m_IsRunning.load(std::memory_order_relaxed))
+            {
+                if (m_pQueue->waitForPending(POLL_INTERVAL)) 
+                    m_pQueue->drain(BATCH_BYTE_BUDGET, std::chrono::microseconds::max(), aSynchronize);
+            }
+        }
+        catch (...)
+        {
+            aReleaseCurrent();
+
+            throw;
+        }
+
+        aReleaseCurrent();
+    }
+    catch (...)
+    {
+        std::lock_guard<std::mutex> lock(m_ExceptionMutex);
+
+        m_Exception = std::current_exception();
+    }
+}
+
+void webgl1es2_upload_thread::rethrowIfFailed() const
+{
+    std::lock_guard<std::mutex> lock(m_ExceptionMutex);
+
+    if (m_Exception) std::rethrow_exception(m_Exception);
+}
@@ -2,6 +2,9 @@
 
 #include <gdk/webgl1es2_vertex_attribute.h>
 
+#include <stdexcept>
+#include <string>
+
 using namespace gdk;
 
 static constexpr char TAG[] = "vertex_attribute";
@@ -10,7 +13,8 @@ bool webgl1es2_vertex_attribute::operator==(const webgl1es2_vertex_attribute &th
 {
     return 
         name == that.name &&
-        size == that.size;
+        size == that.size &&
+        type == that.type;
 }
 
 bool webgl1es2_vertex_attribute::operator!=(const webgl1es2_vertex_attribute &that) const
@@ -18,7 +22,28 @@ bool webgl1es2_vertex_attribute::operator!=(const webgl1es2_vertex_attribute &th
     return !(*this == that);
 }
 
-webgl1es2_vertex_attribute::webgl1es2_vertex_attribute(const std::string &aName, const unsigned short &aSize)
+size_t webgl1es2_vertex_attribute::getComponentSize() const
+{
+    switch (type)
+    {
+        case component_type::float32: return 4;
+        case component_type::float16: return 2;
+        case component_type::int8_normalized: 
+        case component_type::uint8_normalized: return 1;
+        case component_type::int16_normalized: 
+        case component_type::uint16_normalized: return 2;
+    }
+
+    throw std::invalid_argument(std::string(TAG).append(": unhandled component type"));
+}
+
+size_t webgl1es2_vertex_attribute::getPaddedSize() const
+{
+    return ((getComponentSize() * size) + 3) & ~static_cast<size_t>(3);
+}
+
+webgl1es2_vertex_attribute::webgl1es2_vertex_attribute(const std::string &aName, const unsigned short &aSize, const component_type aType)
 : name(aName)
 , size(aSize)
+, type(aType)
 {}
@@ -2,9 +2,12 @@
 
 #include <gdk/glh.h>
 #include <gdk/opengl.h>
+#include <gdk/webgl1es2_render_state.h>
 #include <gdk/webgl1es2_vertex_format.h>
 #include <gdk/webgl1es2_shader_program.h>
 
+#include <string>
+
 using namespace gdk;
 
 static constexpr char TAG[] = "vertex_format";
@@ -32,36 +35,101 @@ webgl1es2_vertex_format::webgl1es2_vertex_format(const std::vector<webgl1es2_ver
 : m_Format(aAttributes)
 , m_SumOfAttributeComponents(([aAttributes]()
 {
-    decltype(m_SumOfAttributeComponents) sum(0);
+    size_t sum(0);
     
-    for (const auto &attribute : aAttributes) sum += attribute.size;
+    for (const auto &attribute : aAttributes) sum += attribute.getPaddedSize();
     
-    return sum;
+    return static_cast<decltype(m_SumOfAttributeComponents)>(sum / 4);
 })())
+, m_ConventionalBindingTable([&aAttributes]()
+{
+    attribute_binding_table table;
+
+    GLint attributeOffset(0);
+
+    for (const auto &attribute : aAttributes)
+    {
+        if (const auto location = webgl1es2_shader_program::tryGetConventionalAttributeLocation(attribute.name))
+        {
+            table.push_back({*location, attribute.size, attribute.type, attributeOffset});
+        }
+
+        attributeOffset += static_cast<GLint>(attribute.getPaddedSize());
+    }
+
+    return table;
+}())
 {}
 
-void webgl1es2_vertex_format::enableAttributes(const webgl1es2_shader_program &aShaderProgram) const
+const webgl1es2_vertex_format::attribute_binding_table &webgl1es2_vertex_format::getBindingTable(const webgl1es2_shader_program &aShaderProgram) const
 {
-    int attributeOffset(0);
+    if (aShaderProgram.hasConventionalAttributeLocations()) return m_ConventionalBindingTable;
+
+    const auto serial = aShaderProgram.getSerial();
+
+    for (const auto &current : m_ProgramBindingTables) if (current.programSerial == serial) return current.table;
+
+    auto &entry = m_ProgramBindingTables[m_NextProgramBindingTable];
+
+    m_NextProgramBindingTable = (m_NextProgramBindingTable + 1) % m_ProgramBindingTables.size();
+
+    // the replaced table's storage is reused
+    auto &table = entry.table;
+    table.clear();
+
+    entry.programSerial = serial;
+
+    GLint attributeOffset(0);
     
     for (const auto &attribute : m_Format)
     {
-        std::string attributeName = attribute.name;
-        int attributeSize = attribute.size;
-
-        if (auto activeAttribute = aShaderProgram.tryGetActiveAttribute(attributeName); activeAttribute)
+        if (auto activeAttribute = aShaderProgram.tryGetActiveAttribute(attribute.name); activeAttribute)
         {
-            //if (attributeType == found->type && //TODO: support types, so not forced to use floats for small range datatypes
-                //attributeSize == found->second.count) //TODO: count is not component count, its number of e.g vector2s
-            //{
-                glh::Enablevertex_attribute(activeAttribute->location, 
-                    attributeSize, 
-                    attributeOffset,
-                    m_SumOfAttributeComponents);
-            //}
+            //TODO: count is not component count, its number of e.g vector2s
+            table.push_back({static_cast<GLuint>(activeAttribute->location), attribute.size, attribute.type, attributeOffset});
         }
         
-        attributeOffset += attributeSize;
+        attributeOffset += static_cast<GLint>(attribute.getPaddedSize());
+    }
+
+    return table;
+}
+
+void webgl1es2_vertex_format::enableAttributes(const webgl1es2_shader_program &aShaderProgram) const
+{
+    enableAttributes(aShaderProgram, 0);
+}
+
+void webgl1es2_vertex_format::enableAttributes(const webgl1es2_shader_program &aShaderProgram, const size_t aBaseOffset) const
+{
+    const auto stride = static_cast<GLsizei>(sizeof(GLfloat) * m_SumOfAttributeComponents);
+    const auto baseOffset = sizeof(GLfloat) * aBaseOffset;
+
+    for (const auto &binding : getBindingTable(aShaderProgram))
+    {
+        GLenum type(GL_FLOAT);
+        GLboolean isNormalized(GL_TRUE);
+
+        switch (binding.type)
+        {
+            case webgl1es2_vertex_attribute::component_type::float32: isNormalized = GL_FALSE; break;
+            case webgl1es2_vertex_attribute::component_type::float16: 
+            {
+                type = webgl1es2_render_state::current().getHalfFloatAttributeType(); 
+                isNormalized = GL_FALSE; 
+            } break;
+            case webgl1es2_vertex_attribute::component_type::int8_normalized: type = GL_BYTE; break;
+            case webgl1es2_vertex_attribute::component_type::uint8_normalized: type = GL_UNSIGNED_BYTE; break;
+            case webgl1es2_vertex_attribute::component_type::int16_normalized: type = GL_SHORT; break;
+            case webgl1es2_vertex_attribute::component_type::uint16_normalized: type = GL_UNSIGNED_SHORT; break;
+        }
+
+        glh::Enablevertex_attribute(binding.location, 
+            binding.size, 
+            type,
+            isNormalized,
+            baseOffset + binding.offset,
+            stride);
     }
 }
 
@@ -70,3 +138,22 @@ int webgl1es2_vertex_format::getSumOfAttributeComponents() const
     return m_SumOfAttributeComponents;
 }
 
+const std::vector<webgl1es2_vertex_attribute> &webgl1es2_vertex_format::getAttributes() const
+{
+    return m_Format;
+}
+
+std::optional<size_t> webgl1es2_vertex_format::tryGetAttributeOffset(const std::string &aName) const
+{
+    size_t offset(0);
+
+    for (const auto &attribute : m_Format)
+    {
+        if (attribute.name == aName) return offset;
+
+        offset += attribute.getPaddedSize();
+    }
+
+    return {};
+}
+
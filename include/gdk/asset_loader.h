@@ -0,0 +1,189 @@
+// © 2019 Joseph Cameron - All Rights Reserved
+
+#ifndef GDK_GFX_ASSET_LOADER_H
+#define GDK_GFX_ASSET_LOADER_H
+
+#include <gdk/graphics_context.h>
+#include <gdk/job_system.h>
+
+#include <chrono>
+#include <cstddef>
+#include <functional>
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#if defined(__cpp_impl_coroutine) && defined(__has_include)
+#if __has_include(<coroutine>)
+#include <coroutine>
+#define GDK_GFX_ASSET_LOADER_HAS_COROUTINES
+#endif
+#endif
+
+namespace gdk
+{
+    /// \brief loads textures, models and shaders from files without stalling the rendering thread
+    ///
+    /// \detailed each load reads its files and decodes them in a job, then makes the resource with the context.
+    /// Textures and models are made pending, so their data reaches the graphics device through context::upload_pending
+    /// or the context's upload thread. Shaders must be compiled on the rendering thread, which is done by update.
+    ///
+    /// Loads start in priority order, a limited number at a time, so that a level load of thousands of assets keeps
+    /// reading, decoding and uploading overlapped without holding every decoded asset in memory at once.
+    ///
+    /// Finished loads are polled through their handles or, when built as C++20, awaited with co_await.
+    /// Awaiting coroutines are resumed by update, on the rendering thread.
+    class asset_loader final
+    {
+    public:
+        //! progress of a load
+        enum class load_state
+        {
+            queued, //!< waiting for a free slot
+            loading, //!< files being read, decoded or made into a resource
+            ready, //!< the resource is available
+            failed, //!< reading, decoding or making the resource threw
+            cancelled //!< cancelled before it was ready
+        };
+
+        //! vertex data produced by a model decoder
+        struct model_data
+        {
+            //! usage of the model
+            vertex_data_view::UsageHint usage = vertex_data_view::UsageHint::Static;
+
+            //! attribute name to its component count and components
+            std::unordered_map<std::string,
+                std::pair<size_t, std::vector<attribute_data_view::attribute_component_type>>> attributes;
+        };
+
+        //! converts the contents of a model file to vertex data. called in a job
+        using model_decoder_type = std::function<model_data(const std::vector<std::byte> &aFileData)>;
+
+        //! a load, shared by the loader and its handle
+        class request;
+
+        //! state shared by the loader and its jobs
+        struct shared_state;
+
+        //! refers to a load regardless of the type of resource
+        class load_handle_base
+        {
+            friend asset_loader;
+
+        protected:
+            //! the load
+            std::shared_ptr<request> m_pRequest;
+
+            //! the resource, untyped
+            /// \exception rethrows the exception that failed the load
+            /// \exception runtime_error the load is not finished, or was cancelled
+            std::shared_ptr<void> get_result() const;
+
+            //! calls aResume once the load is done, from asset_loader::update
+            /// \return false if the load is already done, in which case aResume is not called
+            bool resume_when_done(std::function<void()> aResume) const;
+
+            load_handle_base(std::shared_ptr<request> pRequest);
+
+        public:
+            //! progress of the load
+            load_state get_state() const;
+
+            //! true once the load is ready, failed or cancelled
+            bool is_done() const;
+
+            //! stops the load as soon as possible. Has no effect once the load is done.
+            /// the resource is not made if the load is cancelled before reaching the context
+            void cancel();
+        };
+
+        //! refers to the load of a resource
+        template<typename resource_type>
+        class load_handle final : public load_handle_base
+        {
+        public:
+            //! the loaded resource
+            /// \exception rethrows the exception that failed the load
+            /// \exception runtime_error the load is not finished, or was cancelled
+            std::shared_ptr<resource_type> get() const
+            {
+                return std::static_pointer_cast<resource_type>(get_result());
+            }
+
+#if defined(GDK_GFX_ASSET_LOADER_HAS_COROUTINES)
+            bool await_ready() const
+            {
+                return is_done();
+            }
+
+            bool await_suspend(std::coroutine_handle<> aCoroutine) const
+            {
+                return resume_when_done([aCoroutine]()
+                {
+                    aCoroutine.resume();
+                });
+            }
+
+            std::shared_ptr<resource_type> await_resume() const
+            {
+                return get();
+            }
+#endif
+
+            load_handle(std::shared_ptr<request> pRequest)
+            : load_handle_base(std::move(pRequest))
+            {}
+        };
+
+    private:
+        //! state shared with the jobs doing the loads
+        std::shared_ptr<shared_state> m_pState;
+
+        //! queues a load
+        std::shared_ptr<request> enqueue(std::shared_ptr<request> pRequest);
+
+    public:
+        //! loads a texture from an image file. PNG, JPEG, TGA and BMP are supported. The image is converted to rgba
+        load_handle<texture> load_texture(const std::string &aPath, const int aPriority = 0);
+
+        //! loads a model from a file, using a decoder for the file's format
+        /// \exception invalid_argument the decoder is empty
+        load_handle<model> load_model(const std::string &aPath, model_decoder_type aDecoder, const int aPriority = 0);
+
+        //! loads a shader program from a vertex shader file and a fragment shader file
+        load_handle<shader_program> load_shader(const std::string &aVertexPath, const std::string &aFragmentPath,
+            const int aPriority = 0);
+
+        //! changes the priority of a load that has not started. Higher priority loads start first
+        void set_priority(const load_handle_base &aLoad, const int aPriority);
+
+        /// \brief compiles shaders whose sources have been read, in priority order, until the time budget is spent,
+        /// then resumes coroutines awaiting loads that are done. At least one shader is compiled if any are waiting.
+        /// Intended to be called once per frame.
+        /// \return number of shaders compiled
+        /// \warn must be called on the thread that owns the graphics api context.
+        size_t update(const std::chrono::microseconds aTimeBudget = std::chrono::microseconds::max());
+
+        //! number of loads that are not done
+        size_t get_loading_count() const;
+
+        //! makes an asset loader
+        /// \param aMaxLoadsInFlight number of loads reading or decoding at once
+        /// \warn the context must outlive the loader
+        /// \exception invalid_argument the job system is null or aMaxLoadsInFlight is 0
+        asset_loader(const graphics::context &aContext,
+            std::shared_ptr<job_system> pJobSystem = job_system::get_shared(),
+            const size_t aMaxLoadsInFlight = 16);
+
+        //! cancels unfinished loads, waits for the ones in progress, then resumes coroutines awaiting any of them
+        ~asset_loader();
+
+        asset_loader(const asset_loader &) = delete;
+        asset_loader &operator=(const asset_loader &) = delete;
+    };
+}
+
+#endif
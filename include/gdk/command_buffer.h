@@ -0,0 +1,202 @@
+// © 2019 Joseph Cameron - All Rights Reserved
+
+#ifndef GDK_GFX_COMMAND_BUFFER_H
+#define GDK_GFX_COMMAND_BUFFER_H
+
+#include <gdk/graphics_types.h>
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace gdk
+{
+    class material;
+    class model;
+
+    /// \brief a recorded sequence of rendering commands, replayed later by a context
+    ///
+    /// \detailed recording makes no graphics api calls, so any thread can record into its own buffer,
+    /// e.g: world, ui and debug overlays can be recorded in parallel then submitted in order on the rendering thread.
+    /// Commands are plain data, appended to a single contiguous arena. Clearing a buffer keeps its capacity,
+    /// so a buffer rerecorded every frame stops allocating once it has reached its steady state size.
+    /// \warn a single buffer must not be recorded into by more than one thread at a time
+    class command_buffer final
+    {
+    public:
+        //! identifies a uniform by name, independent of any program.
+        using uniform_handle = std::uint32_t;
+
+        //! backend defined fixed function state. e.g: the key of a webgl1es2_pipeline_state
+        using state_key_type = std::uint64_t;
+
+        //! kinds of command
+        enum class command_type : std::uint8_t
+        {
+            set_camera, //!< payload: set_camera_command
+            bind_material, //!< payload: bind_material_command
+            bind_model, //!< payload: bind_model_command
+            set_uniform, //!< payload: set_uniform_command
+            set_state, //!< payload: set_state_command
+            draw //!< payload: draw_command
+        };
+
+        //! type of a uniform value set by a set_uniform command
+        enum class uniform_type : std::uint8_t
+        {
+            float1, //!< float
+            float2, //!< vec2
+            float3, //!< vec3
+            float4, //!< vec4
+            mat4x4, //!< mat4
+            integer1 //!< int
+        };
+
+        //! camera values used by subsequent draws
+        struct set_camera_command
+        {
+            float viewMatrix[16]; //!< view matrix
+            float projectionMatrix[16]; //!< projection matrix
+            float position[3]; //!< world position of the camera
+        };
+
+        //! activate a material: its program, uniform values and state
+        struct bind_material_command
+        {
+            std::uint32_t materialIndex; //!< index of the material, see get_material
+        };
+
+        //! bind a model's vertex data
+        struct bind_model_command
+        {
+            std::uint32_t modelIndex; //!< index of the model, see get_model
+        };
+
+        //! assign a value to a uniform of the current program
+        struct set_uniform_command
+        {
+            uniform_handle uniform; //!< the uniform to assign
+            uniform_type type; //!< type of the value
+            union
+            {
+                float floats[16]; //!< value if the type is float1 through mat4x4
+                std::int32_t integer; //!< value if the type is integer1
+            };
+        };
+
+        //! set fixed function state, replacing the state set by the current material
+        struct set_state_command
+        {
+            state_key_type key; //!< backend defined state key
+        };
+
+        //! draw the current model with the current material
+        struct draw_command
+        {
+            float modelMatrix[16]; //!< model matrix of the draw
+        };
+
+    private:
+        //! header preceding each command's payload in the arena
+        struct command_header
+        {
+            command_type type; //!< kind of command
+            std::uint32_t size; //!< size of the payload in bytes
+        };
+
+        //! commands, as headers each followed by a payload
+        std::vector<std::byte> m_Data;
+
+        //! number of commands recorded
+        size_t m_CommandCount = 0;
+
+        //! materials referred to by bind_material commands. held so they outlive the buffer's submission
+        std::vector<std::shared_ptr<material>> m_Materials;
+
+        //! models referred to by bind_model commands. held so they outlive the buffer's submission
+        std::vector<std::shared_ptr<model>> m_Models;
+
+        //! appends a header and payload to the arena
+        void push(const command_type aType, const void *pPayload, const std::uint32_t aSize);
+
+        //! appends a set_uniform command
+        void push_uniform(const uniform_handle aUniform, const uniform_type aType, const float *pFloats, const size_t aCount);
+
+    public:
+        //! gets the handle for a uniform name. The same name always produces the same handle. Thread safe
+        static uniform_handle get_uniform_handle(const std::string &aName);
+
+        //! gets the name a handle was created from. Thread safe
+        /// \exception invalid_argument the handle was not produced by get_uniform_handle
+        static std::string get_uniform_name(const uniform_handle aUniform);
+
+        //! record camera values used by subsequent draws
+        void set_camera(const graphics_mat4x4_type &aViewMatrix,
+            const graphics_mat4x4_type &aProjectionMatrix,
+            const graphics_vector3_type &aPosition);
+
+        //! record a material activation
+        void bind_material(std::shared_ptr<material> pMaterial);
+
+        //! record a model binding
+        void bind_model(std::shared_ptr<model> pModel);
+
+        //! record a float uniform assignment
+        void set_uniform(const uniform_handle aUniform, const float aValue);
+        //! record a vec2 uniform assignment
+        void set_uniform(const uniform_handle aUniform, const graphics_vector2_type &aValue);
+        //! record a vec3 uniform assignment
+        void set_uniform(const uniform_handle aUniform, const graphics_vector3_type &aValue);
+        //! record a vec4 uniform assignment
+        void set_uniform(const uniform_handle aUniform, const graphics_vector4_type &aValue);
+        //! record a mat4 uniform assignment
+        void set_uniform(const uniform_handle aUniform, const graphics_mat4x4_type &aValue);
+        //! record an int uniform assignment
+        void set_uniform(const uniform_handle aUniform, const std::int32_t aValue);
+
+        //! record a state change
+        void set_state(const state_key_type aKey);
+
+        //! record a draw of the current model
+        void draw(const graphics_mat4x4_type &aModelMatrix);
+
+        //! number of commands recorded
+        size_t size() const;
+
+        //! check if no commands have been recorded
+        bool empty() const;
+
+        //! discard all commands and resource references, keeping allocated capacity
+        void clear();
+
+        //! the material referred to by a bind_material command
+        const std::shared_ptr<material> &get_material(const std::uint32_t aIndex) const;
+
+        //! the model referred to by a bind_model command
+        const std::shared_ptr<model> &get_model(const std::uint32_t aIndex) const;
+
+        //! calls aVisitor(command_type, const std::byte *pPayload) for each command, in recorded order.
+        /// payloads are not guaranteed to be aligned; copy them into their payload type before reading
+        template<typename visitor_type>
+        void for_each(visitor_type aVisitor) const
+        {
+            for (size_t offset(0); offset < m_Data.size();)
+            {
+                command_header header;
+
+                std::memcpy(&header, &m_Data[offset], sizeof(command_header));
+
+                offset += sizeof(command_header);
+
+                aVisitor(header.type, &m_Data[offset]);
+
+                offset += header.size;
+            }
+        }
+    };
+}
+
+#endif
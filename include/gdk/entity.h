@@ -5,10 +5,14 @@
 
 #include <gdk/graphics_types.h>
 
+#include <memory>
+#include <string>
+
 namespace gdk
 {
     class material;
     class model;
+    class texture;
 
     //! represents an observable 3d object.
     class entity
@@ -34,6 +38,21 @@ namespace gdk
             const graphics_quaternion_type &aRotation, 
             const graphics_vector3_type &aScale = graphics_vector3_type::One) = 0;
 
+        //! overrides a texture assigned by the material, for this entity only
+        virtual void setTexture(const std::string &aName, std::shared_ptr<texture> aTexture) = 0;
+        //! overrides a float assigned by the material, for this entity only
+        virtual void setFloat(const std::string &aName, float aValue) = 0;
+        //! overrides a vec2 assigned by the material, for this entity only
+        virtual void setVector2(const std::string &aName, const graphics_vector2_type &aValue) = 0;
+        //! overrides a vec3 assigned by the material, for this entity only
+        virtual void setVector3(const std::string &aName, const graphics_vector3_type &aValue) = 0;
+        //! overrides a vec4 assigned by the material, for this entity only
+        virtual void setVector4(const std::string &aName, const graphics_vector4_type &aValue) = 0;
+        //! overrides a mat4 assigned by the material, for this entity only
+        virtual void setMatrix4x4(const std::string &aName, const graphics_mat4x4_type &aValue) = 0;
+        //! overrides an int assigned by the material, for this entity only
+        virtual void setInteger(const std::string &aName, int aValue) = 0;
+
         //! dtor
         virtual ~entity() = default;
 
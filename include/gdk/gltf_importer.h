@@ -0,0 +1,162 @@
+// © 2019 Joseph Cameron - All Rights Reserved
+
+#ifndef GDK_GFX_GLTF_IMPORTER_H
+#define GDK_GFX_GLTF_IMPORTER_H
+
+#include <gdk/graphics_context.h>
+#include <gdk/job_system.h>
+#include <gdk/mapped_file.h>
+
+#include <array>
+#include <cstddef>
+#include <memory>
+#include <optional>
+#include <string>
+#include <vector>
+
+namespace gdk
+{
+    /// \brief imports the meshes, materials and textures of glTF 2.0 files, both .gltf and .glb
+    ///
+    /// \detailed importing is done in two stages. decode reads the file and does all of the cpu work: buffers are mapped
+    /// rather than read, accessors are converted in parallel ranges on the job system, and images are decoded in jobs alongside them.
+    /// Float accessors are not converted at all, but viewed in place in the mapped buffers.
+    /// make then makes the resources with the context, all at once at the end: the models through context::make_models,
+    /// the textures, then the materials.
+    ///
+    /// Attributes are named for shaders as follows: POSITION is a_Position, TEXCOORD_0 is a_UV, NORMAL is a_Normal,
+    /// COLOR_0 is a_Color and TANGENT is a_Tangent. Other attributes are prefixed with "a_", e.g: a_TEXCOORD_1.
+    /// Normalized integer attributes keep their size on the gpu, see attribute_data_view::StorageType.
+    ///
+    /// Materials set "_Texture" to the base color texture, "_BaseColor" to the base color factor and,
+    /// for masked materials, "_AlphaCutoff" to the alpha cutoff.
+    ///
+    /// Only triangle lists are supported. Sparse accessors, samplers, scenes, nodes, skins and animations are not imported.
+    class gltf_importer final
+    {
+    public:
+        //! an attribute of a primitive, decoded
+        struct attribute_data
+        {
+            std::string name; //!< name of the attribute in shaders
+            size_t componentCount; //!< components per vertex
+            size_t vertexCount; //!< number of vertexes
+            attribute_data_view::StorageType storageType; //!< how the components are stored on the gpu
+
+            //! the components, converted to floats. empty if the accessor's floats are viewed in place
+            std::vector<attribute_data_view::attribute_component_type> components;
+
+            //! the accessor's floats, in a buffer of the document. null if the components were converted
+            const attribute_data_view::attribute_component_type *pBuffer = nullptr;
+
+            //! bytes from one vertex to the next in pBuffer
+            size_t stride = 0;
+        };
+
+        //! a drawable part of a mesh, decoded
+        struct primitive_data
+        {
+            //! the vertex attributes
+            std::vector<attribute_data> attributes;
+
+            //! indexes of the triangles. empty if the vertexes are drawn in order
+            std::vector<vertex_data_view::index_type> indexes;
+
+            //! index of the primitive's material in the document. empty if the primitive uses the default material
+            std::optional<size_t> material;
+
+            /// \brief a view of the primitive's data
+            /// \warn unowning. the document must outlive the view
+            vertex_data_view getView() const;
+        };
+
+        //! a mesh, decoded
+        struct mesh_data
+        {
+            std::string name; //!< name in the file. may be empty
+            std::vector<primitive_data> primitives; //!< parts of the mesh
+        };
+
+        //! an image, decoded to rgba
+        struct image_data
+        {
+            size_t width; //!< texels wide
+            size_t height; //!< texels tall
+            std::shared_ptr<std::byte> pData; //!< width * height * 4 bytes
+        };
+
+        //! a material's parameters
+        struct material_data
+        {
+            std::string name; //!< name in the file. may be empty
+            std::array<float, 4> baseColorFactor{1, 1, 1, 1}; //!< rgba multiplier of the base color
+            std::optional<size_t> baseColorImage; //!< index of the base color image in the document
+            std::optional<float> alphaCutoff; //!< set if the material's alpha mode is MASK
+        };
+
+        //! the contents of a file, decoded and ready to be made into resources
+        struct document
+        {
+            std::vector<mesh_data> meshes; //!< meshes, in file order
+            std::vector<material_data> materials; //!< materials, in file order
+            std::vector<image_data> images; //!< images, in file order
+
+            //! number of bytes read from files, i.e: the file and its external buffers and images
+            size_t byteCount = 0;
+
+            //! mapped files, referred to by attributes viewed in place
+            std::vector<std::shared_ptr<mapped_file>> files;
+
+            //! buffers decoded from data uris, referred to by attributes viewed in place
+            std::vector<std::shared_ptr<std::vector<std::byte>>> buffers;
+        };
+
+        //! a primitive made into resources
+        struct primitive
+        {
+            std::shared_ptr<model> pModel; //!< the vertex data
+            std::shared_ptr<material> pMaterial; //!< the primitive's material, or a shared default material
+        };
+
+        //! a mesh made into resources
+        struct mesh
+        {
+            std::string name; //!< name in the file. may be empty
+            std::vector<primitive> primitives; //!< parts of the mesh. draw each with an entity
+        };
+
+        //! the resources made from a document
+        struct asset
+        {
+            std::vector<mesh> meshes; //!< in file order
+            std::vector<std::shared_ptr<material>> materials; //!< in file order
+            std::vector<std::shared_ptr<texture>> textures; //!< one per image, in file order
+        };
+
+    private:
+        //! makes the resources
+        const graphics::context &m_Context;
+
+        //! shader of the materials
+        graphics::context::shader_program_shared_ptr_type m_pShader;
+
+    public:
+        /// \brief reads and decodes a .gltf or .glb file. Does not use the graphics api, so can be called on any thread
+        /// \exception runtime_error a file could not be read, or is not valid glTF, or uses unsupported features
+        static document decode(const std::string &aPath, const std::shared_ptr<job_system> &pJobSystem = job_system::get_shared());
+
+        /// \brief makes models, textures and materials from a decoded document
+        /// \warn must be called on the thread that owns the graphics api context
+        asset make(const document &aDocument) const;
+
+        //! decodes then makes a file
+        asset load(const std::string &aPath) const;
+
+        /// \brief makes an importer
+        /// \param pShader shader of the imported materials. the context's alpha cutoff shader if null
+        /// \warn the context must outlive the importer
+        gltf_importer(const graphics::context &aContext, graphics::context::shader_program_shared_ptr_type pShader = nullptr);
+    };
+}
+
+#endif
@@ -3,10 +3,14 @@
 #ifndef GDK_GFX_CONTEXT_H
 #define GDK_GFX_CONTEXT_H
 
+#include <chrono>
+#include <functional>
 #include <memory>
+#include <vector>
 
 #include <gdk/scene.h>
 #include <gdk/camera.h>
+#include <gdk/command_buffer.h>
 #include <gdk/entity.h>
 #include <gdk/material.h>
 #include <gdk/model.h>
@@ -88,6 +92,25 @@ namespace gdk::graphics
         //! construct model by vertext data view
         virtual model_ptr_type make_model(const vertex_data_view &vertexDataView) const = 0;
 
+        /// \brief replaces a model's vertex data, e.g: for deformable or procedural geometry, without recreating its buffers.
+        /// The attributes may differ from the model's current ones. Intended for models made with a dynamic or streaming usage hint.
+        /// \exception invalid_argument the view is invalid
+        /// \exception runtime_error the model is pending
+        /// \warn must be called on the thread that owns the graphics api context. 
+        virtual void update_model(model &aModel, const vertex_data_view &aVertexDataView) const = 0;
+
+        /// \brief construct many models at once. The cpu side preparation of the views (validation, interleaving) is done 
+        /// in parallel on the job system, then the models are uploaded one after the other on the calling thread.
+        /// Much faster than calling make_model per view when importing scenes of many meshes.
+        /// \return the models, in the order of the views
+        /// \exception invalid_argument a view is invalid, in which case no models are made
+        virtual std::vector<model_ptr_type> make_models(const std::vector<vertex_data_view> &aVertexDataViews) const = 0;
+
+        /// \brief construct a model in the pending state. The vertex data is copied, then uploaded by a later call to upload_pending.
+        /// model::isResident is false until then.
+        /// Makes no gl calls, so can be called from threads without a gl context, e.g: by asset_loader jobs
+        virtual model_ptr_type make_pending_model(const vertex_data_view &vertexDataView) const = 0;
+
         //! make a material. 
         virtual material_ptr_type make_material(
             shader_program_shared_ptr_type pShader //!< defines the pipeline's programmable stage behaviours, can be shared among multiple materials
@@ -99,6 +122,60 @@ namespace gdk::graphics
         //! make a texture using a 2d image view
         virtual texture_ptr_type make_texture(const texture::image_data_2d_view &imageView) const = 0;
 
+        /// \brief make a texture in the pending state. The image data is copied, then uploaded by a later call to upload_pending.
+        /// texture::isResident is false until then, during which the texture samples as black.
+        /// Makes no gl calls, so can be called from threads without a gl context, e.g: by asset_loader jobs
+        virtual texture_ptr_type make_pending_texture(const texture::image_data_2d_view &imageView) const = 0;
+
+        /// \brief uploads pending models and textures, in the order they were made, until either budget is spent.
+        /// At least one is uploaded if any are pending.
+        /// Intended to be called once per frame, so that loading many resources is spread over many frames.
+        /// \return number of bytes uploaded
+        /// \exception rethrows an exception that stopped the upload thread
+        /// \warn must be called on the thread that owns the graphics api context. 
+        virtual size_t upload_pending(const size_t aByteBudget, const std::chrono::microseconds aTimeBudget) const = 0;
+
+        //! number of models and textures waiting to be uploaded. thread safe
+        virtual size_t get_pending_upload_count() const = 0;
+
+        /// \brief starts a thread that uploads pending models and textures as soon as they are made, so that streaming does not
+        /// compete with rendering for frame time. upload_pending can still be called, e.g: to force resources in before a frame.
+        /// \param aMakeSharedContextCurrent makes current, on the calling thread, a graphics api context created sharing objects with 
+        /// this context's. e.g: glfwMakeContextCurrent on a hidden window created with the rendering window as its share parameter
+        /// \param aReleaseSharedContext releases the shared context from the calling thread
+        /// \param aSynchronize waits until the calling thread's graphics commands have completed, e.g: with an EGL_KHR_fence_sync fence. 
+        /// if empty, the implementation uses a full pipeline flush.
+        /// \warn the functions are called on the new thread. 
+        /// \exception runtime_error the thread is already running
+        virtual void start_upload_thread(std::function<void()> aMakeSharedContextCurrent, 
+            std::function<void()> aReleaseSharedContext, 
+            std::function<void()> aSynchronize) = 0;
+
+        //! stops the upload thread, if it is running. Resources it has not uploaded remain pending
+        /// \exception rethrows an exception that stopped the thread
+        virtual void stop_upload_thread() = 0;
+
+        /// \brief deletes the graphics api objects of models, textures and shaders released since the last call, with as few api calls as possible.
+        /// Intended to be called once per frame, after the frame's draws.
+        /// Releasing the last reference to a resource only queues its objects, so resources can be released on any thread.
+        /// \return number of objects deleted
+        /// \warn must be called on the thread that owns the graphics api context. 
+        virtual size_t delete_released_resources() const = 0;
+
+        //! keep released objects for a number of further calls to delete_released_resources before deleting them.
+        /// for drivers that stall when an object used by a frame still in flight is deleted. 0 by default
+        virtual void set_deletion_delay(const size_t aFrames) const = 0;
+
+        //! executes recorded command buffers, in order. Redundant binds across the buffers are skipped.
+        /// \warn must be called on the thread that owns the graphics api context. 
+        virtual void submit(const std::vector<const command_buffer *> &aCommandBuffers) const = 0;
+
+        //! executes a recorded command buffer
+        void submit(const command_buffer &aCommandBuffer) const
+        {
+            submit(std::vector<const command_buffer *>({&aCommandBuffer}));
+        }
+
         /**
          * @name special resources provided by the implementation, focused on being resource unintensive.
          */
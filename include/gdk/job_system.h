@@ -0,0 +1,142 @@
+// © 2019 Joseph Cameron - All Rights Reserved
+
+#ifndef GDK_GFX_JOB_SYSTEM_H
+#define GDK_GFX_JOB_SYSTEM_H
+
+#include <gdk/work_stealing_deque.h>
+
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace gdk
+{
+    /// \brief runs cpu work in parallel for the library's heavy tasks, e.g: interleaving vertex data
+    ///
+    /// \detailed by default owns a pool of worker threads, each with a work stealing deque. Jobs submitted by a worker go to
+    /// its own deque, other jobs go to a shared queue. Idle workers steal from each other, and threads waiting on a job
+    /// run other jobs instead of blocking. A job can depend on other jobs, and is only started once they have finished.
+    ///
+    /// Applications with their own scheduler can inject it instead, in which case no threads are created and ready jobs are
+    /// handed to the scheduler.
+    ///
+    /// Parallel code in the library uses the shared instance, see get_shared, rather than creating threads of its own.
+    class job_system final
+    {
+    public:
+        //! work done by a job
+        using job_function_type = std::function<void()>;
+
+        //! work done by a parallel_for over a subrange [begin, end)
+        using range_function_type = std::function<void(const size_t aBegin, const size_t aEnd)>;
+
+        //! an application provided scheduler. must eventually call the given function once, on any thread
+        using scheduler_type = std::function<void(std::function<void()>)>;
+
+        //! state of a submitted job
+        class job;
+
+        //! refers to a submitted job, to wait on it or to make other jobs depend on it
+        using job_handle = std::shared_ptr<job>;
+
+    private:
+        struct worker;
+
+        //! worker threads. empty if a scheduler was injected
+        std::vector<std::unique_ptr<worker>> m_Workers;
+
+        //! injected scheduler. empty if the system owns workers
+        scheduler_type m_Scheduler;
+
+        //! number of jobs handed to the scheduler that have not finished running
+        std::atomic<size_t> m_ScheduledCount{0};
+
+        //! guards m_Injected
+        std::mutex m_InjectedMutex;
+
+        //! ready jobs submitted by threads that are not workers
+        std::deque<job *> m_Injected;
+
+        //! number of ready jobs not yet taken by a thread
+        std::atomic<size_t> m_ReadyCount{0};
+
+        //! cleared on destruction
+        std::atomic<bool> m_IsRunning{true};
+
+        //! guards sleeping and waking
+        std::mutex m_SleepMutex;
+
+        //! notified when jobs become ready, or the system is stopping
+        std::condition_variable m_WorkAvailable;
+
+        //! number of workers waiting on m_WorkAvailable
+        std::atomic<size_t> m_SleepingCount{0};
+
+        //! notified when a job finishes and a thread is blocked in wait
+        std::condition_variable m_JobFinished;
+
+        //! number of threads blocked in wait
+        std::atomic<size_t> m_BlockedCount{0};
+
+        //! makes a ready job available to run
+        void enqueue(job_handle pJob);
+
+        //! takes a ready job, preferring the calling worker's own deque
+        job *take();
+
+        //! runs a job, then readies the jobs that were waiting on it
+        void execute(job *const pJob);
+
+        //! body of a worker thread
+        void run(const size_t aWorkerIndex);
+
+    public:
+        //! makes a job that runs after all of its dependencies have finished
+        job_handle submit(job_function_type aFunction, const std::vector<job_handle> &aDependencies = {});
+
+        //! waits for a job to finish, running other jobs meanwhile if possible
+        /// \exception rethrows an exception thrown by the job
+        void wait(const job_handle &aJob);
+
+        //! check if a job has finished
+        bool is_finished(const job_handle &aJob) const;
+
+        //! splits [aBegin, aEnd) into ranges of at most aGrainSize and calls aFunction on each range in parallel.
+        /// returns once all ranges are done. the calling thread processes ranges too
+        /// \exception rethrows an exception thrown by aFunction
+        void parallel_for(const size_t aBegin, const size_t aEnd, const size_t aGrainSize, const range_function_type &aFunction);
+
+        //! number of worker threads. 0 if a scheduler was injected
+        size_t worker_count() const;
+
+        //! the instance used by the library. created on first use with a worker per hardware thread, less one for the caller
+        static std::shared_ptr<job_system> get_shared();
+
+        //! replace the instance used by the library, e.g: with one using the application's scheduler.
+        /// work already submitted to the previous instance is unaffected
+        static void set_shared(std::shared_ptr<job_system> pJobSystem);
+
+        //! makes a job system that owns worker threads
+        /// \exception invalid_argument worker count is 0
+        explicit job_system(const size_t aWorkerCount);
+
+        //! makes a job system that hands ready jobs to an application's scheduler
+        /// \exception invalid_argument the scheduler is empty
+        explicit job_system(scheduler_type aScheduler);
+
+        //! stops and joins the workers. jobs not yet started are discarded.
+        /// if a scheduler was injected, waits for the scheduler to run every job it was handed
+        ~job_system();
+
+        job_system(const job_system &) = delete;
+        job_system &operator=(const job_system &) = delete;
+    };
+}
+
+#endif
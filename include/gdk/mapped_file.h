@@ -0,0 +1,57 @@
+// © 2019 Joseph Cameron - All Rights Reserved
+
+#ifndef GDK_GFX_MAPPED_FILE_H
+#define GDK_GFX_MAPPED_FILE_H
+
+#include <cstddef>
+#include <string>
+
+namespace gdk
+{
+    /// \brief a whole file, mapped read only into the address space of the process
+    ///
+    /// \detailed pages are read by the os as they are first touched, so opening a large file is cheap,
+    /// and its contents can be handed to the graphics api without first being copied into the heap.
+    /// Uses mmap, or file mappings on Windows
+    class mapped_file final
+    {
+        //! first byte of the mapping. null if the file is empty
+        const std::byte *m_pData = nullptr;
+
+        //! size of the file in bytes
+        size_t m_Size = 0;
+
+#if defined(_WIN32)
+        //! handle of the file mapping object
+        void *m_pMapping = nullptr;
+#endif
+
+        //! unmaps the file
+        void release();
+
+    public:
+        //! contents of the file. null if the file is empty
+        const std::byte *data() const;
+
+        //! size of the file in bytes
+        size_t size() const;
+
+        //! move semantics
+        mapped_file &operator=(mapped_file &&);
+        //! move semantics
+        mapped_file(mapped_file &&);
+
+        //! disable copy semantics
+        mapped_file &operator=(const mapped_file &) = delete;
+        //! disable copy semantics
+        mapped_file(const mapped_file &) = delete;
+
+        //! maps a file
+        /// \exception runtime_error the file could not be opened or mapped
+        mapped_file(const std::string &aPath);
+
+        ~mapped_file();
+    };
+}
+
+#endif
@@ -3,6 +3,8 @@
 #ifndef GDK_GFX_MATERIAL_H
 #define GDK_GFX_MATERIAL_H
 
+#include <gdk/graphics_types.h>
+
 #include <string>
 #include <memory>
 
@@ -22,6 +24,24 @@ namespace gdk
         //! assigns a texture to the material.
         virtual void setTexture(const std::string &aTextureName, texture_ptr_type aTexture) = 0;
 
+        //! assigns a float to the material
+        virtual void setFloat(const std::string &aName, float aValue) = 0;
+
+        //! assigns a vec2 to the material
+        virtual void setVector2(const std::string &aName, const graphics_vector2_type &aValue) = 0;
+
+        //! assigns a vec3 to the material
+        virtual void setVector3(const std::string &aName, const graphics_vector3_type &aValue) = 0;
+
+        //! assigns a vec4 to the material
+        virtual void setVector4(const std::string &aName, const graphics_vector4_type &aValue) = 0;
+
+        //! assigns a mat4 to the material
+        virtual void setMatrix4x4(const std::string &aName, const graphics_mat4x4_type &aValue) = 0;
+
+        //! assigns an int to the material
+        virtual void setInteger(const std::string &aName, int aValue) = 0;
+
         virtual ~material() = default; //!< dtor
 
     protected:
@@ -0,0 +1,82 @@
+// © 2019 Joseph Cameron - All Rights Reserved
+
+#ifndef GDK_GFX_MESH_OPTIMIZER_H
+#define GDK_GFX_MESH_OPTIMIZER_H
+
+#include <cstddef>
+#include <cstdint>
+#include <optional>
+#include <vector>
+
+namespace gdk
+{
+    /// \brief reorders triangle lists so they are cheaper for the gpu to draw
+    ///
+    /// \detailed vertex data is interleaved floats, aStride components per vertex. Indexes are triangle lists.
+    /// The passes are meant to run in order: weld, optimize_vertex_cache, optimize_overdraw, optimize_vertex_fetch.
+    /// optimize runs all of them. Each pass is cpu work only, so can be run on any thread
+    namespace mesh_optimizer
+    {
+        //! type of vertex components
+        using component_type = float;
+
+        //! type of indexes
+        using index_type = std::uint32_t;
+
+        //! number of vertexes in the simulated post transform cache. A fifo of 16 is a conservative model of real hardware
+        static constexpr size_t DEFAULT_CACHE_SIZE(16);
+
+        /// \brief merges vertexes whose components are identical, bit for bit
+        /// \return indexes of the unique vertexes, one per input vertex. aVertexData is replaced by the unique vertexes,
+        /// in order of first appearance
+        /// \exception invalid_argument stride is 0, or the data is not a whole number of vertexes
+        std::vector<index_type> weld(const size_t aStride, std::vector<component_type> &aVertexData);
+
+        /// \brief reorders triangles so that their vertexes are more often still in the post transform cache,
+        /// using Tipsify (Sander, Nehab, Barczak 2007). Linear in the number of triangles
+        /// \exception invalid_argument the indexes are not a whole number of triangles
+        /// \exception out_of_range an index refers to a vertex that does not exist
+        void optimize_vertex_cache(std::vector<index_type> &aIndexData, const size_t aVertexCount,
+            const size_t aCacheSize = DEFAULT_CACHE_SIZE);
+
+        /// \brief reorders clusters of triangles so that those facing away from the mesh's centre are drawn first,
+        /// so they more often occlude the rest of the mesh. Clusters are runs of triangles that begin with a full cache miss,
+        /// so reordering them barely changes the cache efficiency of indexes given by optimize_vertex_cache.
+        /// aPositionOffset is the offset in components of a 3 component position in each vertex
+        /// \exception invalid_argument the indexes are not a whole number of triangles, or the position does not fit the stride
+        void optimize_overdraw(const size_t aStride, const size_t aPositionOffset,
+            const std::vector<component_type> &aVertexData,
+            std::vector<index_type> &aIndexData,
+            const size_t aCacheSize = DEFAULT_CACHE_SIZE);
+
+        /// \brief reorders vertexes into the order the indexes first refer to them, so vertex fetch reads memory mostly in order.
+        /// vertexes not referred to by any index are dropped
+        void optimize_vertex_fetch(const size_t aStride, std::vector<component_type> &aVertexData, std::vector<index_type> &aIndexData);
+
+        /// \brief runs all passes on a triangle list that is not indexed, e.g: 36 vertexes of a cube.
+        /// overdraw optimization is skipped if no position offset is given
+        /// \return the indexes. aVertexData is replaced by the welded and reordered vertexes
+        /// \exception invalid_argument the data is not a whole number of triangles
+        std::vector<index_type> optimize(const size_t aStride,
+            std::vector<component_type> &aVertexData,
+            const std::optional<size_t> aPositionOffset = {},
+            const size_t aCacheSize = DEFAULT_CACHE_SIZE);
+
+        /// \brief runs the reordering passes on an indexed triangle list. Vertexes are not welded
+        /// \exception invalid_argument the indexes are not a whole number of triangles
+        /// \exception out_of_range an index refers to a vertex that does not exist
+        void optimize(const size_t aStride,
+            std::vector<component_type> &aVertexData,
+            std::vector<index_type> &aIndexData,
+            const std::optional<size_t> aPositionOffset = {},
+            const size_t aCacheSize = DEFAULT_CACHE_SIZE);
+
+        /// \brief average cache miss ratio: vertex shader invocations per triangle, given a fifo post transform cache.
+        /// 3 for indexes that share nothing, approaching 0.5 for ideally ordered regular grids
+        double average_cache_miss_ratio(const std::vector<index_type> &aIndexData,
+            const size_t aVertexCount,
+            const size_t aCacheSize = DEFAULT_CACHE_SIZE);
+    }
+}
+
+#endif
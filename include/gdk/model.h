@@ -12,6 +12,9 @@ namespace gdk
     class model
     {
     public:
+        //! false while the model's data is still waiting to be uploaded to the graphics device. 
+        /// scenes skip models that are not resident
+        virtual bool isResident() const = 0;
 
         virtual ~model() = default;
 
@@ -36,6 +36,9 @@ namespace gdk
 
         //TODO image_data_2d. owns data. vec<byte>
 
+        //! false while the texture's data is still waiting to be uploaded to the graphics device
+        virtual bool isResident() const = 0;
+
         //! trivial destructor
         virtual ~texture() = default;
 
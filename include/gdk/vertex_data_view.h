@@ -3,6 +3,9 @@
 #ifndef GDK_GFX_VERTEX_DATA_VIEW_H
 #define GDK_GFX_VERTEX_DATA_VIEW_H
 
+#include <cstddef>
+#include <cstdint>
+#include <stdexcept>
 #include <string>
 #include <unordered_map>
 
@@ -14,8 +17,20 @@ public:
     /// if additional implementations are ever supported, then this could be a good way to reduce vram usage.
     using attribute_component_type = float; //TODO: gl guarantees GLfloat has a with of 32bits. c has stdlib int type widths. is there float?
 
+    //! how the components are stored on the gpu. Data is always supplied as floats, and converted when the model is made.
+    /// Smaller types reduce memory and vertex fetch bandwidth, at the cost of precision
+    enum class StorageType
+    {
+        Float, //!< 4 bytes per component
+        HalfFloat, //!< 2 bytes per component. Stored as Float if the context does not support half float attributes
+        NormalizedByte, //!< 1 byte per component, [-1, 1]. e.g: normals, tangents
+        NormalizedUnsignedByte, //!< 1 byte per component, [0, 1]. e.g: colors
+        NormalizedShort, //!< 2 bytes per component, [-1, 1]. e.g: positions of a model scaled to fit the unit cube, scaled back up by its world matrix
+        NormalizedUnsignedShort //!< 2 bytes per component, [0, 1]. e.g: uvs
+    };
+
 //private:
-    //! ptr to the beginning of the data
+    //! ptr to the first component of the first attribute
     /// \warn unowning
     attribute_component_type *m_pData; 
 
@@ -25,15 +40,56 @@ public:
     //! number of components in a single attribute
     size_t m_ComponentCount; 
 
+    //! how the components are stored on the gpu
+    StorageType m_StorageType;
+
+    //! number of bytes from the start of one attribute to the start of the next. 
+    /// the size of an attribute if the data is tightly packed
+    size_t m_Stride;
+
 public:
-    attribute_data_view(attribute_component_type *pData, size_t aDataLength, size_t aComponentCount)
+    //! a view of tightly packed attribute data
+    attribute_data_view(attribute_component_type *pData, size_t aDataLength, size_t aComponentCount, 
+        const StorageType aStorageType = StorageType::Float)
     : m_pData(pData)
     , m_DataLength(aDataLength)
     , m_ComponentCount(aComponentCount)
+    , m_StorageType(aStorageType)
+    , m_Stride(sizeof(attribute_component_type) * aComponentCount)
     {
         if (!aDataLength) throw std::invalid_argument("attribute data view must contain data");
         if (!aComponentCount) throw std::invalid_argument("attribute component count cannot be zero");
     }
+
+    /// \brief a view of an attribute stored in a buffer shared with other attributes, e.g: a buffer that is already interleaved.
+    /// aStride and aOffset are in bytes. If every attribute of a vertex_data_view shares a buffer, in the layout the context 
+    /// would interleave them to, the buffer is uploaded as is
+    /// \exception invalid_argument the stride or offset is not a whole number of components, 
+    /// or the attribute does not fit in the stride after its offset, so would overlap the next vertex
+    attribute_data_view(attribute_component_type *pBuffer, size_t aVertexCount, size_t aComponentCount, 
+        size_t aStride, size_t aOffset,
+        const StorageType aStorageType = StorageType::Float)
+    : m_pData(pBuffer + (aOffset / sizeof(attribute_component_type)))
+    , m_DataLength(aVertexCount * aComponentCount)
+    , m_ComponentCount(aComponentCount)
+    , m_StorageType(aStorageType)
+    , m_Stride(aStride)
+    {
+        if (!aVertexCount) throw std::invalid_argument("attribute data view must contain data");
+        if (!aComponentCount) throw std::invalid_argument("attribute component count cannot be zero");
+        if (aStride % sizeof(attribute_component_type) || aOffset % sizeof(attribute_component_type)) 
+            throw std::invalid_argument("attribute stride and offset must be whole numbers of components");
+        if (aStride < sizeof(attribute_component_type) * aComponentCount) 
+            throw std::invalid_argument("attribute stride must be at least the size of an attribute");
+        if (aOffset + (sizeof(attribute_component_type) * aComponentCount) > aStride)
+            throw std::invalid_argument("attribute must end within the stride, or it would overlap the next vertex");
+    }
+
+    //! true if the attributes are tightly packed
+    bool isPacked() const
+    {
+        return m_Stride == sizeof(attribute_component_type) * m_ComponentCount;
+    }
 };
 
 //! used to construct a model
@@ -41,25 +97,66 @@ public:
 class vertex_data_view
 {
 public:
+    //! how often the data will be replaced, see graphics::context::update_model
     enum class UsageHint
     {
-        Static,
-        Dynamic,
-        Streaming
+        Static, //!< made once, drawn many times
+        Dynamic, //!< replaced often, drawn many times
+        Streaming //!< replaced often, drawn a few times
+    };
+
+    //! preprocessing done to the data before it is uploaded
+    enum class Optimization
+    {
+        //! uploaded as given
+        None,
+
+        //! the data is a triangle list. If the view has no indexes, identical vertexes are welded into an indexed model. 
+        /// Then triangles are reordered for the post transform cache and overdraw, and vertexes for fetch locality.
+        /// An "a_Position" attribute of 3 components is used for the overdraw ordering. see mesh_optimizer
+        Full
     };
 
     using attribute_data_type = std::unordered_map<std::string, attribute_data_view>;
 
+    //! type of index data
+    using index_type = std::uint32_t;
+
 //private:
     UsageHint m_Usage;
 
     attribute_data_type m_AttributeData;
 
+    Optimization m_Optimization;
+
+    //! ptr to the beginning of the index data. null if the vertexes are drawn in order
+    /// \warn unowning
+    const index_type *m_pIndexData = nullptr;
+
+    //! number of indexes
+    size_t m_IndexCount = 0;
+
 public:
-    vertex_data_view(const UsageHint aUsage, const attribute_data_type &aAttributeData)
+    vertex_data_view(const UsageHint aUsage, const attribute_data_type &aAttributeData, const Optimization aOptimization = Optimization::None)
     : m_Usage(aUsage)
     , m_AttributeData(aAttributeData)
+    , m_Optimization(aOptimization)
     {}
+
+    //! a view of indexed vertex data. Indexes refer to vertexes of the attribute data
+    vertex_data_view(const UsageHint aUsage, 
+        const attribute_data_type &aAttributeData, 
+        const index_type *const pIndexData, 
+        const size_t aIndexCount, 
+        const Optimization aOptimization = Optimization::None)
+    : m_Usage(aUsage)
+    , m_AttributeData(aAttributeData)
+    , m_Optimization(aOptimization)
+    , m_pIndexData(pIndexData)
+    , m_IndexCount(aIndexCount)
+    {
+        if (!pIndexData && aIndexCount) throw std::invalid_argument("index data view must point to data");
+    }
 };
 
 #endif
@@ -0,0 +1,40 @@
+// © 2019 Joseph Cameron - All Rights Reserved
+
+#ifndef GDK_GFX_VERTEX_QUANTIZER_H
+#define GDK_GFX_VERTEX_QUANTIZER_H
+
+#include <cstddef>
+#include <cstdint>
+
+namespace gdk
+{
+    /// \brief converts float vertex components to smaller types, to reduce the memory and fetch bandwidth of vertex data
+    ///
+    /// \detailed normalized conversions clamp to the type's range, then round to nearest. Signed types are encoded for
+    /// gles2 and webgl1, which read a code c of b bits as (2c + 1) / (2^b - 1): +-1 are exact, but 0 is not.
+    /// NaN converts to the lowest value of the type.
+    /// Runs 8 or 16 components at a time with SSE2, and F16C for half floats, when the target supports them.
+    /// Source and destination must not overlap
+    namespace vertex_quantizer
+    {
+        //! to IEEE 754 half precision floats, rounding to nearest even. Out of range values become infinity
+        void to_half(const float *const pSource, std::uint16_t *const pDestination, const size_t aCount);
+
+        //! from [-1, 1] to [-128, 127]
+        void to_snorm8(const float *const pSource, std::int8_t *const pDestination, const size_t aCount);
+
+        //! from [0, 1] to [0, 255]
+        void to_unorm8(const float *const pSource, std::uint8_t *const pDestination, const size_t aCount);
+
+        //! from [-1, 1] to [-32768, 32767]
+        void to_snorm16(const float *const pSource, std::int16_t *const pDestination, const size_t aCount);
+
+        //! from [0, 1] to [0, 65535]
+        void to_unorm16(const float *const pSource, std::uint16_t *const pDestination, const size_t aCount);
+
+        //! a half precision float as a float. exact
+        float from_half(const std::uint16_t aHalf);
+    }
+}
+
+#endif
@@ -0,0 +1,193 @@
+// © 2019 Joseph Cameron - All Rights Reserved
+
+#ifndef GDK_GFX_WORK_STEALING_DEQUE_H
+#define GDK_GFX_WORK_STEALING_DEQUE_H
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <optional>
+#include <type_traits>
+#include <vector>
+
+namespace gdk
+{
+    /// \brief Chase-Lev work stealing deque
+    ///
+    /// \detailed the owning thread pushes and pops at the bottom, like a stack, so it works on the most recently created,
+    /// cache warm items. Any other thread can steal from the top, taking the oldest items, which tend to be the largest
+    /// pieces of remaining work. Owner operations only synchronize with thieves when the deque is nearly empty.
+    /// Grows when full. Outgrown arrays are kept until destruction, since a thief may still be reading one.
+    /// Based on "Correct and Efficient Work-Stealing for Weak Memory Models", Lê et al. 2013
+    /// \warn push and pop must only be called by the owning thread
+    template<typename value_type>
+    class work_stealing_deque final
+    {
+        static_assert(std::is_trivially_copyable<value_type>::value, "values are copied without synchronization; must be trivially copyable");
+
+        //! circular array of values
+        class ring final
+        {
+            //! capacity - 1. capacity is a power of 2
+            const std::int64_t m_Mask;
+
+            //! storage
+            std::unique_ptr<std::atomic<value_type>[]> m_Values;
+
+        public:
+            std::int64_t capacity() const
+            {
+                return m_Mask + 1;
+            }
+
+            value_type get(const std::int64_t aIndex) const
+            {
+                return m_Values[aIndex & m_Mask].load(std::memory_order_relaxed);
+            }
+
+            void put(const std::int64_t aIndex, const value_type aValue)
+            {
+                m_Values[aIndex & m_Mask].store(aValue, std::memory_order_relaxed);
+            }
+
+            //! copy of this ring with double the capacity
+            std::unique_ptr<ring> grow(const std::int64_t aTop, const std::int64_t aBottom) const
+            {
+                auto pRing = std::make_unique<ring>(capacity() * 2);
+
+                for (auto i(aTop); i < aBottom; ++i) pRing->put(i, get(i));
+
+                return pRing;
+            }
+
+            explicit ring(const std::int64_t aCapacity)
+            : m_Mask(aCapacity - 1)
+            , m_Values(new std::atomic<value_type>[static_cast<size_t>(aCapacity)])
+            {}
+        };
+
+        //! index of the oldest value. advanced by steals, and by the owner popping the last value
+        alignas(64) std::atomic<std::int64_t> m_Top{0};
+
+        //! index one past the newest value. only written by the owner
+        alignas(64) std::atomic<std::int64_t> m_Bottom{0};
+
+        //! the current array
+        std::atomic<ring *> m_pRing;
+
+        //! all arrays, current and outgrown. only accessed by the owner
+        std::vector<std::unique_ptr<ring>> m_Rings;
+
+    public:
+        //! add a value at the bottom. owner only
+        void push(const value_type aValue)
+        {
+            const auto bottom = m_Bottom.load(std::memory_order_relaxed);
+            const auto top = m_Top.load(std::memory_order_acquire);
+
+            auto pRing = m_pRing.load(std::memory_order_relaxed);
+
+            if (bottom - top > pRing->capacity() - 1)
+            {
+                m_Rings.push_back(pRing->grow(top, bottom));
+
+                pRing = m_Rings.back().get();
+
+                m_pRing.store(pRing, std::memory_order_release);
+            }
+
+            pRing->put(bottom, aValue);
+
+            std::atomic_thread_fence(std::memory_order_release);
+
+            m_Bottom.store(bottom + 1, std::memory_order_relaxed);
+        }
+
+        //! remove the newest value. owner only
+        /// \return empty if the deque is empty, or a thief took the last value
+        std::optional<value_type> pop()
+        {
+            const auto bottom = m_Bottom.load(std::memory_order_relaxed) - 1;
+
+            const auto pRing = m_pRing.load(std::memory_order_relaxed);
+
+            m_Bottom.store(bottom, std::memory_order_relaxed);
+
+            std::atomic_thread_fence(std::memory_order_seq_cst);
+
+            auto top = m_Top.load(std::memory_order_relaxed);
+
+            std::optional<value_type> value;
+
+            if (top <= bottom)
+            {
+                value = pRing->get(bottom);
+
+                if (top == bottom)
+                {
+                    // the last value: race thieves for it
+                    if (!m_Top.compare_exchange_strong(top, top + 1, std::memory_order_seq_cst, std::memory_order_relaxed)) value.reset();
+
+                    m_Bottom.store(bottom + 1, std::memory_order_relaxed);
+                }
+            }
+            else m_Bottom.store(bottom + 1, std::memory_order_relaxed);
+
+            return value;
+        }
+
+        //! remove the oldest value. any thread
+        /// \return empty if the deque is empty, or another thread won the race for the value
+        std::optional<value_type> steal()
+        {
+            auto top = m_Top.load(std::memory_order_acquire);
+
+            std::atomic_thread_fence(std::memory_order_seq_cst);
+
+            const auto bottom = m_Bottom.load(std::memory_order_acquire);
+
+            if (top < bottom)
+            {
+                const auto value = m_pRing.load(std::memory_order_acquire)->get(top);
+
+                if (m_Top.compare_exchange_strong(top, top + 1, std::memory_order_seq_cst, std::memory_order_relaxed)) return value;
+            }
+
+            return {};
+        }
+
+        //! approximate number of values. any thread
+        size_t size() const
+        {
+            const auto bottom = m_Bottom.load(std::memory_order_relaxed);
+            const auto top = m_Top.load(std::memory_order_relaxed);
+
+            return bottom > top ? static_cast<size_t>(bottom - top) : 0;
+        }
+
+        //! check if the deque is approximately empty. any thread
+        bool empty() const
+        {
+            return !size();
+        }
+
+        //! constructs an empty deque
+        /// \param aInitialCapacity rounded up to a power of 2
+        explicit work_stealing_deque(const size_t aInitialCapacity = 64)
+        {
+            std::int64_t capacity(1);
+
+            while (capacity < static_cast<std::int64_t>(aInitialCapacity)) capacity *= 2;
+
+            m_Rings.push_back(std::make_unique<ring>(capacity));
+
+            m_pRing.store(m_Rings.back().get(), std::memory_order_relaxed);
+        }
+
+        work_stealing_deque(const work_stealing_deque &) = delete;
+        work_stealing_deque &operator=(const work_stealing_deque &) = delete;
+    };
+}
+
+#endif
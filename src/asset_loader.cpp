@@ -0,0 +1,556 @@
+// © 2019 Joseph Cameron - All Rights Reserved
+
+#include <gdk/asset_loader.h>
+
+#include <stb/stb_image.h>
+
+#include <atomic>
+#include <condition_variable>
+#include <exception>
+#include <fstream>
+#include <iterator>
+#include <mutex>
+#include <queue>
+#include <stdexcept>
+
+using namespace gdk;
+
+static constexpr char TAG[] = "asset_loader";
+
+class asset_loader::request final
+{
+public:
+    //! kinds of resources
+    enum class resource_kind
+    {
+        texture,
+        model,
+        shader
+    };
+
+    //! kind of resource being loaded
+    const resource_kind kind;
+
+    //! files to read
+    const std::vector<std::string> paths;
+
+    //! decodes model files
+    const model_decoder_type modelDecoder;
+
+    //! higher starts first. guarded by the loader's mutex
+    int priority;
+
+    //! progress. written under the loader's mutex
+    std::atomic<load_state> state{load_state::queued};
+
+    //! set by cancel, checked between the stages of the load
+    std::atomic<bool> isCancelRequested{false};
+
+    //! the resource, once ready
+    std::shared_ptr<void> pResult;
+
+    //! thrown by the load, once failed
+    std::exception_ptr exception;
+
+    //! shader sources, between being read and being compiled
+    std::vector<std::string> shaderSources;
+
+    //! called by update once the load is done. guarded by the loader's mutex
+    std::function<void()> resume;
+
+    //! the loader, if it still exists
+    std::weak_ptr<shared_state> pLoader;
+
+    request(const resource_kind aKind, std::vector<std::string> aPaths, model_decoder_type aModelDecoder, const int aPriority)
+    : kind(aKind)
+    , paths(std::move(aPaths))
+    , modelDecoder(std::move(aModelDecoder))
+    , priority(aPriority)
+    {}
+};
+
+//! a load waiting in a priority queue
+struct queue_entry final
+{
+    int priority; //!< priority of the load when queued. the entry is stale if the load's priority has since changed
+    size_t sequence; //!< orders loads of equal priority first come, first served
+    std::shared_ptr<asset_loader::request> pRequest; //!< the load
+};
+
+//! orders a priority queue highest priority first, then oldest first
+struct queue_entry_order final
+{
+    bool operator()(const queue_entry &a, const queue_entry &b) const
+    {
+        if (a.priority != b.priority) return a.priority < b.priority;
+
+        return a.sequence > b.sequence;
+    }
+};
+
+using priority_queue_type = std::priority_queue<queue_entry, std::vector<queue_entry>, queue_entry_order>;
+
+struct asset_loader::shared_state final
+{
+    //! makes the resources
+    const graphics::context &context;
+
+    //! runs the loads
+    const std::shared_ptr<job_system> pJobSystem;
+
+    //! number of loads reading or decoding at once
+    const size_t maxLoadsInFlight;
+
+    //! guards the members below, and the mutable state of requests
+    std::mutex mutex;
+
+    //! notified when a job is done with the state
+    std::condition_variable loadFinished;
+
+    //! loads waiting for a free slot
+    priority_queue_type queued;
+
+    //! shaders whose sources have been read, waiting for update
+    priority_queue_type shaders;
+
+    //! functions resuming coroutines whose loads are done
+    std::vector<std::function<void()>> resumable;
+
+    //! number of loads running in jobs
+    size_t loadsInFlight = 0;
+
+    /// \brief number of jobs not yet done with the state
+    /// \attention jobs refer to the state without owning it, so the loader's destructor waits for this to reach 0.
+    /// if jobs owned it, the last reference could be dropped on a worker, which would then join itself in ~job_system
+    size_t runningJobs = 0;
+
+    //! number of loads not done
+    size_t unfinishedCount = 0;
+
+    //! next queue entry sequence number
+    size_t sequence = 0;
+
+    //! set on destruction. no more loads are started
+    bool isStopping = false;
+
+    shared_state(const graphics::context &aContext, std::shared_ptr<job_system> pJobSystem, const size_t aMaxLoadsInFlight)
+    : context(aContext)
+    , pJobSystem(std::move(pJobSystem))
+    , maxLoadsInFlight(aMaxLoadsInFlight)
+    {}
+};
+
+//! marks a load done. the loader's mutex must be held
+static void finish(asset_loader::shared_state &aState, asset_loader::request &aRequest, const asset_loader::load_state aLoadState)
+{
+    const auto state = aRequest.state.load();
+
+    if (state != asset_loader::load_state::queued && state != asset_loader::load_state::loading) return;
+
+    aRequest.state.store(aLoadState);
+    aRequest.shaderSources.clear();
+
+    --aState.unfinishedCount;
+
+    if (aRequest.resume) aState.resumable.push_back(std::move(aRequest.resume));
+}
+
+//! reads a whole file
+static std::vector<std::byte> read_file(const std::string &aPath)
+{
+    std::ifstream file(aPath, std::ios::binary | std::ios::ate);
+
+    if (!file) throw std::runtime_error(std::string(TAG).append(": could not open \"").append(aPath).append("\""));
+
+    std::vector<std::byte> data(static_cast<size_t>(file.tellg()));
+
+    file.seekg(0);
+
+    if (!file.read(reinterpret_cast<char *>(data.data()), static_cast<std::streamsize>(data.size())))
+        throw std::runtime_error(std::string(TAG).append(": could not read \"").append(aPath).append("\""));
+
+    return data;
+}
+
+//! decodes an image file and makes a pending texture from it
+static std::shared_ptr<texture> make_texture(const graphics::context &aContext, const std::vector<std::byte> &aFileData)
+{
+    int width, height, components;
+
+    std::unique_ptr<stbi_uc, void(*)(stbi_uc *)> pDecoded(stbi_load_from_memory(
+            reinterpret_cast<const stbi_uc *>(aFileData.data()),
+            static_cast<int>(aFileData.size()),
+            &width,
+            &height,
+            &components,
+            STBI_rgb_alpha),
+        [](stbi_uc *p)
+        {
+            stbi_image_free(p);
+        });
+
+    if (!pDecoded) throw std::runtime_error(std::string(TAG).append(": could not decode image: ").append(stbi_failure_reason()));
+
+    texture::image_data_2d_view view;
+    view.width = static_cast<size_t>(width);
+    view.height = static_cast<size_t>(height);
+    view.format = texture::data_format::rgba;
+    view.data = reinterpret_cast<std::byte *>(pDecoded.get());
+
+    return aContext.make_pending_texture(view);
+}
+
+//! decodes a model file and makes a pending model from it
+static std::shared_ptr<model> make_model(const graphics::context &aContext, const asset_loader::model_decoder_type &aDecoder,
+    const std::vector<std::byte> &aFileData)
+{
+    auto data = aDecoder(aFileData);
+
+    vertex_data_view::attribute_data_type attributes;
+
+    for (auto &[name, attribute] : data.attributes)
+    {
+        auto &[componentCount, components] = attribute;
+
+        attributes.insert({name, attribute_data_view(components.data(), components.size(), componentCount)});
+    }
+
+    return aContext.make_pending_model(vertex_data_view(data.usage, attributes));
+}
+
+//! starts queued loads while there are free slots
+static void start_queued_loads(asset_loader::shared_state &aState);
+
+//! body of a load's job
+static void run(asset_loader::shared_state &aState, const std::shared_ptr<asset_loader::request> &pRequest)
+{
+    using request = asset_loader::request;
+
+    const auto finishLoad = [&aState, &pRequest](const asset_loader::load_state aLoadState)
+    {
+        std::lock_guard<std::mutex> lock(aState.mutex);
+
+        finish(aState, *pRequest, aLoadState);
+    };
+
+    try
+    {
+        std::vector<std::vector<std::byte>> files;
+
+        for (const auto &path : pRequest->paths)
+        {
+            if (pRequest->isCancelRequested.load()) break;
+
+            files.push_back(read_file(path));
+        }
+
+        if (pRequest->isCancelRequested.load()) finishLoad(asset_loader::load_state::cancelled);
+        else switch (pRequest->kind)
+        {
+            case request::resource_kind::texture:
+            {
+                pRequest->pResult = make_texture(aState.context, files.front());
+
+                finishLoad(asset_loader::load_state::ready);
+            } break;
+
+            case request::resource_kind::model:
+            {
+                pRequest->pResult = make_model(aState.context, pRequest->modelDecoder, files.front());
+
+                finishLoad(asset_loader::load_state::ready);
+            } break;
+
+            case request::resource_kind::shader:
+            {
+                for (const auto &file : files) pRequest->shaderSources.push_back(
+                    std::string(reinterpret_cast<const char *>(file.data()), file.size()));
+
+                // compiling needs the graphics api context, so is left to update
+                std::lock_guard<std::mutex> lock(aState.mutex);
+
+                aState.shaders.push({pRequest->priority, aState.sequence++, pRequest});
+            } break;
+        }
+    }
+    catch (...)
+    {
+        pRequest->exception = std::current_exception();
+
+        finishLoad(asset_loader::load_state::failed);
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(aState.mutex);
+
+        --aState.loadsInFlight;
+    }
+
+    start_queued_loads(aState);
+
+    // the last use of the state. notified under the lock, since the loader's destructor may destroy the state once it is released
+    std::lock_guard<std::mutex> lock(aState.mutex);
+
+    --aState.runningJobs;
+
+    aState.loadFinished.notify_all();
+}
+
+static void start_queued_loads(asset_loader::shared_state &aState)
+{
+    std::vector<std::shared_ptr<asset_loader::request>> starting;
+
+    {
+        std::lock_guard<std::mutex> lock(aState.mutex);
+
+        while (!aState.isStopping && aState.loadsInFlight < aState.maxLoadsInFlight && !aState.queued.empty())
+        {
+            auto entry = aState.queued.top();
+
+            aState.queued.pop();
+
+            // cancelled, or requeued at another priority
+            if (entry.pRequest->state.load() != asset_loader::load_state::queued ||
+                entry.priority != entry.pRequest->priority) continue;
+
+            entry.pRequest->state.store(asset_loader::load_state::loading);
+
+            ++aState.loadsInFlight;
+            ++aState.runningJobs;
+
+            starting.push_back(std::move(entry.pRequest));
+        }
+    }
+
+    for (auto &pRequest : starting) aState.pJobSystem->submit([pState = &aState, pRequest]()
+    {
+        run(*pState, pRequest);
+    });
+}
+
+asset_loader::load_handle_base::load_handle_base(std::shared_ptr<request> pRequest)
+: m_pRequest(std::move(pRequest))
+{}
+
+asset_loader::load_state asset_loader::load_handle_base::get_state() const
+{
+    return m_pRequest->state.load();
+}
+
+bool asset_loader::load_handle_base::is_done() const
+{
+    const auto state = get_state();
+
+    return state != load_state::queued && state != load_state::loading;
+}
+
+void asset_loader::load_handle_base::cancel()
+{
+    m_pRequest->isCancelRequested.store(true);
+
+    // a queued load is done now. a load in progress stops at its next stage
+    if (const auto pState = m_pRequest->pLoader.lock())
+    {
+        std::lock_guard<std::mutex> lock(pState->mutex);
+
+        if (m_pRequest->state.load() == load_state::queued) finish(*pState, *m_pRequest, load_state::cancelled);
+    }
+}
+
+std::shared_ptr<void> asset_loader::load_handle_base::get_result() const
+{
+    switch (get_state())
+    {
+        case load_state::ready: return m_pRequest->pResult;
+
+        case load_state::failed: std::rethrow_exception(m_pRequest->exception);
+
+        case load_state::cancelled: throw std::runtime_error(std::string(TAG).append(": load was cancelled"));
+
+        default: throw std::runtime_error(std::string(TAG).append(": load is not finished"));
+    }
+}
+
+bool asset_loader::load_handle_base::resume_when_done(std::function<void()> aResume) const
+{
+    // the loader finishes every load before it is destroyed
+    if (const auto pState = m_pRequest->pLoader.lock())
+    {
+        std::lock_guard<std::mutex> lock(pState->mutex);
+
+        if (is_done()) return false;
+
+        m_pRequest->resume = std::move(aResume);
+
+        return true;
+    }
+
+    return false;
+}
+
+asset_loader::asset_loader(const graphics::context &aContext, std::shared_ptr<job_system> pJobSystem, const size_t aMaxLoadsInFlight)
+{
+    if (!pJobSystem) throw std::invalid_argument(std::string(TAG).append(": job system must not be null"));
+    if (!aMaxLoadsInFlight) throw std::invalid_argument(std::string(TAG).append(": max loads in flight must be at least 1"));
+
+    m_pState = std::make_shared<shared_state>(aContext, std::move(pJobSystem), aMaxLoadsInFlight);
+}
+
+asset_loader::~asset_loader()
+{
+    std::vector<std::function<void()>> resumable;
+
+    {
+        std::unique_lock<std::mutex> lock(m_pState->mutex);
+
+        m_pState->isStopping = true;
+
+        for (; !m_pState->queued.empty(); m_pState->queued.pop())
+        {
+            const auto &pRequest = m_pState->queued.top().pRequest;
+
+            pRequest->isCancelRequested.store(true);
+
+            finish(*m_pState, *pRequest, load_state::cancelled);
+        }
+
+        // loads in flight refer to the context, and their jobs to the state
+        m_pState->loadFinished.wait(lock, [this]()
+        {
+            return !m_pState->runningJobs;
+        });
+
+        for (; !m_pState->shaders.empty(); m_pState->shaders.pop())
+            finish(*m_pState, *m_pState->shaders.top().pRequest, load_state::cancelled);
+
+        resumable.swap(m_pState->resumable);
+    }
+
+    for (auto &resume : resumable) resume();
+}
+
+std::shared_ptr<asset_loader::request> asset_loader::enqueue(std::shared_ptr<request> pRequest)
+{
+    pRequest->pLoader = m_pState;
+
+    {
+        std::lock_guard<std::mutex> lock(m_pState->mutex);
+
+        ++m_pState->unfinishedCount;
+
+        m_pState->queued.push({pRequest->priority, m_pState->sequence++, pRequest});
+    }
+
+    start_queued_loads(*m_pState);
+
+    return pRequest;
+}
+
+asset_loader::load_handle<texture> asset_loader::load_texture(const std::string &aPath, const int aPriority)
+{
+    return enqueue(std::make_shared<request>(request::resource_kind::texture,
+        std::vector<std::string>({aPath}), nullptr, aPriority));
+}
+
+asset_loader::load_handle<model> asset_loader::load_model(const std::string &aPath, model_decoder_type aDecoder, const int aPriority)
+{
+    if (!aDecoder) throw std::invalid_argument(std::string(TAG).append(": model decoder must not be empty"));
+
+    return enqueue(std::make_shared<request>(request::resource_kind::model,
+        std::vector<std::string>({aPath}), std::move(aDecoder), aPriority));
+}
+
+asset_loader::load_handle<shader_program> asset_loader::load_shader(const std::string &aVertexPath, const std::string &aFragmentPath,
+    const int aPriority)
+{
+    return enqueue(std::make_shared<request>(request::resource_kind::shader,
+        std::vector<std::string>({aVertexPath, aFragmentPath}), nullptr, aPriority));
+}
+
+void asset_loader::set_priority(const load_handle_base &aLoad, const int aPriority)
+{
+    const auto &pRequest = aLoad.m_pRequest;
+
+    {
+        std::lock_guard<std::mutex> lock(m_pState->mutex);
+
+        if (pRequest->state.load() != load_state::queued || pRequest->priority == aPriority) return;
+
+        // the entry at the old priority becomes stale
+        pRequest->priority = aPriority;
+
+        m_pState->queued.push({aPriority, m_pState->sequence++, pRequest});
+    }
+}
+
+size_t asset_loader::update(const std::chrono::microseconds aTimeBudget)
+{
+    const auto start = std::chrono::steady_clock::now();
+
+    size_t compiledCount(0);
+
+    for (;;)
+    {
+        std::shared_ptr<request> pRequest;
+
+        {
+            std::lock_guard<std::mutex> lock(m_pState->mutex);
+
+            if (m_pState->shaders.empty()) break;
+
+            pRequest = m_pState->shaders.top().pRequest;
+
+            m_pState->shaders.pop();
+
+            if (pRequest->isCancelRequested.load())
+            {
+                finish(*m_pState, *pRequest, load_state::cancelled);
+
+                continue;
+            }
+        }
+
+        auto state = load_state::ready;
+
+        try
+        {
+            pRequest->pResult = std::shared_ptr<shader_program>(
+                m_pState->context.make_shader(pRequest->shaderSources[0], pRequest->shaderSources[1]));
+        }
+        catch (...)
+        {
+            pRequest->exception = std::current_exception();
+
+            state = load_state::failed;
+        }
+
+        {
+            std::lock_guard<std::mutex> lock(m_pState->mutex);
+
+            finish(*m_pState, *pRequest, state);
+        }
+
+        ++compiledCount;
+
+        if (std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - start) >= aTimeBudget) break;
+    }
+
+    std::vector<std::function<void()>> resumable;
+
+    {
+        std::lock_guard<std::mutex> lock(m_pState->mutex);
+
+        resumable.swap(m_pState->resumable);
+    }
+
+    for (auto &resume : resumable) resume();
+
+    return compiledCount;
+}
+
+size_t asset_loader::get_loading_count() const
+{
+    std::lock_guard<std::mutex> lock(m_pState->mutex);
+
+    return m_pState->unfinishedCount;
+}
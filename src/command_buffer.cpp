@@ -0,0 +1,193 @@
+// © 2019 Joseph Cameron - All Rights Reserved
+
+#include <gdk/command_buffer.h>
+
+#include <mutex>
+#include <stdexcept>
+#include <unordered_map>
+
+using namespace gdk;
+
+static constexpr char TAG[] = "command_buffer";
+
+//! guards the uniform name tables
+static std::mutex s_UniformNameMutex;
+
+//! uniform names to their handles
+static std::unordered_map<std::string, command_buffer::uniform_handle> s_UniformNameToHandle;
+
+//! uniform names, indexed by handle
+static std::vector<std::string> s_UniformHandleToName;
+
+command_buffer::uniform_handle command_buffer::get_uniform_handle(const std::string &aName)
+{
+    std::lock_guard<std::mutex> lock(s_UniformNameMutex);
+
+    if (const auto search = s_UniformNameToHandle.find(aName); search != s_UniformNameToHandle.end()) return search->second;
+
+    const auto handle = static_cast<uniform_handle>(s_UniformHandleToName.size());
+
+    s_UniformHandleToName.push_back(aName);
+
+    s_UniformNameToHandle[aName] = handle;
+
+    return handle;
+}
+
+std::string command_buffer::get_uniform_name(const uniform_handle aUniform)
+{
+    std::lock_guard<std::mutex> lock(s_UniformNameMutex);
+
+    if (aUniform >= s_UniformHandleToName.size()) throw std::invalid_argument(std::string(TAG).append(": invalid uniform handle"));
+
+    return s_UniformHandleToName[aUniform];
+}
+
+void command_buffer::push(const command_type aType, const void *pPayload, const std::uint32_t aSize)
+{
+    const command_header header{aType, aSize};
+
+    const auto offset = m_Data.size();
+
+    m_Data.resize(offset + sizeof(command_header) + aSize);
+
+    std::memcpy(&m_Data[offset], &header, sizeof(command_header));
+    std::memcpy(&m_Data[offset + sizeof(command_header)], pPayload, aSize);
+
+    ++m_CommandCount;
+}
+
+void command_buffer::push_uniform(const uniform_handle aUniform, const uniform_type aType, const float *pFloats, const size_t aCount)
+{
+    set_uniform_command command;
+    command.uniform = aUniform;
+    command.type = aType;
+
+    std::memcpy(command.floats, pFloats, sizeof(float) * aCount);
+
+    push(command_type::set_uniform, &command, sizeof(command));
+}
+
+void command_buffer::set_camera(const graphics_mat4x4_type &aViewMatrix,
+    const graphics_mat4x4_type &aProjectionMatrix,
+    const graphics_vector3_type &aPosition)
+{
+    set_camera_command command;
+
+    std::memcpy(command.viewMatrix, &aViewMatrix.m[0][0], sizeof(command.viewMatrix));
+    std::memcpy(command.projectionMatrix, &aProjectionMatrix.m[0][0], sizeof(command.projectionMatrix));
+
+    command.position[0] = aPosition.x;
+    command.position[1] = aPosition.y;
+    command.position[2] = aPosition.z;
+
+    push(command_type::set_camera, &command, sizeof(command));
+}
+
+void command_buffer::bind_material(std::shared_ptr<material> pMaterial)
+{
+    if (!pMaterial) throw std::invalid_argument(std::string(TAG).append(": material must not be null"));
+
+    const bind_material_command command{static_cast<std::uint32_t>(m_Materials.size())};
+
+    m_Materials.push_back(std::move(pMaterial));
+
+    push(command_type::bind_material, &command, sizeof(command));
+}
+
+void command_buffer::bind_model(std::shared_ptr<model> pModel)
+{
+    if (!pModel) throw std::invalid_argument(std::string(TAG).append(": model must not be null"));
+
+    const bind_model_command command{static_cast<std::uint32_t>(m_Models.size())};
+
+    m_Models.push_back(std::move(pModel));
+
+    push(command_type::bind_model, &command, sizeof(command));
+}
+
+void command_buffer::set_uniform(const uniform_handle aUniform, const float aValue)
+{
+    push_uniform(aUniform, uniform_type::float1, &aValue, 1);
+}
+
+void command_buffer::set_uniform(const uniform_handle aUniform, const graphics_vector2_type &aValue)
+{
+    const float data[] = {aValue.x, aValue.y};
+
+    push_uniform(aUniform, uniform_type::float2, data, 2);
+}
+
+void command_buffer::set_uniform(const uniform_handle aUniform, const graphics_vector3_type &aValue)
+{
+    const float data[] = {aValue.x, aValue.y, aValue.z};
+
+    push_uniform(aUniform, uniform_type::float3, data, 3);
+}
+
+void command_buffer::set_uniform(const uniform_handle aUniform, const graphics_vector4_type &aValue)
+{
+    const float data[] = {aValue.x, aValue.y, aValue.z, aValue.w};
+
+    push_uniform(aUniform, uniform_type::float4, data, 4);
+}
+
+void command_buffer::set_uniform(const uniform_handle aUniform, const graphics_mat4x4_type &aValue)
+{
+    push_uniform(aUniform, uniform_type::mat4x4, &aValue.m[0][0], 16);
+}
+
+void command_buffer::set_uniform(const uniform_handle aUniform, const std::int32_t aValue)
+{
+    set_uniform_command command;
+    command.uniform = aUniform;
+    command.type = uniform_type::integer1;
+    command.integer = aValue;
+
+    push(command_type::set_uniform, &command, sizeof(command));
+}
+
+void command_buffer::set_state(const state_key_type aKey)
+{
+    const set_state_command command{aKey};
+
+    push(command_type::set_state, &command, sizeof(command));
+}
+
+void command_buffer::draw(const graphics_mat4x4_type &aModelMatrix)
+{
+    draw_command command;
+
+    std::memcpy(command.modelMatrix, &aModelMatrix.m[0][0], sizeof(command.modelMatrix));
+
+    push(command_type::draw, &command, sizeof(command));
+}
+
+size_t command_buffer::size() const
+{
+    return m_CommandCount;
+}
+
+bool command_buffer::empty() const
+{
+    return !m_CommandCount;
+}
+
+void command_buffer::clear()
+{
+    m_Data.clear();
+    m_Materials.clear();
+    m_Models.clear();
+
+    m_CommandCount = 0;
+}
+
+const std::shared_ptr<material> &command_buffer::get_material(const std::uint32_t aIndex) const
+{
+    return m_Materials.at(aIndex);
+}
+
+const std::shared_ptr<model> &command_buffer::get_model(const std::uint32_t aIndex) const
+{
+    return m_Models.at(aIndex);
+}
@@ -0,0 +1,1169 @@
+// © 2019 Joseph Cameron - All Rights Reserved
+
+#include <gdk/gltf_importer.h>
+
+#include <stb/stb_image.h>
+
+#include <algorithm>
+#include <cctype>
+#include <climits>
+#include <cmath>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <exception>
+#include <limits>
+#include <stdexcept>
+#include <string>
+#include <utility>
+
+using namespace gdk;
+
+static constexpr char TAG[] = "gltf_importer";
+
+//! number of elements of an accessor converted by one job
+static constexpr size_t CONVERSION_GRAIN_SIZE = 1 << 16;
+
+//! deepest nesting of json arrays and objects accepted
+static constexpr size_t MAX_JSON_DEPTH = 64;
+
+//! "glTF", first 4 bytes of a glb file
+static constexpr std::uint32_t GLB_MAGIC = 0x46546c67;
+
+//! "JSON", type of a glb's json chunk
+static constexpr std::uint32_t GLB_JSON_CHUNK = 0x4e4f534a;
+
+//! "BIN", type of a glb's binary buffer chunk
+static constexpr std::uint32_t GLB_BINARY_CHUNK = 0x004e4942;
+
+//! accessor component types
+enum component_type : size_t
+{
+    byte_component = 5120,
+    unsigned_byte_component = 5121,
+    short_component = 5122,
+    unsigned_short_component = 5123,
+    unsigned_int_component = 5125,
+    float_component = 5126
+};
+
+static std::runtime_error make_error(const std::string &aWhat)
+{
+    return std::runtime_error(std::string(TAG).append(": ").append(aWhat));
+}
+
+//! a parsed json value
+struct json_value final
+{
+    enum class kind
+    {
+        null,
+        boolean,
+        number,
+        string,
+        array,
+        object
+    };
+
+    kind type = kind::null;
+
+    bool boolean = false;
+
+    double number = 0;
+
+    std::string string;
+
+    std::vector<json_value> array;
+
+    //! members in file order. objects in gltf files are small, so are searched linearly
+    std::vector<std::pair<std::string, json_value>> object;
+
+    //! a member of an object. null if absent, or if the value is not an object
+    const json_value *find(const std::string &aName) const
+    {
+        for (const auto &[name, value] : object) if (name == aName) return &value;
+
+        return nullptr;
+    }
+};
+
+//! recursive descent parser of json text
+class json_parser final
+{
+    const char *const m_pBegin;
+
+    const char *const m_pEnd;
+
+    const char *m_pCurrent;
+
+    [[noreturn]] void fail(const char *aWhat) const
+    {
+        throw make_error(std::string("invalid json at byte ").append(std::to_string(m_pCurrent - m_pBegin)).append(": ").append(aWhat));
+    }
+
+    void skipWhitespace()
+    {
+        while (m_pCurrent < m_pEnd && (*m_pCurrent == ' ' || *m_pCurrent == '\t' || *m_pCurrent == '\n' || *m_pCurrent == '\r'))
+            ++m_pCurrent;
+    }
+
+    bool consume(const char aCharacter)
+    {
+        skipWhitespace();
+
+        if (m_pCurrent < m_pEnd && *m_pCurrent == aCharacter)
+        {
+            ++m_pCurrent;
+
+            return true;
+        }
+
+        return false;
+    }
+
+    void expect(const char aCharacter)
+    {
+        if (!consume(aCharacter)) fail(std::string("expected '").append(1, aCharacter).append("'").c_str());
+    }
+
+    void expectLiteral(const char *const aLiteral)
+    {
+        const auto length = std::strlen(aLiteral);
+
+        if (static_cast<size_t>(m_pEnd - m_pCurrent) < length || std::strncmp(m_pCurrent, aLiteral, length)) fail("unexpected character");
+
+        m_pCurrent += length;
+    }
+
+    std::uint32_t parseHex4()
+    {
+        if (m_pEnd - m_pCurrent < 4) fail("truncated escape");
+
+        std::uint32_t value(0);
+
+        for (int i(0); i < 4; ++i)
+        {
+            const auto c = *m_pCurrent++;
+
+            value <<= 4;
+
+            if (c >= '0' && c <= '9') value |= c - '0';
+            else if (c >= 'a' && c <= 'f') value |= c - 'a' + 10;
+            else if (c >= 'A' && c <= 'F') value |= c - 'A' + 10;
+            else fail("invalid escape");
+        }
+
+        return value;
+    }
+
+    std::string parseString()
+    {
+        expect('"');
+
+        std::string value;
+
+        for (;;)
+        {
+            if (m_pCurrent >= m_pEnd) fail("unterminated string");
+
+            const auto c = *m_pCurrent++;
+
+            if (c == '"') return value;
+
+            if (c != '\\')
+            {
+                value.push_back(c);
+
+                continue;
+            }
+
+            if (m_pCurrent >= m_pEnd) fail("unterminated string");
+
+            switch (*m_pCurrent++)
+            {
+                case '"': value.push_back('"'); break;
+                case '\\': value.push_back('\\'); break;
+                case '/': value.push_back('/'); break;
+                case 'b': value.push_back('\b'); break;
+                case 'f': value.push_back('\f'); break;
+                case 'n': value.push_back('\n'); break;
+                case 'r': value.push_back('\r'); break;
+                case 't': value.push_back('\t'); break;
+
+                case 'u':
+                {
+                    auto codePoint = parseHex4();
+
+                    // characters outside the basic multilingual plane are escaped as a surrogate pair
+                    if (codePoint >= 0xd800 && codePoint < 0xdc00)
+                    {
+                        if (m_pEnd - m_pCurrent < 2 || m_pCurrent[0] != '\\' || m_pCurrent[1] != 'u') fail("unpaired surrogate");
+
+                        m_pCurrent += 2;
+
+                        const auto low = parseHex4();
+
+                        if (low < 0xdc00 || low >= 0xe000) fail("unpaired surrogate");
+
+                        codePoint = 0x10000 + ((codePoint - 0xd800) << 10) + (low - 0xdc00);
+                    }
+
+                    if (codePoint < 0x80) value.push_back(static_cast<char>(codePoint));
+                    else if (codePoint < 0x800)
+                    {
+                        value.push_back(static_cast<char>(0xc0 | (codePoint >> 6)));
+                        value.push_back(static_cast<char>(0x80 | (codePoint & 0x3f)));
+                    }
+                    else if (codePoint < 0x10000)
+                    {
+                        value.push_back(static_cast<char>(0xe0 | (codePoint >> 12)));
+                        value.push_back(static_cast<char>(0x80 | ((codePoint >> 6) & 0x3f)));
+                        value.push_back(static_cast<char>(0x80 | (codePoint & 0x3f)));
+                    }
+                    else
+                    {
+                        value.push_back(static_cast<char>(0xf0 | (codePoint >> 18)));
+                        value.push_back(static_cast<char>(0x80 | ((codePoint >> 12) & 0x3f)));
+                        value.push_back(static_cast<char>(0x80 | ((codePoint >> 6) & 0x3f)));
+                        value.push_back(static_cast<char>(0x80 | (codePoint & 0x3f)));
+                    }
+                } break;
+
+                default: fail("invalid escape");
+            }
+        }
+    }
+
+    double parseNumber()
+    {
+        const auto pStart = m_pCurrent;
+
+        while (m_pCurrent < m_pEnd && ((*m_pCurrent && std::strchr("+-.eE", *m_pCurrent)) || (*m_pCurrent >= '0' && *m_pCurrent <= '9')))
+            ++m_pCurrent;
+
+        // the text is not null terminated
+        const std::string text(pStart, m_pCurrent);
+
+        char *pParsedEnd;
+
+        const auto value = std::strtod(text.c_str(), &pParsedEnd);
+
+        if (text.empty() || pParsedEnd != text.c_str() + text.size()) fail("invalid number");
+
+        return value;
+    }
+
+    json_value parseValue(const size_t aDepth)
+    {
+        if (aDepth > MAX_JSON_DEPTH) fail("nested too deeply");
+
+        skipWhitespace();
+
+        if (m_pCurrent >= m_pEnd) fail("unexpected end");
+
+        json_value value;
+
+        switch (*m_pCurrent)
+        {
+            case '{':
+            {
+                ++m_pCurrent;
+
+                value.type = json_value::kind::object;
+
+                if (consume('}')) break;
+
+                do
+                {
+                    skipWhitespace();
+
+                    auto name = parseString();
+
+                    expect(':');
+
+                    value.object.emplace_back(std::move(name), parseValue(aDepth + 1));
+                }
+                while (consume(','));
+
+                expect('}');
+            } break;
+
+            case '[':
+            {
+                ++m_pCurrent;
+
+                value.type = json_value::kind::array;
+
+                if (consume(']')) break;
+
+                do value.array.push_back(parseValue(aDepth + 1));
+                while (consume(','));
+
+                expect(']');
+            } break;
+
+            case '"':
+            {
+                value.type = json_value::kind::string;
+                value.string = parseString();
+            } break;
+
+            case 't':
+            {
+                expectLiteral("true");
+
+                value.type = json_value::kind::boolean;
+                value.boolean = true;
+            } break;
+
+            case 'f':
+            {
+                expectLiteral("false");
+
+                value.type = json_value::kind::boolean;
+            } break;
+
+            case 'n':
+            {
+                expectLiteral("null");
+            } break;
+
+            default:
+            {
+                value.type = json_value::kind::number;
+                value.number = parseNumber();
+            } break;
+        }
+
+        return value;
+    }
+
+public:
+    //! parses a whole document
+    /// \exception runtime_error the text is not valid json
+    json_value parse()
+    {
+        auto value = parseValue(0);
+
+        skipWhitespace();
+
+        if (m_pCurrent != m_pEnd) fail("unexpected characters after the document");
+
+        return value;
+    }
+
+    json_parser(const char *const pText, const size_t aSize)
+    : m_pBegin(pText)
+    , m_pEnd(pText + aSize)
+    , m_pCurrent(pText)
+    {}
+};
+
+//! a required member of an object
+static const json_value &get_member(const json_value &aObject, const std::string &aName)
+{
+    if (const auto pValue = aObject.find(aName)) return *pValue;
+
+    throw make_error(std::string("missing \"").append(aName).append("\""));
+}
+
+static size_t to_size(const json_value &aValue, const std::string &aName)
+{
+    if (aValue.type != json_value::kind::number || aValue.number < 0 || aValue.number != std::floor(aValue.number) ||
+        aValue.number > static_cast<double>(std::numeric_limits<std::uint32_t>::max()) * 4)
+        throw make_error(std::string("\"").append(aName).append("\" must be a non-negative integer"));
+
+    return static_cast<size_t>(aValue.number);
+}
+
+//! a required non-negative integer member of an object
+static size_t get_size(const json_value &aObject, const std::string &aName)
+{
+    return to_size(get_member(aObject, aName), aName);
+}
+
+//! an optional non-negative integer member of an object
+static std::optional<size_t> find_size(const json_value &aObject, const std::string &aName)
+{
+    if (const auto pValue = aObject.find(aName)) return to_size(*pValue, aName);
+
+    return {};
+}
+
+static double get_number(const json_value &aObject, const std::string &aName, const double aDefault)
+{
+    if (const auto pValue = aObject.find(aName))
+    {
+        if (pValue->type != json_value::kind::number) throw make_error(std::string("\"").append(aName).append("\" must be a number"));
+
+        return pValue->number;
+    }
+
+    return aDefault;
+}
+
+static std::string get_string(const json_value &aObject, const std::string &aName, const std::string &aDefault)
+{
+    if (const auto pValue = aObject.find(aName))
+    {
+        if (pValue->type != json_value::kind::string) throw make_error(std::string("\"").append(aName).append("\" must be a string"));
+
+        return pValue->string;
+    }
+
+    return aDefault;
+}
+
+//! an optional array member of an object. empty if absent
+static const std::vector<json_value> &get_array(const json_value &aObject, const std::string &aName)
+{
+    static const std::vector<json_value> EMPTY;
+
+    if (const auto pValue = aObject.find(aName))
+    {
+        if (pValue->type != json_value::kind::array) throw make_error(std::string("\"").append(aName).append("\" must be an array"));
+
+        return pValue->array;
+    }
+
+    return EMPTY;
+}
+
+//! a range of bytes in a file or decoded buffer
+struct byte_span final
+{
+    const std::byte *pData = nullptr;
+
+    size_t size = 0;
+};
+
+//! an accessor, resolved to the bytes it refers to
+struct accessor_info final
+{
+    //! first element. null if the accessor has no buffer view, in which case its elements are zero
+    const std::byte *pData;
+
+    //! number of elements
+    size_t count;
+
+    //! components per element
+    size_t componentCount;
+
+    //! type of the components
+    size_t componentType;
+
+    //! integer components are mapped to [0, 1] or [-1, 1]
+    bool isNormalized;
+
+    //! the accessor's type is a matrix
+    bool isMatrix;
+
+    //! bytes from one element to the next
+    size_t stride;
+};
+
+//! part of an accessor to convert, and where to
+struct conversion final
+{
+    const accessor_info *pAccessor;
+
+    size_t begin;
+
+    size_t end;
+
+    //! destination of attribute components. null if the accessor is converted to indexes
+    attribute_data_view::attribute_component_type *pComponents;
+
+    //! destination of indexes. null if the accessor is converted to attribute components
+    vertex_data_view::index_type *pIndexes;
+};
+
+static std::uint32_t read_uint32(const std::byte *const pData)
+{
+    std::uint32_t value;
+
+    std::memcpy(&value, pData, sizeof(value));
+
+    return value;
+}
+
+static size_t get_component_size(const size_t aComponentType)
+{
+    switch (aComponentType)
+    {
+        case byte_component:
+        case unsigned_byte_component: return 1;
+
+        case short_component:
+        case unsigned_short_component: return 2;
+
+        case unsigned_int_component:
+        case float_component: return 4;
+
+        default: throw make_error(std::string("unknown component type ").append(std::to_string(aComponentType)));
+    }
+}
+
+static size_t get_component_count(const std::string &aType)
+{
+    if (aType == "SCALAR") return 1;
+    if (aType == "VEC2") return 2;
+    if (aType == "VEC3") return 3;
+    if (aType == "VEC4") return 4;
+    if (aType == "MAT2") return 4;
+    if (aType == "MAT3") return 9;
+    if (aType == "MAT4") return 16;
+
+    throw make_error(std::string("unknown accessor type \"").append(aType).append("\""));
+}
+
+//! how an accessor's components are stored on the gpu once converted to floats
+static attribute_data_view::StorageType get_storage_type(const accessor_info &aAccessor)
+{
+    using StorageType = attribute_data_view::StorageType;
+
+    if (!aAccessor.isNormalized) return StorageType::Float;
+
+    switch (aAccessor.componentType)
+    {
+        case byte_component: return StorageType::NormalizedByte;
+        case unsigned_byte_component: return StorageType::NormalizedUnsignedByte;
+        case short_component: return StorageType::NormalizedShort;
+        case unsigned_short_component: return StorageType::NormalizedUnsignedShort;
+
+        default: return StorageType::Float;
+    }
+}
+
+//! name in shaders of a gltf attribute semantic
+static std::string get_attribute_name(const std::string &aSemantic)
+{
+    if (aSemantic == "POSITION") return "a_Position";
+    if (aSemantic == "TEXCOORD_0") return "a_UV";
+    if (aSemantic == "NORMAL") return "a_Normal";
+    if (aSemantic == "COLOR_0") return "a_Color";
+    if (aSemantic == "TANGENT") return "a_Tangent";
+
+    return std::string("a_").append(aSemantic);
+}
+
+template<typename component_type>
+static void convert_components(const accessor_info &aAccessor, const size_t aBegin, const size_t aEnd,
+    attribute_data_view::attribute_component_type *const pOutput)
+{
+    const auto scale = 1.f / static_cast<float>(std::numeric_limits<component_type>::max());
+
+    for (auto i(aBegin); i < aEnd; ++i)
+    {
+        const auto pElement = aAccessor.pData + i * aAccessor.stride;
+        const auto pOutputElement = pOutput + i * aAccessor.componentCount;
+
+        for (size_t j(0); j < aAccessor.componentCount; ++j)
+        {
+            component_type value;
+
+            std::memcpy(&value, pElement + j * sizeof(component_type), sizeof(value));
+
+            // signed normalized integers have one more negative value than positive, which is clamped to -1
+            pOutputElement[j] = aAccessor.isNormalized
+                ? std::max(static_cast<float>(value) * scale, -1.f)
+                : static_cast<float>(value);
+        }
+    }
+}
+
+static void convert(const accessor_info &aAccessor, const size_t aBegin, const size_t aEnd,
+    attribute_data_view::attribute_component_type *const pOutput)
+{
+    if (!aAccessor.pData)
+    {
+        std::fill(pOutput + aBegin * aAccessor.componentCount, pOutput + aEnd * aAccessor.componentCount, 0.f);
+
+        return;
+    }
+
+    switch (aAccessor.componentType)
+    {
+        case byte_component: convert_components<std::int8_t>(aAccessor, aBegin, aEnd, pOutput); break;
+        case unsigned_byte_component: convert_components<std::uint8_t>(aAccessor, aBegin, aEnd, pOutput); break;
+        case short_component: convert_components<std::int16_t>(aAccessor, aBegin, aEnd, pOutput); break;
+        case unsigned_short_component: convert_components<std::uint16_t>(aAccessor, aBegin, aEnd, pOutput); break;
+        case unsigned_int_component: convert_components<std::uint32_t>(aAccessor, aBegin, aEnd, pOutput); break;
+        case float_component: convert_components<float>(aAccessor, aBegin, aEnd, pOutput); break;
+    }
+}
+
+template<typename component_type>
+static void convert_indexes(const accessor_info &aAccessor, const size_t aBegin, const size_t aEnd,
+    vertex_data_view::index_type *const pOutput)
+{
+    for (auto i(aBegin); i < aEnd; ++i)
+    {
+        component_type value;
+
+        std::memcpy(&value, aAccessor.pData + i * aAccessor.stride, sizeof(value));
+
+        pOutput[i] = value;
+    }
+}
+
+static void convert(const accessor_info &aAccessor, const size_t aBegin, const size_t aEnd,
+    vertex_data_view::index_type *const pOutput)
+{
+    if (!aAccessor.pData)
+    {
+        std::fill(pOutput + aBegin, pOutput + aEnd, 0);
+
+        return;
+    }
+
+    switch (aAccessor.componentType)
+    {
+        case unsigned_byte_component: convert_indexes<std::uint8_t>(aAccessor, aBegin, aEnd, pOutput); break;
+        case unsigned_short_component: convert_indexes<std::uint16_t>(aAccessor, aBegin, aEnd, pOutput); break;
+        case unsigned_int_component: convert_indexes<std::uint32_t>(aAccessor, aBegin, aEnd, pOutput); break;
+    }
+}
+
+//! splits the conversion of an accessor into ranges for the job system
+static void add_conversions(std::vector<conversion> &aConversions, const accessor_info &aAccessor,
+    attribute_data_view::attribute_component_type *const pComponents, vertex_data_view::index_type *const pIndexes)
+{
+    for (size_t begin(0); begin < aAccessor.count; begin += CONVERSION_GRAIN_SIZE)
+        aConversions.push_back({&aAccessor, begin, std::min(begin + CONVERSION_GRAIN_SIZE, aAccessor.count), pComponents, pIndexes});
+}
+
+static std::vector<std::byte> decode_base64(const char *const pText, const size_t aSize)
+{
+    static const auto VALUES = []()
+    {
+        static constexpr char ALPHABET[] = "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/";
+
+        std::array<int, 256> values;
+
+        values.fill(-1);
+
+        for (int i(0); i < 64; ++i) values[static_cast<unsigned char>(ALPHABET[i])] = i;
+
+        return values;
+    }();
+
+    std::vector<std::byte> data;
+    data.reserve(aSize / 4 * 3);
+
+    std::uint32_t bits(0);
+    int bitCount(0);
+
+    for (size_t i(0); i < aSize && pText[i] != '='; ++i)
+    {
+        const auto value = VALUES[static_cast<unsigned char>(pText[i])];
+
+        if (value < 0) throw make_error("invalid base64 data");
+
+        bits = (bits << 6) | static_cast<std::uint32_t>(value);
+        bitCount += 6;
+
+        if (bitCount >= 8)
+        {
+            bitCount -= 8;
+
+            data.push_back(static_cast<std::byte>((bits >> bitCount) & 0xff));
+        }
+    }
+
+    return data;
+}
+
+//! replaces %XX escapes in a uri
+static std::string decode_uri(const std::string &aUri)
+{
+    std::string decoded;
+
+    for (size_t i(0); i < aUri.size(); ++i)
+    {
+        if (aUri[i] == '%' && i + 2 < aUri.size() && std::isxdigit(static_cast<unsigned char>(aUri[i + 1])) &&
+            std::isxdigit(static_cast<unsigned char>(aUri[i + 2])))
+        {
+            decoded.push_back(static_cast<char>(std::stoi(aUri.substr(i + 1, 2), nullptr, 16)));
+
+            i += 2;
+        }
+        else decoded.push_back(aUri[i]);
+    }
+
+    return decoded;
+}
+
+//! the bytes a uri refers to. data uris are decoded, other uris are mapped, relative to the directory of the gltf file
+static byte_span load_uri(gltf_importer::document &aDocument, const std::string &aDirectory, const std::string &aUri)
+{
+    if (!aUri.compare(0, 5, "data:"))
+    {
+        static constexpr char BASE64[] = ";base64,";
+
+        const auto start = aUri.find(BASE64);
+
+        if (start == std::string::npos) throw make_error("only base64 data uris are supported");
+
+        const auto offset = start + sizeof(BASE64) - 1;
+
+        auto pBuffer = std::make_shared<std::vector<std::byte>>(decode_base64(aUri.data() + offset, aUri.size() - offset));
+
+        aDocument.buffers.push_back(pBuffer);
+
+        return {pBuffer->data(), pBuffer->size()};
+    }
+
+    auto pFile = std::make_shared<mapped_file>(aDirectory + decode_uri(aUri));
+
+    aDocument.byteCount += pFile->size();
+    aDocument.files.push_back(pFile);
+
+    return {pFile->data(), pFile->size()};
+}
+
+//! finds the json and binary chunks of a glb file
+static void read_glb(const byte_span &aFile, byte_span &aJson, std::optional<byte_span> &aBinary)
+{
+    static constexpr size_t HEADER_SIZE = 12;
+    static constexpr size_t CHUNK_HEADER_SIZE = 8;
+
+    if (aFile.size < HEADER_SIZE) throw make_error("glb is truncated");
+
+    if (const auto version = read_uint32(aFile.pData + 4); version != 2)
+        throw make_error(std::string("unsupported glb version ").append(std::to_string(version)));
+
+    const size_t length = read_uint32(aFile.pData + 8);
+
+    if (length > aFile.size) throw make_error("glb is truncated");
+
+    bool isFirstChunk(true);
+
+    for (size_t offset(HEADER_SIZE); offset + CHUNK_HEADER_SIZE <= length;)
+    {
+        const size_t chunkLength = read_uint32(aFile.pData + offset);
+        const auto chunkType = read_uint32(aFile.pData + offset + 4);
+
+        offset += CHUNK_HEADER_SIZE;
+
+        if (chunkLength > length - offset) throw make_error("glb chunk is truncated");
+
+        const byte_span chunk{aFile.pData + offset, chunkLength};
+
+        if (isFirstChunk)
+        {
+            if (chunkType != GLB_JSON_CHUNK) throw make_error("first chunk of a glb must be json");
+
+            aJson = chunk;
+        }
+        // chunks of unknown types are skipped, as required by the specification
+        else if (chunkType == GLB_BINARY_CHUNK && !aBinary) aBinary = chunk;
+
+        offset += chunkLength;
+
+        isFirstChunk = false;
+    }
+
+    if (isFirstChunk) throw make_error("glb has no json chunk");
+}
+
+static gltf_importer::image_data decode_image(const byte_span &aEncoded)
+{
+    if (aEncoded.size > static_cast<size_t>(INT_MAX)) throw make_error("image is too large");
+
+    int width, height, components;
+
+    const auto pDecoded = stbi_load_from_memory(reinterpret_cast<const stbi_uc *>(aEncoded.pData),
+        static_cast<int>(aEncoded.size),
+        &width,
+        &height,
+        &components,
+        STBI_rgb_alpha);
+
+    if (!pDecoded) throw make_error(std::string("could not decode image: ").append(stbi_failure_reason()));
+
+    return {static_cast<size_t>(width), static_cast<size_t>(height), std::shared_ptr<std::byte>(reinterpret_cast<std::byte *>(pDecoded),
+        [](std::byte *p)
+        {
+            stbi_image_free(p);
+        })};
+}
+
+vertex_data_view gltf_importer::primitive_data::getView() const
+{
+    vertex_data_view::attribute_data_type views;
+
+    // views only read their data, but attribute_data_view does not take const pointers
+    for (const auto &attribute : attributes) views.insert({attribute.name, attribute.pBuffer
+        ? attribute_data_view(const_cast<attribute_data_view::attribute_component_type *>(attribute.pBuffer),
+            attribute.vertexCount, attribute.componentCount, attribute.stride, 0)
+        : attribute_data_view(const_cast<attribute_data_view::attribute_component_type *>(attribute.components.data()),
+            attribute.components.size(), attribute.componentCount, attribute.storageType)});
+
+    if (indexes.empty()) return vertex_data_view(vertex_data_view::UsageHint::Static, views);
+
+    return vertex_data_view(vertex_data_view::UsageHint::Static, views, indexes.data(), indexes.size());
+}
+
+gltf_importer::document gltf_importer::decode(const std::string &aPath, const std::shared_ptr<job_system> &pJobSystem)
+{
+    if (!pJobSystem) throw std::invalid_argument(std::string(TAG).append(": job system must not be null"));
+
+    document result;
+
+    const auto pFile = std::make_shared<mapped_file>(aPath);
+
+    result.byteCount += pFile->size();
+    result.files.push_back(pFile);
+
+    const byte_span file{pFile->data(), pFile->size()};
+
+    auto json = file;
+    std::optional<byte_span> binaryChunk;
+
+    if (file.size >= 4 && read_uint32(file.pData) == GLB_MAGIC) read_glb(file, json, binaryChunk);
+
+    const auto root = json_parser(reinterpret_cast<const char *>(json.pData), json.size).parse();
+
+    if (const auto version = get_string(get_member(root, "asset"), "version", ""); version.compare(0, 2, "2."))
+        throw make_error(std::string("unsupported gltf version \"").append(version).append("\""));
+
+    const auto directory = aPath.substr(0, aPath.find_last_of("/\\") + 1);
+
+    std::vector<byte_span> buffers;
+
+    for (const auto &buffer : get_array(root, "buffers"))
+    {
+        const auto byteLength = get_size(buffer, "byteLength");
+
+        byte_span data;
+
+        if (buffer.find("uri")) data = load_uri(result, directory, get_string(buffer, "uri", ""));
+        // the first buffer of a glb may refer to its binary chunk
+        else if (buffers.empty() && binaryChunk) data = *binaryChunk;
+        else throw make_error("buffer has no data");
+
+        if (data.size < byteLength) throw make_error("buffer is shorter than its byteLength");
+
+        buffers.push_back({data.pData, byteLength});
+    }
+
+    std::vector<std::pair<byte_span, size_t>> bufferViews;
+
+    for (const auto &bufferView : get_array(root, "bufferViews"))
+    {
+        const auto bufferIndex = get_size(bufferView, "buffer");
+
+        if (bufferIndex >= buffers.size()) throw make_error("buffer view refers to a missing buffer");
+
+        const auto &buffer = buffers[bufferIndex];
+        const auto offset = find_size(bufferView, "byteOffset").value_or(0);
+        const auto length = get_size(bufferView, "byteLength");
+
+        if (offset > buffer.size || length > buffer.size - offset) throw make_error("buffer view exceeds its buffer");
+
+        bufferViews.push_back({{buffer.pData + offset, length}, find_size(bufferView, "byteStride").value_or(0)});
+    }
+
+    std::vector<accessor_info> accessors;
+
+    for (const auto &accessor : get_array(root, "accessors"))
+    {
+        if (accessor.find("sparse")) throw make_error("sparse accessors are not supported");
+
+        const auto type = get_string(accessor, "type", "");
+
+        accessor_info info;
+        info.count = get_size(accessor, "count");
+        info.componentType = get_size(accessor, "componentType");
+        info.componentCount = get_component_count(type);
+        info.isMatrix = !type.compare(0, 3, "MAT");
+        info.isNormalized = accessor.find("normalized") && get_member(accessor, "normalized").boolean;
+
+        const auto elementSize = get_component_size(info.componentType) * info.componentCount;
+
+        if (const auto bufferViewIndex = find_size(accessor, "bufferView"))
+        {
+            if (*bufferViewIndex >= bufferViews.size()) throw make_error("accessor refers to a missing buffer view");
+
+            const auto &[bufferView, byteStride] = bufferViews[*bufferViewIndex];
+            const auto offset = find_size(accessor, "byteOffset").value_or(0);
+
+            info.pData = bufferView.pData + offset;
+            info.stride = byteStride ? byteStride : elementSize;
+
+            if (info.stride < elementSize) throw make_error("buffer view stride is smaller than its accessor's elements");
+
+            if (info.count && (offset > bufferView.size || bufferView.size - offset < elementSize ||
+                (info.count - 1) > (bufferView.size - offset - elementSize) / info.stride))
+                throw make_error("accessor exceeds its buffer view");
+        }
+        else
+        {
+            info.pData = nullptr;
+            info.stride = elementSize;
+        }
+
+        accessors.push_back(info);
+    }
+
+    const auto getAccessor = [&accessors](const size_t aIndex) -> const accessor_info &
+    {
+        if (aIndex >= accessors.size()) throw make_error("primitive refers to a missing accessor");
+
+        return accessors[aIndex];
+    };
+
+    std::vector<byte_span> encodedImages;
+
+    for (const auto &image : get_array(root, "images"))
+    {
+        if (image.find("uri")) encodedImages.push_back(load_uri(result, directory, get_string(image, "uri", "")));
+        else
+        {
+            const auto bufferViewIndex = get_size(image, "bufferView");
+
+            if (bufferViewIndex >= bufferViews.size()) throw make_error("image refers to a missing buffer view");
+
+            encodedImages.push_back(bufferViews[bufferViewIndex].first);
+        }
+    }
+
+    std::vector<std::optional<size_t>> textureImages;
+
+    for (const auto &texture : get_array(root, "textures"))
+    {
+        const auto source = find_size(texture, "source");
+
+        if (source && *source >= encodedImages.size()) throw make_error("texture refers to a missing image");
+
+        textureImages.push_back(source);
+    }
+
+    for (const auto &material : get_array(root, "materials"))
+    {
+        material_data data;
+        data.name = get_string(material, "name", "");
+
+        if (const auto pPbr = material.find("pbrMetallicRoughness"))
+        {
+            if (const auto pFactor = pPbr->find("baseColorFactor"))
+            {
+                if (pFactor->array.size() != data.baseColorFactor.size()) throw make_error("baseColorFactor must have 4 components");
+
+                for (size_t i(0); i < data.baseColorFactor.size(); ++i)
+                    data.baseColorFactor[i] = static_cast<float>(pFactor->array[i].number);
+            }
+
+            if (const auto pTexture = pPbr->find("baseColorTexture"))
+            {
+                const auto textureIndex = get_size(*pTexture, "index");
+
+                if (textureIndex >= textureImages.size()) throw make_error("material refers to a missing texture");
+
+                data.baseColorImage = textureImages[textureIndex];
+            }
+        }
+
+        if (get_string(material, "alphaMode", "OPAQUE") == "MASK")
+            data.alphaCutoff = static_cast<float>(get_number(material, "alphaCutoff", 0.5));
+
+        result.materials.push_back(std::move(data));
+    }
+
+    // the conversions refer to the components and indexes of primitives, whose storage does not move once sized
+    std::vector<conversion> conversions;
+
+    for (const auto &mesh : get_array(root, "meshes"))
+    {
+        mesh_data meshData;
+        meshData.name = get_string(mesh, "name", "");
+
+        for (const auto &primitive : get_array(mesh, "primitives"))
+        {
+            if (find_size(primitive, "mode").value_or(4) != 4) throw make_error("only triangle list primitives are supported");
+
+            primitive_data primitiveData;
+
+            if ((primitiveData.material = find_size(primitive, "material")) && *primitiveData.material >= result.materials.size())
+                throw make_error("primitive refers to a missing material");
+
+            const auto &attributes = get_member(primitive, "attributes");
+
+            if (attributes.type != json_value::kind::object) throw make_error("\"attributes\" must be an object");
+
+            primitiveData.attributes.reserve(attributes.object.size());
+
+            for (const auto &[semantic, index] : attributes.object)
+            {
+                const auto &accessor = getAccessor(to_size(index, semantic));
+
+                if (accessor.isMatrix) throw make_error("matrix attributes are not supported");
+
+                attribute_data attribute;
+                attribute.name = get_attribute_name(semantic);
+                attribute.componentCount = accessor.componentCount;
+                attribute.vertexCount = accessor.count;
+                attribute.storageType = get_storage_type(accessor);
+
+                // float accessors are viewed where they are, if aligned as attribute_data_view requires
+                if (accessor.componentType == float_component && accessor.pData &&
+                    !(reinterpret_cast<std::uintptr_t>(accessor.pData) % sizeof(float)) && !(accessor.stride % sizeof(float)))
+                {
+                    attribute.pBuffer = reinterpret_cast<const attribute_data_view::attribute_component_type *>(accessor.pData);
+                    attribute.stride = accessor.stride;
+                }
+                else
+                {
+                    attribute.components.resize(accessor.count * accessor.componentCount);
+
+                    add_conversions(conversions, accessor, attribute.components.data(), nullptr);
+                }
+
+                primitiveData.attributes.push_back(std::move(attribute));
+            }
+
+            if (const auto indexesIndex = find_size(primitive, "indices"))
+            {
+                const auto &accessor = getAccessor(*indexesIndex);
+
+                if (accessor.componentCount != 1 || (accessor.componentType != unsigned_byte_component &&
+                    accessor.componentType != unsigned_short_component && accessor.componentType != unsigned_int_component))
+                    throw make_error("indexes must be unsigned integer scalars");
+
+                primitiveData.indexes.resize(accessor.count);
+
+                add_conversions(conversions, accessor, nullptr, primitiveData.indexes.data());
+            }
+
+            meshData.primitives.push_back(std::move(primitiveData));
+        }
+
+        result.meshes.push_back(std::move(meshData));
+    }
+
+    // images are decoded in jobs while the accessors are converted
+    result.images.resize(encodedImages.size());
+
+    std::vector<job_system::job_handle> imageJobs;
+
+    for (size_t i(0); i < encodedImages.size(); ++i) imageJobs.push_back(pJobSystem->submit([&encodedImages, &result, i]()
+    {
+        result.images[i] = decode_image(encodedImages[i]);
+    }));
+
+    std::exception_ptr exception;
+
+    try
+    {
+        pJobSystem->parallel_for(0, conversions.size(), 1, [&conversions](const size_t aBegin, const size_t aEnd)
+        {
+            for (auto i(aBegin); i < aEnd; ++i)
+            {
+                const auto &current = conversions[i];
+
+                if (current.pComponents) convert(*current.pAccessor, current.begin, current.end, current.pComponents);
+                else convert(*current.pAccessor, current.begin, current.end, current.pIndexes);
+            }
+        });
+    }
+    catch (...)
+    {
+        exception = std::current_exception();
+    }
+
+    // every image job must finish before returning, since they refer to the document
+    for (const auto &pJob : imageJobs)
+    {
+        try
+        {
+            pJobSystem->wait(pJob);
+        }
+        catch (...)
+        {
+            if (!exception) exception = std::current_exception();
+        }
+    }
+
+    if (exception) std::rethrow_exception(exception);
+
+    return result;
+}
+
+gltf_importer::asset gltf_importer::make(const document &aDocument) const
+{
+    asset result;
+
+    result.textures.reserve(aDocument.images.size());
+
+    for (const auto &image : aDocument.images)
+    {
+        texture::image_data_2d_view view;
+        view.width = image.width;
+        view.height = image.height;
+        view.format = texture::data_format::rgba;
+        view.data = image.pData.get();
+
+        result.textures.push_back(m_Context.make_texture(view));
+    }
+
+    for (const auto &materialData : aDocument.materials)
+    {
+        std::shared_ptr<material> pMaterial(m_Context.make_material(m_pShader));
+
+        const auto &factor = materialData.baseColorFactor;
+
+        pMaterial->setVector4("_BaseColor", graphics_vector4_type(factor[0], factor[1], factor[2], factor[3]));
+
+        if (materialData.baseColorImage) pMaterial->setTexture("_Texture", result.textures[*materialData.baseColorImage]);
+
+        if (materialData.alphaCutoff) pMaterial->setFloat("_AlphaCutoff", *materialData.alphaCutoff);
+
+        result.materials.push_back(std::move(pMaterial));
+    }
+
+    // primitives without a material share one, as the gltf default material is shared
+    std::shared_ptr<material> pDefaultMaterial;
+
+    std::vector<vertex_data_view> views;
+
+    for (const auto &meshData : aDocument.meshes) for (const auto &primitiveData : meshData.primitives)
+    {
+        views.push_back(primitiveData.getView());
+
+        if (!primitiveData.material && !pDefaultMaterial)
+        {
+            pDefaultMaterial = m_Context.make_material(m_pShader);
+
+            pDefaultMaterial->setVector4("_BaseColor", graphics_vector4_type(1, 1, 1, 1));
+        }
+    }
+
+    // the models are interleaved in parallel, then uploaded one after the other
+    auto models = m_Context.make_models(views);
+
+    auto pModel = models.begin();
+
+    for (const auto &meshData : aDocument.meshes)
+    {
+        mesh current;
+        current.name = meshData.name;
+
+        for (const auto &primitiveData : meshData.primitives) current.primitives.push_back({std::move(*pModel++),
+            primitiveData.material ? result.materials[*primitiveData.material] : pDefaultMaterial});
+
+        result.meshes.push_back(std::move(current));
+    }
+
+    return result;
+}
+
+gltf_importer::asset gltf_importer::load(const std::string &aPath) const
+{
+    return make(decode(aPath));
+}
+
+gltf_importer::gltf_importer(const graphics::context &aContext, graphics::context::shader_program_shared_ptr_type pShader)
+: m_Context(aContext)
+, m_pShader(pShader ? std::move(pShader) : aContext.get_alpha_cutoff_shader())
+{}
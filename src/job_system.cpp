@@ -0,0 +1,375 @@
+// © 2019 Joseph Cameron - All Rights Reserved
+
+#include <gdk/job_system.h>
+
+#include <algorithm>
+#include <chrono>
+#include <exception>
+#include <stdexcept>
+#include <string>
+
+using namespace gdk;
+
+static constexpr char TAG[] = "job_system";
+
+class job_system::job final
+{
+public:
+    //! the work
+    job_function_type function;
+
+    //! dependencies not yet finished, plus one while the job is being submitted
+    std::atomic<size_t> unfinishedDependencyCount{1};
+
+    //! guards dependents and the transition to finished
+    std::mutex mutex;
+
+    //! set once the job has run
+    std::atomic<bool> isFinished{false};
+
+    //! jobs waiting on this one
+    std::vector<job_handle> dependents;
+
+    //! exception thrown by the function, if any
+    std::exception_ptr exception;
+
+    //! keeps the job alive while it is queued by raw pointer
+    job_handle self;
+};
+
+struct job_system::worker final
+{
+    //! jobs submitted by this worker
+    work_stealing_deque<job *> deque;
+
+    //! the thread
+    std::thread thread;
+};
+
+//! the worker the calling thread is, if any
+static thread_local struct
+{
+    const job_system *pSystem = nullptr; //!< system the worker belongs to
+    size_t index = 0; //!< index of the worker in the system
+} s_CurrentWorker;
+
+job_system::job_system(const size_t aWorkerCount)
+{
+    if (!aWorkerCount) throw std::invalid_argument(std::string(TAG).append(": worker count must be at least 1"));
+
+    for (size_t i(0); i < aWorkerCount; ++i) m_Workers.push_back(std::make_unique<worker>());
+
+    // deques must all exist before any worker can try to steal from them
+    for (size_t i(0); i < aWorkerCount; ++i) m_Workers[i]->thread = std::thread(&job_system::run, this, i);
+}
+
+job_system::job_system(scheduler_type aScheduler)
+: m_Scheduler(std::move(aScheduler))
+{
+    if (!m_Scheduler) throw std::invalid_argument(std::string(TAG).append(": scheduler must not be empty"));
+}
+
+job_system::~job_system()
+{
+    // jobs handed to a scheduler refer to this system until they have run
+    while (m_ScheduledCount.load()) std::this_thread::yield();
+
+    {
+        std::lock_guard<std::mutex> lock(m_SleepMutex);
+
+        m_IsRunning.store(false);
+    }
+
+    m_WorkAvailable.notify_all();
+
+    for (auto &pWorker : m_Workers) pWorker->thread.join();
+
+    // release the jobs that never ran
+    for (auto &pWorker : m_Workers) while (const auto pJob = pWorker->deque.steal()) (*pJob)->self.reset();
+
+    for (const auto pJob : m_Injected) pJob->self.reset();
+}
+
+void job_system::enqueue(job_handle pJob)
+{
+    if (m_Scheduler)
+    {
+        m_ScheduledCount.fetch_add(1);
+
+        m_Scheduler([this, pJob]()
+        {
+            execute(pJob.get());
+
+            m_ScheduledCount.fetch_sub(1);
+        });
+
+        return;
+    }
+
+    const auto pRaw = pJob.get();
+
+    pRaw->self = std::move(pJob);
+
+    if (s_CurrentWorker.pSystem == this) m_Workers[s_CurrentWorker.index]->deque.push(pRaw);
+    else
+    {
+        std::lock_guard<std::mutex> lock(m_InjectedMutex);
+
+        m_Injected.push_back(pRaw);
+    }
+
+    m_ReadyCount.fetch_add(1);
+
+    // paired with the sleeping count increment in run: either the worker sees the job, or this sees the worker
+    if (m_SleepingCount.load())
+    {
+        { std::lock_guard<std::mutex> lock(m_SleepMutex); }
+
+        m_WorkAvailable.notify_one();
+    }
+}
+
+job_system::job *job_system::take()
+{
+    const auto isWorker = s_CurrentWorker.pSystem == this;
+
+    const auto taken = [this](job *const pJob)
+    {
+        m_ReadyCount.fetch_sub(1);
+
+        return pJob;
+    };
+
+    if (isWorker) if (const auto pJob = m_Workers[s_CurrentWorker.index]->deque.pop()) return taken(*pJob);
+
+    {
+        std::lock_guard<std::mutex> lock(m_InjectedMutex);
+
+        if (m_Injected.size())
+        {
+            const auto pJob = m_Injected.front();
+
+            m_Injected.pop_front();
+
+            return taken(pJob);
+        }
+    }
+
+    // start at the next worker so that thieves spread out over their victims
+    const auto first = isWorker ? s_CurrentWorker.index + 1 : 0;
+
+    for (size_t i(0); i < m_Workers.size(); ++i)
+    {
+        const auto victim = (first + i) % m_Workers.size();
+
+        if (isWorker && victim == s_CurrentWorker.index) continue;
+
+        if (const auto pJob = m_Workers[victim]->deque.steal()) return taken(*pJob);
+    }
+
+    return nullptr;
+}
+
+void job_system::execute(job *const pJob)
+{
+    try
+    {
+        pJob->function();
+    }
+    catch (...)
+    {
+        pJob->exception = std::current_exception();
+    }
+
+    pJob->function = nullptr;
+
+    std::vector<job_handle> dependents;
+
+    {
+        std::lock_guard<std::mutex> lock(pJob->mutex);
+
+        pJob->isFinished.store(true);
+
+        dependents.swap(pJob->dependents);
+    }
+
+    for (auto &pDependent : dependents) if (pDependent->unfinishedDependencyCount.fetch_sub(1) == 1) enqueue(std::move(pDependent));
+
+    // paired with the blocked count increment in wait
+    if (m_BlockedCount.load())
+    {
+        { std::lock_guard<std::mutex> lock(m_SleepMutex); }
+
+        m_JobFinished.notify_all();
+    }
+
+    // may destroy the job
+    const auto self = std::move(pJob->self);
+}
+
+void job_system::run(const size_t aWorkerIndex)
+{
+    s_CurrentWorker.pSystem = this;
+    s_CurrentWorker.index = aWorkerIndex;
+
+    while (m_IsRunning.load())
+    {
+        if (const auto pJob = take())
+        {
+            execute(pJob);
+
+            continue;
+        }
+
+        std::unique_lock<std::mutex> lock(m_SleepMutex);
+
+        m_SleepingCount.fetch_add(1);
+
+        m_WorkAvailable.wait(lock, [this]()
+        {
+            return !m_IsRunning.load() || m_ReadyCount.load();
+        });
+
+        m_SleepingCount.fetch_sub(1);
+    }
+}
+
+job_system::job_handle job_system::submit(job_function_type aFunction, const std::vector<job_handle> &aDependencies)
+{
+    if (!aFunction) throw std::invalid_argument(std::string(TAG).append(": job function must not be empty"));
+
+    auto pJob = std::make_shared<job>();
+
+    pJob->function = std::move(aFunction);
+
+    for (const auto &pDependency : aDependencies)
+    {
+        if (!pDependency) throw std::invalid_argument(std::string(TAG).append(": dependency must not be null"));
+
+        std::lock_guard<std::mutex> lock(pDependency->mutex);
+
+        if (!pDependency->isFinished.load())
+        {
+            pJob->unfinishedDependencyCount.fetch_add(1);
+
+            pDependency->dependents.push_back(pJob);
+        }
+    }
+
+    // remove the submission's own count. if every dependency has already finished, the job is ready now
+    if (pJob->unfinishedDependencyCount.fetch_sub(1) == 1) enqueue(pJob);
+
+    return pJob;
+}
+
+void job_system::wait(const job_handle &aJob)
+{
+    if (!aJob) throw std::invalid_argument(std::string(TAG).append(": job must not be null"));
+
+    while (!aJob->isFinished.load())
+    {
+        if (!m_Scheduler)
+        {
+            if (const auto pJob = take())
+            {
+                execute(pJob);
+
+                continue;
+            }
+        }
+
+        std::unique_lock<std::mutex> lock(m_SleepMutex);
+
+        m_BlockedCount.fetch_add(1);
+
+        // the timeout covers jobs becoming ready while blocked, which do not notify m_JobFinished
+        m_JobFinished.wait_for(lock, std::chrono::milliseconds(1), [&aJob]()
+        {
+            return aJob->isFinished.load();
+        });
+
+        m_BlockedCount.fetch_sub(1);
+    }
+
+    if (aJob->exception) std::rethrow_exception(aJob->exception);
+}
+
+bool job_system::is_finished(const job_handle &aJob) const
+{
+    return aJob->isFinished.load();
+}
+
+void job_system::parallel_for(const size_t aBegin, const size_t aEnd, const size_t aGrainSize, const range_function_type &aFunction)
+{
+    if (aEnd <= aBegin) return;
+
+    const auto grainSize = std::max<size_t>(aGrainSize, 1);
+
+    std::vector<job_handle> jobs;
+
+    for (auto begin = aBegin + grainSize; begin < aEnd; begin += grainSize)
+    {
+        const auto end = std::min(begin + grainSize, aEnd);
+
+        jobs.push_back(submit([&aFunction, begin, end]()
+        {
+            aFunction(begin, end);
+        }));
+    }
+
+    std::exception_ptr exception;
+
+    try
+    {
+        aFunction(aBegin, std::min(aBegin + grainSize, aEnd));
+    }
+    catch (...)
+    {
+        exception = std::current_exception();
+    }
+
+    // every job must finish before returning, since they refer to aFunction
+    for (const auto &pJob : jobs)
+    {
+        try
+        {
+            wait(pJob);
+        }
+        catch (...)
+        {
+            if (!exception) exception = std::current_exception();
+        }
+    }
+
+    if (exception) std::rethrow_exception(exception);
+}
+
+size_t job_system::worker_count() const
+{
+    return m_Workers.size();
+}
+
+//! guards s_pShared
+static std::mutex s_SharedMutex;
+
+//! the instance used by the library
+static std::shared_ptr<job_system> s_pShared;
+
+std::shared_ptr<job_system> job_system::get_shared()
+{
+    std::lock_guard<std::mutex> lock(s_SharedMutex);
+
+    if (!s_pShared) s_pShared = std::make_shared<job_system>(
+        std::max<size_t>(std::thread::hardware_concurrency(), 2) - 1);
+
+    return s_pShared;
+}
+
+void job_system::set_shared(std::shared_ptr<job_system> pJobSystem)
+{
+    if (!pJobSystem) throw std::invalid_argument(std::string(TAG).append(": shared job system must not be null"));
+
+    std::lock_guard<std::mutex> lock(s_SharedMutex);
+
+    s_pShared = std::move(pJobSystem);
+}
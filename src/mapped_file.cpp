@@ -0,0 +1,149 @@
+// © 2019 Joseph Cameron - All Rights Reserved
+
+#include <gdk/mapped_file.h>
+
+#include <stdexcept>
+#include <utility>
+
+#if defined(_WIN32)
+#define WIN32_LEAN_AND_MEAN
+#define NOMINMAX
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+using namespace gdk;
+
+static constexpr char TAG[] = "mapped_file";
+
+static std::runtime_error make_error(const char *aWhat, const std::string &aPath)
+{
+    return std::runtime_error(std::string(TAG).append(": could not ").append(aWhat).append(" \"").append(aPath).append("\""));
+}
+
+#if defined(_WIN32)
+mapped_file::mapped_file(const std::string &aPath)
+{
+    const auto file = CreateFileA(aPath.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_FLAG_SEQUENTIAL_SCAN, nullptr);
+
+    if (file == INVALID_HANDLE_VALUE) throw make_error("open", aPath);
+
+    LARGE_INTEGER size;
+
+    if (!GetFileSizeEx(file, &size))
+    {
+        CloseHandle(file);
+
+        throw make_error("get the size of", aPath);
+    }
+
+    m_Size = static_cast<size_t>(size.QuadPart);
+
+    // empty files cannot be mapped
+    if (m_Size)
+    {
+        m_pMapping = CreateFileMappingA(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+
+        if (m_pMapping) m_pData = static_cast<const std::byte *>(MapViewOfFile(m_pMapping, FILE_MAP_READ, 0, 0, 0));
+    }
+
+    // the mapping keeps the file open
+    CloseHandle(file);
+
+    if (m_Size && !m_pData)
+    {
+        release();
+
+        throw make_error("map", aPath);
+    }
+}
+
+void mapped_file::release()
+{
+    if (m_pData) UnmapViewOfFile(m_pData);
+    if (m_pMapping) CloseHandle(m_pMapping);
+
+    m_pData = nullptr;
+    m_pMapping = nullptr;
+    m_Size = 0;
+}
+#else
+mapped_file::mapped_file(const std::string &aPath)
+{
+    const auto file = open(aPath.c_str(), O_RDONLY);
+
+    if (file < 0) throw make_error("open", aPath);
+
+    struct stat status;
+
+    if (fstat(file, &status))
+    {
+        close(file);
+
+        throw make_error("get the size of", aPath);
+    }
+
+    m_Size = static_cast<size_t>(status.st_size);
+
+    // empty files cannot be mapped
+    if (m_Size)
+    {
+        const auto pMapping = mmap(nullptr, m_Size, PROT_READ, MAP_PRIVATE, file, 0);
+
+        if (pMapping != MAP_FAILED) m_pData = static_cast<const std::byte *>(pMapping);
+    }
+
+    // the mapping keeps the file open
+    close(file);
+
+    if (m_Size && !m_pData) throw make_error("map", aPath);
+}
+
+void mapped_file::release()
+{
+    if (m_pData) munmap(const_cast<std::byte *>(m_pData), m_Size);
+
+    m_pData = nullptr;
+    m_Size = 0;
+}
+#endif
+
+const std::byte *mapped_file::data() const
+{
+    return m_pData;
+}
+
+size_t mapped_file::size() const
+{
+    return m_Size;
+}
+
+mapped_file &mapped_file::operator=(mapped_file &&aOther)
+{
+    if (this != &aOther)
+    {
+        release();
+
+        std::swap(m_pData, aOther.m_pData);
+        std::swap(m_Size, aOther.m_Size);
+#if defined(_WIN32)
+        std::swap(m_pMapping, aOther.m_pMapping);
+#endif
+    }
+
+    return *this;
+}
+
+mapped_file::mapped_file(mapped_file &&aOther)
+{
+    *this = std::move(aOther);
+}
+
+mapped_file::~mapped_file()
+{
+    release();
+}
@@ -0,0 +1,417 @@
+// © 2019 Joseph Cameron - All Rights Reserved
+
+#include <gdk/mesh_optimizer.h>
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstring>
+#include <limits>
+#include <numeric>
+#include <stdexcept>
+#include <string>
+#include <unordered_set>
+
+using namespace gdk;
+
+static constexpr char TAG[] = "mesh_optimizer";
+
+static constexpr auto UNMAPPED(std::numeric_limits<mesh_optimizer::index_type>::max());
+
+//! throws unless the indexes are whole triangles referring to existing vertexes
+static void validate_triangles(const std::vector<mesh_optimizer::index_type> &aIndexData, const size_t aVertexCount)
+{
+    if (aIndexData.size() % 3) throw std::invalid_argument(std::string(TAG).append(": index data is not a whole number of triangles"));
+
+    for (const auto index : aIndexData) if (index >= aVertexCount)
+        throw std::out_of_range(std::string(TAG).append(": index refers to a vertex that does not exist"));
+}
+
+//! fifo cache simulation. a vertex is a miss if at least aCacheSize vertexes have entered the cache since it last did.
+/// timestamps start at 0 and time at aCacheSize + 1, so every vertex misses the first time it is seen
+static bool is_cache_miss(std::vector<size_t> &aTimestamps, size_t &aTime, const mesh_optimizer::index_type aVertex, const size_t aCacheSize)
+{
+    if (aTime - aTimestamps[aVertex] <= aCacheSize) return false;
+
+    aTimestamps[aVertex] = aTime++;
+
+    return true;
+}
+
+std::vector<mesh_optimizer::index_type> mesh_optimizer::weld(const size_t aStride, std::vector<component_type> &aVertexData)
+{
+    if (!aStride) throw std::invalid_argument(std::string(TAG).append(": stride must be greater than 0"));
+
+    if (aVertexData.size() % aStride) throw std::invalid_argument(std::string(TAG).append(": vertex data is not a whole number of vertexes"));
+
+    const auto vertexCount = aVertexData.size() / aStride;
+
+    if (vertexCount >= UNMAPPED) throw std::invalid_argument(std::string(TAG).append(": too many vertexes to index"));
+
+    const auto byteStride = sizeof(component_type) * aStride;
+
+    std::vector<component_type> uniqueVertexData;
+    uniqueVertexData.reserve(aVertexData.size());
+
+    // vertexes are hashed and compared by their bits, so only identical vertexes are merged. -0 and 0 are kept apart
+    const auto hash = [&uniqueVertexData, aStride](const index_type aVertex)
+    {
+        const auto pComponents = uniqueVertexData.data() + (aStride * aVertex);
+
+        std::uint64_t hash(14695981039346656037ull);
+
+        for (size_t i(0); i < aStride; ++i)
+        {
+            std::uint32_t bits;
+
+            std::memcpy(&bits, pComponents + i, sizeof(bits));
+
+            hash = (hash ^ bits) * 1099511628211ull;
+        }
+
+        return static_cast<size_t>(hash ^ (hash >> 32));
+    };
+
+    const auto equal = [&uniqueVertexData, aStride, byteStride](const index_type a, const index_type b)
+    {
+        return !std::memcmp(uniqueVertexData.data() + (aStride * a), uniqueVertexData.data() + (aStride * b), byteStride);
+    };
+
+    std::unordered_set<index_type, decltype(hash), decltype(equal)> uniqueVertexes(vertexCount, hash, equal);
+
+    std::vector<index_type> indexData(vertexCount);
+
+    for (size_t vertex(0); vertex < vertexCount; ++vertex)
+    {
+        // the candidate is appended so the set can hash it, then removed again if it is a duplicate
+        const auto candidate = static_cast<index_type>(uniqueVertexes.size());
+
+        uniqueVertexData.insert(uniqueVertexData.end(),
+            aVertexData.begin() + (aStride * vertex), aVertexData.begin() + (aStride * (vertex + 1)));
+
+        const auto [iter, isInserted] = uniqueVertexes.insert(candidate);
+
+        if (!isInserted) uniqueVertexData.resize(uniqueVertexData.size() - aStride);
+
+        indexData[vertex] = *iter;
+    }
+
+    uniqueVertexData.shrink_to_fit();
+
+    aVertexData = std::move(uniqueVertexData);
+
+    return indexData;
+}
+
+void mesh_optimizer::optimize_vertex_cache(std::vector<index_type> &aIndexData, const size_t aVertexCount, const size_t aCacheSize)
+{
+    validate_triangles(aIndexData, aVertexCount);
+
+    const auto triangleCount = aIndexData.size() / 3;
+
+    // triangles not yet emitted that use each vertex
+    std::vector<size_t> liveTriangleCounts(aVertexCount, 0);
+
+    for (const auto index : aIndexData) ++liveTriangleCounts[index];
+
+    // triangles of each vertex, stored contiguously. the triangles of vertex v are [offsets[v], offsets[v + 1])
+    std::vector<size_t> adjacencyOffsets(aVertexCount + 1, 0);
+
+    std::partial_sum(liveTriangleCounts.begin(), liveTriangleCounts.end(), adjacencyOffsets.begin() + 1);
+
+    std::vector<index_type> adjacency(aIndexData.size());
+
+    {
+        auto cursors = adjacencyOffsets;
+
+        for (size_t i(0); i < aIndexData.size(); ++i) adjacency[cursors[aIndexData[i]]++] = static_cast<index_type>(i / 3);
+    }
+
+    std::vector<size_t> timestamps(aVertexCount, 0);
+    std::vector<bool> isEmitted(triangleCount, false);
+
+    // recently used vertexes, to resume from when the fanning vertex has no live triangles left
+    std::vector<index_type> deadEnds;
+    deadEnds.reserve(aIndexData.size());
+
+    std::vector<index_type> candidates;
+
+    std::vector<index_type> optimizedIndexData;
+    optimizedIndexData.reserve(aIndexData.size());
+
+    size_t time(aCacheSize + 1), cursor(0);
+
+    const auto skipDeadEnd = [&]() -> std::optional<index_type>
+    {
+        while (!deadEnds.empty())
+        {
+            const auto vertex = deadEnds.back();
+
+            deadEnds.pop_back();
+
+            if (liveTriangleCounts[vertex]) return vertex;
+        }
+
+        for (; cursor < aVertexCount; ++cursor) if (liveTriangleCounts[cursor]) return static_cast<index_type>(cursor);
+
+        return {};
+    };
+
+    for (auto fanningVertex = skipDeadEnd(); fanningVertex;)
+    {
+        candidates.clear();
+
+        // emit every live triangle around the fanning vertex
+        for (auto i(adjacencyOffsets[*fanningVertex]); i < adjacencyOffsets[*fanningVertex + 1]; ++i)
+        {
+            const auto triangle = adjacency[i];
+
+            if (isEmitted[triangle]) continue;
+
+            for (size_t corner(0); corner < 3; ++corner)
+            {
+                const auto vertex = aIndexData[(3 * triangle) + corner];
+
+                optimizedIndexData.push_back(vertex);
+                deadEnds.push_back(vertex);
+                candidates.push_back(vertex);
+
+                --liveTriangleCounts[vertex];
+
+                is_cache_miss(timestamps, time, vertex, aCacheSize);
+            }
+
+            isEmitted[triangle] = true;
+        }
+
+        // next fan from the oldest candidate that will still be cached once its own fan is emitted.
+        // candidates that would be evicted part way through rank below them
+        fanningVertex.reset();
+
+        long long bestPriority(-1);
+
+        for (const auto vertex : candidates) if (liveTriangleCounts[vertex])
+        {
+            long long priority(0);
+
+            if (const auto age = time - timestamps[vertex]; age + (2 * liveTriangleCounts[vertex]) <= aCacheSize)
+                priority = static_cast<long long>(age);
+
+            if (priority > bestPriority)
+            {
+                bestPriority = priority;
+                fanningVertex = vertex;
+            }
+        }
+
+        if (!fanningVertex) fanningVertex = skipDeadEnd();
+    }
+
+    aIndexData = std::move(optimizedIndexData);
+}
+
+void mesh_optimizer::optimize_overdraw(const size_t aStride,
+    const size_t aPositionOffset,
+    const std::vector<component_type> &aVertexData,
+    std::vector<index_type> &aIndexData,
+    const size_t aCacheSize)
+{
+    if (!aStride || aPositionOffset + 3 > aStride)
+        throw std::invalid_argument(std::string(TAG).append(": position does not fit in the vertex stride"));
+
+    const auto vertexCount = aVertexData.size() / aStride;
+
+    validate_triangles(aIndexData, vertexCount);
+
+    const auto triangleCount = aIndexData.size() / 3;
+
+    if (!triangleCount) return;
+
+    // a cluster begins at each triangle whose vertexes all miss the cache.
+    // these are the places the cache is already empty of useful vertexes, so reordering clusters costs little
+    std::vector<size_t> clusterStarts;
+
+    {
+        std::vector<size_t> timestamps(vertexCount, 0);
+
+        size_t time(aCacheSize + 1);
+
+        for (size_t triangle(0); triangle < triangleCount; ++triangle)
+        {
+            size_t missCount(0);
+
+            for (size_t corner(0); corner < 3; ++corner)
+                missCount += is_cache_miss(timestamps, time, aIndexData[(3 * triangle) + corner], aCacheSize);
+
+            if (!triangle || missCount == 3) clusterStarts.push_back(triangle);
+        }
+    }
+
+    clusterStarts.push_back(triangleCount);
+
+    using vector_type = std::array<double, 3>;
+
+    const auto position = [&](const index_type aVertex)
+    {
+        const auto pPosition = aVertexData.data() + (aStride * aVertex) + aPositionOffset;
+
+        return vector_type{pPosition[0], pPosition[1], pPosition[2]};
+    };
+
+    struct cluster
+    {
+        vector_type centroid{}; //!< sum of triangle centroids, weighted by area
+        vector_type normal{}; //!< sum of triangle normals, weighted by area
+        double area = 0; //!< twice the area of the cluster
+        double sortKey = 0; //!< how much the cluster faces away from the mesh's centre
+    };
+
+    const auto clusterCount = clusterStarts.size() - 1;
+
+    std::vector<cluster> clusters(clusterCount);
+
+    vector_type meshCentroid{};
+
+    double meshArea(0);
+
+    for (size_t i(0); i < clusterCount; ++i)
+    {
+        auto &current = clusters[i];
+
+        for (auto triangle(clusterStarts[i]); triangle < clusterStarts[i + 1]; ++triangle)
+        {
+            const auto a = position(aIndexData[(3 * triangle) + 0]);
+            const auto b = position(aIndexData[(3 * triangle) + 1]);
+            const auto c = position(aIndexData[(3 * triangle) + 2]);
+
+            const vector_type ab{b[0] - a[0], b[1] - a[1], b[2] - a[2]};
+            const vector_type ac{c[0] - a[0], c[1] - a[1], c[2] - a[2]};
+
+            // length of the cross product is twice the triangle's area
+            const vector_type normal{
+                (ab[1] * ac[2]) - (ab[2] * ac[1]),
+                (ab[2] * ac[0]) - (ab[0] * ac[2]),
+                (ab[0] * ac[1]) - (ab[1] * ac[0])};
+
+            const auto area = std::sqrt((normal[0] * normal[0]) + (normal[1] * normal[1]) + (normal[2] * normal[2]));
+
+            for (size_t axis(0); axis < 3; ++axis)
+            {
+                current.centroid[axis] += area * (a[axis] + b[axis] + c[axis]) / 3;
+                current.normal[axis] += normal[axis];
+            }
+
+            current.area += area;
+        }
+
+        for (size_t axis(0); axis < 3; ++axis) meshCentroid[axis] += current.centroid[axis];
+
+        meshArea += current.area;
+    }
+
+    if (meshArea > 0) for (auto &component : meshCentroid) component /= meshArea;
+
+    for (auto &current : clusters) if (current.area > 0)
+    {
+        const auto normalLength = std::sqrt((current.normal[0] * current.normal[0]) +
+            (current.normal[1] * current.normal[1]) +
+            (current.normal[2] * current.normal[2]));
+
+        if (normalLength > 0) for (size_t axis(0); axis < 3; ++axis)
+            current.sortKey += ((current.centroid[axis] / current.area) - meshCentroid[axis]) * (current.normal[axis] / normalLength);
+    }
+
+    std::vector<size_t> clusterOrder(clusterCount);
+
+    std::iota(clusterOrder.begin(), clusterOrder.end(), 0);
+
+    std::stable_sort(clusterOrder.begin(), clusterOrder.end(), [&clusters](const size_t a, const size_t b)
+    {
+        return clusters[a].sortKey > clusters[b].sortKey;
+    });
+
+    std::vector<index_type> optimizedIndexData;
+    optimizedIndexData.reserve(aIndexData.size());
+
+    for (const auto i : clusterOrder) optimizedIndexData.insert(optimizedIndexData.end(),
+        aIndexData.begin() + (3 * clusterStarts[i]), aIndexData.begin() + (3 * clusterStarts[i + 1]));
+
+    aIndexData = std::move(optimizedIndexData);
+}
+
+void mesh_optimizer::optimize_vertex_fetch(const size_t aStride, std::vector<component_type> &aVertexData, std::vector<index_type> &aIndexData)
+{
+    if (!aStride || aVertexData.size() % aStride)
+        throw std::invalid_argument(std::string(TAG).append(": vertex data is not a whole number of vertexes"));
+
+    const auto vertexCount = aVertexData.size() / aStride;
+
+    std::vector<index_type> remap(vertexCount, UNMAPPED);
+
+    index_type nextVertex(0);
+
+    for (auto &index : aIndexData)
+    {
+        if (index >= vertexCount) throw std::out_of_range(std::string(TAG).append(": index refers to a vertex that does not exist"));
+
+        if (remap[index] == UNMAPPED) remap[index] = nextVertex++;
+
+        index = remap[index];
+    }
+
+    std::vector<component_type> optimizedVertexData(aStride * nextVertex);
+
+    for (size_t vertex(0); vertex < vertexCount; ++vertex) if (remap[vertex] != UNMAPPED)
+        std::copy(aVertexData.begin() + (aStride * vertex), aVertexData.begin() + (aStride * (vertex + 1)),
+            optimizedVertexData.begin() + (aStride * remap[vertex]));
+
+    aVertexData = std::move(optimizedVertexData);
+}
+
+std::vector<mesh_optimizer::index_type> mesh_optimizer::optimize(const size_t aStride,
+    std::vector<component_type> &aVertexData,
+    const std::optional<size_t> aPositionOffset,
+    const size_t aCacheSize)
+{
+    if (!aStride || aVertexData.size() % (3 * aStride))
+        throw std::invalid_argument(std::string(TAG).append(": vertex data is not a whole number of triangles"));
+
+    auto indexData = weld(aStride, aVertexData);
+
+    optimize(aStride, aVertexData, indexData, aPositionOffset, aCacheSize);
+
+    return indexData;
+}
+
+void mesh_optimizer::optimize(const size_t aStride,
+    std::vector<component_type> &aVertexData,
+    std::vector<index_type> &aIndexData,
+    const std::optional<size_t> aPositionOffset,
+    const size_t aCacheSize)
+{
+    if (!aStride || aVertexData.size() % aStride)
+        throw std::invalid_argument(std::string(TAG).append(": vertex data is not a whole number of vertexes"));
+
+    optimize_vertex_cache(aIndexData, aVertexData.size() / aStride, aCacheSize);
+
+    if (aPositionOffset) optimize_overdraw(aStride, *aPositionOffset, aVertexData, aIndexData, aCacheSize);
+
+    optimize_vertex_fetch(aStride, aVertexData, aIndexData);
+}
+
+double mesh_optimizer::average_cache_miss_ratio(const std::vector<index_type> &aIndexData,
+    const size_t aVertexCount,
+    const size_t aCacheSize)
+{
+    validate_triangles(aIndexData, aVertexCount);
+
+    if (aIndexData.empty()) return 0;
+
+    std::vector<size_t> timestamps(aVertexCount, 0);
+
+    size_t time(aCacheSize + 1), missCount(0);
+
+    for (const auto index : aIndexData) missCount += is_cache_miss(timestamps, time, index, aCacheSize);
+
+    return static_cast<double>(missCount) / static_cast<double>(aIndexData.size() / 3);
+}
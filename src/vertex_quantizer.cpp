@@ -0,0 +1,196 @@
+// © 2019 Joseph Cameron - All Rights Reserved
+
+#include <gdk/vertex_quantizer.h>
+
+#include <cmath>
+#include <cstring>
+
+#if defined __SSE2__ || defined _M_X64
+#define GDK_GFX_VERTEX_QUANTIZER_SSE2
+#include <emmintrin.h>
+#endif
+
+#if defined __F16C__
+#define GDK_GFX_VERTEX_QUANTIZER_F16C
+#include <immintrin.h>
+#endif
+
+using namespace gdk;
+
+//! clamps the same way as sse min and max, so NaN becomes aLow in both paths
+static float clamp(const float aValue, const float aLow, const float aHigh)
+{
+    const auto low = aValue > aLow ? aValue : aLow;
+
+    return low < aHigh ? low : aHigh;
+}
+
+//! scales, offsets and rounds to nearest even, as cvtps does with the default rounding mode
+template<typename integer_type>
+static integer_type quantize(const float aValue, const float aLow, const float aHigh, const float aScale, const float aOffset = 0.f)
+{
+    return static_cast<integer_type>(std::nearbyint(clamp(aValue, aLow, aHigh) * aScale - aOffset));
+}
+
+static std::uint16_t float_to_half(const float aValue)
+{
+    std::uint32_t bits;
+
+    std::memcpy(&bits, &aValue, sizeof(bits));
+
+    const auto sign = static_cast<std::uint16_t>((bits >> 16) & 0x8000);
+
+    auto magnitude = bits & 0x7fffffff;
+
+    // infinity and NaN. NaNs stay NaNs
+    if (magnitude >= 0x7f800000) return sign | 0x7c00 | (magnitude > 0x7f800000 ? 0x0200 : 0);
+
+    // 65520 and above round to infinity
+    if (magnitude >= 0x477ff000) return sign | 0x7c00;
+
+    // below the smallest normal half, 2^-14: subnormal, in units of 2^-24
+    if (magnitude < 0x38800000)
+    {
+        float value;
+
+        std::memcpy(&value, &magnitude, sizeof(value));
+
+        return sign | static_cast<std::uint16_t>(std::nearbyint(value * 16777216.f));
+    }
+
+    // rebias the exponent from 127 to 15, then round the mantissa from 23 to 10 bits, to nearest even
+    magnitude -= 0x38000000;
+
+    return sign | static_cast<std::uint16_t>((magnitude + 0x0fff + ((magnitude >> 13) & 1)) >> 13);
+}
+
+void vertex_quantizer::to_half(const float *const pSource, std::uint16_t *const pDestination, const size_t aCount)
+{
+    size_t i(0);
+
+#if defined GDK_GFX_VERTEX_QUANTIZER_F16C
+    for (; i + 4 <= aCount; i += 4) _mm_storel_epi64(reinterpret_cast<__m128i *>(pDestination + i),
+        _mm_cvtps_ph(_mm_loadu_ps(pSource + i), _MM_FROUND_TO_NEAREST_INT));
+#endif
+
+    for (; i < aCount; ++i) pDestination[i] = float_to_half(pSource[i]);
+}
+
+// gles2 and webgl1 read a signed normalized code c of b bits as (2c + 1) / (2^b - 1), so the inverse is
+// c = (f * (2^b - 1) - 1) / 2, i.e: f * (2^(b-1) - 0.5) - 0.5, which maps [-1, 1] onto the type's full range
+
+void vertex_quantizer::to_snorm8(const float *const pSource, std::int8_t *const pDestination, const size_t aCount)
+{
+    size_t i(0);
+
+#if defined GDK_GFX_VERTEX_QUANTIZER_SSE2
+    const auto low = _mm_set1_ps(-1.f), high = _mm_set1_ps(1.f), scale = _mm_set1_ps(127.5f), offset = _mm_set1_ps(0.5f);
+
+    const auto convert = [&](const float *const p)
+    {
+        return _mm_cvtps_epi32(_mm_sub_ps(_mm_mul_ps(_mm_min_ps(_mm_max_ps(_mm_loadu_ps(p), low), high), scale), offset));
+    };
+
+    for (; i + 16 <= aCount; i += 16)
+    {
+        const auto a = _mm_packs_epi32(convert(pSource + i), convert(pSource + i + 4));
+        const auto b = _mm_packs_epi32(convert(pSource + i + 8), convert(pSource + i + 12));
+
+        _mm_storeu_si128(reinterpret_cast<__m128i *>(pDestination + i), _mm_packs_epi16(a, b));
+    }
+#endif
+
+    for (; i < aCount; ++i) pDestination[i] = quantize<std::int8_t>(pSource[i], -1.f, 1.f, 127.5f, 0.5f);
+}
+
+void vertex_quantizer::to_unorm8(const float *const pSource, std::uint8_t *const pDestination, const size_t aCount)
+{
+    size_t i(0);
+
+#if defined GDK_GFX_VERTEX_QUANTIZER_SSE2
+    const auto low = _mm_set1_ps(0.f), high = _mm_set1_ps(1.f), scale = _mm_set1_ps(255.f);
+
+    const auto convert = [&](const float *const p)
+    {
+        return _mm_cvtps_epi32(_mm_mul_ps(_mm_min_ps(_mm_max_ps(_mm_loadu_ps(p), low), high), scale));
+    };
+
+    for (; i + 16 <= aCount; i += 16)
+    {
+        // 0..255 fits a signed 16 bit pack, then packus saturates to unsigned 8 bits
+        const auto a = _mm_packs_epi32(convert(pSource + i), convert(pSource + i + 4));
+        const auto b = _mm_packs_epi32(convert(pSource + i + 8), convert(pSource + i + 12));
+
+        _mm_storeu_si128(reinterpret_cast<__m128i *>(pDestination + i), _mm_packus_epi16(a, b));
+    }
+#endif
+
+    for (; i < aCount; ++i) pDestination[i] = quantize<std::uint8_t>(pSource[i], 0.f, 1.f, 255.f);
+}
+
+void vertex_quantizer::to_snorm16(const float *const pSource, std::int16_t *const pDestination, const size_t aCount)
+{
+    size_t i(0);
+
+#if defined GDK_GFX_VERTEX_QUANTIZER_SSE2
+    const auto low = _mm_set1_ps(-1.f), high = _mm_set1_ps(1.f), scale = _mm_set1_ps(32767.5f), offset = _mm_set1_ps(0.5f);
+
+    const auto convert = [&](const float *const p)
+    {
+        return _mm_cvtps_epi32(_mm_sub_ps(_mm_mul_ps(_mm_min_ps(_mm_max_ps(_mm_loadu_ps(p), low), high), scale), offset));
+    };
+
+    for (; i + 8 <= aCount; i += 8) _mm_storeu_si128(reinterpret_cast<__m128i *>(pDestination + i),
+        _mm_packs_epi32(convert(pSource + i), convert(pSource + i + 4)));
+#endif
+
+    for (; i < aCount; ++i) pDestination[i] = quantize<std::int16_t>(pSource[i], -1.f, 1.f, 32767.5f, 0.5f);
+}
+
+void vertex_quantizer::to_unorm16(const float *const pSource, std::uint16_t *const pDestination, const size_t aCount)
+{
+    size_t i(0);
+
+#if defined GDK_GFX_VERTEX_QUANTIZER_SSE2
+    const auto low = _mm_set1_ps(0.f), high = _mm_set1_ps(1.f), scale = _mm_set1_ps(65535.f);
+    const auto bias = _mm_set1_epi32(32768);
+    const auto signBit = _mm_set1_epi16(static_cast<short>(0x8000));
+
+    // sse2 has no unsigned 32 to 16 bit pack, so the values are biased into the signed range, packed, then the bias flipped back
+    const auto convert = [&](const float *const p)
+    {
+        return _mm_sub_epi32(_mm_cvtps_epi32(_mm_mul_ps(_mm_min_ps(_mm_max_ps(_mm_loadu_ps(p), low), high), scale)), bias);
+    };
+
+    for (; i + 8 <= aCount; i += 8) _mm_storeu_si128(reinterpret_cast<__m128i *>(pDestination + i),
+        _mm_xor_si128(_mm_packs_epi32(convert(pSource + i), convert(pSource + i + 4)), signBit));
+#endif
+
+    for (; i < aCount; ++i) pDestination[i] = quantize<std::uint16_t>(pSource[i], 0.f, 1.f, 65535.f);
+}
+
+float vertex_quantizer::from_half(const std::uint16_t aHalf)
+{
+    const std::uint32_t sign = static_cast<std::uint32_t>(aHalf & 0x8000) << 16;
+    const std::uint32_t exponent = (aHalf >> 10) & 0x1f;
+    const std::uint32_t mantissa = aHalf & 0x03ff;
+
+    float value;
+
+    if (!exponent)
+    {
+        // zero and subnormals: mantissa * 2^-24
+        value = static_cast<float>(mantissa) / 16777216.f;
+
+        return sign ? -value : value;
+    }
+
+    std::uint32_t bits;
+
+    if (exponent == 0x1f) bits = sign | 0x7f800000 | (mantissa << 13);
+    else bits = sign | ((exponent + 112) << 23) | (mantissa << 13);
+
+    std::memcpy(&value, &bits, sizeof(value));
+
+    return value;
+}
@@ -0,0 +1,260 @@
+// © 2019 Joseph Cameron - All Rights Reserved
+
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <deque>
+#include <fstream>
+#include <functional>
+#include <limits>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <jfc/catch.hpp>
+#include <jfc/types.h>
+
+#include "test_include.h"
+
+#include <gdk/asset_loader.h>
+
+using namespace gdk;
+
+//! writes a file for the loader to read
+static void write_file(const std::string &aPath, const void *const pData, const size_t aSize)
+{
+    std::ofstream file(aPath, std::ios::binary);
+
+    file.write(static_cast<const char *>(pData), static_cast<std::streamsize>(aSize));
+}
+
+//! 8x8 rgb png
+static const std::vector<unsigned char> PNG_DATA({
+    0x89, 0x50, 0x4e, 0x47, 0x0d, 0x0a, 0x1a, 0x0a, 0x00, 0x00, 0x00, 0x0d,
+    0x49, 0x48, 0x44, 0x52, 0x00, 0x00, 0x00, 0x08, 0x00, 0x00, 0x00, 0x08,
+    0x08, 0x02, 0x00, 0x00, 0x00, 0x4b, 0x6d, 0x29, 0xdc, 0x00, 0x00, 0x00,
+    0x01, 0x73, 0x52, 0x47, 0x42, 0x00, 0xae, 0xce, 0x1c, 0xe9, 0x00, 0x00,
+    0x00, 0x04, 0x67, 0x41, 0x4d, 0x41, 0x00, 0x00, 0xb1, 0x8f, 0x0b, 0xfc,
+    0x61, 0x05, 0x00, 0x00, 0x00, 0x09, 0x70, 0x48, 0x59, 0x73, 0x00, 0x00,
+    0x0e, 0xc3, 0x00, 0x00, 0x0e, 0xc3, 0x01, 0xc7, 0x6f, 0xa8, 0x64, 0x00,
+    0x00, 0x00, 0x1b, 0x49, 0x44, 0x41, 0x54, 0x18, 0x57, 0x63, 0xf8, 0xff,
+    0xff, 0xff, 0xcc, 0x9b, 0xaf, 0x30, 0x49, 0x06, 0xac, 0xa2, 0x40, 0x72,
+    0x30, 0xea, 0xf8, 0xff, 0x1f, 0x00, 0xd3, 0x06, 0xab, 0x21, 0x92, 0xd9,
+    0xa4, 0x0f, 0x00, 0x00, 0x00, 0x00, 0x49, 0x45, 0x4e, 0x44, 0xae, 0x42,
+    0x60, 0x82
+});
+
+static const std::string VERTEX_GLSL(R"V0G0N(
+    uniform mat4 _MVP;
+
+    attribute highp vec3 a_Position;
+
+    void main ()
+    {
+        gl_Position = _MVP * vec4(a_Position, 1.0);
+    }
+)V0G0N");
+
+static const std::string FRAGMENT_GLSL(R"V0G0N(
+    void main()
+    {
+        gl_FragColor = vec4(1.0, 0.0, 1.0, 1.0);
+    }
+)V0G0N");
+
+//! model files in the test are raw arrays of float positions
+static asset_loader::model_data decode_positions(const std::vector<std::byte> &aFileData)
+{
+    asset_loader::model_data data;
+
+    std::vector<attribute_data_view::attribute_component_type> positions(aFileData.size() / sizeof(float));
+
+    std::memcpy(positions.data(), aFileData.data(), positions.size() * sizeof(float));
+
+    data.attributes["a_Position"] = {3, std::move(positions)};
+
+    return data;
+}
+
+TEST_CASE("gdk::asset_loader", "[gdk::asset_loader]")
+{
+    initGL();
+
+    auto pContext = graphics::context::make(graphics::context::implementation::opengl_webgl1_gles2);
+
+    write_file("asset_loader_test.png", PNG_DATA.data(), PNG_DATA.size());
+    write_file("asset_loader_test.vert", VERTEX_GLSL.data(), VERTEX_GLSL.size());
+    write_file("asset_loader_test.frag", FRAGMENT_GLSL.data(), FRAGMENT_GLSL.size());
+
+    const std::vector<float> triangle({0, 0, 0, 1, 0, 0, 0, 1, 0});
+
+    write_file("asset_loader_test.model", triangle.data(), triangle.size() * sizeof(float));
+
+    // runs jobs as soon as they are ready, on the calling thread
+    const auto pInlineJobs = std::make_shared<job_system>([](std::function<void()> aJob)
+    {
+        aJob();
+    });
+
+    SECTION("textures and models are made pending")
+    {
+        asset_loader loader(*pContext, pInlineJobs);
+
+        auto textureLoad = loader.load_texture("asset_loader_test.png");
+        auto modelLoad = loader.load_model("asset_loader_test.model", decode_positions);
+
+        REQUIRE(textureLoad.get_state() == asset_loader::load_state::ready);
+        REQUIRE(modelLoad.get_state() == asset_loader::load_state::ready);
+        REQUIRE(loader.get_loading_count() == 0);
+
+        const auto pTexture = textureLoad.get();
+        const auto pModel = modelLoad.get();
+
+        REQUIRE(!pTexture->isResident());
+        REQUIRE(!pModel->isResident());
+
+        pContext->upload_pending(std::numeric_limits<size_t>::max(), std::chrono::microseconds::max());
+
+        REQUIRE(pTexture->isResident());
+        REQUIRE(pModel->isResident());
+        REQUIRE(!jfc::glGetError());
+    }
+
+    SECTION("shaders are compiled by update")
+    {
+        asset_loader loader(*pContext, pInlineJobs);
+
+        auto shaderLoad = loader.load_shader("asset_loader_test.vert", "asset_loader_test.frag");
+
+        REQUIRE(shaderLoad.get_state() == asset_loader::load_state::loading);
+        REQUIRE_THROWS_AS(shaderLoad.get(), std::runtime_error);
+
+        REQUIRE(loader.update() == 1);
+
+        REQUIRE(shaderLoad.get_state() == asset_loader::load_state::ready);
+        REQUIRE(shaderLoad.get());
+        REQUIRE(!jfc::glGetError());
+    }
+
+    SECTION("failed loads rethrow")
+    {
+        asset_loader loader(*pContext, pInlineJobs);
+
+        auto missingLoad = loader.load_texture("asset_loader_test_missing.png");
+        auto undecodableLoad = loader.load_texture("asset_loader_test.vert");
+
+        REQUIRE(missingLoad.get_state() == asset_loader::load_state::failed);
+        REQUIRE(undecodableLoad.get_state() == asset_loader::load_state::failed);
+        REQUIRE_THROWS_AS(missingLoad.get(), std::runtime_error);
+        REQUIRE_THROWS_AS(undecodableLoad.get(), std::runtime_error);
+    }
+
+    SECTION("queued loads start in priority order and can be cancelled")
+    {
+        // jobs run when the test says so
+        std::deque<std::function<void()>> scheduled;
+
+        const auto pManualJobs = std::make_shared<job_system>([&scheduled](std::function<void()> aJob)
+        {
+            scheduled.push_back(std::move(aJob));
+        });
+
+        const auto runScheduled = [&scheduled]()
+        {
+            while (scheduled.size())
+            {
+                auto job = std::move(scheduled.front());
+
+                scheduled.pop_front();
+
+                job();
+            }
+        };
+
+        std::vector<std::string> decodeOrder;
+
+        const auto decodeNamed = [&decodeOrder](const std::string &aName)
+        {
+            return [&decodeOrder, aName](const std::vector<std::byte> &aFileData)
+            {
+                decodeOrder.push_back(aName);
+
+                return decode_positions(aFileData);
+            };
+        };
+
+        {
+            asset_loader loader(*pContext, pManualJobs, 1);
+
+            auto first = loader.load_model("asset_loader_test.model", decodeNamed("first"), 0);
+            auto low = loader.load_model("asset_loader_test.model", decodeNamed("low"), 0);
+            auto high = loader.load_model("asset_loader_test.model", decodeNamed("high"), 5);
+            auto raised = loader.load_model("asset_loader_test.model", decodeNamed("raised"), 0);
+            auto cancelled = loader.load_model("asset_loader_test.model", decodeNamed("cancelled"), 10);
+
+            loader.set_priority(raised, 10);
+
+            cancelled.cancel();
+
+            REQUIRE(first.get_state() == asset_loader::load_state::loading);
+            REQUIRE(low.get_state() == asset_loader::load_state::queued);
+            REQUIRE(cancelled.get_state() == asset_loader::load_state::cancelled);
+            REQUIRE_THROWS_AS(cancelled.get(), std::runtime_error);
+
+            runScheduled();
+
+            REQUIRE(loader.get_loading_count() == 0);
+        }
+
+        REQUIRE(decodeOrder == std::vector<std::string>({"first", "raised", "high", "low"}));
+    }
+
+    SECTION("many loads overlap on worker threads")
+    {
+        asset_loader loader(*pContext, std::make_shared<job_system>(4), 8);
+
+        std::vector<asset_loader::load_handle<texture>> textureLoads;
+        std::vector<asset_loader::load_handle<shader_program>> shaderLoads;
+
+        for (int i(0); i < 64; ++i) textureLoads.push_back(loader.load_texture("asset_loader_test.png", i % 3));
+        for (int i(0); i < 4; ++i) shaderLoads.push_back(loader.load_shader("asset_loader_test.vert", "asset_loader_test.frag"));
+
+        for (const auto timeout = std::chrono::steady_clock::now() + std::chrono::seconds(10);
+            loader.get_loading_count() && std::chrono::steady_clock::now() < timeout;)
+        {
+            loader.update(std::chrono::milliseconds(1));
+
+            pContext->upload_pending(std::numeric_limits<size_t>::max(), std::chrono::microseconds::max());
+
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        }
+
+        REQUIRE(loader.get_loading_count() == 0);
+
+        pContext->upload_pending(std::numeric_limits<size_t>::max(), std::chrono::microseconds::max());
+
+        for (const auto &load : textureLoads) REQUIRE(load.get()->isResident());
+        for (const auto &load : shaderLoads) REQUIRE(load.get());
+
+        REQUIRE(!jfc::glGetError());
+    }
+
+    SECTION("destroying a loader that owns its job system waits for loads in flight")
+    {
+        for (int i(0); i < 16; ++i)
+        {
+            asset_loader loader(*pContext, std::make_shared<job_system>(4), 8);
+
+            for (int j(0); j < 16; ++j) loader.load_texture("asset_loader_test.png");
+        }
+
+        pContext->upload_pending(std::numeric_limits<size_t>::max(), std::chrono::microseconds::max());
+
+        REQUIRE(!jfc::glGetError());
+    }
+
+    for (const auto path : {"asset_loader_test.png", "asset_loader_test.vert", "asset_loader_test.frag", "asset_loader_test.model"})
+        std::remove(path);
+}
@@ -0,0 +1,150 @@
+// © 2019 Joseph Cameron - All Rights Reserved
+
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <jfc/catch.hpp>
+#include <jfc/types.h>
+
+#include "test_include.h"
+
+#include <gdk/command_buffer.h>
+#include <gdk/graphics_context.h>
+#include <gdk/webgl1es2_model.h>
+#include <gdk/webgl1es2_shader_program.h>
+
+using namespace gdk;
+
+TEST_CASE("gdk::command_buffer", "[gdk::command_buffer]")
+{
+    initGL();
+
+    auto pContext = graphics::context::make(graphics::context::implementation::opengl_webgl1_gles2);
+
+    auto pMaterial = std::shared_ptr<material>(pContext->make_material(pContext->get_alpha_cutoff_shader()));
+    auto pModel = pContext->get_quad_model();
+
+    command_buffer a;
+
+    SECTION("a new buffer is empty")
+    {
+        REQUIRE(a.empty());
+        REQUIRE(a.size() == 0);
+    }
+
+    SECTION("uniform handles are stable and map back to their names")
+    {
+        const auto handle = command_buffer::get_uniform_handle("_Tint");
+
+        REQUIRE(handle == command_buffer::get_uniform_handle("_Tint"));
+        REQUIRE(handle != command_buffer::get_uniform_handle("_Threshold"));
+        REQUIRE(command_buffer::get_uniform_name(handle) == "_Tint");
+    }
+
+    SECTION("commands are visited in recorded order, clear discards them")
+    {
+        a.bind_material(pMaterial);
+        a.bind_model(pModel);
+        a.set_uniform(command_buffer::get_uniform_handle("_Tint"), graphics_vector4_type(1, 0, 0, 1));
+        a.draw(graphics_mat4x4_type::Identity);
+
+        REQUIRE(a.size() == 4);
+
+        std::vector<command_buffer::command_type> types;
+
+        a.for_each([&](const command_buffer::command_type aType, const std::byte *)
+        {
+            types.push_back(aType);
+        });
+
+        REQUIRE(types == std::vector<command_buffer::command_type>({
+            command_buffer::command_type::bind_material,
+            command_buffer::command_type::bind_model,
+            command_buffer::command_type::set_uniform,
+            command_buffer::command_type::draw}));
+
+        a.clear();
+
+        REQUIRE(a.empty());
+    }
+
+    SECTION("buffers recorded on other threads can be submitted")
+    {
+        std::vector<command_buffer> buffers(4);
+        std::vector<std::thread> threads;
+
+        for (auto &buffer : buffers) threads.emplace_back([&]()
+        {
+            buffer.set_camera(graphics_mat4x4_type::Identity, graphics_mat4x4_type::Identity, graphics_vector3_type::Zero);
+            buffer.bind_material(pMaterial);
+            buffer.bind_model(pModel);
+
+            for (int i(0); i < 100; ++i) buffer.draw(graphics_mat4x4_type::Identity);
+        });
+
+        for (auto &thread : threads) thread.join();
+
+        std::vector<const command_buffer *> pBuffers;
+
+        for (const auto &buffer : buffers) pBuffers.push_back(&buffer);
+
+        pContext->submit(pBuffers);
+
+        REQUIRE(!jfc::glGetError());
+    }
+
+    SECTION("a model bound against a program at unconventional locations is rebound for a conventional program")
+    {
+        // a program reading a_Position and one other attribute
+        const auto makeMaterial = [&](const std::string &aType, const std::string &aAttribute)
+        {
+            return std::shared_ptr<material>(pContext->make_material(pContext->make_shader(
+                "uniform mat4 _MVP;\n"
+                "attribute highp vec3 a_Position;\n"
+                "attribute highp " + aType + " " + aAttribute + ";\n"
+                "void main() { gl_Position = _MVP * vec4(a_Position, 1.0) + vec4(" + aAttribute + ".x); }\n",
+                "void main() { gl_FragColor = vec4(1.0); }\n")));
+        };
+
+        // a_Custom has no conventional location, so the first program does not have conventional locations
+        const auto pUnconventional = makeMaterial("vec3", "a_Custom");
+        const auto pConventional = makeMaterial("vec2", "a_UV");
+
+        std::vector<float> positions(9, 0), uvs(6, 0), custom(9, 0);
+
+        auto pCustomModel = std::shared_ptr<model>(pContext->make_model({vertex_data_view::UsageHint::Static, {
+            {"a_Position", {positions.data(), positions.size(), 3}},
+            {"a_UV", {uvs.data(), uvs.size(), 2}},
+            {"a_Custom", {custom.data(), custom.size(), 3}}
+        }}));
+
+        const auto uvLocation = *webgl1es2_shader_program::tryGetConventionalAttributeLocation("a_UV");
+
+        // a pointer that neither program's binding would set, so a stale binding is detected
+        glBindBuffer(GL_ARRAY_BUFFER, static_cast<const webgl1es2_model &>(*pCustomModel).getVertexBufferHandle());
+        glVertexAttribPointer(uvLocation, 4, GL_FLOAT, GL_FALSE, 0, nullptr);
+
+        a.bind_material(pUnconventional);
+        a.bind_model(pCustomModel);
+        a.draw(graphics_mat4x4_type::Identity);
+        a.bind_material(pConventional);
+        a.draw(graphics_mat4x4_type::Identity);
+
+        pContext->submit(a);
+
+        GLint uvSize;
+        glGetVertexAttribiv(uvLocation, GL_VERTEX_ATTRIB_ARRAY_SIZE, &uvSize);
+
+        REQUIRE(uvSize == 2);
+        REQUIRE(!jfc::glGetError());
+    }
+
+    SECTION("drawing without a material throws")
+    {
+        a.bind_model(pModel);
+        a.draw(graphics_mat4x4_type::Identity);
+
+        REQUIRE_THROWS(pContext->submit(a));
+    }
+}
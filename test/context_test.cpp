@@ -1,6 +1,12 @@
 // © 2019 Joseph Cameron - All Rights Reserved
 
+#include <chrono>
+#include <iostream>
+#include <limits>
+#include <stdexcept>
 #include <string>
+#include <thread>
+#include <vector>
 
 #include <jfc/catch.hpp>
 #include <jfc/types.h>
@@ -8,6 +14,9 @@
 #include "test_include.h"
 
 #include <gdk/graphics_context.h>
+#include <gdk/webgl1es2_model.h>
+#include <gdk/webgl1es2_shader_program.h>
+#include <gdk/webgl1es2_texture.h>
 
 using namespace gdk;
 
@@ -87,6 +96,34 @@ TEST_CASE("graphics_context", "[gdk::graphics_context]")
         
     }
 
+    SECTION("destroying a context deletes the objects released to it, regardless of the delay")
+    {
+        texture::image_data_2d_view view;
+        view.width = 1;
+        view.height = 1;
+        view.format = texture::data_format::rgba;
+
+        std::vector<std::underlying_type<std::byte>::type> imageData({0xff, 0xff, 0xff, 0xff});
+
+        view.data = reinterpret_cast<std::byte *>(&imageData.front());
+
+        pContext->set_deletion_delay(4);
+
+        auto pTexture = pContext->make_texture(view);
+
+        const auto handle = static_cast<const webgl1es2_texture &>(*pTexture).getHandle();
+
+        pTexture.reset();
+
+        REQUIRE(pContext->delete_released_resources() == 0);
+        REQUIRE(glIsTexture(handle));
+
+        pContext.reset();
+
+        REQUIRE(!glIsTexture(handle));
+        REQUIRE(!jfc::glGetError());
+    }
+
     SECTION("make a model using a vertex_data_view")
     {
         float size = 1;
@@ -130,6 +167,178 @@ TEST_CASE("graphics_context", "[gdk::graphics_context]")
         })));
 
         REQUIRE(pModel);
+
+        SECTION("an optimized view is welded into an indexed model")
+        {
+            const auto pOptimizedModel = pContext->make_model({vertex_data_view::UsageHint::Static, {
+                {"a_Position", {posData.data(), posData.size(), 3}},
+                {"a_UV", {uvData.data(), uvData.size(), 2}}
+            }, vertex_data_view::Optimization::Full});
+
+            const auto &optimizedModel = static_cast<const webgl1es2_model &>(*pOptimizedModel);
+
+            REQUIRE(optimizedModel.getVertexCount() == 4);
+            REQUIRE(optimizedModel.getIndexCount() == 6);
+            REQUIRE(!jfc::glGetError());
+        }
+
+        SECTION("buffers replaced by update_model are released to the context's deletion queue")
+        {
+            const std::vector<vertex_data_view::index_type> indexes({0, 1, 2, 3, 4, 5});
+
+            pContext->delete_released_resources();
+
+            // the first update gives the model an index buffer, the second releases it
+            pContext->update_model(*pModel, {vertex_data_view::UsageHint::Static, {
+                {"a_Position", {posData.data(), posData.size(), 3}},
+                {"a_UV", {uvData.data(), uvData.size(), 2}}
+            }, indexes.data(), indexes.size()});
+
+            pContext->update_model(*pModel, {vertex_data_view::UsageHint::Static, {
+                {"a_Position", {posData.data(), posData.size(), 3}},
+                {"a_UV", {uvData.data(), uvData.size(), 2}}
+            }});
+
+            REQUIRE(static_cast<const webgl1es2_model &>(*pModel).getIndexCount() == 0);
+            REQUIRE(pContext->delete_released_resources() == 1);
+            REQUIRE(!jfc::glGetError());
+        }
+
+        SECTION("attributes can be stored in smaller types")
+        {
+            const auto pCompressedModel = pContext->make_model({vertex_data_view::UsageHint::Static, {
+                {"a_Position", {posData.data(), posData.size(), 3, attribute_data_view::StorageType::HalfFloat}},
+                {"a_UV", {uvData.data(), uvData.size(), 2, attribute_data_view::StorageType::NormalizedUnsignedShort}}
+            }});
+
+            const auto &compressedModel = static_cast<const webgl1es2_model &>(*pCompressedModel);
+
+            REQUIRE(compressedModel.getVertexCount() == 6);
+
+            auto pShader = std::static_pointer_cast<webgl1es2_shader_program>(pContext->get_alpha_cutoff_shader());
+
+            pShader->useProgram();
+
+            compressedModel.bind(*pShader);
+            compressedModel.draw();
+
+            REQUIRE(!jfc::glGetError());
+        }
+
+        SECTION("a pending model made on a thread without a gl context matches one made on the gl thread")
+        {
+            const vertex_data_view view(vertex_data_view::UsageHint::Static, {
+                {"a_Position", {posData.data(), posData.size(), 3, attribute_data_view::StorageType::HalfFloat}},
+                {"a_UV", {uvData.data(), uvData.size(), 2}}
+            });
+
+            graphics::context::model_ptr_type pPendingModel;
+
+            std::thread([&]() { pPendingModel = pContext->make_pending_model(view); }).join();
+
+            pContext->upload_pending(std::numeric_limits<size_t>::max(), std::chrono::microseconds::max());
+
+            const auto pGLThreadModel = pContext->make_model(view);
+
+            const auto &pending = static_cast<const webgl1es2_model &>(*pPendingModel).getVertexFormat().getAttributes();
+            const auto &expected = static_cast<const webgl1es2_model &>(*pGLThreadModel).getVertexFormat().getAttributes();
+
+            REQUIRE(pPendingModel->isResident());
+            REQUIRE(pending.size() == expected.size());
+
+            for (size_t i(0); i < expected.size(); ++i) REQUIRE(pending[i].type == expected[i].type);
+
+            REQUIRE(!jfc::glGetError());
+        }
+    }
+
+    SECTION("make many models at once")
+    {
+        std::vector<std::vector<float>> positions;
+
+        for (int i(0); i < 100; ++i) positions.push_back(std::vector<float>(9, static_cast<float>(i)));
+
+        std::vector<vertex_data_view> views;
+
+        for (auto &current : positions) views.push_back({vertex_data_view::UsageHint::Static, {
+            {"a_Position", {current.data(), current.size(), 3}}
+        }});
+
+        const auto models = pContext->make_models(views);
+
+        REQUIRE(models.size() == views.size());
+
+        for (const auto &pModel : models) REQUIRE(pModel);
+
+        REQUIRE(!jfc::glGetError());
+
+        SECTION("an invalid view throws")
+        {
+            std::vector<float> uvs(4, 0);
+
+            views.push_back({vertex_data_view::UsageHint::Static, {
+                {"a_Position", {positions.front().data(), positions.front().size(), 3}},
+                {"a_UV", {uvs.data(), uvs.size(), 2}}
+            }});
+
+            REQUIRE_THROWS_AS(pContext->make_models(views), std::invalid_argument);
+        }
     }
 }
 
+TEST_CASE("graphics_context make_models benchmark", "[.][benchmark][gdk::graphics_context]")
+{
+    initGL();
+
+    auto pContext = graphics::context::make(graphics::context::implementation::opengl_webgl1_gles2);
+
+    static constexpr size_t MESH_COUNT(5000);
+    static constexpr size_t VERTEX_COUNT(600);
+
+    std::vector<std::vector<float>> positions(MESH_COUNT, std::vector<float>(VERTEX_COUNT * 3, 1));
+    std::vector<std::vector<float>> uvs(MESH_COUNT, std::vector<float>(VERTEX_COUNT * 2, 0.5f));
+    std::vector<std::vector<float>> normals(MESH_COUNT, std::vector<float>(VERTEX_COUNT * 3, 0));
+
+    std::vector<vertex_data_view> views;
+
+    for (size_t i(0); i < MESH_COUNT; ++i) views.push_back({vertex_data_view::UsageHint::Static, {
+        {"a_Position", {positions[i].data(), positions[i].size(), 3}},
+        {"a_UV", {uvs[i].data(), uvs[i].size(), 2}},
+        {"a_Normal", {normals[i].data(), normals[i].size(), 3}}
+    }});
+
+    using clock = std::chrono::steady_clock;
+
+    const auto toMilliseconds = [](const clock::duration aDuration)
+    {
+        return std::chrono::duration<double, std::milli>(aDuration).count();
+    };
+
+    const auto serialStart = clock::now();
+
+    {
+        std::vector<graphics::context::model_ptr_type> models;
+
+        for (const auto &view : views) models.push_back(pContext->make_model(view));
+
+        glFinish();
+    }
+
+    const auto serialTime = toMilliseconds(clock::now() - serialStart);
+
+    const auto bulkStart = clock::now();
+
+    {
+        const auto models = pContext->make_models(views);
+
+        glFinish();
+    }
+
+    const auto bulkTime = toMilliseconds(clock::now() - bulkStart);
+
+    std::cout << "make_models benchmark, " << MESH_COUNT << " meshes of " << VERTEX_COUNT << " vertexes:\n"
+        << "make_model per mesh: " << serialTime << "ms\n"
+        << "make_models: " << bulkTime << "ms\n";
+
+    REQUIRE(!jfc::glGetError());
+}
@@ -0,0 +1,107 @@
+// © 2019 Joseph Cameron - All Rights Reserved
+
+#include <memory>
+#include <thread>
+#include <vector>
+
+#include <jfc/catch.hpp>
+#include <jfc/types.h>
+
+#include "test_include.h"
+
+#include <gdk/webgl1es2_deletion_queue.h>
+#include <gdk/webgl1es2_model.h>
+#include <gdk/webgl1es2_render_state.h>
+
+using namespace gdk;
+
+TEST_CASE("gdk::webgl1es2_deletion_queue", "[gdk::webgl1es2_deletion_queue]")
+{
+    initGL();
+
+    using object_type = webgl1es2_deletion_queue::object_type;
+
+    auto pQueue = std::make_shared<webgl1es2_deletion_queue>();
+
+    const auto makeBuffer = []()
+    {
+        GLuint handle;
+
+        glGenBuffers(1, &handle);
+        glBindBuffer(GL_ARRAY_BUFFER, handle);
+        glBindBuffer(GL_ARRAY_BUFFER, 0);
+
+        return handle;
+    };
+
+    SECTION("deleters without a queue delete immediately")
+    {
+        const auto handle = makeBuffer();
+
+        webgl1es2_deletion_queue::make_deleter(nullptr, object_type::buffer)(handle);
+
+        REQUIRE(!glIsBuffer(handle));
+    }
+
+    SECTION("released objects live until the queue is flushed")
+    {
+        const auto a = makeBuffer(), b = makeBuffer();
+
+        const auto deleter = webgl1es2_deletion_queue::make_deleter(pQueue, object_type::buffer);
+
+        deleter(a);
+        deleter(b);
+        deleter(0);
+
+        REQUIRE(pQueue->getPendingCount() == 2);
+        REQUIRE(glIsBuffer(a));
+
+        REQUIRE(pQueue->flush() == 2);
+
+        REQUIRE(!glIsBuffer(a));
+        REQUIRE(!glIsBuffer(b));
+        REQUIRE(pQueue->getPendingCount() == 0);
+        REQUIRE(!jfc::glGetError());
+    }
+
+    SECTION("the delay keeps objects for further flushes")
+    {
+        pQueue->setDelay(2);
+
+        const auto handle = makeBuffer();
+
+        pQueue->push(object_type::buffer, handle);
+
+        REQUIRE(pQueue->flush() == 0);
+        REQUIRE(pQueue->flush() == 0);
+        REQUIRE(glIsBuffer(handle));
+        REQUIRE(pQueue->flush() == 1);
+        REQUIRE(!glIsBuffer(handle));
+
+        pQueue->push(object_type::buffer, makeBuffer());
+
+        REQUIRE(pQueue->flushAll() == 1);
+    }
+
+    SECTION("resources made under a bound state can be released on another thread")
+    {
+        webgl1es2_render_state renderState;
+        renderState.setDeletionQueue(pQueue);
+
+        std::unique_ptr<webgl1es2_model> pModel;
+
+        {
+            const webgl1es2_render_state::binding binding(&renderState);
+
+            pModel = std::make_unique<webgl1es2_model>(webgl1es2_model::Type::Static,
+                webgl1es2_vertex_format::Pos3,
+                std::vector<float>({0, 0, 0, 1, 0, 0, 0, 1, 0}));
+        }
+
+        std::thread([&pModel]() { pModel.reset(); }).join();
+
+        REQUIRE(pQueue->getPendingCount() == 1);
+        REQUIRE(pQueue->flush() == 1);
+        REQUIRE(!jfc::glGetError());
+    }
+}
@@ -34,6 +34,23 @@ TEST_CASE("gdk::webgl1es2_entity", "[gdk::webgl1es2_entity]")
         REQUIRE(!a.isHidden());
     }
 
+    SECTION("property overrides take precedence over material values when packed")
+    {
+        webgl1es2_entity a(pModel, pMaterial);
+
+        pMaterial->setFloat("_Threshold", 0.5f);
+        pMaterial->setVector2("_Offset", graphics_vector2_type(1, 2));
+
+        a.setFloat("_Threshold", 0.25f);
+
+        std::vector<GLfloat> buffer;
+
+        a.packProperties({"_Offset", "_Threshold"}, buffer);
+
+        REQUIRE(buffer == std::vector<GLfloat>({1, 2, 0.25f}));
+        REQUIRE_THROWS(a.packProperties({"_Missing"}, buffer));
+    }
+
     /*{auto blar2 = std::shared_ptr<webgl1es2_shader_program>(webgl1es2_shader_program::AlphaCutOff);}
     auto blar = std::shared_ptr<webgl1es2_shader_program>(webgl1es2_shader_program::AlphaCutOff);
 
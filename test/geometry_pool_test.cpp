@@ -0,0 +1,145 @@
+// © 2019 Joseph Cameron - All Rights Reserved
+
+#include <memory>
+#include <stdexcept>
+#include <vector>
+
+#include <jfc/catch.hpp>
+#include <jfc/types.h>
+
+#include "test_include.h"
+
+#include <gdk/webgl1es2_geometry_pool.h>
+#include <gdk/webgl1es2_model.h>
+#include <gdk/webgl1es2_shader_program.h>
+
+using namespace gdk;
+
+TEST_CASE("gdk::webgl1es2_geometry_pool", "[gdk::webgl1es2_geometry_pool]")
+{
+    initGL();
+
+    const auto pPool = std::make_shared<webgl1es2_geometry_pool>(100, 30);
+
+    const std::vector<GLfloat> vertexData(30, 0.5f);
+    const std::vector<GLushort> indexData({0, 1, 2, 3, 4, 5});
+
+    SECTION("allocations are packed into shared pages")
+    {
+        auto a = pPool->allocateVertexData(vertexData.data(), vertexData.size());
+        auto b = pPool->allocateVertexData(vertexData.data(), vertexData.size());
+        auto indexes = pPool->allocateIndexData(indexData.data(), indexData.size());
+
+        REQUIRE(a->getBufferHandle() == b->getBufferHandle());
+        REQUIRE(a->getBufferHandle() != indexes->getBufferHandle());
+        REQUIRE(a->getOffset() == 0);
+        REQUIRE(b->getOffset() == 30);
+        REQUIRE(pPool->getPageCount() == 2);
+        REQUIRE(pPool->getAllocationCount() == 3);
+        REQUIRE(pPool->getFreeCount() == (100 - 60) + (30 - 6));
+        REQUIRE(!jfc::glGetError());
+    }
+
+    SECTION("released ranges are merged and reused")
+    {
+        auto a = pPool->allocateVertexData(vertexData.data(), 20);
+        auto b = pPool->allocateVertexData(vertexData.data(), 20);
+        auto c = pPool->allocateVertexData(vertexData.data(), 20);
+
+        a.reset();
+        b.reset();
+
+        auto d = pPool->allocateVertexData(vertexData.data(), 40);
+
+        REQUIRE(d->getOffset() == 0);
+        REQUIRE(pPool->getPageCount() == 1);
+    }
+
+    SECTION("data that does not fit in a page gets a page of its own")
+    {
+        const std::vector<GLfloat> large(250, 1.f);
+
+        auto a = pPool->allocateVertexData(vertexData.data(), vertexData.size());
+        auto b = pPool->allocateVertexData(large.data(), large.size());
+
+        REQUIRE(a->getBufferHandle() != b->getBufferHandle());
+        REQUIRE(b->getCount() == 250);
+        REQUIRE(pPool->getPageCount() == 2);
+    }
+
+    SECTION("compaction moves allocations to the start of their page and deletes empty pages")
+    {
+        auto a = pPool->allocateVertexData(vertexData.data(), 30);
+        auto b = pPool->allocateVertexData(vertexData.data(), 30);
+        auto c = pPool->allocateVertexData(vertexData.data(), 30);
+        auto d = pPool->allocateVertexData(vertexData.data(), 30);
+        auto e = pPool->allocateVertexData(vertexData.data(), 30);
+
+        REQUIRE(pPool->getPageCount() == 2);
+
+        a.reset();
+        c.reset();
+        d.reset();
+        e.reset();
+
+        REQUIRE(pPool->compact() == 1);
+        REQUIRE(b->getOffset() == 0);
+        REQUIRE(pPool->getPageCount() == 1);
+        REQUIRE(pPool->getFreeCount() == 70);
+
+        auto f = pPool->allocateVertexData(vertexData.data(), 70);
+
+        REQUIRE(f->getOffset() == 30);
+        REQUIRE(!jfc::glGetError());
+    }
+
+    SECTION("writes outside an allocation throw")
+    {
+        auto a = pPool->allocateVertexData(vertexData.data(), 10);
+
+        a->write(5, vertexData.data(), 5);
+
+        REQUIRE_THROWS_AS(a->write(6, vertexData.data(), 5), std::out_of_range);
+        REQUIRE_THROWS_AS(pPool->allocateIndexData(indexData.data(), 0), std::invalid_argument);
+    }
+
+    SECTION("pooled models share buffers and can be drawn")
+    {
+        const std::vector<webgl1es2_model::attribute_component_data_type> quad(5 * 4, 0.5f);
+
+        webgl1es2_model first(*pPool, webgl1es2_vertex_format::Pos3uv2, quad, {0, 1, 2, 0, 2, 3});
+        webgl1es2_model second(*pPool, webgl1es2_vertex_format::Pos3uv2, quad);
+
+        REQUIRE(first.isPooled());
+        REQUIRE(first.getVertexBufferHandle() == second.getVertexBufferHandle());
+
+        const std::shared_ptr<webgl1es2_shader_program> pProgram(webgl1es2_shader_program::AlphaCutOff);
+
+        pProgram->useProgram();
+
+        first.bind(*pProgram);
+        first.draw();
+
+        second.bind(*pProgram, &first);
+        second.draw();
+
+        REQUIRE(!jfc::glGetError());
+
+        second.updateVertexData(std::vector<webgl1es2_model::attribute_component_data_type>(5 * 6, 1.f));
+        first.updateIndexData({});
+
+        REQUIRE(second.getVertexCount() == 6);
+        REQUIRE(first.getIndexCount() == 0);
+        REQUIRE(pPool->getAllocationCount() == 2);
+
+        pPool->compact();
+
+        first.bind(*pProgram);
+        first.draw();
+
+        second.bind(*pProgram, &first);
+        second.draw();
+
+        REQUIRE(!jfc::glGetError());
+    }
+}
@@ -0,0 +1,416 @@
+// © 2019 Joseph Cameron - All Rights Reserved
+
+#include <algorithm>
+#include <array>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <functional>
+#include <iostream>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include <jfc/catch.hpp>
+
+#include "test_include.h"
+
+#include <gdk/gltf_importer.h>
+
+using namespace gdk;
+
+//! directory of the sample files
+static const std::string SAMPLES = std::string(__FILE__).substr(0, std::string(__FILE__).find_last_of("/\\") + 1) + "gltf/";
+
+//! writes a file for the importer to read
+static void write_file(const std::string &aPath, const void *const pData, const size_t aSize)
+{
+    std::ofstream file(aPath, std::ios::binary);
+
+    file.write(static_cast<const char *>(pData), static_cast<std::streamsize>(aSize));
+}
+
+static size_t get_file_size(const std::string &aPath)
+{
+    return static_cast<size_t>(std::ifstream(aPath, std::ios::binary | std::ios::ate).tellg());
+}
+
+static const gltf_importer::attribute_data &find_attribute(const gltf_importer::primitive_data &aPrimitive, const std::string &aName)
+{
+    for (const auto &attribute : aPrimitive.attributes) if (attribute.name == aName) return attribute;
+
+    throw std::invalid_argument(aName);
+}
+
+TEST_CASE("gdk::gltf_importer decode", "[gdk::gltf_importer]")
+{
+    SECTION("a gltf with an embedded buffer decodes, viewing its floats in place")
+    {
+        const auto document = gltf_importer::decode(SAMPLES + "triangle.gltf");
+
+        REQUIRE(document.meshes.size() == 1);
+        REQUIRE(document.meshes[0].name == "triangle");
+        REQUIRE(document.meshes[0].primitives.size() == 1);
+
+        const auto &primitive = document.meshes[0].primitives[0];
+
+        REQUIRE(!primitive.material);
+        REQUIRE(primitive.indexes.empty());
+
+        const auto &position = find_attribute(primitive, "a_Position");
+
+        REQUIRE(position.pBuffer);
+        REQUIRE(position.components.empty());
+        REQUIRE(position.vertexCount == 3);
+        REQUIRE(position.pBuffer[3] == 1);
+        REQUIRE(position.pBuffer[7] == 1);
+
+        REQUIRE(document.byteCount == get_file_size(SAMPLES + "triangle.gltf"));
+    }
+
+    SECTION("a gltf with an external buffer decodes interleaved floats, normalized integers, indexes and materials")
+    {
+        const auto document = gltf_importer::decode(SAMPLES + "quad.gltf");
+
+        const auto &primitive = document.meshes[0].primitives[0];
+
+        REQUIRE(primitive.attributes.size() == 3);
+
+        const auto &position = find_attribute(primitive, "a_Position");
+        const auto &normal = find_attribute(primitive, "a_Normal");
+
+        REQUIRE(position.stride == 24);
+        REQUIRE(normal.stride == 24);
+        REQUIRE(normal.pBuffer == position.pBuffer + 3);
+        REQUIRE(normal.pBuffer[2] == 1);
+
+        const auto &uv = find_attribute(primitive, "a_UV");
+
+        REQUIRE(!uv.pBuffer);
+        REQUIRE(uv.storageType == attribute_data_view::StorageType::NormalizedUnsignedShort);
+        REQUIRE(uv.components == std::vector<float>({0, 0, 1, 0, 1, 1, 0, 1}));
+
+        REQUIRE(primitive.indexes == std::vector<vertex_data_view::index_type>({0, 1, 2, 0, 2, 3}));
+
+        REQUIRE(primitive.material == 0);
+        REQUIRE(document.materials[0].name == "leaves");
+        REQUIRE(document.materials[0].baseColorFactor == std::array<float, 4>({0.5f, 1, 0.25f, 1}));
+        REQUIRE(document.materials[0].alphaCutoff == 0.25f);
+        REQUIRE(!document.materials[0].baseColorImage);
+
+        REQUIRE(document.byteCount == get_file_size(SAMPLES + "quad.gltf") + get_file_size(SAMPLES + "quad.bin"));
+
+        const auto view = primitive.getView();
+
+        REQUIRE(view.m_AttributeData.size() == 3);
+        REQUIRE(view.m_IndexCount == 6);
+        REQUIRE(view.m_AttributeData.at("a_Normal").m_Stride == 24);
+    }
+
+    SECTION("a glb decodes its binary chunk and images")
+    {
+        const auto document = gltf_importer::decode(SAMPLES + "textured_quad.glb");
+
+        const auto &primitive = document.meshes[0].primitives[0];
+
+        REQUIRE(find_attribute(primitive, "a_UV").pBuffer);
+        REQUIRE(primitive.indexes == std::vector<vertex_data_view::index_type>({0, 1, 2, 0, 2, 3}));
+
+        REQUIRE(document.images.size() == 1);
+        REQUIRE(document.images[0].width == 2);
+        REQUIRE(document.images[0].height == 2);
+        REQUIRE(document.images[0].pData);
+
+        REQUIRE(document.materials[0].baseColorImage == 0);
+        REQUIRE(!document.materials[0].alphaCutoff);
+    }
+
+    SECTION("decoding without worker threads gives the same result")
+    {
+        const auto pSerial = std::make_shared<job_system>([](std::function<void()> aJob)
+        {
+            aJob();
+        });
+
+        const auto document = gltf_importer::decode(SAMPLES + "quad.gltf", pSerial);
+
+        REQUIRE(find_attribute(document.meshes[0].primitives[0], "a_UV").components == std::vector<float>({0, 0, 1, 0, 1, 1, 0, 1}));
+    }
+
+    SECTION("a missing file throws")
+    {
+        REQUIRE_THROWS_AS(gltf_importer::decode(SAMPLES + "does_not_exist.gltf"), std::runtime_error);
+    }
+
+    SECTION("invalid files throw")
+    {
+        static constexpr char PATH[] = "gltf_importer_test.gltf";
+
+        for (const std::string json : {
+            "{\"asset\": {\"version\": \"2.0\"}",
+            "{\"asset\": {\"version\": \"1.0\"}}",
+            "{\"asset\": {\"version\": \"2.0\"}, \"buffers\": [{\"byteLength\": 4}]}",
+            "{\"asset\": {\"version\": \"2.0\"}, \"buffers\": [{\"byteLength\": 4, \"uri\": \"data:;base64,AAAAAA==\"}],"
+                "\"bufferViews\": [{\"buffer\": 0, \"byteOffset\": 2, \"byteLength\": 4}]}",
+            "{\"asset\": {\"version\": \"2.0\"}, \"accessors\": [{\"componentType\": 5126, \"count\": 1, \"type\": \"VEC3\"}],"
+                "\"meshes\": [{\"primitives\": [{\"attributes\": {\"POSITION\": 0}, \"mode\": 1}]}]}",
+            "{\"asset\": {\"version\": \"2.0\"}, \"meshes\": [{\"primitives\": [{\"attributes\": {\"POSITION\": 0}}]}]}"})
+        {
+            write_file(PATH, json.data(), json.size());
+
+            REQUIRE_THROWS_AS(gltf_importer::decode(PATH), std::runtime_error);
+        }
+
+        std::remove(PATH);
+    }
+}
+
+TEST_CASE("gdk::gltf_importer make", "[gdk::gltf_importer]")
+{
+    initGL();
+
+    auto pContext = graphics::context::make(graphics::context::implementation::opengl_webgl1_gles2);
+
+    const gltf_importer importer(*pContext);
+
+    SECTION("a glb is made into a model, texture and material")
+    {
+        const auto asset = importer.load(SAMPLES + "textured_quad.glb");
+
+        REQUIRE(asset.meshes.size() == 1);
+        REQUIRE(asset.meshes[0].name == "textured_quad");
+        REQUIRE(asset.meshes[0].primitives.size() == 1);
+        REQUIRE(asset.meshes[0].primitives[0].pModel);
+        REQUIRE(asset.meshes[0].primitives[0].pMaterial == asset.materials[0]);
+        REQUIRE(asset.textures.size() == 1);
+        REQUIRE(asset.textures[0]->isResident());
+    }
+
+    SECTION("primitives without a material share a default material")
+    {
+        const auto asset = importer.load(SAMPLES + "triangle.gltf");
+
+        REQUIRE(asset.materials.empty());
+        REQUIRE(asset.meshes[0].primitives[0].pMaterial);
+    }
+}
+
+//! appends a big endian 32 bit value
+static void append_big_endian(std::vector<std::uint8_t> &aData, const std::uint32_t aValue)
+{
+    for (int shift(24); shift >= 0; shift -= 8) aData.push_back(static_cast<std::uint8_t>(aValue >> shift));
+}
+
+//! an rgba png of noise, stored uncompressed
+static std::vector<std::uint8_t> make_png(const std::uint32_t aSize)
+{
+    std::array<std::uint32_t, 256> crcTable;
+
+    for (std::uint32_t i(0); i < 256; ++i)
+    {
+        auto c = i;
+
+        for (int j(0); j < 8; ++j) c = c & 1 ? 0xedb88320 ^ (c >> 1) : c >> 1;
+
+        crcTable[i] = c;
+    }
+
+    std::vector<std::uint8_t> png({0x89, 'P', 'N', 'G', '\r', '\n', 0x1a, '\n'});
+
+    const auto appendChunk = [&png, &crcTable](const char *aType, const std::vector<std::uint8_t> &aData)
+    {
+        append_big_endian(png, static_cast<std::uint32_t>(aData.size()));
+
+        const auto start = png.size();
+
+        png.insert(png.end(), aType, aType + 4);
+        png.insert(png.end(), aData.begin(), aData.end());
+
+        std::uint32_t crc(0xffffffff);
+
+        for (auto i(start); i < png.size(); ++i) crc = crcTable[(crc ^ png[i]) & 0xff] ^ (crc >> 8);
+
+        append_big_endian(png, crc ^ 0xffffffff);
+    };
+
+    std::vector<std::uint8_t> header;
+    append_big_endian(header, aSize);
+    append_big_endian(header, aSize);
+    header.insert(header.end(), {8, 6, 0, 0, 0});
+
+    appendChunk("IHDR", header);
+
+    std::vector<std::uint8_t> scanlines;
+    std::uint32_t noise(1);
+
+    for (std::uint32_t y(0); y < aSize; ++y)
+    {
+        scanlines.push_back(0);
+
+        for (std::uint32_t x(0); x < aSize * 4; ++x) scanlines.push_back(static_cast<std::uint8_t>((noise = noise * 1103515245 + 12345) >> 16));
+    }
+
+    // zlib stream of stored deflate blocks
+    std::vector<std::uint8_t> zlib({0x78, 0x01});
+    std::uint32_t a(1), b(0);
+
+    for (size_t offset(0); offset < scanlines.size(); offset += 65535)
+    {
+        const auto length = static_cast<std::uint16_t>(std::min<size_t>(65535, scanlines.size() - offset));
+
+        zlib.push_back(offset + length == scanlines.size());
+        zlib.insert(zlib.end(), {static_cast<std::uint8_t>(length), static_cast<std::uint8_t>(length >> 8),
+            static_cast<std::uint8_t>(~length), static_cast<std::uint8_t>(~length >> 8)});
+        zlib.insert(zlib.end(), scanlines.begin() + offset, scanlines.begin() + offset + length);
+    }
+
+    for (const auto byte : scanlines)
+    {
+        a = (a + byte) % 65521;
+        b = (b + a) % 65521;
+    }
+
+    append_big_endian(zlib, (b << 16) | a);
+
+    appendChunk("IDAT", zlib);
+    appendChunk("IEND", {});
+
+    return png;
+}
+
+TEST_CASE("gdk::gltf_importer benchmark", "[.][benchmark][gdk::gltf_importer]")
+{
+    static constexpr size_t MESH_COUNT(32), VERTEX_COUNT(50000), IMAGE_COUNT(8), IMAGE_SIZE(512);
+    static constexpr char PATH[] = "gltf_importer_benchmark.glb";
+
+    // each mesh: float positions, normalized short uvs, normalized byte colors and uint indexes
+    std::vector<std::uint8_t> binary;
+    std::string bufferViews, accessors, meshes, images;
+
+    const auto appendView = [&binary, &bufferViews](const void *pData, const size_t aSize)
+    {
+        const auto offset = binary.size();
+
+        binary.insert(binary.end(), static_cast<const std::uint8_t *>(pData), static_cast<const std::uint8_t *>(pData) + aSize);
+        binary.resize((binary.size() + 3) & ~size_t(3));
+
+        bufferViews.append(bufferViews.empty() ? "" : ",").append("{\"buffer\":0,\"byteOffset\":").append(std::to_string(offset))
+            .append(",\"byteLength\":").append(std::to_string(aSize)).append("}");
+    };
+
+    size_t viewCount(0);
+
+    const auto appendAccessor = [&accessors, &viewCount](const int aComponentType, const bool aNormalized, const size_t aCount,
+        const char *aType)
+    {
+        accessors.append(accessors.empty() ? "" : ",").append("{\"bufferView\":").append(std::to_string(viewCount++))
+            .append(",\"componentType\":").append(std::to_string(aComponentType))
+            .append(",\"normalized\":").append(aNormalized ? "true" : "false")
+            .append(",\"count\":").append(std::to_string(aCount)).append(",\"type\":\"").append(aType).append("\"}");
+    };
+
+    std::vector<float> positions(VERTEX_COUNT * 3);
+    std::vector<std::uint16_t> uvs(VERTEX_COUNT * 2);
+    std::vector<std::uint8_t> colors(VERTEX_COUNT * 4);
+    std::vector<std::uint32_t> indexes(VERTEX_COUNT * 3);
+
+    for (size_t i(0); i < positions.size(); ++i) positions[i] = static_cast<float>(i);
+    for (size_t i(0); i < uvs.size(); ++i) uvs[i] = static_cast<std::uint16_t>(i);
+    for (size_t i(0); i < colors.size(); ++i) colors[i] = static_cast<std::uint8_t>(i);
+    for (size_t i(0); i < indexes.size(); ++i) indexes[i] = static_cast<std::uint32_t>((i * 7) % VERTEX_COUNT);
+
+    for (size_t mesh(0); mesh < MESH_COUNT; ++mesh)
+    {
+        const auto first = viewCount;
+
+        appendView(positions.data(), positions.size() * sizeof(float));
+        appendAccessor(5126, false, VERTEX_COUNT, "VEC3");
+
+        appendView(uvs.data(), uvs.size() * sizeof(std::uint16_t));
+        appendAccessor(5123, true, VERTEX_COUNT, "VEC2");
+
+        appendView(colors.data(), colors.size());
+        appendAccessor(5121, true, VERTEX_COUNT, "VEC4");
+
+        appendView(indexes.data(), indexes.size() * sizeof(std::uint32_t));
+        appendAccessor(5125, false, indexes.size(), "SCALAR");
+
+        meshes.append(meshes.empty() ? "" : ",").append("{\"primitives\":[{\"attributes\":{")
+            .append("\"POSITION\":").append(std::to_string(first))
+            .append(",\"TEXCOORD_0\":").append(std::to_string(first + 1))
+            .append(",\"COLOR_0\":").append(std::to_string(first + 2))
+            .append("},\"indices\":").append(std::to_string(first + 3)).append("}]}");
+    }
+
+    const auto png = make_png(IMAGE_SIZE);
+
+    for (size_t image(0); image < IMAGE_COUNT; ++image)
+    {
+        images.append(images.empty() ? "" : ",").append("{\"bufferView\":").append(std::to_string(viewCount++))
+            .append(",\"mimeType\":\"image/png\"}");
+
+        appendView(png.data(), png.size());
+    }
+
+    auto json = std::string("{\"asset\":{\"version\":\"2.0\"},\"buffers\":[{\"byteLength\":").append(std::to_string(binary.size()))
+        .append("}],\"bufferViews\":[").append(bufferViews)
+        .append("],\"accessors\":[").append(accessors)
+        .append("],\"images\":[").append(images)
+        .append("],\"meshes\":[").append(meshes).append("]}");
+
+    json.resize((json.size() + 3) & ~size_t(3), ' ');
+
+    {
+        const std::array<std::uint32_t, 3> header({0x46546c67, 2,
+            static_cast<std::uint32_t>(12 + 8 + json.size() + 8 + binary.size())});
+        const std::array<std::uint32_t, 2> jsonChunk({static_cast<std::uint32_t>(json.size()), 0x4e4f534a});
+        const std::array<std::uint32_t, 2> binaryChunk({static_cast<std::uint32_t>(binary.size()), 0x004e4942});
+
+        std::ofstream file(PATH, std::ios::binary);
+
+        file.write(reinterpret_cast<const char *>(header.data()), sizeof(header));
+        file.write(reinterpret_cast<const char *>(jsonChunk.data()), sizeof(jsonChunk));
+        file.write(json.data(), static_cast<std::streamsize>(json.size()));
+        file.write(reinterpret_cast<const char *>(binaryChunk.data()), sizeof(binaryChunk));
+        file.write(reinterpret_cast<const char *>(binary.data()), static_cast<std::streamsize>(binary.size()));
+    }
+
+    using clock = std::chrono::steady_clock;
+
+    const auto megabytesPerSecond = [](const size_t aByteCount, const clock::time_point aStart)
+    {
+        return static_cast<double>(aByteCount) / 1000000. / std::chrono::duration<double>(clock::now() - aStart).count();
+    };
+
+    // baseline: every accessor and image decoded one after the other, on the calling thread
+    const auto pSerial = std::make_shared<job_system>([](std::function<void()> aJob)
+    {
+        aJob();
+    });
+
+    auto start = clock::now();
+
+    const auto serial = gltf_importer::decode(PATH, pSerial);
+
+    const auto serialThroughput = megabytesPerSecond(serial.byteCount, start);
+
+    start = clock::now();
+
+    const auto parallel = gltf_importer::decode(PATH);
+
+    const auto parallelThroughput = megabytesPerSecond(parallel.byteCount, start);
+
+    std::remove(PATH);
+
+    std::cout << "gltf_importer benchmark, " << MESH_COUNT << " meshes of " << VERTEX_COUNT << " vertexes, "
+        << IMAGE_COUNT << " " << IMAGE_SIZE << "x" << IMAGE_SIZE << " pngs, " << parallel.byteCount / 1000000 << "MB:\n"
+        << "serial: " << serialThroughput << "MB/s\n"
+        << "parallel: " << parallelThroughput << "MB/s\n";
+
+    REQUIRE(parallel.meshes.size() == MESH_COUNT);
+    REQUIRE(parallel.meshes.back().primitives[0].indexes == serial.meshes.back().primitives[0].indexes);
+    REQUIRE(parallel.meshes.back().primitives[0].attributes[1].components == serial.meshes.back().primitives[0].attributes[1].components);
+}
@@ -0,0 +1,308 @@
+// © 2019 Joseph Cameron - All Rights Reserved
+
+#include <chrono>
+#include <cstdint>
+#include <cstring>
+#include <iostream>
+#include <stdexcept>
+#include <vector>
+
+#include <jfc/catch.hpp>
+
+#include <gdk/webgl1es2_interleaved_view.h>
+
+using namespace gdk;
+
+//! names of a format's attributes, in vertex order
+static std::vector<std::string> names_of(const webgl1es2_vertex_format &aFormat)
+{
+    std::vector<std::string> names;
+
+    for (const auto &attribute : aFormat.getAttributes()) names.push_back(attribute.name);
+
+    return names;
+}
+
+TEST_CASE("gdk::webgl1es2_interleaved_view", "[gdk::webgl1es2_interleaved_view]")
+{
+    std::vector<float> positions({
+        0, 0, 0,
+        1, 0, 0,
+        1, 1, 0});
+
+    std::vector<float> uvs({
+        0, 0,
+        1, 0,
+        1, 1});
+
+    std::vector<float> normals({
+        0, 0, 1,
+        0, 0, 1,
+        0, 0, 1});
+
+    std::vector<float> weights({0.25f, 0.5f, 0.75f});
+
+    SECTION("attributes are interleaved in canonical order: conventional by location, then by name")
+    {
+        const webgl1es2_interleaved_view interleaved(vertex_data_view(vertex_data_view::UsageHint::Static, {
+            {"z_Weight", attribute_data_view(weights.data(), weights.size(), 1)},
+            {"a_Normal", attribute_data_view(normals.data(), normals.size(), 3)},
+            {"b_Weight", attribute_data_view(weights.data(), weights.size(), 1)},
+            {"a_UV", attribute_data_view(uvs.data(), uvs.size(), 2)},
+            {"a_Position", attribute_data_view(positions.data(), positions.size(), 3)}}), false);
+
+        REQUIRE(names_of(interleaved.vertexFormat) == std::vector<std::string>({"a_Position", "a_UV", "a_Normal", "b_Weight", "z_Weight"}));
+
+        REQUIRE(interleaved.vertexData == std::vector<float>({
+            0, 0, 0, 0, 0, 0, 0, 1, 0.25f, 0.25f,
+            1, 0, 0, 1, 0, 0, 0, 1, 0.5f, 0.5f,
+            1, 1, 0, 1, 1, 0, 0, 1, 0.75f, 0.75f}));
+
+        REQUIRE(interleaved.indexData.empty());
+    }
+
+    SECTION("the same attributes give the same data, whatever order the view was built in")
+    {
+        const webgl1es2_interleaved_view a(vertex_data_view(vertex_data_view::UsageHint::Static, {
+            {"a_Position", attribute_data_view(positions.data(), positions.size(), 3)},
+            {"a_Normal", attribute_data_view(normals.data(), normals.size(), 3)}}), false);
+
+        const webgl1es2_interleaved_view b(vertex_data_view(vertex_data_view::UsageHint::Static, {
+            {"a_Normal", attribute_data_view(normals.data(), normals.size(), 3)},
+            {"a_Position", attribute_data_view(positions.data(), positions.size(), 3)}}), false);
+
+        REQUIRE(names_of(a.vertexFormat) == names_of(b.vertexFormat));
+        REQUIRE(a.vertexData == b.vertexData);
+    }
+
+    SECTION("usage hints map to model types")
+    {
+        const auto typeOf = [&positions](const vertex_data_view::UsageHint aUsage)
+        {
+            return webgl1es2_interleaved_view(vertex_data_view(aUsage, {
+                {"a_Position", attribute_data_view(positions.data(), positions.size(), 3)}}), false).type;
+        };
+
+        REQUIRE(typeOf(vertex_data_view::UsageHint::Static) == webgl1es2_model::Type::Static);
+        REQUIRE(typeOf(vertex_data_view::UsageHint::Dynamic) == webgl1es2_model::Type::Dynamic);
+        REQUIRE(typeOf(vertex_data_view::UsageHint::Streaming) == webgl1es2_model::Type::Stream);
+    }
+
+    SECTION("packed attributes are converted in place")
+    {
+        const webgl1es2_interleaved_view interleaved(vertex_data_view(vertex_data_view::UsageHint::Static, {
+            {"a_Position", attribute_data_view(positions.data(), positions.size(), 3)},
+            {"a_Normal", attribute_data_view(normals.data(), normals.size(), 3, attribute_data_view::StorageType::NormalizedByte)}}), false);
+
+        // 3 position words, then 3 normal bytes padded to a word
+        REQUIRE(interleaved.vertexFormat.getSumOfAttributeComponents() == 4);
+        REQUIRE(interleaved.vertexData.size() == 12);
+
+        std::int8_t normal[4];
+        std::memcpy(normal, &interleaved.vertexData[7], sizeof(normal));
+
+        REQUIRE(normal[0] == 0);
+        REQUIRE(normal[1] == 0);
+        REQUIRE(normal[2] == 127);
+        REQUIRE(normal[3] == 0);
+    }
+
+    SECTION("index views are copied")
+    {
+        const std::vector<vertex_data_view::index_type> indexes({0, 1, 2, 2, 1, 0});
+
+        const webgl1es2_interleaved_view interleaved(vertex_data_view(vertex_data_view::UsageHint::Static, {
+            {"a_Position", attribute_data_view(positions.data(), positions.size(), 3)}},
+            indexes.data(), indexes.size()), false);
+
+        REQUIRE(interleaved.indexData == std::vector<webgl1es2_model::index_data_type>(indexes.begin(), indexes.end()));
+        REQUIRE(interleaved.getVertexData() == positions.data());
+    }
+
+    SECTION("optimized index views are reordered, not welded")
+    {
+        const std::vector<vertex_data_view::index_type> indexes({2, 1, 0});
+
+        const webgl1es2_interleaved_view interleaved(vertex_data_view(vertex_data_view::UsageHint::Static, {
+            {"a_Position", attribute_data_view(positions.data(), positions.size(), 3)}},
+            indexes.data(), indexes.size(), vertex_data_view::Optimization::Full), false);
+
+        REQUIRE(interleaved.indexData == std::vector<webgl1es2_model::index_data_type>({0, 1, 2}));
+        REQUIRE(interleaved.vertexData == std::vector<float>({
+            1, 1, 0,
+            1, 0, 0,
+            0, 0, 0}));
+    }
+
+    SECTION("index referring to a vertex that does not exist throws")
+    {
+        const std::vector<vertex_data_view::index_type> indexes({0, 1, 3});
+
+        REQUIRE_THROWS_AS(webgl1es2_interleaved_view(vertex_data_view(vertex_data_view::UsageHint::Static, {
+            {"a_Position", attribute_data_view(positions.data(), positions.size(), 3)}},
+            indexes.data(), indexes.size()), false), std::invalid_argument);
+    }
+
+    SECTION("attributes of different vertex counts throw")
+    {
+        REQUIRE_THROWS_AS(webgl1es2_interleaved_view(vertex_data_view(vertex_data_view::UsageHint::Static, {
+            {"a_Position", attribute_data_view(positions.data(), positions.size(), 3)},
+            {"a_UV", attribute_data_view(uvs.data(), uvs.size() - 2, 2)}}), false), std::invalid_argument);
+    }
+
+    SECTION("a buffer already in the format's layout is used as is")
+    {
+        std::vector<float> buffer({
+            0, 0, 0, 0, 0,
+            1, 0, 0, 1, 0,
+            1, 1, 0, 1, 1});
+
+        const webgl1es2_interleaved_view interleaved(vertex_data_view(vertex_data_view::UsageHint::Static, {
+            {"a_UV", attribute_data_view(buffer.data(), 3, 2, 5 * sizeof(float), 3 * sizeof(float))},
+            {"a_Position", attribute_data_view(buffer.data(), 3, 3, 5 * sizeof(float), 0)}}), false);
+
+        REQUIRE(interleaved.pSharedVertexData == buffer.data());
+        REQUIRE(interleaved.vertexData.empty());
+        REQUIRE(interleaved.getVertexData() == buffer.data());
+        REQUIRE(interleaved.getVertexDataSize() == buffer.size());
+    }
+
+    SECTION("tightly packed single attributes are used as is")
+    {
+        const webgl1es2_interleaved_view interleaved(vertex_data_view(vertex_data_view::UsageHint::Static, {
+            {"a_Position", attribute_data_view(positions.data(), positions.size(), 3)}}), false);
+
+        REQUIRE(interleaved.getVertexData() == positions.data());
+    }
+
+    SECTION("a buffer in another layout is interleaved into the format's layout")
+    {
+        // uv before position, and an unused component at the end of each vertex
+        std::vector<float> buffer({
+            0, 0, 0, 0, 0, -1,
+            1, 0, 1, 0, 0, -1,
+            1, 1, 1, 1, 0, -1});
+
+        const webgl1es2_interleaved_view interleaved(vertex_data_view(vertex_data_view::UsageHint::Static, {
+            {"a_UV", attribute_data_view(buffer.data(), 3, 2, 6 * sizeof(float), 0)},
+            {"a_Position", attribute_data_view(buffer.data(), 3, 3, 6 * sizeof(float), 2 * sizeof(float))}}), false);
+
+        REQUIRE(!interleaved.pSharedVertexData);
+        REQUIRE(interleaved.vertexData == std::vector<float>({
+            0, 0, 0, 0, 0,
+            1, 0, 0, 1, 0,
+            1, 1, 0, 1, 1}));
+    }
+
+    SECTION("strided attributes are gathered before they are packed")
+    {
+        std::vector<float> buffer({
+            0, 0, 0, 0, 0, 1,
+            1, 0, 0, 0, 0, 1,
+            1, 1, 0, 0, 0, 1});
+
+        const webgl1es2_interleaved_view interleaved(vertex_data_view(vertex_data_view::UsageHint::Static, {
+            {"a_Position", attribute_data_view(buffer.data(), 3, 3, 6 * sizeof(float), 0)},
+            {"a_Normal", attribute_data_view(buffer.data(), 3, 3, 6 * sizeof(float), 3 * sizeof(float), 
+                attribute_data_view::StorageType::NormalizedByte)}}), false);
+
+        REQUIRE(!interleaved.pSharedVertexData);
+        REQUIRE(interleaved.vertexData.size() == 12);
+
+        for (size_t vertex(0); vertex < 3; ++vertex)
+        {
+            REQUIRE(interleaved.vertexData[(vertex * 4) + 0] == buffer[(vertex * 6) + 0]);
+            REQUIRE(interleaved.vertexData[(vertex * 4) + 1] == buffer[(vertex * 6) + 1]);
+
+            std::int8_t normal[4];
+            std::memcpy(normal, &interleaved.vertexData[(vertex * 4) + 3], sizeof(normal));
+
+            REQUIRE(normal[2] == 127);
+        }
+    }
+
+    SECTION("optimized views are copied, even if their buffer is already in the format's layout")
+    {
+        const webgl1es2_interleaved_view interleaved(vertex_data_view(vertex_data_view::UsageHint::Static, {
+            {"a_Position", attribute_data_view(positions.data(), positions.size(), 3)}},
+            vertex_data_view::Optimization::Full), false);
+
+        REQUIRE(!interleaved.pSharedVertexData);
+        REQUIRE(interleaved.getVertexData() == interleaved.vertexData.data());
+    }
+
+    SECTION("strides and offsets that are not whole numbers of components throw")
+    {
+        std::vector<float> buffer(16);
+
+        REQUIRE_THROWS_AS(attribute_data_view(buffer.data(), 2, 3, 13, 0), std::invalid_argument);
+        REQUIRE_THROWS_AS(attribute_data_view(buffer.data(), 2, 3, 16, 2), std::invalid_argument);
+        REQUIRE_THROWS_AS(attribute_data_view(buffer.data(), 2, 3, 8, 0), std::invalid_argument);
+    }
+
+    SECTION("attributes that do not end within the stride throw")
+    {
+        std::vector<float> buffer(16);
+
+        // a vec3 at the fourth float of a 5 float vertex would run into the next vertex
+        REQUIRE_THROWS_AS(attribute_data_view(buffer.data(), 2, 3, 5 * sizeof(float), 3 * sizeof(float)), std::invalid_argument);
+        REQUIRE_NOTHROW(attribute_data_view(buffer.data(), 2, 3, 5 * sizeof(float), 2 * sizeof(float)));
+    }
+
+    SECTION("empty view throws")
+    {
+        REQUIRE_THROWS_AS(webgl1es2_interleaved_view(vertex_data_view(vertex_data_view::UsageHint::Static, {}), false),
+            std::invalid_argument);
+    }
+}
+
+TEST_CASE("gdk::webgl1es2_interleaved_view benchmark", "[.][benchmark][gdk::webgl1es2_interleaved_view]")
+{
+    static constexpr size_t VERTEX_COUNT(1000000);
+
+    std::vector<float> positions(VERTEX_COUNT * 3), uvs(VERTEX_COUNT * 2), normals(VERTEX_COUNT * 3);
+
+    for (size_t i(0); i < positions.size(); ++i) positions[i] = static_cast<float>(i);
+    for (size_t i(0); i < uvs.size(); ++i) uvs[i] = static_cast<float>(i) * 0.5f;
+    for (size_t i(0); i < normals.size(); ++i) normals[i] = static_cast<float>(i) * 0.25f;
+
+    const vertex_data_view view(vertex_data_view::UsageHint::Static, {
+        {"a_Position", attribute_data_view(positions.data(), positions.size(), 3)},
+        {"a_UV", attribute_data_view(uvs.data(), uvs.size(), 2)},
+        {"a_Normal", attribute_data_view(normals.data(), normals.size(), 3)}});
+
+    using clock = std::chrono::steady_clock;
+
+    const auto milliseconds = [](const clock::time_point aStart)
+    {
+        return std::chrono::duration<double, std::milli>(clock::now() - aStart).count();
+    };
+
+    // baseline: a float at a time into an unreserved vector
+    auto start = clock::now();
+
+    std::vector<float> naive;
+
+    for (size_t vertex(0); vertex < VERTEX_COUNT; ++vertex)
+        for (const auto *pAttribute : {&positions, &uvs, &normals})
+        {
+            const auto componentCount = pAttribute->size() / VERTEX_COUNT;
+
+            for (size_t component(0); component < componentCount; ++component)
+                naive.push_back((*pAttribute)[(vertex * componentCount) + component]);
+        }
+
+    const auto naiveTime = milliseconds(start);
+
+    start = clock::now();
+
+    const webgl1es2_interleaved_view interleaved(view, false);
+
+    const auto interleavedTime = milliseconds(start);
+
+    std::cout << "webgl1es2_interleaved_view benchmark, " << VERTEX_COUNT << " vertexes of Pos3uv2Norm3:\n"
+        << "naive: " << naiveTime << "ms\n"
+        << "interleaved view: " << interleavedTime << "ms\n";
+
+    REQUIRE(interleaved.vertexData == naive);
+}
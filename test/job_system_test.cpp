@@ -0,0 +1,189 @@
+// © 2019 Joseph Cameron - All Rights Reserved
+
+#include <atomic>
+#include <cstdint>
+#include <functional>
+#include <stdexcept>
+#include <thread>
+#include <vector>
+
+#include <jfc/catch.hpp>
+
+#include <gdk/job_system.h>
+#include <gdk/work_stealing_deque.h>
+
+using namespace gdk;
+
+TEST_CASE("gdk::job_system", "[gdk::job_system]")
+{
+    job_system jobs(4);
+
+    SECTION("parallel_for visits every index exactly once")
+    {
+        std::vector<int> visits(100000, 0);
+
+        jobs.parallel_for(0, visits.size(), 1000, [&visits](const size_t aBegin, const size_t aEnd)
+        {
+            for (auto i(aBegin); i < aEnd; ++i) ++visits[i];
+        });
+
+        for (const auto count : visits) REQUIRE(count == 1);
+    }
+
+    SECTION("parallel_for over an empty range does nothing")
+    {
+        bool isCalled(false);
+
+        jobs.parallel_for(10, 10, 1, [&isCalled](const size_t, const size_t) { isCalled = true; });
+
+        REQUIRE(!isCalled);
+    }
+
+    SECTION("jobs run after their dependencies")
+    {
+        std::atomic<int> order(0);
+
+        int a(-1), b(-1), c(-1);
+
+        const auto jobA = jobs.submit([&]() { a = order++; });
+        const auto jobB = jobs.submit([&]() { b = order++; }, {jobA});
+        const auto jobC = jobs.submit([&]() { c = order++; }, {jobA, jobB});
+
+        jobs.wait(jobC);
+
+        REQUIRE(jobs.is_finished(jobA));
+        REQUIRE(jobs.is_finished(jobB));
+        REQUIRE(a == 0);
+        REQUIRE(b == 1);
+        REQUIRE(c == 2);
+    }
+
+    SECTION("jobs can wait on nested parallel work without deadlocking")
+    {
+        std::atomic<size_t> count(0);
+
+        std::vector<job_system::job_handle> handles;
+
+        for (int i(0); i < 200; ++i) handles.push_back(jobs.submit([&]()
+        {
+            jobs.parallel_for(0, 64, 4, [&count](const size_t aBegin, const size_t aEnd) { count += aEnd - aBegin; });
+        }));
+
+        for (const auto &pJob : handles) jobs.wait(pJob);
+
+        REQUIRE(count == 200 * 64);
+    }
+
+    SECTION("exceptions thrown by jobs are rethrown by wait and parallel_for")
+    {
+        REQUIRE_THROWS_AS(jobs.wait(jobs.submit([]() { throw std::runtime_error("job"); })), std::runtime_error);
+
+        REQUIRE_THROWS_AS(jobs.parallel_for(0, 100, 10, [](const size_t aBegin, const size_t)
+        {
+            if (aBegin == 50) throw std::runtime_error("range");
+        }), std::runtime_error);
+    }
+
+    SECTION("invalid arguments throw")
+    {
+        REQUIRE_THROWS_AS(job_system(size_t(0)), std::invalid_argument);
+        REQUIRE_THROWS_AS(job_system(job_system::scheduler_type()), std::invalid_argument);
+        REQUIRE_THROWS_AS(jobs.submit(nullptr), std::invalid_argument);
+        REQUIRE_THROWS_AS(jobs.submit([]() {}, {nullptr}), std::invalid_argument);
+    }
+}
+
+TEST_CASE("gdk::job_system with an injected scheduler", "[gdk::job_system]")
+{
+    SECTION("jobs are handed to the scheduler")
+    {
+        size_t scheduledCount(0);
+
+        job_system jobs([&scheduledCount](std::function<void()> aJob)
+        {
+            ++scheduledCount;
+
+            aJob();
+        });
+
+        REQUIRE(jobs.worker_count() == 0);
+
+        int value(0);
+
+        const auto pFirst = jobs.submit([&value]() { value = 1; });
+        const auto pSecond = jobs.submit([&value]() { value *= 2; }, {pFirst});
+
+        jobs.wait(pSecond);
+
+        REQUIRE(value == 2);
+        REQUIRE(scheduledCount == 2);
+    }
+
+    SECTION("the scheduler can run jobs on its own threads")
+    {
+        job_system jobs([](std::function<void()> aJob)
+        {
+            std::thread(std::move(aJob)).detach();
+        });
+
+        std::atomic<size_t> count(0);
+
+        jobs.parallel_for(0, 100, 10, [&count](const size_t aBegin, const size_t aEnd) { count += aEnd - aBegin; });
+
+        REQUIRE(count == 100);
+    }
+}
+
+TEST_CASE("gdk::work_stealing_deque", "[gdk::work_stealing_deque]")
+{
+    work_stealing_deque<std::int64_t> deque(2);
+
+    SECTION("the owner pops newest first, thieves steal oldest first")
+    {
+        for (std::int64_t i(0); i < 100; ++i) deque.push(i);
+
+        REQUIRE(deque.size() == 100);
+        REQUIRE(*deque.pop() == 99);
+        REQUIRE(*deque.steal() == 0);
+        REQUIRE(deque.size() == 98);
+    }
+
+    SECTION("an empty deque yields nothing")
+    {
+        REQUIRE(deque.empty());
+        REQUIRE(!deque.pop());
+        REQUIRE(!deque.steal());
+    }
+
+    SECTION("every value is taken exactly once under contention")
+    {
+        static constexpr std::int64_t VALUE_COUNT(100000);
+
+        std::atomic<std::int64_t> stolenSum(0);
+        std::atomic<bool> isDone(false);
+
+        std::vector<std::thread> thieves;
+
+        for (int i(0); i < 3; ++i) thieves.emplace_back([&]()
+        {
+            while (!isDone || !deque.empty()) if (const auto value = deque.steal()) stolenSum += *value;
+        });
+
+        std::int64_t poppedSum(0);
+
+        for (std::int64_t i(1); i <= VALUE_COUNT; ++i)
+        {
+            deque.push(i);
+
+            if (!(i % 3)) if (const auto value = deque.pop()) poppedSum += *value;
+        }
+
+        while (const auto value = deque.pop()) poppedSum += *value;
+
+        isDone = true;
+
+        for (auto &thief : thieves) thief.join();
+
+        REQUIRE(stolenSum + poppedSum == VALUE_COUNT * (VALUE_COUNT + 1) / 2);
+    }
+}
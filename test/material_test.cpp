@@ -25,5 +25,18 @@ TEST_CASE("gdk::webgl1es2_material", "[gdk::webgl1es2_material]")
         
         REQUIRE(!jfc::glGetError());
     }
+
+    SECTION("set typed uniforms, activate the material repeatedly")
+    {
+        mat.setTexture("_Texture", webgl1es2_texture::GetCheckerboardOfDeath());
+        mat.setFloat("_Threshold", 0.5f);
+        mat.setVector4("_Tint", graphics_vector4_type(1, 0, 0, 1));
+        mat.setMatrix4x4("_MVP", graphics_mat4x4_type::Identity);
+
+        mat.activate();
+        mat.activate();
+
+        REQUIRE(!jfc::glGetError());
+    }
 }
 
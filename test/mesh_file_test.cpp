@@ -0,0 +1,145 @@
+// © 2019 Joseph Cameron - All Rights Reserved
+
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <stdexcept>
+#include <vector>
+
+#include <jfc/catch.hpp>
+
+#include <gdk/webgl1es2_mesh_file.h>
+
+using namespace gdk;
+
+TEST_CASE("gdk::webgl1es2_mesh_file", "[gdk::webgl1es2_mesh_file]")
+{
+    std::vector<float> positions({
+        -1, 0, 0,
+        1, 0, 2,
+        1, 3, 0,
+        -1, 3, -4});
+
+    std::vector<float> uvs({
+        0, 0,
+        1, 0,
+        1, 1,
+        0, 1});
+
+    const std::vector<vertex_data_view::index_type> indexes({0, 1, 2, 0, 2, 3});
+
+    const vertex_data_view view(vertex_data_view::UsageHint::Dynamic, {
+        {"a_Position", attribute_data_view(positions.data(), positions.size(), 3)},
+        {"a_UV", attribute_data_view(uvs.data(), uvs.size(), 2, attribute_data_view::StorageType::NormalizedUnsignedShort)}},
+        indexes.data(), indexes.size());
+
+    const auto encoded = webgl1es2_mesh_file::encode(view, {{0, 3}, {3, 3}});
+
+    SECTION("encoded mesh reads back in the layout make_model uses")
+    {
+        const webgl1es2_mesh_file meshFile(encoded.data(), encoded.size());
+
+        REQUIRE(meshFile.getType() == webgl1es2_model::Type::Dynamic);
+        REQUIRE(meshFile.getVertexFormat().getAttributes() == std::vector<webgl1es2_vertex_attribute>({
+            {"a_Position", 3},
+            {"a_UV", 2, webgl1es2_vertex_attribute::component_type::uint16_normalized}}));
+
+        // 3 position words, then 2 uv shorts in one word
+        REQUIRE(meshFile.getVertexDataSize() == 16);
+        REQUIRE(meshFile.getVertexData()[4] == 1);
+        REQUIRE(meshFile.getVertexData()[6] == 2);
+
+        std::uint16_t uv[2];
+        std::memcpy(uv, &meshFile.getVertexData()[11], sizeof(uv));
+
+        REQUIRE(uv[0] == 65535);
+        REQUIRE(uv[1] == 65535);
+
+        REQUIRE(meshFile.getIndexType() == GL_UNSIGNED_BYTE);
+        REQUIRE(meshFile.getIndexCount() == 6);
+        REQUIRE(static_cast<const std::uint8_t *>(meshFile.getIndexData())[5] == 3);
+
+        REQUIRE(meshFile.getSubmeshes().size() == 2);
+        REQUIRE(meshFile.getSubmeshes()[1].first == 3);
+        REQUIRE(meshFile.getSubmeshes()[1].count == 3);
+
+        REQUIRE(meshFile.getHeader().boundsMin == std::array<float, 3>({-1, 0, -4}));
+        REQUIRE(meshFile.getHeader().boundsMax == std::array<float, 3>({1, 3, 2}));
+    }
+
+    SECTION("blobs are aligned")
+    {
+        const webgl1es2_mesh_file meshFile(encoded.data(), encoded.size());
+
+        REQUIRE(meshFile.getHeader().vertexDataOffset % webgl1es2_mesh_file::BLOB_ALIGNMENT == 0);
+        REQUIRE(meshFile.getHeader().indexDataOffset % webgl1es2_mesh_file::BLOB_ALIGNMENT == 0);
+    }
+
+    SECTION("files are mapped")
+    {
+        static constexpr char PATH[] = "webgl1es2_mesh_file_test.gdkm";
+
+        std::ofstream(PATH, std::ios::binary).write(reinterpret_cast<const char *>(encoded.data()),
+            static_cast<std::streamsize>(encoded.size()));
+
+        {
+            const webgl1es2_mesh_file meshFile(PATH);
+
+            REQUIRE(std::memcmp(meshFile.getVertexData(), encoded.data() + meshFile.getHeader().vertexDataOffset,
+                sizeof(float) * meshFile.getVertexDataSize()) == 0);
+        }
+
+        std::remove(PATH);
+    }
+
+    SECTION("meshes without indexes have one submesh of every vertex by default")
+    {
+        const auto unindexed = webgl1es2_mesh_file::encode(vertex_data_view(vertex_data_view::UsageHint::Static, {
+            {"a_Position", attribute_data_view(positions.data(), positions.size(), 3)}}));
+
+        const webgl1es2_mesh_file meshFile(unindexed.data(), unindexed.size());
+
+        REQUIRE(!meshFile.getIndexData());
+        REQUIRE(meshFile.getIndexType() == 0);
+        REQUIRE(meshFile.getSubmeshes().size() == 1);
+        REQUIRE(meshFile.getSubmeshes()[0].count == 4);
+    }
+
+    SECTION("submesh exceeding the mesh throws")
+    {
+        REQUIRE_THROWS_AS(webgl1es2_mesh_file::encode(view, {{3, 4}}), std::invalid_argument);
+    }
+
+    SECTION("truncated data throws")
+    {
+        REQUIRE_THROWS_AS(webgl1es2_mesh_file(encoded.data(), encoded.size() - 1), std::runtime_error);
+        REQUIRE_THROWS_AS(webgl1es2_mesh_file(encoded.data(), 16), std::runtime_error);
+    }
+
+    SECTION("data that is not a mesh file throws")
+    {
+        auto corrupted = encoded;
+        corrupted[0] = std::byte(0);
+
+        REQUIRE_THROWS_AS(webgl1es2_mesh_file(corrupted.data(), corrupted.size()), std::runtime_error);
+    }
+
+    SECTION("index past the last vertex throws")
+    {
+        auto corrupted = encoded;
+
+        webgl1es2_mesh_file::header header;
+        std::memcpy(&header, corrupted.data(), sizeof(header));
+
+        // 4 vertexes, so indexes are a byte each
+        corrupted[static_cast<size_t>(header.indexDataOffset) + 4] = std::byte(header.vertexCount);
+
+        REQUIRE_THROWS_AS(webgl1es2_mesh_file(corrupted.data(), corrupted.size()), std::runtime_error);
+    }
+
+    SECTION("missing file throws")
+    {
+        REQUIRE_THROWS_AS(webgl1es2_mesh_file("does_not_exist.gdkm"), std::runtime_error);
+    }
+}
@@ -0,0 +1,159 @@
+// © 2019 Joseph Cameron - All Rights Reserved
+
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <iostream>
+#include <random>
+#include <set>
+#include <stdexcept>
+#include <vector>
+
+#include <jfc/catch.hpp>
+
+#include <gdk/mesh_optimizer.h>
+
+using namespace gdk;
+
+//! a grid of quads on the xy plane, as a triangle list that is not indexed. 3 position components per vertex
+static std::vector<float> make_grid(const size_t aQuadsPerSide)
+{
+    std::vector<float> vertexData;
+
+    const auto pushVertex = [&vertexData](const size_t x, const size_t y)
+    {
+        vertexData.insert(vertexData.end(), {static_cast<float>(x), static_cast<float>(y), 0.f});
+    };
+
+    for (size_t y(0); y < aQuadsPerSide; ++y) for (size_t x(0); x < aQuadsPerSide; ++x)
+    {
+        pushVertex(x, y);
+        pushVertex(x + 1, y);
+        pushVertex(x + 1, y + 1);
+
+        pushVertex(x, y);
+        pushVertex(x + 1, y + 1);
+        pushVertex(x, y + 1);
+    }
+
+    return vertexData;
+}
+
+//! set of triangles, each as its 3 positions, independent of vertex order and triangle order
+static std::multiset<std::vector<float>> triangles_of(const std::vector<float> &aVertexData, const std::vector<mesh_optimizer::index_type> &aIndexData)
+{
+    std::multiset<std::vector<float>> triangles;
+
+    for (size_t i(0); i < aIndexData.size(); i += 3)
+    {
+        std::vector<float> triangle;
+
+        for (size_t corner(0); corner < 3; ++corner) triangle.insert(triangle.end(),
+            aVertexData.begin() + (3 * aIndexData[i + corner]), aVertexData.begin() + (3 * (aIndexData[i + corner] + 1)));
+
+        triangles.insert(triangle);
+    }
+
+    return triangles;
+}
+
+TEST_CASE("gdk::mesh_optimizer", "[gdk::mesh_optimizer]")
+{
+    SECTION("weld merges identical vertexes")
+    {
+        std::vector<float> vertexData({0, 0, 1, 1, 0, 0, 2, 2, 1, 1});
+
+        const auto indexData = mesh_optimizer::weld(2, vertexData);
+
+        REQUIRE(indexData == std::vector<mesh_optimizer::index_type>({0, 1, 0, 2, 1}));
+        REQUIRE(vertexData == std::vector<float>({0, 0, 1, 1, 2, 2}));
+
+        REQUIRE_THROWS_AS(mesh_optimizer::weld(4, vertexData), std::invalid_argument);
+    }
+
+    SECTION("optimize keeps every triangle and reduces vertex shader invocations")
+    {
+        const auto original = make_grid(32);
+
+        auto vertexData = original;
+
+        const auto indexData = mesh_optimizer::optimize(3, vertexData, 0);
+
+        std::vector<mesh_optimizer::index_type> originalIndexData(original.size() / 3);
+
+        for (size_t i(0); i < originalIndexData.size(); ++i) originalIndexData[i] = static_cast<mesh_optimizer::index_type>(i);
+
+        REQUIRE(vertexData.size() == 3 * 33 * 33);
+        REQUIRE(triangles_of(vertexData, indexData) == triangles_of(original, originalIndexData));
+        REQUIRE(mesh_optimizer::average_cache_miss_ratio(originalIndexData, original.size() / 3) == 3);
+        REQUIRE(mesh_optimizer::average_cache_miss_ratio(indexData, vertexData.size() / 3) < 1);
+    }
+
+    SECTION("vertex fetch order follows first use, dropping unused vertexes")
+    {
+        std::vector<float> vertexData({0, 1, 2, 3});
+        std::vector<mesh_optimizer::index_type> indexData({3, 1, 3});
+
+        mesh_optimizer::optimize_vertex_fetch(1, vertexData, indexData);
+
+        REQUIRE(vertexData == std::vector<float>({3, 1}));
+        REQUIRE(indexData == std::vector<mesh_optimizer::index_type>({0, 1, 0}));
+    }
+
+    SECTION("invalid input throws")
+    {
+        std::vector<float> vertexData(3 * 4, 0);
+        std::vector<mesh_optimizer::index_type> indexData({0, 1, 4});
+
+        REQUIRE_THROWS_AS(mesh_optimizer::optimize(3, vertexData), std::invalid_argument);
+        REQUIRE_THROWS_AS(mesh_optimizer::optimize_vertex_cache(indexData, 4), std::out_of_range);
+        REQUIRE_THROWS_AS(mesh_optimizer::optimize_overdraw(3, 1, vertexData, indexData), std::invalid_argument);
+    }
+}
+
+TEST_CASE("gdk::mesh_optimizer benchmark", "[.][benchmark][gdk::mesh_optimizer]")
+{
+    static constexpr size_t QUADS_PER_SIDE(256);
+
+    auto vertexData = make_grid(QUADS_PER_SIDE);
+
+    // shuffle the triangles, as an arbitrarily ordered export would be
+    {
+        std::vector<std::vector<float>> triangles;
+
+        for (size_t i(0); i < vertexData.size(); i += 9) triangles.emplace_back(vertexData.begin() + i, vertexData.begin() + i + 9);
+
+        std::shuffle(triangles.begin(), triangles.end(), std::mt19937(1));
+
+        vertexData.clear();
+
+        for (const auto &triangle : triangles) vertexData.insert(vertexData.end(), triangle.begin(), triangle.end());
+    }
+
+    const auto triangleCount = vertexData.size() / 9;
+
+    auto weldedVertexData = vertexData;
+
+    const auto weldedIndexData = mesh_optimizer::weld(3, weldedVertexData);
+
+    using clock = std::chrono::steady_clock;
+
+    const auto start = clock::now();
+
+    const auto indexData = mesh_optimizer::optimize(3, vertexData, 0);
+
+    const auto optimizeTime = std::chrono::duration<double, std::milli>(clock::now() - start).count();
+
+    const auto weldedAcmr = mesh_optimizer::average_cache_miss_ratio(weldedIndexData, weldedVertexData.size() / 3);
+    const auto optimizedAcmr = mesh_optimizer::average_cache_miss_ratio(indexData, vertexData.size() / 3);
+
+    std::cout << "mesh_optimizer benchmark, " << triangleCount << " triangles, fifo cache of "
+        << mesh_optimizer::DEFAULT_CACHE_SIZE << ":\n"
+        << "ACMR not indexed: 3\n"
+        << "ACMR welded: " << weldedAcmr << "\n"
+        << "ACMR optimized: " << optimizedAcmr << "\n"
+        << "vertex shader invocations: " << (3 * triangleCount) << " -> " << static_cast<size_t>(optimizedAcmr * triangleCount) << "\n"
+        << "optimize: " << optimizeTime << "ms\n";
+
+    REQUIRE(optimizedAcmr < weldedAcmr);
+}
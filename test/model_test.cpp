@@ -1,6 +1,9 @@
 // © 2019 Joseph Cameron - All Rights Reserved
 
+#include <memory>
+#include <stdexcept>
 #include <string>
+#include <vector>
 
 #include <jfc/catch.hpp>
 #include <jfc/types.h>
@@ -8,6 +11,8 @@
 #include "test_include.h"
 
 #include <gdk/webgl1es2_model.h>
+#include <gdk/webgl1es2_render_state.h>
+#include <gdk/webgl1es2_shader_program.h>
 
 using namespace gdk;
 
@@ -25,5 +30,146 @@ TEST_CASE("webgl1es2_model", "[gdk::webgl1es2_model]")
 
         REQUIRE(pQuad->getHandle() >= 0);*/
     }
-}
 
+    SECTION("vertex and index data can be updated in place")
+    {
+        std::vector<webgl1es2_model::attribute_component_data_type> vertexData(5 * 4, 0.5f);
+
+        webgl1es2_model model(webgl1es2_model::Type::Dynamic, webgl1es2_vertex_format::Pos3uv2, vertexData);
+
+        REQUIRE(model.getType() == webgl1es2_model::Type::Dynamic);
+        REQUIRE(model.getVertexCount() == 4);
+
+        const std::shared_ptr<webgl1es2_shader_program> pProgram(webgl1es2_shader_program::AlphaCutOff);
+
+        const auto getBoundBufferParameter = [&model, &pProgram](const GLenum aTarget, const GLenum aParameter)
+        {
+            pProgram->useProgram();
+
+            model.bind(*pProgram);
+
+            // draw binds the index buffer
+            if (aTarget == GL_ELEMENT_ARRAY_BUFFER) model.draw();
+
+            GLint value(0);
+
+            glGetBufferParameteriv(aTarget, aParameter, &value);
+
+            return value;
+        };
+
+        SECTION("whole replacement can change the vertex count, and keeps the usage")
+        {
+            model.updateVertexData(std::vector<webgl1es2_model::attribute_component_data_type>(5 * 6, 1.f));
+
+            REQUIRE(model.getVertexCount() == 6);
+            REQUIRE(getBoundBufferParameter(GL_ARRAY_BUFFER, GL_BUFFER_SIZE) == sizeof(GLfloat) * 5 * 6);
+            REQUIRE(getBoundBufferParameter(GL_ARRAY_BUFFER, GL_BUFFER_USAGE) == GL_DYNAMIC_DRAW);
+            REQUIRE(!jfc::glGetError());
+        }
+
+        SECTION("ranged updates keep the buffer size")
+        {
+            const std::vector<webgl1es2_model::attribute_component_data_type> vertex(5, 2.f);
+
+            model.updateVertexData(5, vertex.data(), vertex.size());
+
+            REQUIRE(getBoundBufferParameter(GL_ARRAY_BUFFER, GL_BUFFER_SIZE) == sizeof(GLfloat) * 5 * 4);
+            REQUIRE(!jfc::glGetError());
+
+            REQUIRE_THROWS_AS(model.updateVertexData(16, vertex.data(), vertex.size()), std::out_of_range);
+        }
+
+        SECTION("index data can be added, updated and removed")
+        {
+            model.updateIndexData({0, 1, 2, 0, 2, 3});
+
+            REQUIRE(model.getIndexCount() == 6);
+            REQUIRE(getBoundBufferParameter(GL_ELEMENT_ARRAY_BUFFER, GL_BUFFER_SIZE) == sizeof(GLubyte) * 6);
+            REQUIRE(model.getIndexType() == GL_UNSIGNED_BYTE);
+
+            const std::vector<webgl1es2_model::index_data_type> triangle({3, 2, 1});
+
+            model.updateIndexData(3, triangle.data(), triangle.size());
+
+            REQUIRE_THROWS_AS(model.updateIndexData(4, triangle.data(), triangle.size()), std::out_of_range);
+
+            model.updateIndexData({});
+
+            REQUIRE(model.getIndexCount() == 0);
+            REQUIRE(!jfc::glGetError());
+        }
+
+        SECTION("data that is not a whole number of vertexes throws")
+        {
+            REQUIRE_THROWS_AS(model.updateVertexData(std::vector<webgl1es2_model::attribute_component_data_type>(7, 0)), 
+                std::invalid_argument);
+        }
+    }
+    SECTION("indexes are stored in the smallest type that fits")
+    {
+        const std::vector<webgl1es2_model::attribute_component_data_type> vertexData(3 * 70000, 0.5f);
+
+        webgl1es2_model small(webgl1es2_model::Type::Static, webgl1es2_vertex_format::Pos3, vertexData, {0, 1, 2, 0, 2, 3});
+        webgl1es2_model medium(webgl1es2_model::Type::Static, webgl1es2_vertex_format::Pos3, vertexData, {0, 1, 300});
+        webgl1es2_model large(webgl1es2_model::Type::Static, webgl1es2_vertex_format::Pos3, vertexData, {0, 1, 69999});
+
+        REQUIRE(small.getIndexType() == GL_UNSIGNED_BYTE);
+        REQUIRE(medium.getIndexType() == GL_UNSIGNED_SHORT);
+
+        if (webgl1es2_render_state::current().supportsUintIndexes())
+        {
+            REQUIRE(large.getIndexType() == GL_UNSIGNED_INT);
+            REQUIRE(large.getIndexChunks().empty());
+        }
+        else
+        {
+            REQUIRE(large.getIndexType() == GL_UNSIGNED_SHORT);
+            REQUIRE(large.getIndexChunks().size() == 1);
+            REQUIRE(large.getVertexCount() == 3);
+            REQUIRE_THROWS_AS(large.updateIndexData({0, 1, 2}), std::runtime_error);
+        }
+
+        const std::shared_ptr<webgl1es2_shader_program> pProgram(webgl1es2_shader_program::AlphaCutOff);
+
+        pProgram->useProgram();
+
+        for (const auto *pModel : {&small, &medium, &large})
+        {
+            pModel->bind(*pProgram);
+            pModel->draw();
+        }
+
+        REQUIRE(!jfc::glGetError());
+    }
+
+    SECTION("split_indexes divides indexed data into chunks that fit 16 bit indexes")
+    {
+        static constexpr size_t VERTEX_COUNT(70000);
+
+        std::vector<webgl1es2_model::attribute_component_data_type> vertexData(3 * VERTEX_COUNT);
+        std::vector<webgl1es2_model::index_data_type> indexData;
+
+        for (size_t i(0); i < vertexData.size(); ++i) vertexData[i] = static_cast<GLfloat>(i / 3);
+
+        for (webgl1es2_model::index_data_type i(0); i + 2 < VERTEX_COUNT; i += 3) indexData.insert(indexData.end(), {i, i + 1, i + 2});
+
+        const auto originalIndexData = indexData;
+
+        const auto chunks = webgl1es2_model::split_indexes(3, vertexData, indexData, webgl1es2_model::PrimitiveMode::Triangles);
+
+        REQUIRE(chunks.size() == 2);
+        REQUIRE(indexData.size() == originalIndexData.size());
+
+        for (const auto &chunk : chunks) for (size_t i(chunk.firstIndex); i < chunk.firstIndex + chunk.indexCount; ++i)
+        {
+            REQUIRE(indexData[i] < 65536);
+
+            // every split vertex still holds the position of the vertex it was copied from
+            REQUIRE(vertexData[3 * (chunk.firstVertex + indexData[i])] == static_cast<GLfloat>(originalIndexData[i]));
+        }
+
+        REQUIRE_THROWS_AS(webgl1es2_model::split_indexes(3, vertexData, indexData, webgl1es2_model::PrimitiveMode::TriangleStrip), 
+            std::invalid_argument);
+    }
+}
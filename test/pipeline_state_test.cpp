@@ -0,0 +1,66 @@
+// © 2019 Joseph Cameron - All Rights Reserved
+
+#include <string>
+#include <unordered_set>
+
+#include <jfc/catch.hpp>
+#include <jfc/types.h>
+
+#include "test_include.h"
+
+#include <gdk/webgl1es2_pipeline_state.h>
+
+using namespace gdk;
+
+TEST_CASE("gdk::webgl1es2_pipeline_state", "[gdk::webgl1es2_pipeline_state]")
+{
+    initGL();
+
+    const webgl1es2_pipeline_state a;
+
+    SECTION("default state is opaque")
+    {
+        REQUIRE(a == webgl1es2_pipeline_state::Opaque);
+        REQUIRE(a.getDepthTestEnabled());
+        REQUIRE(a.getDepthWriteEnabled());
+        REQUIRE(!a.getBlendEnabled());
+        REQUIRE(a.getFaceCullingMode() == webgl1es2_pipeline_state::face_culling_mode::none);
+        REQUIRE(a.getColorMask() == 0xF);
+    }
+
+    SECTION("with methods change only the requested state")
+    {
+        const auto b = a.withFaceCullingMode(webgl1es2_pipeline_state::face_culling_mode::back)
+            .withDepthFunction(webgl1es2_pipeline_state::depth_function::less_or_equal);
+
+        REQUIRE(b != a);
+        REQUIRE(b.getFaceCullingMode() == webgl1es2_pipeline_state::face_culling_mode::back);
+        REQUIRE(b.getDepthFunction() == webgl1es2_pipeline_state::depth_function::less_or_equal);
+        REQUIRE(b.getDepthWriteEnabled() == a.getDepthWriteEnabled());
+        REQUIRE(b.withFaceCullingMode(webgl1es2_pipeline_state::face_culling_mode::none)
+            .withDepthFunction(webgl1es2_pipeline_state::depth_function::less) == a);
+    }
+
+    SECTION("blended states sort after opaque states")
+    {
+        REQUIRE(webgl1es2_pipeline_state::AlphaBlended.getKey() > webgl1es2_pipeline_state::Opaque.getKey());
+        REQUIRE(webgl1es2_pipeline_state::Additive.getKey() > a.withFaceCullingMode(webgl1es2_pipeline_state::face_culling_mode::back).getKey());
+    }
+
+    SECTION("states are hashable")
+    {
+        std::unordered_set<webgl1es2_pipeline_state> set({a, webgl1es2_pipeline_state::AlphaBlended, webgl1es2_pipeline_state::Opaque});
+
+        REQUIRE(set.size() == 2);
+    }
+
+    SECTION("activating states does not cause gl errors")
+    {
+        webgl1es2_pipeline_state::AlphaBlended.activate();
+        webgl1es2_pipeline_state::AlphaBlended.activate();
+        a.withColorMask(true, false, true, false).withFaceCullingMode(webgl1es2_pipeline_state::face_culling_mode::front).activate();
+        a.activate();
+
+        REQUIRE(!jfc::glGetError());
+    }
+}
@@ -0,0 +1,124 @@
+// © 2019 Joseph Cameron - All Rights Reserved
+
+#include <thread>
+
+#include <jfc/catch.hpp>
+#include <jfc/types.h>
+
+#include "test_include.h"
+
+#include <gdk/webgl1es2_render_state.h>
+#include <gdk/webgl1es2_shader_program.h>
+
+using namespace gdk;
+
+TEST_CASE("gdk::webgl1es2_render_state", "[gdk::webgl1es2_render_state]")
+{
+    SECTION("bindings nest, and restore the previous state")
+    {
+        auto &threadDefault = webgl1es2_render_state::current();
+
+        webgl1es2_render_state a, b;
+
+        {
+            const webgl1es2_render_state::binding bindA(&a);
+
+            REQUIRE(&webgl1es2_render_state::current() == &a);
+
+            {
+                const webgl1es2_render_state::binding bindB(&b);
+
+                REQUIRE(&webgl1es2_render_state::current() == &b);
+
+                const webgl1es2_render_state::binding bindNothing(nullptr);
+
+                REQUIRE(&webgl1es2_render_state::current() == &b);
+            }
+
+            REQUIRE(&webgl1es2_render_state::current() == &a);
+        }
+
+        REQUIRE(&webgl1es2_render_state::current() == &threadDefault);
+    }
+
+    SECTION("each thread has its own default state")
+    {
+        const auto pMainDefault = &webgl1es2_render_state::current();
+
+        const webgl1es2_render_state *pOtherDefault = nullptr;
+
+        std::thread([&pOtherDefault]() { pOtherDefault = &webgl1es2_render_state::current(); }).join();
+
+        REQUIRE(pOtherDefault != pMainDefault);
+    }
+
+    SECTION("a state made without a gl context assumes the lowest common denominator")
+    {
+        bool supportsUintIndexes(true), supportsHalfFloatAttributes(true);
+
+        std::thread([&supportsUintIndexes, &supportsHalfFloatAttributes]()
+        {
+            const webgl1es2_render_state state;
+
+            supportsUintIndexes = state.supportsUintIndexes();
+            supportsHalfFloatAttributes = state.supportsHalfFloatAttributes();
+        }).join();
+
+        REQUIRE(!supportsUintIndexes);
+        REQUIRE(!supportsHalfFloatAttributes);
+    }
+
+    SECTION("states track programs independently")
+    {
+        webgl1es2_render_state a, b;
+
+        REQUIRE(a.setCurrentProgram(1));
+        REQUIRE(!a.setCurrentProgram(1));
+        REQUIRE(b.setCurrentProgram(1));
+
+        REQUIRE(a.getTextureUnit("_Texture") == 0);
+        REQUIRE(a.getTextureUnit("_Normals") == 1);
+        REQUIRE(a.getTextureUnit("_Texture") == 0);
+        REQUIRE(a.getTextureUnitCount() == 2);
+        REQUIRE(b.getTextureUnitCount() == 0);
+
+        REQUIRE(a.setCurrentProgram(2));
+        REQUIRE(a.getTextureUnitCount() == 0);
+
+        a.invalidate();
+
+        REQUIRE(a.setCurrentProgram(2));
+    }
+
+    SECTION("a program used in one state is used again when another state is bound")
+    {
+        initGL();
+
+        auto pProgram = static_cast<std::shared_ptr<webgl1es2_shader_program>>(webgl1es2_shader_program::PinkShaderOfDeath);
+
+        webgl1es2_render_state a, b;
+
+        {
+            const webgl1es2_render_state::binding bindA(&a);
+
+            pProgram->useProgram();
+        }
+
+        glUseProgram(0);
+
+        GLint handle;
+
+        {
+            const webgl1es2_render_state::binding bindB(&b);
+
+            handle = pProgram->useProgram();
+        }
+
+        GLint currentProgram;
+
+        glGetIntegerv(GL_CURRENT_PROGRAM, &currentProgram);
+
+        REQUIRE(currentProgram == handle);
+        REQUIRE(!jfc::glGetError());
+    }
+}
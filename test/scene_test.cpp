@@ -1,13 +1,25 @@
 // © 2019 Joseph Cameron - All Rights Reserved
 
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <iostream>
 #include <string>
+#include <thread>
+#include <vector>
 
 #include <jfc/catch.hpp>
 #include <jfc/types.h>
 
 #include <gdk/camera.h>
+#include <gdk/color.h>
 #include <gdk/webgl1es2_entity.h>
+#include <gdk/webgl1es2_material.h>
+#include <gdk/webgl1es2_model.h>
+#include <gdk/webgl1es2_pipeline_state.h>
 #include <gdk/webgl1es2_scene.h>
+#include <gdk/webgl1es2_shader_program.h>
 
 #include "test_include.h"
 
@@ -39,9 +51,290 @@ TEST_CASE("gdk::webgl1es2_scene", "[gdk::webgl1es2_scene]")
         REQUIRE(!jfc::glGetError());
     }
 
+    SECTION("extracted packets can be drawn, before and after extraction")
+    {
+        auto pMaterial = std::make_shared<webgl1es2_material>(webgl1es2_shader_program::AlphaCutOff);
+        auto pModel = std::shared_ptr<webgl1es2_model>(webgl1es2_model::Quad);
+        auto pEntity = std::make_shared<webgl1es2_entity>(pModel, pMaterial);
+
+        a.add_camera(std::shared_ptr<camera>(new webgl1es2_camera()));
+        a.add_entity(pEntity);
+
+        a.draw_extracted({400, 300});
+
+        a.extract();
+
+        pEntity->hide();
+
+        a.draw_extracted({400, 300});
+        a.draw_extracted({400, 300});
+
+        REQUIRE(!jfc::glGetError());
+    }
+
+    SECTION("extraction shares an entity's property overrides, and changes after it do not reach the packet")
+    {
+        auto pMaterial = std::make_shared<webgl1es2_material>(webgl1es2_shader_program::AlphaCutOff);
+        auto pModel = std::shared_ptr<webgl1es2_model>(webgl1es2_model::Quad);
+        auto pEntity = std::make_shared<webgl1es2_entity>(pModel, pMaterial);
+
+        pEntity->setFloat("_Cutoff", 0.5f);
+
+        a.add_camera(std::shared_ptr<camera>(new webgl1es2_camera()));
+        a.add_entity(pEntity);
+
+        a.extract();
+        a.draw_extracted({400, 300});
+
+        // the table compiled by the draw is kept on the entity's block, for the next extraction
+        const auto pOverrides = pEntity->getPropertyOverrides();
+
+        REQUIRE(pOverrides->compiled.programSerial == webgl1es2_shader_program::AlphaCutOff->getSerial());
+
+        a.extract();
+
+        REQUIRE(pEntity->getPropertyOverrides() == pOverrides);
+
+        // the packets still refer to the block, so it is replaced rather than modified
+        pEntity->setFloat("_Cutoff", 0.25f);
+
+        REQUIRE(pEntity->getPropertyOverrides() != pOverrides);
+
+        a.draw_extracted({400, 300});
+
+        REQUIRE(!jfc::glGetError());
+    }
+
+    SECTION("draw_extracted provides the time of the extracted packet")
+    {
+        initGL();
+
+        auto pProgram = std::make_shared<webgl1es2_shader_program>(R"V0G0N(
+            uniform mat4 _MVP;
+            uniform float _Time;
+
+            attribute highp vec3 a_Position;
+
+            void main ()
+            {
+                gl_Position = _MVP * vec4(a_Position, 1.0) + vec4(_Time);
+            }
+        )V0G0N", R"V0G0N(
+            void main()
+            {
+                gl_FragColor = vec4(1.0, 0.0, 1.0, 1.0);
+            }
+        )V0G0N");
+
+        auto pModel = std::shared_ptr<webgl1es2_model>(webgl1es2_model::Quad);
+
+        a.add_camera(std::shared_ptr<camera>(new webgl1es2_camera()));
+        a.add_entity(std::make_shared<webgl1es2_entity>(pModel, std::make_shared<webgl1es2_material>(pProgram)));
+
+        a.setTime(5);
+        a.extract();
+
+        // set after the extraction, so not part of the packet being drawn
+        a.setTime(9);
+
+        a.draw_extracted({400, 300});
+
+        GLfloat time;
+
+        glGetUniformfv(pProgram->useProgram(), 
+            pProgram->getStandardUniformLocation(webgl1es2_shader_program::standard_uniform::time), &time);
+
+        REQUIRE(time == 5);
+        REQUIRE(!jfc::glGetError());
+    }
+
+    SECTION("blended entities are drawn back to front")
+    {
+        initGL();
+
+        const auto makeBlendedMaterial = [](const std::string &aColor)
+        {
+            auto pMaterial = std::make_shared<webgl1es2_material>(std::make_shared<webgl1es2_shader_program>(R"V0G0N(
+                uniform mat4 _MVP;
+
+                attribute highp vec3 a_Position;
+
+                void main ()
+                {
+                    gl_Position = _MVP * vec4(a_Position, 1.0);
+                }
+            )V0G0N", std::string(R"V0G0N(
+                void main()
+                {
+                    gl_FragColor = )V0G0N").append(aColor).append(";}")));
+
+            pMaterial->setPipelineState(webgl1es2_pipeline_state::AlphaBlended);
+
+            return pMaterial;
+        };
+
+        // the near entity's program is made first, so its batch precedes the far entity's
+        auto pNearMaterial = makeBlendedMaterial("vec4(0.0, 1.0, 0.0, 0.5)");
+        auto pFarMaterial = makeBlendedMaterial("vec4(1.0, 0.0, 0.0, 0.5)");
+
+        auto pModel = std::shared_ptr<webgl1es2_model>(webgl1es2_model::Quad);
+
+        auto pNear = std::make_shared<webgl1es2_entity>(pModel, pNearMaterial);
+        pNear->set_model_matrix({0, 0, -0.2f}, graphics_quaternion_type());
+
+        auto pFar = std::make_shared<webgl1es2_entity>(pModel, pFarMaterial);
+        pFar->set_model_matrix({0, 0, -0.5f}, graphics_quaternion_type());
+
+        auto pCamera = std::make_shared<webgl1es2_camera>();
+        pCamera->setClearcolor(color::Black);
+
+        a.add_camera(pCamera);
+        a.add_entity(pNear);
+        a.add_entity(pFar);
+
+        a.draw({400, 300});
+
+        // drawn far then near, the near color dominates
+        std::uint8_t pixel[4];
+        glReadPixels(200, 150, 1, 1, GL_RGBA, GL_UNSIGNED_BYTE, pixel);
+
+        REQUIRE(pixel[1] > pixel[0]);
+        REQUIRE(!jfc::glGetError());
+    }
+
+    SECTION("transforms written from worker threads are applied by draw")
+    {
+        auto pMaterial = std::make_shared<webgl1es2_material>(webgl1es2_shader_program::AlphaCutOff);
+        auto pModel = std::shared_ptr<webgl1es2_model>(webgl1es2_model::Quad);
+
+        std::vector<std::shared_ptr<webgl1es2_entity>> entities;
+        std::vector<size_t> slots;
+
+        for (int i(0); i < 100; ++i)
+        {
+            entities.push_back(std::make_shared<webgl1es2_entity>(pModel, pMaterial));
+
+            a.add_entity(entities.back());
+
+            slots.push_back(a.add_transform_slot(entities.back()));
+        }
+
+        std::vector<std::thread> writers;
+
+        for (size_t writer(0); writer < 4; ++writer) writers.emplace_back([&, writer]()
+        {
+            for (size_t i(writer); i < slots.size(); i += 4)
+                a.write_transform(slots[i], {static_cast<float>(i), 0, 0}, graphics_quaternion_type());
+        });
+
+        for (auto &writer : writers) writer.join();
+
+        a.draw({400, 300});
+
+        for (size_t i(0); i < entities.size(); ++i)
+        {
+            graphics_mat4x4_type expected;
+            expected.translate({static_cast<float>(i), 0, 0});
+
+            REQUIRE(entities[i]->getModelMatrix() == expected);
+        }
+
+        REQUIRE(!jfc::glGetError());
+    }
+
     SECTION("Entity methods")
     {
         //auto pEntity = std::shared_ptr<entity>(new webgl1es2_entity());
     }
 }
 
+//! moves every entity, standing in for a simulation step
+static void simulate(std::vector<std::shared_ptr<webgl1es2_entity>> &aEntities, const float aTime)
+{
+    for (size_t i(0); i < aEntities.size(); ++i)
+    {
+        const float phase = aTime + static_cast<float>(i) * 0.01f;
+
+        aEntities[i]->set_model_matrix({std::sin(phase), std::cos(phase), -2}, graphics_quaternion_type(), {0.1f, 0.1f, 0.1f});
+    }
+}
+
+TEST_CASE("gdk::webgl1es2_scene extract benchmark", "[.][benchmark][gdk::webgl1es2_scene]")
+{
+    initGL();
+
+    static constexpr size_t ENTITY_COUNT(5000);
+    static constexpr size_t FRAME_COUNT(300);
+    const gdk::graphics_intvector2_type FRAME_SIZE(400, 300);
+
+    webgl1es2_scene scene;
+
+    scene.add_camera(std::shared_ptr<camera>(new webgl1es2_camera()));
+
+    auto pMaterial = std::make_shared<webgl1es2_material>(webgl1es2_shader_program::AlphaCutOff);
+    auto pModel = std::shared_ptr<webgl1es2_model>(webgl1es2_model::Quad);
+
+    std::vector<std::shared_ptr<webgl1es2_entity>> entities;
+
+    for (size_t i(0); i < ENTITY_COUNT; ++i)
+    {
+        entities.push_back(std::make_shared<webgl1es2_entity>(pModel, pMaterial));
+
+        scene.add_entity(entities.back());
+    }
+
+    using clock = std::chrono::steady_clock;
+
+    const auto toMilliseconds = [](const clock::duration aDuration)
+    {
+        return std::chrono::duration<double, std::milli>(aDuration).count() / FRAME_COUNT;
+    };
+
+    // simulation and rendering take turns on one thread
+    const auto serialStart = clock::now();
+
+    for (size_t frame(0); frame < FRAME_COUNT; ++frame)
+    {
+        simulate(entities, static_cast<float>(frame));
+
+        scene.draw(FRAME_SIZE);
+
+        glFinish();
+    }
+
+    const auto serialFrameTime = toMilliseconds(clock::now() - serialStart);
+
+    // simulation extracts packets on a worker thread while this thread renders them
+    std::atomic<bool> done(false);
+
+    const auto concurrentStart = clock::now();
+
+    std::thread simulation([&]()
+    {
+        for (size_t frame(0); !done; ++frame)
+        {
+            simulate(entities, static_cast<float>(frame));
+
+            scene.extract();
+        }
+    });
+
+    for (size_t frame(0); frame < FRAME_COUNT; ++frame)
+    {
+        scene.draw_extracted(FRAME_SIZE);
+
+        glFinish();
+    }
+
+    const auto concurrentFrameTime = toMilliseconds(clock::now() - concurrentStart);
+
+    done = true;
+
+    simulation.join();
+
+    std::cout << "extract benchmark, " << ENTITY_COUNT << " entities, mean frame time:\n"
+        << "serial simulate + draw: " << serialFrameTime << "ms\n"
+        << "concurrent simulate + extract / draw_extracted: " << concurrentFrameTime << "ms\n";
+
+    REQUIRE(!jfc::glGetError());
+}
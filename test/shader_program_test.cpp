@@ -31,6 +31,18 @@ TEST_CASE("gdk::webgl1es2_shader_program", "[gdk::webgl1es2_shader_program]")
         REQUIRE(*a == *b);
     }
 
+    SECTION("conventional attributes are bound to fixed locations")
+    {
+        auto a = static_cast<std::shared_ptr<webgl1es2_shader_program>>(webgl1es2_shader_program::AlphaCutOff);
+
+        REQUIRE(a->hasConventionalAttributeLocations());
+        REQUIRE(a->tryGetActiveAttribute("a_Position")->location == 0);
+        REQUIRE(a->tryGetActiveAttribute("a_UV")->location == 1);
+
+        REQUIRE(*webgl1es2_shader_program::tryGetConventionalAttributeLocation("a_Normal") == 2);
+        REQUIRE(!webgl1es2_shader_program::tryGetConventionalAttributeLocation("a_NotConventional"));
+    }
+
     auto a = static_cast<std::shared_ptr<webgl1es2_shader_program>>(webgl1es2_shader_program::AlphaCutOff);
 
     SECTION("can use the program in the pipeline, can assign uniform values")
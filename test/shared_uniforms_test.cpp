@@ -0,0 +1,98 @@
+// © 2019 Joseph Cameron - All Rights Reserved
+
+#include <string>
+
+#include <jfc/catch.hpp>
+#include <jfc/types.h>
+
+#include "test_include.h"
+
+#include <gdk/webgl1es2_shader_program.h>
+#include <gdk/webgl1es2_shared_uniforms.h>
+
+using namespace gdk;
+
+TEST_CASE("gdk::webgl1es2_shared_uniforms", "[gdk::webgl1es2_shared_uniforms]")
+{
+    initGL();
+
+    webgl1es2_shader_program program(R"V0G0N(
+        uniform mat4 _MVP;
+        uniform float _Time;
+
+        attribute highp vec3 a_Position;
+
+        void main ()
+        {
+            gl_Position = _MVP * vec4(a_Position, 1.0) + vec4(_Time);
+        }
+    )V0G0N", R"V0G0N(
+        void main()
+        {
+            gl_FragColor = vec4(1.0, 0.0, 1.0, 1.0);
+        }
+    )V0G0N");
+
+    using standard_uniform = webgl1es2_shader_program::standard_uniform;
+
+    const auto timeLocation = program.getStandardUniformLocation(standard_uniform::time);
+
+    const auto getTime = [&]()
+    {
+        GLfloat value;
+
+        glGetUniformfv(program.useProgram(), timeLocation, &value);
+
+        return value;
+    };
+
+    SECTION("programs resolve only the standard uniforms they declare")
+    {
+        REQUIRE(timeLocation != -1);
+        REQUIRE(program.getStandardUniformLocation(standard_uniform::model_view_projection) != -1);
+        REQUIRE(program.getStandardUniformLocation(standard_uniform::view) == -1);
+        REQUIRE(program.getStandardUniformLocation(standard_uniform::camera_position) == -1);
+    }
+
+    SECTION("values are uploaded only when their version is stale")
+    {
+        webgl1es2_shared_uniforms a;
+
+        program.useProgram();
+
+        a.setTime(2);
+        a.upload(program);
+
+        REQUIRE(getTime() == 2);
+
+        glUniform1f(timeLocation, 5);
+
+        a.setTime(2);
+        a.upload(program);
+
+        REQUIRE(getTime() == 5);
+
+        a.setTime(3);
+        a.upload(program);
+
+        REQUIRE(getTime() == 3);
+
+        REQUIRE(!jfc::glGetError());
+    }
+
+    SECTION("a second instance never shares versions with the first")
+    {
+        webgl1es2_shared_uniforms a, b;
+
+        program.useProgram();
+
+        a.setTime(7);
+        a.upload(program);
+
+        b.setTime(7);
+        glUniform1f(timeLocation, 5);
+        b.upload(program);
+
+        REQUIRE(getTime() == 7);
+    }
+}
@@ -0,0 +1,100 @@
+// © 2019 Joseph Cameron - All Rights Reserved
+
+#include <memory>
+#include <stdexcept>
+#include <vector>
+
+#include <jfc/catch.hpp>
+#include <jfc/types.h>
+
+#include "test_include.h"
+
+#include <gdk/webgl1es2_shader_program.h>
+#include <gdk/webgl1es2_stream_buffer.h>
+
+using namespace gdk;
+
+TEST_CASE("gdk::webgl1es2_stream_buffer", "[gdk::webgl1es2_stream_buffer]")
+{
+    initGL();
+
+    const auto &format = webgl1es2_vertex_format::Pos3uv2;
+
+    webgl1es2_stream_buffer buffer(5 * 8, 12, 2);
+
+    const std::shared_ptr<webgl1es2_shader_program> pProgram(webgl1es2_shader_program::AlphaCutOff);
+
+    SECTION("allocations are packed one after the other until the frame is full")
+    {
+        auto first = buffer.tryAllocate(format, 4, 6);
+        auto second = buffer.tryAllocate(format, 3);
+
+        REQUIRE(first);
+        REQUIRE(second);
+        REQUIRE(first->vertexOffset == 0);
+        REQUIRE(first->indexOffset == 0);
+        REQUIRE(second->vertexOffset == 5 * 4);
+        REQUIRE(second->pVertexData == first->pVertexData + (5 * 4));
+        REQUIRE(!second->pIndexData);
+
+        REQUIRE(!buffer.tryAllocate(format, 2));
+        REQUIRE(buffer.tryAllocate(format, 1));
+    }
+
+    SECTION("flushed allocations can be drawn until the next flush")
+    {
+        auto quad = *buffer.tryAllocate(format, 4, 6);
+        auto triangle = *buffer.tryAllocate(format, 3);
+
+        for (size_t i(0); i < 5 * 4; ++i) quad.pVertexData[i] = 0.5f;
+        for (size_t i(0); i < 5 * 3; ++i) triangle.pVertexData[i] = 0.25f;
+
+        const std::vector<webgl1es2_stream_buffer::index_data_type> indexes({0, 1, 2, 0, 2, 3});
+
+        for (size_t i(0); i < indexes.size(); ++i) quad.pIndexData[i] = indexes[i];
+
+        REQUIRE_THROWS_AS(buffer.draw(quad, format, *pProgram), std::runtime_error);
+
+        buffer.flush();
+
+        pProgram->useProgram();
+
+        buffer.draw(quad, format, *pProgram);
+        buffer.draw(triangle, format, *pProgram);
+
+        REQUIRE(!jfc::glGetError());
+
+        REQUIRE_THROWS_AS(buffer.draw(quad, webgl1es2_vertex_format::Pos3, *pProgram), std::invalid_argument);
+
+        buffer.flush();
+
+        REQUIRE_THROWS_AS(buffer.draw(quad, format, *pProgram), std::runtime_error);
+    }
+
+    SECTION("each flush starts an empty frame in the next buffers of the ring")
+    {
+        for (int frame(0); frame < 5; ++frame)
+        {
+            auto allocation = buffer.tryAllocate(format, 8);
+
+            REQUIRE(allocation);
+            REQUIRE(allocation->vertexOffset == 0);
+
+            for (size_t i(0); i < 5 * 8; ++i) allocation->pVertexData[i] = static_cast<float>(frame);
+
+            buffer.flush();
+
+            pProgram->useProgram();
+
+            buffer.draw(*allocation, format, *pProgram, webgl1es2_model::PrimitiveMode::Lines);
+        }
+
+        REQUIRE(!jfc::glGetError());
+    }
+
+    SECTION("invalid allocations throw")
+    {
+        REQUIRE_THROWS_AS(buffer.tryAllocate(format, 0), std::invalid_argument);
+        REQUIRE_THROWS_AS(buffer.tryAllocate(webgl1es2_vertex_format::Pos3, 70000, 3), std::invalid_argument);
+    }
+}
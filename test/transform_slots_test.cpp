@@ -0,0 +1,135 @@
+// © 2019 Joseph Cameron - All Rights Reserved
+
+#include <atomic>
+#include <cstddef>
+#include <thread>
+#include <vector>
+
+#include <jfc/catch.hpp>
+
+#include <gdk/webgl1es2_transform_slots.h>
+
+using namespace gdk;
+
+//! a transform whose components are all the same value
+static graphics_mat4x4_type make_uniform_transform(const float aValue)
+{
+    graphics_mat4x4_type transform;
+
+    for (size_t column(0); column < 4; ++column) for (size_t row(0); row < 4; ++row) transform.m[column][row] = aValue;
+
+    return transform;
+}
+
+TEST_CASE("gdk::webgl1es2_transform_slots", "[gdk::webgl1es2_transform_slots]")
+{
+    webgl1es2_transform_slots slots(130);
+
+    SECTION("only written slots are consumed, once")
+    {
+        slots.write(3, make_uniform_transform(3));
+        slots.write(64, make_uniform_transform(64));
+        slots.write(129, make_uniform_transform(129));
+
+        REQUIRE(slots.isDirty(64));
+        REQUIRE(!slots.isDirty(65));
+
+        std::vector<size_t> consumed;
+
+        REQUIRE(slots.consume([&consumed](const size_t aSlot, const graphics_mat4x4_type &aTransform)
+        {
+            REQUIRE(aTransform == make_uniform_transform(static_cast<float>(aSlot)));
+
+            consumed.push_back(aSlot);
+        }) == 3);
+
+        REQUIRE(consumed == std::vector<size_t>({3, 64, 129}));
+
+        REQUIRE(slots.consume([](const size_t, const graphics_mat4x4_type &) {}) == 0);
+    }
+
+    SECTION("discarded writes are not consumed")
+    {
+        slots.write(7, make_uniform_transform(7));
+        slots.discard(7);
+
+        REQUIRE(slots.consume([](const size_t, const graphics_mat4x4_type &) {}) == 0);
+    }
+
+    SECTION("resizing keeps transforms and dirty bits of remaining slots")
+    {
+        slots.write(1, make_uniform_transform(1));
+        slots.write(100, make_uniform_transform(100));
+
+        slots.resize(64);
+
+        REQUIRE(slots.size() == 64);
+        REQUIRE(slots.isDirty(1));
+
+        slots.resize(200);
+
+        REQUIRE(!slots.isDirty(100));
+
+        graphics_mat4x4_type transform;
+
+        REQUIRE(slots.read(150, transform));
+        REQUIRE(transform == graphics_mat4x4_type::Identity);
+
+        REQUIRE(slots.consume([](const size_t, const graphics_mat4x4_type &) {}) == 1);
+    }
+
+    SECTION("out of range slots throw")
+    {
+        REQUIRE_THROWS_AS(slots.write(130, graphics_mat4x4_type::Identity), std::out_of_range);
+    }
+}
+
+TEST_CASE("gdk::webgl1es2_transform_slots concurrent writers", "[gdk::webgl1es2_transform_slots]")
+{
+    static constexpr size_t WRITER_COUNT(8);
+    static constexpr size_t SLOTS_PER_WRITER(100);
+    static constexpr size_t WRITE_COUNT(2000);
+
+    webgl1es2_transform_slots slots(WRITER_COUNT * SLOTS_PER_WRITER);
+
+    std::atomic<size_t> runningWriterCount(WRITER_COUNT);
+
+    std::vector<std::thread> writers;
+
+    // each writer owns a contiguous range of slots, so neighbouring writers share dirty words
+    for (size_t writer(0); writer < WRITER_COUNT; ++writer) writers.emplace_back([&, writer]()
+    {
+        for (size_t i(1); i <= WRITE_COUNT; ++i) for (size_t slot(0); slot < SLOTS_PER_WRITER; ++slot)
+            slots.write((writer * SLOTS_PER_WRITER) + slot, make_uniform_transform(static_cast<float>(i)));
+
+        --runningWriterCount;
+    });
+
+    std::vector<float> latest(slots.size(), 0);
+
+    bool isTorn(false), isStale(false);
+
+    const auto consume = [&]()
+    {
+        slots.consume([&](const size_t aSlot, const graphics_mat4x4_type &aTransform)
+        {
+            const auto value = aTransform.m[0][0];
+
+            if (aTransform != make_uniform_transform(value)) isTorn = true;
+            if (value < latest[aSlot]) isStale = true;
+
+            latest[aSlot] = value;
+        });
+    };
+
+    while (runningWriterCount) consume();
+
+    for (auto &writer : writers) writer.join();
+
+    consume();
+
+    REQUIRE(!isTorn);
+    REQUIRE(!isStale);
+
+    for (const auto value : latest) REQUIRE(value == static_cast<float>(WRITE_COUNT));
+}
@@ -0,0 +1,74 @@
+// © 2019 Joseph Cameron - All Rights Reserved
+
+#include <string>
+#include <thread>
+
+#include <jfc/catch.hpp>
+
+#include <gdk/webgl1es2_triple_buffer.h>
+
+using namespace gdk;
+
+TEST_CASE("gdk::webgl1es2_triple_buffer", "[gdk::webgl1es2_triple_buffer]")
+{
+    webgl1es2_triple_buffer<int> a;
+
+    SECTION("acquire reports nothing new until something is published")
+    {
+        REQUIRE(!a.acquire());
+
+        a.back() = 1;
+        a.publish();
+
+        REQUIRE(a.acquire());
+        REQUIRE(a.front() == 1);
+        REQUIRE(!a.acquire());
+        REQUIRE(a.front() == 1);
+    }
+
+    SECTION("only the most recent publication is seen")
+    {
+        a.back() = 1;
+        a.publish();
+        a.back() = 2;
+        a.publish();
+
+        REQUIRE(a.acquire());
+        REQUIRE(a.front() == 2);
+    }
+
+    SECTION("a consumer on another thread sees published values in order, never a partial write")
+    {
+        static constexpr int LAST(100000);
+
+        webgl1es2_triple_buffer<std::pair<int, int>> b;
+
+        std::thread producer([&]()
+        {
+            for (int i(1); i <= LAST; ++i)
+            {
+                b.back() = {i, -i};
+                b.publish();
+            }
+        });
+
+        int previous(0);
+        bool ordered(true);
+
+        while (previous != LAST)
+        {
+            if (b.acquire())
+            {
+                const auto &value = b.front();
+
+                if (value.first <= previous || value.second != -value.first) ordered = false;
+
+                previous = value.first;
+            }
+        }
+
+        producer.join();
+
+        REQUIRE(ordered);
+    }
+}
@@ -0,0 +1,143 @@
+// © 2019 Joseph Cameron - All Rights Reserved
+
+#include <string>
+
+#include <jfc/catch.hpp>
+#include <jfc/types.h>
+
+#include "test_include.h"
+
+#include <gdk/webgl1es2_render_state.h>
+#include <gdk/webgl1es2_shader_program.h>
+#include <gdk/webgl1es2_texture.h>
+#include <gdk/webgl1es2_uniform_collection.h>
+
+using namespace gdk;
+
+TEST_CASE("gdk::webgl1es2_uniform_collection", "[gdk::webgl1es2_uniform_collection]")
+{
+    initGL();
+
+    webgl1es2_uniform_collection a;
+
+    SECTION("a new collection is empty")
+    {
+        REQUIRE(a.empty());
+        REQUIRE(!a.contains("_Texture"));
+    }
+
+    SECTION("overwriting a value does not change the layout, adding a name does")
+    {
+        a.set("_Threshold", 0.5f);
+
+        const auto version = a.getLayoutVersion();
+
+        a.set("_Threshold", 0.25f);
+
+        REQUIRE(a.getLayoutVersion() == version);
+
+        a.set("_Tint", graphics_vector4_type(1, 1, 1, 1));
+
+        REQUIRE(a.getLayoutVersion() != version);
+        REQUIRE(a.contains("_Tint"));
+    }
+
+    SECTION("assigning a value of a different type to an existing name throws")
+    {
+        a.set("_Threshold", 0.5f);
+
+        REQUIRE_THROWS(a.set("_Threshold", GLint(1)));
+    }
+
+    SECTION("compile drops unused names, upload assigns the rest")
+    {
+        auto pProgram = static_cast<std::shared_ptr<webgl1es2_shader_program>>(webgl1es2_shader_program::AlphaCutOff);
+
+        a.set("_Texture", webgl1es2_texture::GetCheckerboardOfDeath());
+        a.set("_NotInTheProgram", 1.0f);
+        a.set("_MVP", graphics_mat4x4_type::Identity);
+
+        const auto table = a.compile(*pProgram);
+
+        REQUIRE(table.uniforms.size() == 2);
+        REQUIRE(a.isCompiled(table, *pProgram));
+
+        pProgram->useProgram();
+
+        REQUIRE(a.upload(table) == 1);
+        REQUIRE(!jfc::glGetError());
+    }
+
+    SECTION("overrides reuse the units of the textures they override and give new textures free units")
+    {
+        auto pProgram = static_cast<std::shared_ptr<webgl1es2_shader_program>>(webgl1es2_shader_program::AlphaCutOff);
+
+        webgl1es2_uniform_collection defaults;
+        defaults.set("_Texture", webgl1es2_texture::GetCheckerboardOfDeath());
+
+        a.set("_Texture", webgl1es2_texture::GetCheckerboardOfDeath());
+        a.set("_MVP", graphics_mat4x4_type::Identity);
+
+        const auto table = a.compileOverrides(*pProgram, defaults);
+
+        REQUIRE(table.overrides.size() == 2);
+        REQUIRE(a.isCompiled(table, *pProgram, defaults));
+        REQUIRE(table.overrides[0].defaultValue);
+        REQUIRE(!table.overrides[1].defaultValue);
+
+        webgl1es2_render_state state;
+        const webgl1es2_render_state::binding binding(&state);
+
+        pProgram->useProgram();
+
+        defaults.upload(defaults.compile(*pProgram));
+        a.uploadOverrides(table, defaults);
+        a.restoreDefaults(table, defaults);
+
+        // the override is bound to the unit of the texture it overrides
+        REQUIRE(state.getTextureUnitCount() == 1);
+        REQUIRE(!jfc::glGetError());
+
+        defaults.set("_Tint", 1.0f);
+
+        REQUIRE(!a.isCompiled(table, *pProgram, defaults));
+    }
+
+    SECTION("textures are bound to the units the render state assigns to their names")
+    {
+        auto pProgram = static_cast<std::shared_ptr<webgl1es2_shader_program>>(webgl1es2_shader_program::AlphaCutOff);
+
+        webgl1es2_render_state state;
+        const webgl1es2_render_state::binding binding(&state);
+
+        pProgram->useProgram();
+
+        // a unit assigned by another user of the program, e.g: shader_program::setUniform
+        REQUIRE(state.getTextureUnit("_Other") == 0);
+
+        a.set("_Texture", webgl1es2_texture::GetCheckerboardOfDeath());
+        a.upload(a.compile(*pProgram));
+
+        GLint unit;
+        glGetUniformiv(pProgram->useProgram(), pProgram->tryGetActiveUniform("_Texture")->location, &unit);
+
+        REQUIRE(unit == 1);
+        REQUIRE(state.getTextureUnit("_Texture") == 1);
+        REQUIRE(!jfc::glGetError());
+    }
+
+    SECTION("pack appends value components")
+    {
+        std::vector<GLfloat> buffer;
+
+        a.set("_Tint", graphics_vector4_type(1, 2, 3, 4));
+        a.set("_Index", GLint(5));
+        a.set("_Texture", webgl1es2_texture::GetCheckerboardOfDeath());
+
+        REQUIRE(a.pack("_Tint", buffer) == 4);
+        REQUIRE(a.pack("_Index", buffer) == 1);
+        REQUIRE(a.pack("_Missing", buffer) == 0);
+        REQUIRE(buffer == std::vector<GLfloat>({1, 2, 3, 4, 5}));
+        REQUIRE_THROWS(a.pack("_Texture", buffer));
+    }
+}
@@ -0,0 +1,180 @@
+// © 2019 Joseph Cameron - All Rights Reserved
+
+#include <chrono>
+#include <cstddef>
+#include <stdexcept>
+#include <vector>
+
+#include <jfc/catch.hpp>
+#include <jfc/types.h>
+
+#include "test_include.h"
+
+#include <gdk/webgl1es2_model.h>
+#include <gdk/webgl1es2_texture.h>
+#include <gdk/webgl1es2_upload_queue.h>
+
+using namespace gdk;
+
+//! counts its uploads instead of touching the gl
+class counting_upload final : public webgl1es2_upload_queue::pending_upload
+{
+public:
+    size_t size;
+    size_t uploadCount = 0;
+
+    virtual size_t getSize() const override
+    {
+        return size;
+    }
+
+    virtual void upload() override
+    {
+        ++uploadCount;
+    }
+
+    counting_upload(const size_t aSize)
+    : size(aSize)
+    {}
+};
+
+//! fails its upload, as a gl error would
+class throwing_upload final : public webgl1es2_upload_queue::pending_upload
+{
+public:
+    virtual size_t getSize() const override
+    {
+        return 1;
+    }
+
+    virtual void upload() override
+    {
+        throw std::runtime_error("upload failed");
+    }
+};
+
+TEST_CASE("gdk::webgl1es2_upload_queue", "[gdk::webgl1es2_upload_queue]")
+{
+    webgl1es2_upload_queue queue;
+
+    static constexpr auto NO_TIME_LIMIT = std::chrono::microseconds::max();
+
+    SECTION("drain respects the byte budget")
+    {
+        std::vector<std::shared_ptr<counting_upload>> uploads;
+
+        for (int i(0); i < 4; ++i)
+        {
+            uploads.push_back(std::make_shared<counting_upload>(100));
+
+            queue.push(uploads.back());
+        }
+
+        REQUIRE(queue.getPendingCount() == 4);
+        REQUIRE(queue.getPendingBytes() == 400);
+
+        REQUIRE(queue.drain(250, NO_TIME_LIMIT) == 200);
+
+        REQUIRE(uploads[0]->isResident());
+        REQUIRE(uploads[1]->isResident());
+        REQUIRE(!uploads[2]->isResident());
+        REQUIRE(queue.getPendingCount() == 2);
+        REQUIRE(queue.getPendingBytes() == 200);
+
+        REQUIRE(queue.drain() == 200);
+
+        REQUIRE(queue.getPendingCount() == 0);
+
+        for (const auto &current : uploads) REQUIRE(current->uploadCount == 1);
+    }
+
+    SECTION("an upload larger than the budget is not stalled")
+    {
+        auto pUpload = std::make_shared<counting_upload>(1000);
+
+        queue.push(pUpload);
+
+        REQUIRE(queue.drain(1, NO_TIME_LIMIT) == 1000);
+        REQUIRE(pUpload->isResident());
+    }
+
+    SECTION("a spent time budget uploads a single item")
+    {
+        auto pFirst = std::make_shared<counting_upload>(1);
+        auto pSecond = std::make_shared<counting_upload>(1);
+
+        queue.push(pFirst);
+        queue.push(pSecond);
+
+        REQUIRE(queue.drain(1000, std::chrono::microseconds(0)) == 1);
+        REQUIRE(pFirst->isResident());
+        REQUIRE(!pSecond->isResident());
+    }
+
+    SECTION("uploads of destroyed resources are discarded")
+    {
+        auto pKept = std::make_shared<counting_upload>(10);
+
+        queue.push(std::make_shared<counting_upload>(10));
+        queue.push(pKept);
+
+        REQUIRE(queue.drain() == 10);
+        REQUIRE(pKept->isResident());
+        REQUIRE(queue.getPendingCount() == 0);
+    }
+
+    SECTION("uploads completed before one that throws are still made resident")
+    {
+        auto pBefore = std::make_shared<counting_upload>(10);
+        auto pFailing = std::make_shared<throwing_upload>();
+        auto pAfter = std::make_shared<counting_upload>(10);
+
+        queue.push(pBefore);
+        queue.push(pFailing);
+        queue.push(pAfter);
+
+        size_t synchronizeCount(0);
+
+        REQUIRE_THROWS_AS(queue.drain(1000, NO_TIME_LIMIT, [&]() { ++synchronizeCount; }), std::runtime_error);
+
+        REQUIRE(pBefore->isResident());
+        REQUIRE(!pFailing->isResident());
+        REQUIRE(synchronizeCount == 1);
+
+        REQUIRE(queue.drain() == 10);
+        REQUIRE(pAfter->isResident());
+        REQUIRE(pBefore->uploadCount == 1);
+    }
+
+    SECTION("pending models and textures become resident when drained")
+    {
+        initGL();
+
+        webgl1es2_model model(queue,
+            webgl1es2_model::Type::Static,
+            webgl1es2_vertex_format::Pos3,
+            std::vector<float>({0, 0, 0, 1, 0, 0, 0, 1, 0}));
+
+        std::vector<std::byte> pixels(4 * 4 * 4, std::byte(0xff));
+
+        webgl1es2_texture::webgl1es2_texture_2d_data_view_type view;
+        view.width = 4;
+        view.height = 4;
+        view.format = webgl1es2_texture::format::rgba;
+        view.data = pixels.data();
+
+        webgl1es2_texture texture(queue, view);
+
+        REQUIRE(!model.isResident());
+        REQUIRE(!texture.isResident());
+        REQUIRE(texture.getHandle() == 0);
+        REQUIRE(queue.getPendingBytes() == sizeof(float) * 9 + pixels.size());
+
+        queue.drain();
+
+        REQUIRE(model.isResident());
+        REQUIRE(texture.isResident());
+        REQUIRE(texture.getHandle() != 0);
+        REQUIRE(!jfc::glGetError());
+    }
+}
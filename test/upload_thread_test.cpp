@@ -0,0 +1,106 @@
+// © 2019 Joseph Cameron - All Rights Reserved
+
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <memory>
+#include <thread>
+#include <vector>
+
+#include <jfc/catch.hpp>
+#include <jfc/types.h>
+
+#include "test_include.h"
+
+#include <gdk/webgl1es2_texture.h>
+#include <gdk/webgl1es2_upload_thread.h>
+
+using namespace gdk;
+
+TEST_CASE("gdk::webgl1es2_upload_thread", "[gdk::webgl1es2_upload_thread]")
+{
+    initGL();
+
+    // a hidden window whose context shares objects with the test context
+    glfwWindowHint(GLFW_VISIBLE, GLFW_FALSE);
+
+    GLFWwindow *const pSharedWindow = glfwCreateWindow(1, 1, "gdk upload thread", nullptr, glfwGetCurrentContext());
+
+    glfwWindowHint(GLFW_VISIBLE, GLFW_TRUE);
+
+    REQUIRE(pSharedWindow);
+
+    auto pQueue = std::make_shared<webgl1es2_upload_queue>();
+
+    const auto makeCurrent = [pSharedWindow]() { glfwMakeContextCurrent(pSharedWindow); };
+    const auto releaseCurrent = []() { glfwMakeContextCurrent(nullptr); };
+
+    const auto waitUntilResident = [](const webgl1es2_texture &aTexture)
+    {
+        for (const auto timeout = std::chrono::steady_clock::now() + std::chrono::seconds(10);
+            !aTexture.isResident() && std::chrono::steady_clock::now() < timeout;)
+        {
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        }
+
+        return aTexture.isResident();
+    };
+
+    std::vector<std::byte> pixels(4 * 4 * 4, std::byte(0x7f));
+
+    webgl1es2_texture::webgl1es2_texture_2d_data_view_type view;
+    view.width = 4;
+    view.height = 4;
+    view.format = webgl1es2_texture::format::rgba;
+    view.data = pixels.data();
+
+    SECTION("textures made pending are uploaded by the thread and usable by the rendering context")
+    {
+        webgl1es2_upload_thread thread(pQueue, makeCurrent, releaseCurrent);
+
+        webgl1es2_texture texture(*pQueue, view);
+
+        REQUIRE(waitUntilResident(texture));
+
+        const auto handle = texture.getHandle();
+
+        REQUIRE(handle != 0);
+        REQUIRE(glIsTexture(handle));
+        REQUIRE(!jfc::glGetError());
+    }
+
+    SECTION("the synchronize function is called before uploads become resident")
+    {
+        std::atomic<int> synchronizeCount(0);
+
+        webgl1es2_upload_thread thread(pQueue, makeCurrent, releaseCurrent, [&synchronizeCount]()
+        {
+            glFinish();
+
+            ++synchronizeCount;
+        });
+
+        webgl1es2_texture texture(*pQueue, view);
+
+        REQUIRE(waitUntilResident(texture));
+        REQUIRE(synchronizeCount > 0);
+    }
+
+    SECTION("stopping leaves the rest of the queue pending")
+    {
+        {
+            webgl1es2_upload_thread thread(pQueue, makeCurrent, releaseCurrent);
+        }
+
+        webgl1es2_texture texture(*pQueue, view);
+
+        REQUIRE(!texture.isResident());
+        REQUIRE(pQueue->getPendingCount() == 1);
+
+        pQueue->drain();
+
+        REQUIRE(texture.isResident());
+    }
+
+    glfwDestroyWindow(pSharedWindow);
+}
@@ -47,6 +47,19 @@ TEST_CASE("gdk::webgl1es2_vertex_attribute", "[gdk::webgl1es2_vertex_attribute]"
     {
         REQUIRE(a.name == NAME);
         REQUIRE(a.size == SIZE);
+        REQUIRE(a.type == webgl1es2_vertex_attribute::component_type::float32);
+    }
+
+    SECTION("typed components are padded to 4 bytes")
+    {
+        const webgl1es2_vertex_attribute normal("a_Normal", 3, webgl1es2_vertex_attribute::component_type::int8_normalized);
+        const webgl1es2_vertex_attribute position("a_Position", 3, webgl1es2_vertex_attribute::component_type::float16);
+
+        REQUIRE(normal.getComponentSize() == 1);
+        REQUIRE(normal.getPaddedSize() == 4);
+        REQUIRE(position.getPaddedSize() == 8);
+        REQUIRE(a.getPaddedSize() == 8);
+        REQUIRE(normal != webgl1es2_vertex_attribute("a_Normal", 3));
     }
 }
 
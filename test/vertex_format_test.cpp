@@ -1,12 +1,15 @@
 // © 2019 Joseph Cameron - All Rights Reserved
 
+#include <memory>
 #include <string>
+#include <vector>
 
 #include <jfc/catch.hpp>
 #include <jfc/types.h>
 
 #include "test_include.h"
 
+#include <gdk/webgl1es2_shader_program.h>
 #include <gdk/webgl1es2_vertex_format.h>
 
 using namespace gdk;
@@ -21,5 +24,63 @@ TEST_CASE("webgl1es2_vertex_format", "[gdk::webgl1es2_vertex_format]")
         
         REQUIRE(format.getSumOfAttributeComponents() == decltype(format.getSumOfAttributeComponents())(3));
     }
+
+    SECTION("typed attributes are laid out in 4 byte words")
+    {
+        const webgl1es2_vertex_format format({
+            {"a_Position", 3},
+            {"a_Normal", 3, webgl1es2_vertex_attribute::component_type::int8_normalized},
+            {"a_UV", 2, webgl1es2_vertex_attribute::component_type::uint16_normalized}
+        });
+
+        REQUIRE(format.getSumOfAttributeComponents() == 5);
+        REQUIRE(*format.tryGetAttributeOffset("a_Normal") == 12);
+        REQUIRE(*format.tryGetAttributeOffset("a_UV") == 16);
+        REQUIRE(!format.tryGetAttributeOffset("a_Color"));
+    }
+
+    SECTION("bindings stay correct for more programs without conventional locations than the format keeps tables for")
+    {
+        const webgl1es2_vertex_format format({{"a_First", 1}, {"a_Second", 3}});
+
+        std::vector<std::unique_ptr<webgl1es2_shader_program>> programs;
+
+        // alternating declaration orders, so the programs do not all share locations
+        for (int i(0); i < 6; ++i) programs.push_back(std::make_unique<webgl1es2_shader_program>(std::string(i % 2 
+            ? "attribute float a_First; attribute vec3 a_Second;" 
+            : "attribute vec3 a_Second; attribute float a_First;").append(R"V0G0N(
+                void main ()
+                {
+                    gl_Position = vec4(a_Second, a_First);
+                }
+            )V0G0N"), R"V0G0N(
+                void main()
+                {
+                    gl_FragColor = vec4(1.0);
+                }
+            )V0G0N"));
+
+        for (int pass(0); pass < 2; ++pass) for (const auto &pProgram : programs)
+        {
+            REQUIRE(!pProgram->hasConventionalAttributeLocations());
+
+            const auto first = static_cast<GLuint>(pProgram->tryGetActiveAttribute("a_First")->location);
+            const auto second = static_cast<GLuint>(pProgram->tryGetActiveAttribute("a_Second")->location);
+
+            glVertexAttribPointer(first, 4, GL_FLOAT, GL_FALSE, 0, nullptr);
+            glVertexAttribPointer(second, 4, GL_FLOAT, GL_FALSE, 0, nullptr);
+
+            format.enableAttributes(*pProgram);
+
+            GLint firstSize, secondSize;
+            glGetVertexAttribiv(first, GL_VERTEX_ATTRIB_ARRAY_SIZE, &firstSize);
+            glGetVertexAttribiv(second, GL_VERTEX_ATTRIB_ARRAY_SIZE, &secondSize);
+
+            REQUIRE(firstSize == 1);
+            REQUIRE(secondSize == 3);
+        }
+
+        REQUIRE(!jfc::glGetError());
+    }
 }
 
@@ -0,0 +1,108 @@
+// © 2019 Joseph Cameron - All Rights Reserved
+
+#include <cmath>
+#include <cstdint>
+#include <limits>
+#include <vector>
+
+#include <jfc/catch.hpp>
+
+#include <gdk/vertex_quantizer.h>
+
+using namespace gdk;
+
+TEST_CASE("gdk::vertex_quantizer", "[gdk::vertex_quantizer]")
+{
+    // long enough to cover both the vectorized body and the scalar tail
+    std::vector<float> source({-2.f, -1.f, -0.5f, 0.f, 0.25f, 0.5f, 1.f, 2.f, std::numeric_limits<float>::quiet_NaN()});
+
+    while (source.size() < 19) source.push_back(0.75f);
+
+    SECTION("normalized conversions clamp and round to nearest")
+    {
+        std::vector<std::int8_t> snorm8(source.size());
+        std::vector<std::uint8_t> unorm8(source.size());
+        std::vector<std::int16_t> snorm16(source.size());
+        std::vector<std::uint16_t> unorm16(source.size());
+
+        vertex_quantizer::to_snorm8(source.data(), snorm8.data(), source.size());
+        vertex_quantizer::to_unorm8(source.data(), unorm8.data(), source.size());
+        vertex_quantizer::to_snorm16(source.data(), snorm16.data(), source.size());
+        vertex_quantizer::to_unorm16(source.data(), unorm16.data(), source.size());
+
+        REQUIRE(snorm8 == std::vector<std::int8_t>({-128, -128, -64, 0, 31, 63, 127, 127, -128,
+            95, 95, 95, 95, 95, 95, 95, 95, 95, 95}));
+        REQUIRE(unorm8 == std::vector<std::uint8_t>({0, 0, 0, 0, 64, 128, 255, 255, 0,
+            191, 191, 191, 191, 191, 191, 191, 191, 191, 191}));
+
+        REQUIRE(snorm16[0] == -32768);
+        REQUIRE(snorm16[5] == 16383);
+        REQUIRE(snorm16[7] == 32767);
+        REQUIRE(snorm16[18] == 24575);
+
+        REQUIRE(unorm16[1] == 0);
+        REQUIRE(unorm16[5] == 32768);
+        REQUIRE(unorm16[6] == 65535);
+        REQUIRE(unorm16[18] == 49151);
+    }
+
+    SECTION("signed normalized codes round trip through the gles2 decode")
+    {
+        // gles2 and webgl1 read a code c of b bits as (2c + 1) / (2^b - 1)
+        const auto decode = [](const int aCode, const float aMax)
+        {
+            return (2.f * aCode + 1.f) / aMax;
+        };
+
+        std::vector<float> decoded8, decoded16;
+
+        for (int code(-128); code <= 127; ++code) decoded8.push_back(decode(code, 255.f));
+        for (int code(-32768); code <= 32767; ++code) decoded16.push_back(decode(code, 65535.f));
+
+        std::vector<std::int8_t> snorm8(decoded8.size());
+        std::vector<std::int16_t> snorm16(decoded16.size());
+
+        vertex_quantizer::to_snorm8(decoded8.data(), snorm8.data(), decoded8.size());
+        vertex_quantizer::to_snorm16(decoded16.data(), snorm16.data(), decoded16.size());
+
+        for (size_t i(0); i < snorm8.size(); ++i) REQUIRE(snorm8[i] == static_cast<int>(i) - 128);
+        for (size_t i(0); i < snorm16.size(); ++i) REQUIRE(snorm16[i] == static_cast<int>(i) - 32768);
+
+        // anything in range decodes to within half a step, 1 / (2^b - 1), of itself
+        std::vector<std::int8_t> encoded8(source.size());
+
+        vertex_quantizer::to_snorm8(source.data(), encoded8.data(), source.size());
+
+        for (size_t i(0); i < source.size(); ++i) if (std::abs(source[i]) <= 1.f)
+            REQUIRE(std::abs(decode(encoded8[i], 255.f) - source[i]) <= 1.f / 255.f);
+    }
+
+    SECTION("half floats round to nearest even and convert back exactly")
+    {
+        const std::vector<float> values({1.f, -2.f, 65504.f, 65520.f, 0.1f, std::ldexp(1.f, -24), 0.f,
+            std::numeric_limits<float>::infinity(), 1.f + std::ldexp(1.f, -11)});
+
+        std::vector<std::uint16_t> halfs(values.size());
+
+        vertex_quantizer::to_half(values.data(), halfs.data(), values.size());
+
+        REQUIRE(halfs == std::vector<std::uint16_t>({0x3c00, 0xc000, 0x7bff, 0x7c00, 0x2e66, 0x0001, 0x0000, 0x7c00, 0x3c00}));
+
+        for (const auto half : halfs) if (half != 0x7c00)
+        {
+            std::uint16_t roundTripped;
+
+            const auto value = vertex_quantizer::from_half(half);
+
+            vertex_quantizer::to_half(&value, &roundTripped, 1);
+
+            REQUIRE(roundTripped == half);
+        }
+
+        std::vector<std::uint16_t> nans(source.size());
+
+        vertex_quantizer::to_half(source.data(), nans.data(), source.size());
+
+        REQUIRE(std::isnan(vertex_quantizer::from_half(nans[8])));
+    }
+}